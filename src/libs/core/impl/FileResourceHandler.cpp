@@ -21,10 +21,36 @@
 
 #include <fstream>
 
+#include "core/Exception.hpp"
 #include "core/ILogger.hpp"
+#include "core/Path.hpp"
+#include "core/http/ConditionalRequest.hpp"
 
 namespace lms
 {
+    namespace
+    {
+        core::http::CacheValidators computeFileValidators(const std::filesystem::path& path, ::uint64_t fileSize)
+        {
+            core::http::CacheValidators validators;
+
+            try
+            {
+                validators.lastModified = core::pathUtils::getLastWriteTime(path);
+
+                std::ostringstream oss;
+                oss << std::hex << validators.lastModified.toTime_t() << "-" << fileSize;
+                validators.entityTag = oss.str();
+            }
+            catch (const core::LmsException& e)
+            {
+                LMS_LOG(UTILS, ERROR, "Cannot compute validators for '" << path.string() << "': " << e.what());
+            }
+
+            return validators;
+        }
+    }
+
     std::unique_ptr<IResourceHandler> createFileResourceHandler(const std::filesystem::path& path, std::string_view mimeType)
     {
         return std::make_unique<FileResourceHandler>(path, mimeType);
@@ -56,6 +82,9 @@ namespace lms
 
             LMS_LOG(UTILS, DEBUG, "File '" << _path.string() << "', fileSize = " << fileSize);
 
+            if (core::http::processConditionalRequest(request, response, computeFileValidators(_path, fileSize)))
+                return {};
+
             response.addHeader("Accept-Ranges", "bytes");
 
             const Wt::Http::Request::ByteRangeSpecifier ranges{ request.getRanges(fileSize) };
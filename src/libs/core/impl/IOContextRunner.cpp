@@ -28,13 +28,20 @@ namespace lms::core
 {
     IOContextRunner::IOContextRunner(boost::asio::io_service& ioService, std::size_t threadCount, std::string_view name)
         : _ioService{ ioService }
+        , _name{ name }
         , _work{ ioService }
     {
         LMS_LOG(UTILS, INFO, "Starting IO context with " << threadCount << " threads...");
 
-        for (std::size_t i{}; i < threadCount; ++i)
+        addThreads(threadCount);
+    }
+
+    void IOContextRunner::addThreads(std::size_t threadCount)
+    {
+        const std::size_t firstThreadIndex{ _threads.size() };
+        for (std::size_t i{ firstThreadIndex }; i < firstThreadIndex + threadCount; ++i)
         {
-            std::string threadName{ name };
+            std::string threadName{ _name };
             if (!threadName.empty())
             {
                 threadName += "Thread_";
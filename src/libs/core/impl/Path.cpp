@@ -23,6 +23,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
 #include <fstream>
 
@@ -99,6 +100,9 @@ namespace lms::core::pathUtils
             }
         }
 
+        std::vector<std::filesystem::path> files;
+        std::vector<std::filesystem::path> subDirectories;
+
         std::filesystem::directory_iterator itEnd;
         while (itPath != itEnd)
         {
@@ -112,12 +116,12 @@ namespace lms::core::pathUtils
             {
                 if (std::filesystem::is_regular_file(*itPath, ec))
                 {
-                    continueExploring = cb(ec, *itPath);
+                    files.push_back(itPath->path());
                 }
                 else if (std::filesystem::is_directory(*itPath, ec))
                 {
                     if (!ec)
-                        continueExploring = exploreFilesRecursive(*itPath, cb, excludeDirFileName);
+                        subDirectories.push_back(itPath->path());
                     else
                         continueExploring = cb(ec, *itPath);
                 }
@@ -129,6 +133,47 @@ namespace lms::core::pathUtils
             itPath.increment(ec);
         }
 
+        std::sort(std::begin(files), std::end(files));
+        for (const std::filesystem::path& file : files)
+        {
+            if (!cb(std::error_code{}, file))
+                return false;
+        }
+
+        std::sort(std::begin(subDirectories), std::end(subDirectories));
+        for (const std::filesystem::path& subDirectory : subDirectories)
+        {
+            if (!exploreFilesRecursive(subDirectory, cb, excludeDirFileName))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool exploreFiles(const std::filesystem::path& directory, const std::function<bool(std::error_code, const std::filesystem::path&)>& cb)
+    {
+        std::error_code ec;
+        std::filesystem::directory_iterator itPath{ directory, std::filesystem::directory_options::follow_directory_symlink, ec };
+        if (ec)
+            return cb(ec, directory);
+
+        std::vector<std::filesystem::path> files;
+        for (const std::filesystem::directory_iterator itEnd; itPath != itEnd; itPath.increment(ec))
+        {
+            if (ec)
+                return cb(ec, directory);
+
+            if (std::filesystem::is_regular_file(*itPath, ec))
+                files.push_back(itPath->path());
+        }
+
+        std::sort(std::begin(files), std::end(files));
+        for (const std::filesystem::path& file : files)
+        {
+            if (!cb(std::error_code{}, file))
+                return false;
+        }
+
         return true;
     }
 
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/http/ConditionalRequest.hpp"
+
+#include <ctime>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+#include "core/Fnv1a64Calculator.hpp"
+#include "core/ILogger.hpp"
+#include "core/String.hpp"
+
+namespace lms::core::http
+{
+    namespace
+    {
+        constexpr const char* httpDateFormat{ "%a, %d %b %Y %H:%M:%S GMT" };
+
+        std::string_view stripWeakPrefix(std::string_view entityTag)
+        {
+            if (entityTag.starts_with("W/"))
+                entityTag.remove_prefix(2);
+
+            return entityTag;
+        }
+
+        std::string_view stripQuotes(std::string_view entityTag)
+        {
+            if (entityTag.size() >= 2 && entityTag.front() == '"' && entityTag.back() == '"')
+                entityTag = entityTag.substr(1, entityTag.size() - 2);
+
+            return entityTag;
+        }
+    }
+
+    std::string computeEntityTag(std::string_view data)
+    {
+        Fnv1a64Calculator calculator;
+        calculator.processBytes(reinterpret_cast<const std::byte*>(data.data()), data.size());
+
+        std::ostringstream oss;
+        oss << std::hex << std::setw(16) << std::setfill('0') << calculator.getResult();
+        return oss.str();
+    }
+
+    std::string formatHttpDate(const Wt::WDateTime& dateTime)
+    {
+        const std::time_t t{ dateTime.toTime_t() };
+        std::tm tm{};
+        ::gmtime_r(&t, &tm);
+
+        std::ostringstream oss;
+        oss.imbue(std::locale::classic());
+        oss << std::put_time(&tm, httpDateFormat);
+
+        return oss.str();
+    }
+
+    std::optional<Wt::WDateTime> parseHttpDate(std::string_view str)
+    {
+        std::tm tm{};
+
+        std::istringstream iss{ std::string{ stringUtils::stringTrim(str) } };
+        iss.imbue(std::locale::classic());
+        iss >> std::get_time(&tm, httpDateFormat);
+        if (iss.fail())
+            return std::nullopt;
+
+        return Wt::WDateTime::fromTime_t(::timegm(&tm));
+    }
+
+    bool isEntityTagMatching(std::string_view ifNoneMatch, std::string_view entityTag)
+    {
+        if (stringUtils::stringTrim(ifNoneMatch) == "*")
+            return true;
+
+        for (std::string_view candidate : stringUtils::splitString(ifNoneMatch, ','))
+        {
+            candidate = stripQuotes(stripWeakPrefix(stringUtils::stringTrim(candidate)));
+            if (!candidate.empty() && candidate == entityTag)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool isNotModified(std::string_view ifNoneMatch, std::string_view ifModifiedSince, const CacheValidators& validators)
+    {
+        if (!ifNoneMatch.empty())
+            return !validators.entityTag.empty() && isEntityTagMatching(ifNoneMatch, validators.entityTag);
+
+        if (!ifModifiedSince.empty() && validators.lastModified.isValid())
+        {
+            const std::optional<Wt::WDateTime> since{ parseHttpDate(ifModifiedSince) };
+            // HTTP dates have a one second resolution
+            return since && validators.lastModified.toTime_t() <= since->toTime_t();
+        }
+
+        return false;
+    }
+
+    bool processConditionalRequest(const Wt::Http::Request& request, Wt::Http::Response& response, const CacheValidators& validators, std::string_view cacheControl)
+    {
+        if (!validators.entityTag.empty())
+            response.addHeader("ETag", "\"" + validators.entityTag + "\"");
+        if (validators.lastModified.isValid())
+            response.addHeader("Last-Modified", formatHttpDate(validators.lastModified));
+        if (!cacheControl.empty())
+            response.addHeader("Cache-Control", std::string{ cacheControl });
+
+        if (!isNotModified(request.headerValue("If-None-Match"), request.headerValue("If-Modified-Since"), validators))
+            return false;
+
+        LMS_LOG(UTILS, DEBUG, "Client cache still valid, answering 304");
+        response.setStatus(304);
+        return true;
+    }
+}
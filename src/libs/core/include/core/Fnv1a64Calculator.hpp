@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lms::core
+{
+    // Streaming implementation of the 64-bit FNV-1a non cryptographic hash, stable across runs and platforms
+    class Fnv1a64Calculator
+    {
+    public:
+        void processBytes(const std::byte* data, std::size_t dataSize)
+        {
+            for (std::size_t i{}; i < dataSize; ++i)
+            {
+                _result ^= static_cast<std::uint64_t>(data[i]);
+                _result *= prime;
+            }
+        }
+
+        std::uint64_t getResult() const
+        {
+            return _result;
+        }
+
+    private:
+        static constexpr std::uint64_t offsetBasis{ 0xcbf29ce484222325ULL };
+        static constexpr std::uint64_t prime{ 0x100000001b3ULL };
+
+        std::uint64_t _result{ offsetBasis };
+    };
+}
@@ -20,7 +20,10 @@
 #pragma once
 
 #include <optional>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 #include <boost/asio/io_service.hpp>
 
 namespace lms::core
@@ -34,11 +37,15 @@ namespace lms::core
         void stop();
         std::size_t getThreadCount() const;
 
+        // Not thread safe: must not be called concurrently with getThreadCount()
+        void addThreads(std::size_t threadCount);
+
     private:
         IOContextRunner(const IOContextRunner&) = delete;
         IOContextRunner& operator=(const IOContextRunner&) = delete;
 
         boost::asio::io_service& _ioService;
+        const std::string                               _name;
         std::optional<boost::asio::io_service::work>    _work;
         std::vector<std::thread>                        _threads;
     };
@@ -38,7 +38,10 @@ namespace lms::core::pathUtils
     Wt::WDateTime getLastWriteTime(const std::filesystem::path& dir);
 
     // returns false if aborted by user
+    // Stable order: entries sorted by name, files of a directory reported before exploring its sub directories
     bool exploreFilesRecursive(const std::filesystem::path& directory, std::function<bool(std::error_code, const std::filesystem::path&)> cb, const std::filesystem::path* excludeDirFileName = {});
+    // Non recursive, same order as exploreFilesRecursive
+    bool exploreFiles(const std::filesystem::path& directory, const std::function<bool(std::error_code, const std::filesystem::path&)>& cb);
 
     // Check if file's extension is one of provided extensions
     bool hasFileAnyExtension(const std::filesystem::path& file, const std::vector<std::filesystem::path>& extensions);
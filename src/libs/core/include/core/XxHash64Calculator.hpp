@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lms::core
+{
+    // Streaming implementation of the XXH64 non cryptographic hash (little endian hosts only)
+    class XxHash64Calculator
+    {
+    public:
+        XxHash64Calculator(std::uint64_t seed = 0)
+            : _seed{ seed }
+            , _accumulators{ seed + prime1 + prime2, seed + prime2, seed, seed - prime1 }
+        {
+        }
+
+        void processBytes(const std::byte* data, std::size_t dataSize)
+        {
+            _totalSize += dataSize;
+
+            // complete the pending stripe first
+            if (_bufferSize > 0)
+            {
+                const std::size_t size{ std::min(dataSize, _buffer.size() - _bufferSize) };
+                std::memcpy(_buffer.data() + _bufferSize, data, size);
+                _bufferSize += size;
+                data += size;
+                dataSize -= size;
+
+                if (_bufferSize < _buffer.size())
+                    return;
+
+                processStripe(_buffer.data());
+                _bufferSize = 0;
+            }
+
+            for (; dataSize >= _buffer.size(); data += _buffer.size(), dataSize -= _buffer.size())
+                processStripe(data);
+
+            std::memcpy(_buffer.data(), data, dataSize);
+            _bufferSize = dataSize;
+        }
+
+        std::uint64_t getResult() const
+        {
+            std::uint64_t hash;
+            if (_totalSize >= _buffer.size())
+            {
+                hash = std::rotl(_accumulators[0], 1) + std::rotl(_accumulators[1], 7) + std::rotl(_accumulators[2], 12) + std::rotl(_accumulators[3], 18);
+                for (const std::uint64_t accumulator : _accumulators)
+                    hash = (hash ^ round(0, accumulator)) * prime1 + prime4;
+            }
+            else
+                hash = _seed + prime5;
+
+            hash += _totalSize;
+
+            std::size_t offset{};
+            for (; offset + 8 <= _bufferSize; offset += 8)
+                hash = std::rotl(hash ^ round(0, read64(_buffer.data() + offset)), 27) * prime1 + prime4;
+
+            if (offset + 4 <= _bufferSize)
+            {
+                hash = std::rotl(hash ^ (read32(_buffer.data() + offset) * prime1), 23) * prime2 + prime3;
+                offset += 4;
+            }
+
+            for (; offset < _bufferSize; ++offset)
+                hash = std::rotl(hash ^ (std::to_integer<std::uint64_t>(_buffer[offset]) * prime5), 11) * prime1;
+
+            // avalanche
+            hash ^= hash >> 33;
+            hash *= prime2;
+            hash ^= hash >> 29;
+            hash *= prime3;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+
+    private:
+        static constexpr std::uint64_t prime1{ 0x9E3779B185EBCA87ULL };
+        static constexpr std::uint64_t prime2{ 0xC2B2AE3D27D4EB4FULL };
+        static constexpr std::uint64_t prime3{ 0x165667B19E3779F9ULL };
+        static constexpr std::uint64_t prime4{ 0x85EBCA77C2B2AE63ULL };
+        static constexpr std::uint64_t prime5{ 0x27D4EB2F165667C5ULL };
+
+        static std::uint64_t read64(const std::byte* data)
+        {
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static std::uint64_t read32(const std::byte* data)
+        {
+            std::uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+        {
+            return std::rotl(accumulator + input * prime2, 31) * prime1;
+        }
+
+        void processStripe(const std::byte* data)
+        {
+            for (std::size_t i{}; i < _accumulators.size(); ++i)
+                _accumulators[i] = round(_accumulators[i], read64(data + i * 8));
+        }
+
+        std::uint64_t _seed;
+        std::array<std::uint64_t, 4> _accumulators;
+        std::array<std::byte, 32> _buffer;
+        std::size_t _bufferSize{};
+        std::uint64_t _totalSize{};
+    };
+}
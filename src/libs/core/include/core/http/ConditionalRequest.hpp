@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <Wt/WDateTime.h>
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+namespace lms::core::http
+{
+    // Validators describing the current representation of a resource
+    struct CacheValidators
+    {
+        std::string entityTag;      // opaque value, without quotes. Not used if empty
+        Wt::WDateTime lastModified; // not used if invalid
+    };
+
+    // Returns an opaque entity tag built from the given data
+    [[nodiscard]] std::string computeEntityTag(std::string_view data);
+
+    // IMF-fixdate format, as used in Last-Modified/If-Modified-Since headers
+    [[nodiscard]] std::string formatHttpDate(const Wt::WDateTime& dateTime);
+    [[nodiscard]] std::optional<Wt::WDateTime> parseHttpDate(std::string_view str);
+
+    // Weak comparison of an If-None-Match header value against the given entity tag
+    [[nodiscard]] bool isEntityTagMatching(std::string_view ifNoneMatch, std::string_view entityTag);
+
+    // If-None-Match takes precedence over If-Modified-Since, empty header values are ignored
+    [[nodiscard]] bool isNotModified(std::string_view ifNoneMatch, std::string_view ifModifiedSince, const CacheValidators& validators);
+
+    // Sets the validator and Cache-Control headers, and answers 304 if the client's copy is still valid
+    // Returns true if the request has been fully handled
+    bool processConditionalRequest(const Wt::Http::Request& request, Wt::Http::Response& response, const CacheValidators& validators, std::string_view cacheControl = "private, no-cache");
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <Wt/WDate.h>
+#include <Wt/WDateTime.h>
+#include <Wt/WTime.h>
+
+#include "core/http/ConditionalRequest.hpp"
+
+namespace lms::core::http::tests
+{
+    TEST(ConditionalRequest, httpDate)
+    {
+        const Wt::WDateTime dateTime{ Wt::WDate{ 1994, 11, 6 }, Wt::WTime{ 8, 49, 37 } };
+
+        EXPECT_EQ(formatHttpDate(dateTime), "Sun, 06 Nov 1994 08:49:37 GMT");
+
+        const std::optional<Wt::WDateTime> parsed{ parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT") };
+        ASSERT_TRUE(parsed.has_value());
+        EXPECT_EQ(*parsed, dateTime);
+
+        EXPECT_FALSE(parseHttpDate("").has_value());
+        EXPECT_FALSE(parseHttpDate("garbage").has_value());
+    }
+
+    TEST(ConditionalRequest, entityTag)
+    {
+        EXPECT_EQ(computeEntityTag("foo"), computeEntityTag("foo"));
+        EXPECT_NE(computeEntityTag("foo"), computeEntityTag("bar"));
+        EXPECT_EQ(computeEntityTag("foo").size(), 16);
+
+        EXPECT_TRUE(isEntityTagMatching("\"abc\"", "abc"));
+        EXPECT_TRUE(isEntityTagMatching("W/\"abc\"", "abc"));
+        EXPECT_TRUE(isEntityTagMatching("\"def\", \"abc\"", "abc"));
+        EXPECT_TRUE(isEntityTagMatching("*", "abc"));
+        EXPECT_FALSE(isEntityTagMatching("\"abcd\"", "abc"));
+        EXPECT_FALSE(isEntityTagMatching("\"\"", "abc"));
+    }
+
+    TEST(ConditionalRequest, isNotModified)
+    {
+        const Wt::WDateTime lastModified{ Wt::WDate{ 2024, 1, 1 }, Wt::WTime{ 12, 0, 0 } };
+        const CacheValidators validators{ "abc", lastModified };
+
+        EXPECT_FALSE(isNotModified("", "", validators));
+        EXPECT_TRUE(isNotModified("\"abc\"", "", validators));
+        EXPECT_FALSE(isNotModified("\"def\"", "", validators));
+
+        EXPECT_TRUE(isNotModified("", formatHttpDate(lastModified), validators));
+        EXPECT_TRUE(isNotModified("", formatHttpDate(lastModified.addSecs(1)), validators));
+        EXPECT_FALSE(isNotModified("", formatHttpDate(lastModified.addSecs(-1)), validators));
+
+        // If-None-Match takes precedence
+        EXPECT_FALSE(isNotModified("\"def\"", formatHttpDate(lastModified), validators));
+
+        // no validators
+        EXPECT_FALSE(isNotModified("\"abc\"", formatHttpDate(lastModified), CacheValidators{}));
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "core/Fnv1a64Calculator.hpp"
+
+namespace lms::core::tests
+{
+    namespace
+    {
+        std::uint64_t computeHash(std::string_view str, std::size_t chunkSize)
+        {
+            Fnv1a64Calculator calculator;
+            for (std::size_t offset{}; offset < str.size(); offset += chunkSize)
+            {
+                const std::string_view chunk{ str.substr(offset, chunkSize) };
+                calculator.processBytes(reinterpret_cast<const std::byte*>(chunk.data()), chunk.size());
+            }
+
+            return calculator.getResult();
+        }
+    }
+
+    TEST(Fnv1a64Calculator, referenceValues)
+    {
+        EXPECT_EQ(Fnv1a64Calculator{}.getResult(), 0xcbf29ce484222325ULL);
+        EXPECT_EQ(computeHash("a", 1), 0xaf63dc4c8601ec8cULL);
+        EXPECT_EQ(computeHash("foobar", 6), 0x85944171f73967e8ULL);
+    }
+
+    TEST(Fnv1a64Calculator, streaming)
+    {
+        const std::string_view str{ "The quick brown fox jumps over the lazy dog" };
+
+        const std::uint64_t expected{ computeHash(str, str.size()) };
+        for (std::size_t chunkSize : { 1, 2, 5, 16 })
+            EXPECT_EQ(computeHash(str, chunkSize), expected) << "chunkSize = " << chunkSize;
+    }
+}
@@ -17,6 +17,11 @@
  * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unistd.h>
+
+#include <fstream>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "core/Path.hpp"
@@ -105,4 +110,30 @@ namespace lms::core::pathUtils::tests
             EXPECT_EQ(core::pathUtils::isPathInRootPath(test.path, test.rootPath), test.expectedResult) << "Failed: path = " << test.path << ", rootPath = " << test.rootPath;
         }
     }
-}
\ No newline at end of file
+
+    TEST(Path, exploreFilesRecursive)
+    {
+        const std::filesystem::path root{ std::filesystem::temp_directory_path() / ("lms-test-explore-" + std::to_string(::getpid())) };
+        std::filesystem::remove_all(root);
+
+        for (const std::filesystem::path& directory : { root / "b", root / "a" / "c", root / "d" })
+            std::filesystem::create_directories(directory);
+        for (const std::filesystem::path& file : { root / "z.mp3", root / "b.mp3", root / "b" / "1.mp3", root / "a" / "c" / "2.mp3", root / "a" / "3.mp3", root / "d" / ".lmsignore", root / "d" / "4.mp3" })
+            std::ofstream{ file };
+
+        std::vector<std::filesystem::path> files;
+        const std::filesystem::path excludeDirFileName{ ".lmsignore" };
+        EXPECT_TRUE(exploreFilesRecursive(root, [&](std::error_code ec, const std::filesystem::path& path)
+            {
+                EXPECT_FALSE(ec);
+                files.push_back(path.lexically_relative(root));
+                return true;
+            }, &excludeDirFileName));
+
+        // files first, then sub directories, sorted by name
+        const std::vector<std::filesystem::path> expectedFiles{ "b.mp3", "z.mp3", "a/3.mp3", "a/c/2.mp3", "b/1.mp3" };
+        EXPECT_EQ(files, expectedFiles);
+
+        std::filesystem::remove_all(root);
+    }
+}
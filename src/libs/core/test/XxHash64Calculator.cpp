@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "core/XxHash64Calculator.hpp"
+
+namespace lms::core::tests
+{
+    namespace
+    {
+        std::uint64_t computeHash(std::string_view str, std::size_t chunkSize)
+        {
+            XxHash64Calculator calculator;
+            for (std::size_t offset{}; offset < str.size(); offset += chunkSize)
+            {
+                const std::string_view chunk{ str.substr(offset, chunkSize) };
+                calculator.processBytes(reinterpret_cast<const std::byte*>(chunk.data()), chunk.size());
+            }
+
+            return calculator.getResult();
+        }
+    }
+
+    TEST(XxHash64Calculator, referenceValues)
+    {
+        EXPECT_EQ(XxHash64Calculator{}.getResult(), 0xEF46DB3751D8E999ULL);
+        EXPECT_EQ(computeHash("a", 1), 0xD24EC4F1A98C6E5BULL);
+        EXPECT_EQ(computeHash("abc", 3), 0x44BC2CF5AD770999ULL);
+        EXPECT_EQ(computeHash("Nobody inspects the spammish repetition", 64), 0xFBCEA83C8A378BF1ULL);
+    }
+
+    TEST(XxHash64Calculator, streaming)
+    {
+        const std::string_view str{ "The quick brown fox jumps over the lazy dog, several times, to get a long enough input" };
+
+        const std::uint64_t expected{ computeHash(str, str.size()) };
+        for (std::size_t chunkSize : { 1, 3, 7, 8, 31, 32, 33 })
+            EXPECT_EQ(computeHash(str, chunkSize), expected) << "chunkSize = " << chunkSize;
+    }
+
+    TEST(XxHash64Calculator, seed)
+    {
+        XxHash64Calculator calculator{ 42 };
+        EXPECT_NE(calculator.getResult(), XxHash64Calculator{}.getResult());
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <benchmark/benchmark.h>
+
+#include "database/Db.hpp"
+#include "database/Release.hpp"
+#include "database/Session.hpp"
+#include "database/Track.hpp"
+#include "core/Random.hpp"
+
+// Read path benchmarks, to be run on a database generated using lms-db-generator:
+// LMS_BENCH_DB=/path/to/generated.db bench-database
+namespace lms::db::benchs
+{
+    namespace
+    {
+        std::filesystem::path getDbPath()
+        {
+            const char* dbPath{ std::getenv("LMS_BENCH_DB") };
+            return dbPath ? dbPath : "";
+        }
+
+        // Shared by all the benchmark threads, one instance per connection settings
+        Db& getDb(std::size_t mmapSizeMBytes, std::size_t readCacheSizeMBytes, bool readTempStoreInMemory)
+        {
+            static std::mutex mutex;
+            static std::map<std::tuple<std::size_t, std::size_t, bool>, std::unique_ptr<Db>> dbs;
+
+            const std::scoped_lock lock{ mutex };
+
+            std::unique_ptr<Db>& db{ dbs[{ mmapSizeMBytes, readCacheSizeMBytes, readTempStoreInMemory }] };
+            if (!db)
+            {
+                Db::ConnectionSettings settings;
+                settings.mmapSizeMBytes = mmapSizeMBytes;
+                settings.readCacheSizeMBytes = readCacheSizeMBytes;
+                settings.readTempStoreInMemory = readTempStoreInMemory;
+
+                db = std::make_unique<Db>(getDbPath(), std::thread::hardware_concurrency(), settings);
+            }
+
+            return *db;
+        }
+
+        template <typename FindFunc>
+        void runFindBenchmark(benchmark::State& state, FindFunc findFunc)
+        {
+            if (getDbPath().empty())
+            {
+                state.SkipWithError("LMS_BENCH_DB not set");
+                return;
+            }
+
+            Session& session{ getDb(state.range(0), state.range(1), state.range(2) != 0).getTLSSession() };
+            for (auto _ : state)
+            {
+                auto transaction{ session.createReadTransaction() };
+                findFunc(session);
+            }
+        }
+    }
+
+    static void BM_Db_findTracksByName(benchmark::State& state)
+    {
+        runFindBenchmark(state, [](Session& session)
+            {
+                static const std::size_t trackCount{ Track::getCount(session) };
+
+                Track::FindParameters params;
+                params.setSortMethod(TrackSortMethod::Name);
+                params.setRange(Range{ core::random::getRandom<std::size_t>(0, trackCount), 50 });
+
+                benchmark::DoNotOptimize(Track::findIds(session, params));
+            });
+    }
+
+    static void BM_Db_findReleasesByName(benchmark::State& state)
+    {
+        runFindBenchmark(state, [](Session& session)
+            {
+                static const std::size_t releaseCount{ Release::getCount(session) };
+
+                Release::FindParameters params;
+                params.setSortMethod(ReleaseSortMethod::Name);
+                params.setRange(Range{ core::random::getRandom<std::size_t>(0, releaseCount), 50 });
+
+                benchmark::DoNotOptimize(Release::findIds(session, params));
+            });
+    }
+
+    // Args: mmap size (MBytes), read cache budget (MBytes), temp store in memory. 0 means SQLite defaults: the first set is the baseline, without any pragma
+    BENCHMARK(BM_Db_findTracksByName)->Args({ 0, 0, 0 })->Args({ 256, 64, 1 })->Threads(1)->Threads(std::thread::hardware_concurrency());
+    BENCHMARK(BM_Db_findReleasesByName)->Args({ 0, 0, 0 })->Args({ 256, 64, 1 })->Threads(1)->Threads(std::thread::hardware_concurrency());
+}
+
+BENCHMARK_MAIN();
@@ -35,6 +35,8 @@ namespace lms::db
 {
     namespace
     {
+        constexpr const char* orphanIdsQuery{ "SELECT DISTINCT a.id FROM artist a WHERE NOT EXISTS(SELECT 1 FROM track t INNER JOIN track_artist_link t_a_l ON t_a_l.artist_id = a.id WHERE t.id = t_a_l.track_id)" };
+
         template <typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Artist::FindParameters& params)
         {
@@ -73,7 +75,12 @@ namespace lms::db
             if (params.linkType)
                 query.where("+t_a_l.type = ?").bind(*params.linkType); // Exclude this since the query planner does not do a good job when db is not analyzed
 
-            if (!params.keywords.empty())
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("a.id IN (SELECT rowid FROM artist_fts WHERE artist_fts MATCH ?)")
+                    .bind(utils::buildFullTextSearchMatch(params.keywords, "name") + " OR " + utils::buildFullTextSearchMatch(params.keywords, "sort_name"));
+            }
+            else if (!params.keywords.empty())
             {
                 std::vector<std::string> clauses;
                 std::vector<std::string> sortClauses;
@@ -129,18 +136,26 @@ namespace lms::db
             if (params.track.isValid())
                 query.where("t_a_l.track_id = ?").bind(params.track);
 
+            assert(!params.cursor || params.sortMethod == ArtistSortMethod::Id || params.sortMethod == ArtistSortMethod::Name || params.sortMethod == ArtistSortMethod::SortName);
+
             switch (params.sortMethod)
             {
             case ArtistSortMethod::None:
                 break;
             case ArtistSortMethod::Id:
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "", "a.id", *params.cursor);
                 query.orderBy("a.id");
                 break;
             case ArtistSortMethod::Name:
-                query.orderBy("a.name COLLATE NOCASE");
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "a.name COLLATE NOCASE", "a.id", *params.cursor);
+                query.orderBy("a.name COLLATE NOCASE, a.id");
                 break;
             case ArtistSortMethod::SortName:
-                query.orderBy("a.sort_name COLLATE NOCASE");
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "a.sort_name COLLATE NOCASE", "a.id", *params.cursor);
+                query.orderBy("a.sort_name COLLATE NOCASE, a.id");
                 break;
             case ArtistSortMethod::Random:
                 query.orderBy("RANDOM()");
@@ -173,6 +188,24 @@ namespace lms::db
 
             return createQuery<ResultType>(session, itemToSelect, params);
         }
+
+        std::optional<RangeResults<ArtistId>> sampleRandomArtistIds(Session& session, const Artist::FindParameters& params)
+        {
+            assert(params.sortMethod == ArtistSortMethod::Random);
+            if (!params.range || params.range->offset != 0)
+                return std::nullopt;
+
+            return utils::sampleRandomRange<ArtistId>(utils::getMaxId(session, "artist"), params.range->size, [&](std::span<const IdType::ValueType> candidateIds)
+                {
+                    Artist::FindParameters sampleParams{ params };
+                    sampleParams.setSortMethod(ArtistSortMethod::None);
+                    sampleParams.setRange(std::nullopt);
+
+                    auto query{ createQuery<ArtistId>(session, sampleParams) };
+                    utils::applyIdsFilter(query, "a.id", candidateIds);
+                    return utils::fetchQueryResults(query);
+                });
+        }
     }
 
     Artist::Artist(const std::string& name, const std::optional<core::UUID>& MBID)
@@ -246,32 +279,92 @@ namespace lms::db
     RangeResults<ArtistId> Artist::findOrphanIds(Session& session, std::optional<Range> range)
     {
         session.checkReadTransaction();
-        auto query{ session.getDboSession()->query<ArtistId>("SELECT DISTINCT a.id FROM artist a WHERE NOT EXISTS(SELECT 1 FROM track t INNER JOIN track_artist_link t_a_l ON t_a_l.artist_id = a.id WHERE t.id = t_a_l.track_id)") };
+        auto query{ session.getDboSession()->query<ArtistId>(orphanIdsQuery) };
         return utils::execRangeQuery<ArtistId>(query, range);
     }
 
+    std::size_t Artist::removeOrphans(Session& session, std::size_t maxCount)
+    {
+        return utils::deleteIdsFromQuery(session, "artist", orphanIdsQuery, maxCount);
+    }
+
     RangeResults<ArtistId> Artist::findIds(Session& session, const FindParameters& params)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ArtistSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ArtistId>> artistIds{ sampleRandomArtistIds(session, params) })
+                return std::move(*artistIds);
+        }
+
         auto query{ createQuery<ArtistId>(session, params) };
-        return utils::execRangeQuery<ArtistId>(query, params.range);
+        RangeResults<ArtistId> res{ utils::execRangeQuery<ArtistId>(query, params.range, params.cursor) };
+        if (res.moreResults && !res.results.empty())
+        {
+            if (const pointer lastArtist{ find(session, res.results.back()) })
+                res.nextCursor = lastArtist->getKeysetCursor(params.sortMethod);
+        }
+
+        return res;
     }
 
     RangeResults<Artist::pointer> Artist::find(Session& session, const FindParameters& params)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ArtistSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ArtistId>> artistIds{ sampleRandomArtistIds(session, params) })
+            {
+                RangeResults<Artist::pointer> res;
+                res.results = utils::fetchObjects<Artist>(*session.getDboSession(), std::span<const ArtistId>{ artistIds->results });
+                res.range = Range{ 0, res.results.size() };
+                res.moreResults = artistIds->moreResults;
+
+                return res;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Artist>>(session, params) };
-        return utils::execRangeQuery<Artist::pointer>(query, params.range);
+        RangeResults<Artist::pointer> res{ utils::execRangeQuery<Artist::pointer>(query, params.range, params.cursor) };
+        if (res.moreResults && !res.results.empty())
+            res.nextCursor = res.results.back()->getKeysetCursor(params.sortMethod);
+
+        return res;
     }
 
     void Artist::find(Session& session, const FindParameters& params, std::function<void(const pointer&)> func)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ArtistSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ArtistId>> artistIds{ sampleRandomArtistIds(session, params) })
+            {
+                for (const Artist::pointer& artist : utils::fetchObjects<Artist>(*session.getDboSession(), std::span<const ArtistId>{ artistIds->results }))
+                    func(artist);
+                return;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Artist>>(session, params) };
-        utils::forEachQueryRangeResult(query, params.range, func);
+        utils::forEachQueryRangeResult(query, params.range, params.cursor, func);
+    }
+
+    std::optional<KeysetCursor> Artist::getKeysetCursor(ArtistSortMethod sortMethod) const
+    {
+        switch (sortMethod)
+        {
+        case ArtistSortMethod::Id:
+            return KeysetCursor{ {}, getId().getValue() };
+        case ArtistSortMethod::Name:
+            return KeysetCursor{ _name, getId().getValue() };
+        case ArtistSortMethod::SortName:
+            return KeysetCursor{ _sortName, getId().getValue() };
+        default:
+            return std::nullopt;
+        }
     }
 
     RangeResults<ArtistId> Artist::findSimilarArtistIds(core::EnumSet<TrackArtistLinkType> artistLinkTypes, std::optional<Range> range) const
@@ -34,6 +34,9 @@ namespace lms::db
 {
     namespace
     {
+        constexpr const char* orphanClusterIdsQuery{ "SELECT DISTINCT c.id FROM cluster c WHERE NOT EXISTS(SELECT 1 FROM track_cluster t_c WHERE t_c.cluster_id = c.id)" };
+        constexpr const char* orphanClusterTypeIdsQuery{ "SELECT c_t.id FROM cluster_type c_t LEFT OUTER JOIN cluster c ON c_t.id = c.cluster_type_id WHERE c.id IS NULL" };
+
         template <typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Cluster::FindParameters& params)
         {
@@ -138,11 +141,16 @@ namespace lms::db
     RangeResults<ClusterId> Cluster::findOrphanIds(Session& session, std::optional<Range> range)
     {
         session.checkReadTransaction();
-        auto query{ session.getDboSession()->query<ClusterId>("SELECT DISTINCT c.id FROM cluster c WHERE NOT EXISTS(SELECT 1 FROM track_cluster t_c WHERE t_c.cluster_id = c.id)") };
+        auto query{ session.getDboSession()->query<ClusterId>(orphanClusterIdsQuery) };
 
         return utils::execRangeQuery<ClusterId>(query, range);
     }
 
+    std::size_t Cluster::removeOrphans(Session& session, std::size_t maxCount)
+    {
+        return utils::deleteIdsFromQuery(session, "cluster", orphanClusterIdsQuery, maxCount);
+    }
+
     Cluster::pointer Cluster::find(Session& session, ClusterId id)
     {
         session.checkReadTransaction();
@@ -150,6 +158,15 @@ namespace lms::db
         return utils::fetchQuerySingleResult(session.getDboSession()->find<Cluster>().where("id = ?").bind(id));
     }
 
+    Cluster::pointer Cluster::find(Session& session, ClusterTypeId clusterTypeId, std::string_view name)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<Cluster>()
+            .where("name = ?").bind(name)
+            .where("cluster_type_id = ?").bind(clusterTypeId));
+    }
+
     std::size_t Cluster::computeTrackCount(Session& session, ClusterId id)
     {
         session.checkReadTransaction();
@@ -166,6 +183,34 @@ namespace lms::db
             .where("t_c.cluster_id = ?").bind(id));
     }
 
+    std::vector<Cluster::Counts> Cluster::findOutdatedCounts(Session& session)
+    {
+        session.checkReadTransaction();
+
+        using ResultType = std::tuple<ClusterId, int, int>;
+        auto query{ session.getDboSession()->query<ResultType>("SELECT c.id, COUNT(t.id), COUNT(DISTINCT t.release_id) FROM cluster c"
+            " LEFT OUTER JOIN track_cluster t_c ON t_c.cluster_id = c.id"
+            " LEFT OUTER JOIN track t ON t.id = t_c.track_id")
+            .groupBy("c.id")
+            .having("COUNT(t.id) <> c.track_count OR COUNT(DISTINCT t.release_id) <> c.release_count") };
+
+        std::vector<Counts> res;
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            res.push_back(Counts{ std::get<0>(result), static_cast<std::size_t>(std::get<1>(result)), static_cast<std::size_t>(std::get<2>(result)) });
+        });
+
+        return res;
+    }
+
+    void Cluster::updateCounts(Session& session, std::span<const Counts> counts)
+    {
+        session.checkWriteTransaction();
+
+        // bump the version, so that the cached objects are detected as stale
+        for (const Counts& clusterCounts : counts)
+            session.getDboSession()->execute("UPDATE cluster SET track_count = ?, release_count = ?, version = version + 1 WHERE id = ?").bind(static_cast<int>(clusterCounts.trackCount)).bind(static_cast<int>(clusterCounts.releaseCount)).bind(clusterCounts.id);
+    }
+
     void Cluster::addTrack(ObjectPtr<Track> track)
     {
         _tracks.insert(getDboPtr(track));
@@ -202,14 +247,16 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
-        auto query{ session.getDboSession()->query<ClusterTypeId>(
-                "SELECT c_t.id from cluster_type c_t"
-                " LEFT OUTER JOIN cluster c ON c_t.id = c.cluster_type_id")
-            .where("c.id IS NULL") };
+        auto query{ session.getDboSession()->query<ClusterTypeId>(orphanClusterTypeIdsQuery) };
 
         return utils::execRangeQuery<ClusterTypeId>(query, range);
     }
 
+    std::size_t ClusterType::removeOrphans(Session& session, std::size_t maxCount)
+    {
+        return utils::deleteIdsFromQuery(session, "cluster_type", orphanClusterTypeIdsQuery, maxCount);
+    }
+
     RangeResults<ClusterTypeId> ClusterType::findUsed(Session& session, std::optional<Range> range)
     {
         session.checkReadTransaction();
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Connection.hpp"
+
+#include <algorithm>
+
+#include "database/Session.hpp"
+#include "core/ILogger.hpp"
+
+namespace lms::db
+{
+    Connection::Connection(const std::filesystem::path& dbPath, ConnectionType type, const Db::ConnectionSettings& settings, std::size_t readConnectionCount)
+        : Wt::Dbo::backend::Sqlite3{ dbPath.string() }
+        , _dbPath{ dbPath }
+        , _type{ type }
+        , _mmapSize{ settings.mmapSizeMBytes * 1024 * 1024 }
+        , _cacheSizeKBytes{ type == ConnectionType::Read ? settings.readCacheSizeMBytes * 1024 / std::max<std::size_t>(readConnectionCount, 1) : 0 }
+        , _tempStoreInMemory{ type == ConnectionType::Read && settings.readTempStoreInMemory }
+        , _maxCachedStatementCount{ settings.maxCachedStatementCount }
+    {
+        prepare();
+    }
+
+    Connection::Connection(const Connection& other)
+        : Wt::Dbo::backend::Sqlite3{ other }
+        , _dbPath{ other._dbPath }
+        , _type{ other._type }
+        , _mmapSize{ other._mmapSize }
+        , _cacheSizeKBytes{ other._cacheSizeKBytes }
+        , _tempStoreInMemory{ other._tempStoreInMemory }
+        , _maxCachedStatementCount{ other._maxCachedStatementCount }
+    {
+        prepare();
+    }
+
+    Connection::~Connection()
+    {
+        // make use of per-connection usage stats to optimize
+        optimize();
+    }
+
+    std::unique_ptr<Wt::Dbo::SqlConnection> Connection::clone() const
+    {
+        return std::make_unique<Connection>(*this);
+    }
+
+    std::unique_ptr<Wt::Dbo::SqlStatement> Connection::prepareStatement(const std::string& sql)
+    {
+        _cachedStatementCount += 1;
+        return Wt::Dbo::backend::Sqlite3::prepareStatement(sql);
+    }
+
+    void Connection::commitTransaction()
+    {
+        Wt::Dbo::backend::Sqlite3::commitTransaction();
+        trimStatementCache();
+    }
+
+    void Connection::rollbackTransaction()
+    {
+        Wt::Dbo::backend::Sqlite3::rollbackTransaction();
+        trimStatementCache();
+    }
+
+    void Connection::trimStatementCache()
+    {
+        // Only done outside of transactions, as no statement can be in use at this point
+        if (_cachedStatementCount <= _maxCachedStatementCount)
+            return;
+
+        LMS_LOG(DB, DEBUG, "Clearing statement cache (" << _cachedStatementCount << " statements)");
+        clearStatementCache();
+        _cachedStatementCount = 0;
+    }
+
+    void Connection::prepare()
+    {
+        LMS_LOG(DB, DEBUG, "Setting per-connection settings...");
+        executeSql("PRAGMA journal_mode=WAL");
+        executeSql("PRAGMA synchronous=normal");
+        // 0 means SQLite defaults
+        if (_mmapSize > 0)
+            executeSql("PRAGMA mmap_size=" + std::to_string(_mmapSize));
+        if (_cacheSizeKBytes > 0)
+            executeSql("PRAGMA cache_size=-" + std::to_string(_cacheSizeKBytes)); // negative value means KiB
+        if (_tempStoreInMemory)
+            executeSql("PRAGMA temp_store=MEMORY");
+        LMS_LOG(DB, DEBUG, "Setting per-connection settings done!");
+    }
+
+    void Connection::optimize()
+    {
+        LMS_LOG(DB, DEBUG, "connection close: Running pragma optimize...");
+        executeSql("PRAGMA optimize");
+        LMS_LOG(DB, DEBUG, "connection close: pragma optimize complete");
+    }
+
+    DispatchConnectionPool::DispatchConnectionPool(Wt::Dbo::SqlConnectionPool& readPool, Wt::Dbo::SqlConnectionPool& writePool)
+        : _readPool{ readPool }
+        , _writePool{ writePool }
+    {
+    }
+
+    std::unique_ptr<Wt::Dbo::SqlConnection> DispatchConnectionPool::getConnection()
+    {
+        return (WriteTransaction::isActiveInCurrentThread() ? _writePool : _readPool).getConnection();
+    }
+
+    void DispatchConnectionPool::returnConnection(std::unique_ptr<Wt::Dbo::SqlConnection> connection)
+    {
+        const bool isWriteConnection{ static_cast<const Connection&>(*connection).getType() == ConnectionType::Write };
+        (isWriteConnection ? _writePool : _readPool).returnConnection(std::move(connection));
+    }
+
+    void DispatchConnectionPool::prepareForDroppingTables() const
+    {
+        _readPool.prepareForDroppingTables();
+        _writePool.prepareForDroppingTables();
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <Wt/Dbo/SqlConnectionPool.h>
+#include <Wt/Dbo/backend/Sqlite3.h>
+
+#include "database/Db.hpp"
+
+namespace lms::db
+{
+    enum class ConnectionType
+    {
+        Read,
+        Write,
+    };
+
+    class Connection : public Wt::Dbo::backend::Sqlite3
+    {
+    public:
+        Connection(const std::filesystem::path& dbPath, ConnectionType type, const Db::ConnectionSettings& settings, std::size_t readConnectionCount);
+        Connection(const Connection& other);
+        ~Connection() override;
+
+        ConnectionType getType() const { return _type; }
+        std::size_t getCachedStatementCount() const { return _cachedStatementCount; }
+
+    private:
+        Connection& operator=(const Connection&) = delete;
+
+        std::unique_ptr<SqlConnection> clone() const override;
+
+        // Wt::Dbo only prepares statements that are not in its per-connection cache, keyed by SQL text
+        // As most of our queries are dynamically built, this cache would grow without bounds
+        std::unique_ptr<Wt::Dbo::SqlStatement> prepareStatement(const std::string& sql) override;
+        void commitTransaction() override;
+        void rollbackTransaction() override;
+        void trimStatementCache();
+
+        void prepare();
+        void optimize();
+
+        std::filesystem::path _dbPath;
+        const ConnectionType _type;
+        const std::size_t _mmapSize;
+        const std::size_t _cacheSizeKBytes;
+        const bool _tempStoreInMemory;
+        const std::size_t _maxCachedStatementCount;
+        std::size_t _cachedStatementCount{};
+    };
+
+    // Connections are taken when the outermost transaction starts: write transactions get write connections
+    class DispatchConnectionPool : public Wt::Dbo::SqlConnectionPool
+    {
+    public:
+        DispatchConnectionPool(Wt::Dbo::SqlConnectionPool& readPool, Wt::Dbo::SqlConnectionPool& writePool);
+
+    private:
+        std::unique_ptr<Wt::Dbo::SqlConnection> getConnection() override;
+        void returnConnection(std::unique_ptr<Wt::Dbo::SqlConnection> connection) override;
+        void prepareForDroppingTables() const override;
+
+        Wt::Dbo::SqlConnectionPool& _readPool;
+        Wt::Dbo::SqlConnectionPool& _writePool;
+    };
+}
@@ -20,7 +20,6 @@
 #include "database/Db.hpp"
 
 #include <Wt/Dbo/FixedSqlConnectionPool.h>
-#include <Wt/Dbo/backend/Sqlite3.h>
 
 #include "database/Session.hpp"
 #include "database/User.hpp"
@@ -28,79 +27,65 @@
 #include "core/ILogger.hpp"
 #include "core/ITraceLogger.hpp"
 #include "core/Service.hpp"
+#include "Connection.hpp"
+#include "QueryStats.hpp"
 
 namespace lms::db
 {
     namespace
     {
-        class Connection : public Wt::Dbo::backend::Sqlite3
+        std::unique_ptr<Wt::Dbo::SqlConnectionPool> createConnectionPool(std::unique_ptr<Connection> connection, std::size_t connectionCount)
         {
-        public:
-            Connection(const std::filesystem::path& dbPath)
-                : Wt::Dbo::backend::Sqlite3{ dbPath.string() }
-                , _dbPath{ dbPath }
-            {
-                prepare();
-            }
-
-            Connection(const Connection& other)
-                : Wt::Dbo::backend::Sqlite3{ other }
-                , _dbPath{ other._dbPath }
-            {
-                prepare();
-            }
+            auto connectionPool{ std::make_unique<Wt::Dbo::FixedSqlConnectionPool>(std::move(connection), connectionCount) };
+            connectionPool->setTimeout(std::chrono::seconds{ 10 });
 
-            ~Connection() override
-            {
-                // make use of per-connection usage stats to optimize
-                optimize();
-            }
-
-        private:
-            Connection& operator=(const Connection&) = delete;
-
-            std::unique_ptr<SqlConnection> clone() const override
-            {
-                return std::make_unique<Connection>(*this);
-            }
+            return connectionPool;
+        }
+    }
 
-            void prepare()
-            {
-                LMS_LOG(DB, DEBUG, "Setting per-connection settings...");
-                executeSql("PRAGMA journal_mode=WAL");
-                executeSql("PRAGMA synchronous=normal");
-                LMS_LOG(DB, DEBUG, "Setting per-connection settings done!");
-            }
+    Db::ConnectionSettings Db::ConnectionSettings::fromConfig()
+    {
+        ConnectionSettings settings;
 
-            void optimize()
-            {
-                LMS_LOG(DB, DEBUG, "connection close: Running pragma optimize...");
-                executeSql("PRAGMA optimize");
-                LMS_LOG(DB, DEBUG, "connection close: pragma optimize complete");
-            }
+        if (const core::IConfig * config{ core::Service<core::IConfig>::get() }) // may not be here on testU
+        {
+            settings.mmapSizeMBytes = config->getULong("db-mmap-size", settings.mmapSizeMBytes);
+            settings.readCacheSizeMBytes = config->getULong("db-read-cache-size", settings.readCacheSizeMBytes);
+            settings.readTempStoreInMemory = config->getBool("db-read-temp-store-memory", settings.readTempStoreInMemory);
+            settings.maxCachedStatementCount = config->getULong("db-max-cached-statement-count", settings.maxCachedStatementCount);
+            settings.showQueries = config->getBool("db-show-queries", false);
+            settings.queryStats = config->getBool("db-query-stats", false);
+        }
 
-            std::filesystem::path _dbPath;
-        };
+        return settings;
     }
 
     // Session living class handling the database and the login
-    Db::Db(const std::filesystem::path& dbPath, std::size_t connectionCount)
+    Db::Db(const std::filesystem::path& dbPath, std::size_t readConnectionCount, const ConnectionSettings& settings)
     {
-        LMS_LOG(DB, INFO, "Creating connection pool on file " << dbPath.string());
+        LMS_LOG(DB, INFO, "Creating connection pools on file " << dbPath.string());
 
-        auto connection{ std::make_unique<Connection>(dbPath.string()) };
-        if (core::IConfig * config{ core::Service<core::IConfig>::get() })// may not be here on testU
-            connection->setProperty("show-queries", config->getBool("db-show-queries", false) ? "true" : "false");
+        QueryStats::setEnabled(settings.queryStats);
 
-        auto connectionPool{ std::make_unique<Wt::Dbo::FixedSqlConnectionPool>(std::move(connection), connectionCount) };
-        connectionPool->setTimeout(std::chrono::seconds{ 10 });
+        // Writes are serialized anyway
+        constexpr std::size_t writeConnectionCount{ 2 };
 
-        _connectionPool = std::move(connectionPool);
+        auto createConnection{ [&](ConnectionType type)
+            {
+                auto connection{ std::make_unique<Connection>(dbPath, type, settings, readConnectionCount) };
+                connection->setProperty("show-queries", settings.showQueries ? "true" : "false");
+                return connection;
+            } };
+
+        _writeConnectionPool = createConnectionPool(createConnection(ConnectionType::Write), writeConnectionCount);
+        _readConnectionPool = createConnectionPool(createConnection(ConnectionType::Read), readConnectionCount);
+        _connectionPool = std::make_unique<DispatchConnectionPool>(*_readConnectionPool, *_writeConnectionPool);
+        _writeQueue = std::make_unique<WriteQueue>(*this);
     }
 
     void Db::executeSql(const std::string& sql)
     {
-        ScopedConnection connection{ *_connectionPool };
+        ScopedConnection connection{ *_writeConnectionPool };
         connection->executeSql(sql);
     }
 
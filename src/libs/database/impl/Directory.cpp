@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/Directory.hpp"
+
+#include "database/Session.hpp"
+#include "IdTypeTraits.hpp"
+#include "PathTraits.hpp"
+#include "Utils.hpp"
+
+namespace lms::db
+{
+    Directory::Directory(const std::filesystem::path& p, ObjectPtr<Directory> parent)
+        : _absolutePath{ p }
+        , _parent{ getDboPtr(parent) }
+    {
+    }
+
+    Directory::pointer Directory::create(Session& session, const std::filesystem::path& p, ObjectPtr<Directory> parent)
+    {
+        return session.getDboSession()->add(std::unique_ptr<Directory>{ new Directory{ p, parent } });
+    }
+
+    std::size_t Directory::getCount(Session& session)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) FROM directory"));
+    }
+
+    Directory::pointer Directory::find(Session& session, DirectoryId id)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<Directory>().where("id = ?").bind(id));
+    }
+
+    Directory::pointer Directory::find(Session& session, const std::filesystem::path& p)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<Directory>().where("absolute_path = ?").bind(p));
+    }
+
+    std::vector<Directory::pointer> Directory::findRootDirectories(Session& session)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQueryResults(session.getDboSession()->find<Directory>().where("parent_directory_id IS NULL").orderBy("absolute_path"));
+    }
+
+    std::vector<Directory::pointer> Directory::findChildren(Session& session, DirectoryId parentId)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQueryResults(session.getDboSession()->find<Directory>().where("parent_directory_id = ?").bind(parentId).orderBy("absolute_path"));
+    }
+} // namespace lms::db
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/Image.hpp"
+
+#include "database/Session.hpp"
+#include "IdTypeTraits.hpp"
+#include "PathTraits.hpp"
+#include "Utils.hpp"
+
+namespace lms::db
+{
+    Image::Image(const std::filesystem::path& p)
+        : _absoluteFilePath{ p }
+        , _directory{ p.parent_path() }
+        , _stem{ p.stem().string() }
+    {
+    }
+
+    Image::pointer Image::create(Session& session, const std::filesystem::path& p)
+    {
+        return session.getDboSession()->add(std::unique_ptr<Image>{ new Image{ p } });
+    }
+
+    std::size_t Image::getCount(Session& session)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) FROM image"));
+    }
+
+    Image::pointer Image::find(Session& session, ImageId id)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<Image>().where("id = ?").bind(id));
+    }
+
+    Image::pointer Image::find(Session& session, const std::filesystem::path& p)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<Image>().where("absolute_file_path = ?").bind(p));
+    }
+
+    void Image::find(Session& session, ImageId& lastRetrievedImage, std::size_t count, const std::function<void(const Image::pointer&)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->find<Image>()
+            .orderBy("id")
+            .where("id > ?").bind(lastRetrievedImage)
+            .limit(static_cast<int>(count)) };
+
+        utils::forEachQueryResult(query, [&](const Image::pointer& image)
+            {
+                func(image);
+                lastRetrievedImage = image->getId();
+            });
+    }
+
+    void Image::findInDirectory(Session& session, const std::filesystem::path& directory, bool recursive, ImageId& lastRetrievedImage, std::size_t count, const std::function<void(const Image::pointer&)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->find<Image>()
+            .orderBy("id")
+            .where("id > ?").bind(lastRetrievedImage)
+            .limit(static_cast<int>(count)) };
+        utils::applyDirectoryFilter(query, "absolute_file_path", directory, recursive);
+
+        utils::forEachQueryResult(query, [&](const Image::pointer& image)
+            {
+                func(image);
+                lastRetrievedImage = image->getId();
+            });
+    }
+
+    std::vector<Image::pointer> Image::findByDirectory(Session& session, const std::filesystem::path& directory)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQueryResults(session.getDboSession()->find<Image>().where("directory = ?").bind(directory).orderBy("absolute_file_path"));
+    }
+} // namespace lms::db
@@ -21,6 +21,7 @@
 #include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "database/User.hpp"
+#include "core/ILogger.hpp"
 #include "IdTypeTraits.hpp"
 #include "SqlQuery.hpp"
 #include "Utils.hpp"
@@ -29,17 +30,91 @@ namespace lms::db
 {
     namespace
     {
+        // Listen stats are stored in <entity>_listen_stats tables
+        struct ListenStatsTable
+        {
+            std::string_view entity;
+            std::string_view entityId; // entity id, from the listen 'l'
+            std::string_view join;     // joins needed to get the entity id
+        };
+
+        constexpr ListenStatsTable trackListenStatsTable{ "track", "l.track_id", "" };
+        constexpr ListenStatsTable releaseListenStatsTable{ "release", "t.release_id", " JOIN track t ON t.id = l.track_id" };
+        constexpr ListenStatsTable artistListenStatsTable{ "artist", "t_a_l.artist_id", " JOIN track_artist_link t_a_l ON t_a_l.track_id = l.track_id" };
+        constexpr ListenStatsTable listenStatsTables[]{ trackListenStatsTable, releaseListenStatsTable, artistListenStatsTable };
+
+        std::string getStatsTableName(const ListenStatsTable& table)
+        {
+            return std::string{ table.entity } + "_listen_stats";
+        }
+
+        // Recomputes the stats of an entity, for all the users/backends that listened to the given track
+        std::string createStatsRecomputeStatements(const ListenStatsTable& table, std::string_view entityIdExpr, std::string_view trackIdExpr)
+        {
+            const std::string statsTable{ getStatsTableName(table) };
+            const std::string entity{ table.entity };
+            const std::string entityId{ table.entityId };
+            const std::string listeners{ "(SELECT user_id, backend FROM listen WHERE track_id = " + std::string{ trackIdExpr } + ")" };
+
+            return "DELETE FROM " + statsTable + " WHERE " + entity + "_id = " + std::string{ entityIdExpr } + " AND (user_id, backend) IN " + listeners + ";"
+                " INSERT INTO " + statsTable + "(user_id, backend, " + entity + "_id, listen_count, last_listened_at)"
+                " SELECT l.user_id, l.backend, " + entityId + ", COUNT(DISTINCT l.id), MAX(l.date_time) FROM listen l" + std::string{ table.join }
+                + " WHERE " + entityId + " = " + std::string{ entityIdExpr } + " AND (l.user_id, l.backend) IN " + listeners
+                + " GROUP BY l.user_id, l.backend, " + entityId + ";";
+        }
+
+        void createStatsTable(Session& session, const ListenStatsTable& table)
+        {
+            const std::string statsTable{ getStatsTableName(table) };
+            const std::string entity{ table.entity };
+            const std::string entityId{ table.entityId };
+            const std::string join{ table.join };
+
+            session.getDboSession()->execute("CREATE TABLE IF NOT EXISTS " + statsTable + " ("
+                "user_id INTEGER NOT NULL REFERENCES \"user\"(id) ON DELETE CASCADE,"
+                " backend INTEGER NOT NULL,"
+                " " + entity + "_id INTEGER NOT NULL REFERENCES " + entity + "(id) ON DELETE CASCADE,"
+                " listen_count INTEGER NOT NULL,"
+                " last_listened_at TEXT,"
+                " PRIMARY KEY (user_id, backend, " + entity + "_id)) WITHOUT ROWID");
+
+            session.getDboSession()->execute("CREATE INDEX IF NOT EXISTS " + statsTable + "_" + entity + "_idx ON " + statsTable + "(" + entity + "_id)");
+            session.getDboSession()->execute("CREATE INDEX IF NOT EXISTS " + statsTable + "_user_backend_count_idx ON " + statsTable + "(user_id, backend, listen_count DESC)");
+            session.getDboSession()->execute("CREATE INDEX IF NOT EXISTS " + statsTable + "_user_backend_last_listened_at_idx ON " + statsTable + "(user_id, backend, last_listened_at DESC)");
+
+            // the inserted row is visible in AFTER INSERT triggers
+            session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS " + statsTable + "_ai AFTER INSERT ON listen BEGIN"
+                " INSERT INTO " + statsTable + "(user_id, backend, " + entity + "_id, listen_count, last_listened_at)"
+                " SELECT DISTINCT l.user_id, l.backend, " + entityId + ", 1, l.date_time FROM listen l" + join + " WHERE l.id = new.id AND " + entityId + " IS NOT NULL"
+                " ON CONFLICT(user_id, backend, " + entity + "_id) DO UPDATE SET listen_count = listen_count + 1, last_listened_at = MAX(last_listened_at, excluded.last_listened_at);"
+                " END");
+
+            session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS " + statsTable + "_ad AFTER DELETE ON listen BEGIN"
+                " UPDATE " + statsTable + " SET listen_count = listen_count - 1,"
+                " last_listened_at = (SELECT MAX(l.date_time) FROM listen l" + join + " WHERE l.user_id = old.user_id AND l.backend = old.backend AND " + entityId + " = " + statsTable + "." + entity + "_id)"
+                " WHERE user_id = old.user_id AND backend = old.backend AND " + entity + "_id IN (SELECT " + entityId + " FROM (SELECT old.track_id AS track_id) l" + join + ");"
+                " DELETE FROM " + statsTable + " WHERE user_id = old.user_id AND backend = old.backend AND listen_count <= 0;"
+                " END");
+        }
+
         Wt::Dbo::Query<ArtistId> createArtistsQuery(Session& session, const Listen::ArtistStatsFindParameters& params)
         {
-            auto query{ session.getDboSession()->query<ArtistId>("SELECT a.id from artist a")
-                            .join("track_artist_link t_a_l ON t_a_l.artist_id = a.id")
-                            .join("listen l ON l.track_id = t_a_l.track_id") };
+            auto query{ session.getDboSession()->query<ArtistId>("SELECT a.id from artist a") };
+
+            // Per track stats are only needed if filtering on track attributes
+            if (params.library.isValid() || params.linkType)
+            {
+                query.join("track_artist_link t_a_l ON t_a_l.artist_id = a.id")
+                    .join("track_listen_stats l_s ON l_s.track_id = t_a_l.track_id");
+            }
+            else
+                query.join("artist_listen_stats l_s ON l_s.artist_id = a.id");
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             assert(!params.artist.isValid()); // poor check
 
@@ -71,7 +146,12 @@ namespace lms::db
                 query.where(oss.str());
             }
 
-            if (!params.keywords.empty())
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("a.id IN (SELECT rowid FROM artist_fts WHERE artist_fts MATCH ?)")
+                    .bind(utils::buildFullTextSearchMatch(params.keywords, "name") + " OR " + utils::buildFullTextSearchMatch(params.keywords, "sort_name"));
+            }
+            else if (!params.keywords.empty())
             {
                 std::vector<std::string> clauses;
                 std::vector<std::string> sortClauses;
@@ -96,15 +176,22 @@ namespace lms::db
 
         Wt::Dbo::Query<ReleaseId> createReleasesQuery(Session& session, const Listen::StatsFindParameters& params)
         {
-            auto query{ session.getDboSession()->query<ReleaseId>("SELECT r.id from release r")
-                            .join("track t ON t.release_id = r.id")
-                            .join("listen l ON l.track_id = t.id") };
+            auto query{ session.getDboSession()->query<ReleaseId>("SELECT r.id from release r") };
+
+            // Per track stats are only needed if filtering on track attributes
+            if (params.artist.isValid() || params.library.isValid())
+            {
+                query.join("track t ON t.release_id = r.id")
+                    .join("track_listen_stats l_s ON l_s.track_id = t.id");
+            }
+            else
+                query.join("release_listen_stats l_s ON l_s.release_id = r.id");
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             if (params.artist.isValid())
             {
@@ -136,8 +223,15 @@ namespace lms::db
                 query.where(oss.str());
             }
 
-            for (std::string_view keyword : params.keywords)
-                query.where("r.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("r.id IN (SELECT rowid FROM release_fts WHERE release_fts MATCH ?)").bind(utils::buildFullTextSearchMatch(params.keywords, "name"));
+            }
+            else
+            {
+                for (std::string_view keyword : params.keywords)
+                    query.where("r.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            }
 
             return query;
         }
@@ -145,13 +239,13 @@ namespace lms::db
         Wt::Dbo::Query<TrackId> createTracksQuery(Session& session, const Listen::StatsFindParameters& params)
         {
             auto query{ session.getDboSession()->query<TrackId>("SELECT t.id from track t")
-                        .join("listen l ON l.track_id = t.id") };
+                        .join("track_listen_stats l_s ON l_s.track_id = t.id") };
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             if (params.artist.isValid())
             {
@@ -182,8 +276,15 @@ namespace lms::db
                 query.where(oss.str());
             }
 
-            for (std::string_view keyword : params.keywords)
-                query.where("t.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("t.id IN (SELECT rowid FROM track_fts WHERE track_fts MATCH ?)").bind(utils::buildFullTextSearchMatch(params.keywords, "name"));
+            }
+            else
+            {
+                for (std::string_view keyword : params.keywords)
+                    query.where("t.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            }
 
             return query;
         }
@@ -247,11 +348,9 @@ namespace lms::db
     RangeResults<ArtistId> Listen::getTopArtists(Session& session, const ArtistStatsFindParameters& params)
     {
         session.checkReadTransaction();
-        auto query{ createArtistsQuery(session, params) };
-
-        auto collection{ query
-            .orderBy("COUNT(a.id) DESC")
-            .groupBy("a.id") };
+        auto query{ createArtistsQuery(session, params)
+                        .orderBy("SUM(l_s.listen_count) DESC")
+                        .groupBy("a.id") };
 
         return utils::execRangeQuery<ArtistId>(query, params.range);
     }
@@ -260,7 +359,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createReleasesQuery(session, params)
-                        .orderBy("COUNT(r.id) DESC")
+                        .orderBy("SUM(l_s.listen_count) DESC")
                         .groupBy("r.id") };
 
         return utils::execRangeQuery<ReleaseId>(query, params.range);
@@ -270,7 +369,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createTracksQuery(session, params)
-                        .orderBy("COUNT(t.id) DESC")
+                        .orderBy("SUM(l_s.listen_count) DESC")
                         .groupBy("t.id") };
 
         return utils::execRangeQuery<TrackId>(query, params.range);
@@ -280,8 +379,8 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createArtistsQuery(session, params)
-                        .groupBy("a.id").having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .groupBy("a.id")
+                        .orderBy("MAX(l_s.last_listened_at) DESC") };
 
         return utils::execRangeQuery<ArtistId>(query, params.range);
     }
@@ -290,8 +389,8 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createReleasesQuery(session, params)
-                        .groupBy("r.id").having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .groupBy("r.id")
+                        .orderBy("MAX(l_s.last_listened_at) DESC") };
 
         return utils::execRangeQuery<ReleaseId>(query, params.range);
     }
@@ -300,8 +399,8 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createTracksQuery(session, params)
-                        .groupBy("t.id").having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .groupBy("t.id")
+                        .orderBy("MAX(l_s.last_listened_at) DESC") };
 
         return utils::execRangeQuery<TrackId>(query, params.range);
     }
@@ -310,30 +409,90 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
-        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) from listen l")
-            .join("user u ON u.id = l.user_id")
-            .where("l.track_id = ?").bind(trackId)
-            .where("l.user_id = ?").bind(userId)
-            .where("l.backend = u.scrobbling_backend"));
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT IFNULL(SUM(l_s.listen_count), 0) from track_listen_stats l_s")
+            .join("user u ON u.id = l_s.user_id")
+            .where("l_s.track_id = ?").bind(trackId)
+            .where("l_s.user_id = ?").bind(userId)
+            .where("l_s.backend = u.scrobbling_backend"));
     }
 
     std::size_t Listen::getCount(Session& session, UserId userId, ReleaseId releaseId)
     {
         session.checkReadTransaction();
 
+        // number of times all the tracks of the release have been listened to
         return utils::fetchQuerySingleResult(session.getDboSession()->query<int>(
-            "SELECT IFNULL(MIN(count_result), 0)"
-            " FROM ("
-            " SELECT COUNT(l.track_id) AS count_result"
+            "SELECT IFNULL(MIN(IFNULL(l_s.listen_count, 0)), 0)"
             " FROM track t"
-            " LEFT JOIN listen l ON t.id = l.track_id AND l.backend = (SELECT scrobbling_backend FROM user WHERE id = ?) AND l.user_id = ?"
-            " WHERE t.release_id = ?"
-            " GROUP BY t.id)")
+            " LEFT JOIN track_listen_stats l_s ON l_s.track_id = t.id AND l_s.backend = (SELECT scrobbling_backend FROM user WHERE id = ?) AND l_s.user_id = ?"
+            " WHERE t.release_id = ?")
             .bind(userId)
             .bind(userId)
             .bind(releaseId));
     }
 
+    void Listen::createStatsTablesIfNeeded(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        std::vector<std::string> expectedEntries{ "track_listen_stats_bd", "release_listen_stats_track_au", "artist_listen_stats_link_ai", "artist_listen_stats_link_ad" };
+        for (const ListenStatsTable& table : listenStatsTables)
+        {
+            const std::string statsTable{ getStatsTableName(table) };
+            expectedEntries.push_back(statsTable);
+            expectedEntries.push_back(statsTable + "_ai");
+            expectedEntries.push_back(statsTable + "_ad");
+        }
+
+        std::size_t existingEntryCount{};
+        for (const std::string& entry : expectedEntries)
+            existingEntryCount += utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) FROM sqlite_master").where("name = ?").bind(entry));
+
+        for (const ListenStatsTable& table : listenStatsTables)
+            createStatsTable(session, table);
+
+        // Remove listens before the track itself, so that the release/artist the track belongs to can still be resolved
+        session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS track_listen_stats_bd BEFORE DELETE ON track BEGIN"
+            " DELETE FROM listen WHERE track_id = old.id;"
+            " END");
+
+        // Tracks may be linked to other releases/artists when rescanned
+        session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS release_listen_stats_track_au AFTER UPDATE OF release_id ON track WHEN old.release_id IS NOT new.release_id BEGIN "
+            + createStatsRecomputeStatements(releaseListenStatsTable, "old.release_id", "new.id")
+            + " " + createStatsRecomputeStatements(releaseListenStatsTable, "new.release_id", "new.id")
+            + " END");
+        session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS artist_listen_stats_link_ai AFTER INSERT ON track_artist_link BEGIN "
+            + createStatsRecomputeStatements(artistListenStatsTable, "new.artist_id", "new.track_id")
+            + " END");
+        session.getDboSession()->execute("CREATE TRIGGER IF NOT EXISTS artist_listen_stats_link_ad AFTER DELETE ON track_artist_link BEGIN "
+            + createStatsRecomputeStatements(artistListenStatsTable, "old.artist_id", "old.track_id")
+            + " END");
+
+        // Missing triggers may have let the stats drift
+        if (existingEntryCount != expectedEntries.size())
+        {
+            LMS_LOG(DB, INFO, "Building listen stats...");
+            rebuildStats(session);
+        }
+    }
+
+    void Listen::rebuildStats(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        for (const ListenStatsTable& table : listenStatsTables)
+        {
+            const std::string statsTable{ getStatsTableName(table) };
+            const std::string entityId{ table.entityId };
+
+            session.getDboSession()->execute("DELETE FROM " + statsTable);
+            session.getDboSession()->execute("INSERT INTO " + statsTable + "(user_id, backend, " + std::string{ table.entity } + "_id, listen_count, last_listened_at)"
+                " SELECT l.user_id, l.backend, " + entityId + ", COUNT(DISTINCT l.id), MAX(l.date_time) FROM listen l" + std::string{ table.join }
+                + " WHERE " + entityId + " IS NOT NULL"
+                " GROUP BY l.user_id, l.backend, " + entityId);
+        }
+    }
+
     Listen::pointer Listen::getMostRecentListen(Session& session, UserId userId, ScrobblingBackend backend, ReleaseId releaseId)
     {
         session.checkReadTransaction();
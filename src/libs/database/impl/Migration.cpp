@@ -34,7 +34,7 @@ namespace lms::db
 {
     namespace
     {
-        static constexpr Version LMS_DATABASE_VERSION{ 59 };
+        static constexpr Version LMS_DATABASE_VERSION{ 64 };
     }
 
     VersionInfo::VersionInfo()
@@ -472,6 +472,65 @@ SELECT
         session.getDboSession()->execute("UPDATE scan_settings SET audio_file_extensions = audio_file_extensions || ' .dsf'");
     }
 
+    void migrateFromV59(Session& session)
+    {
+        // Library generation, used to build HTTP cache validators
+        session.getDboSession()->execute("ALTER TABLE scan_settings ADD library_generation INTEGER NOT NULL DEFAULT(0)");
+    }
+
+    void migrateFromV60(Session& session)
+    {
+        // Image files are now indexed during scans
+        session.getDboSession()->execute(R"(CREATE TABLE IF NOT EXISTS "image" (
+  "id" integer primary key autoincrement,
+  "version" integer not null,
+  "absolute_file_path" text not null,
+  "directory" text not null,
+  "stem" text not null,
+  "file_last_write" text,
+  "file_size" bigint not null
+))");
+
+        // Just increment the scan version of the settings to make the next scheduled scan rescan everything and fill the image table
+        session.getDboSession()->execute("UPDATE scan_settings SET scan_version = scan_version + 1");
+    }
+
+    void migrateFromV61(Session& session)
+    {
+        // Content hash, used to skip files whose content did not change
+        session.getDboSession()->execute("ALTER TABLE track ADD content_hash BIGINT");
+    }
+
+    void migrateFromV62(Session& session)
+    {
+        // Directories are now tracked during scans, the next scan will fill this table
+        session.getDboSession()->execute(R"(CREATE TABLE IF NOT EXISTS "directory" (
+  "id" integer primary key autoincrement,
+  "version" integer not null,
+  "absolute_path" text not null,
+  "last_write_time" text,
+  "file_count" integer not null,
+  "parent_directory_id" bigint,
+  constraint "fk_directory_parent_directory" foreign key ("parent_directory_id") references "directory" ("id") on delete cascade deferrable initially deferred
+))");
+    }
+
+    void migrateFromV63(Session& session)
+    {
+        // Scan checkpoint, used to resume interrupted scans
+        session.getDboSession()->execute(R"(CREATE TABLE IF NOT EXISTS "scan_checkpoint" (
+  "id" integer primary key autoincrement,
+  "version" integer not null,
+  "scan_version" integer not null,
+  "full_scan" boolean not null,
+  "step" integer not null,
+  "last_processed_path" text not null,
+  "stats" text not null,
+  "media_library_id" bigint,
+  constraint "fk_scan_checkpoint_media_library" foreign key ("media_library_id") references "media_library" ("id") on delete set null deferrable initially deferred
+))");
+    }
+
     bool doDbMigration(Session& session)
     {
         static const std::string outdatedMsg{ "Outdated database, please rebuild it (delete the .db file and restart)" };
@@ -508,6 +567,11 @@ SELECT
             {56, migrateFromV56},
             {57, migrateFromV57},
             {58, migrateFromV58},
+            {59, migrateFromV59},
+            {60, migrateFromV60},
+            {61, migrateFromV61},
+            {62, migrateFromV62},
+            {63, migrateFromV63},
         };
 
         bool migrationPerformed{};
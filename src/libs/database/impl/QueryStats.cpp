@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "QueryStats.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+
+namespace lms::db
+{
+    namespace
+    {
+        std::mutex entriesMutex;
+        std::unordered_map<std::string, QueryStats::Entry> entries; // by normalized sql
+
+        std::size_t skipSpaces(std::string_view str, std::size_t pos)
+        {
+            while (pos < str.size() && str[pos] == ' ')
+                ++pos;
+
+            return pos;
+        }
+
+        bool isIdentifierChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        }
+
+        bool endsWithOpeningParenthesis(std::string_view str)
+        {
+            while (!str.empty() && str.back() == ' ')
+                str.remove_suffix(1);
+
+            return !str.empty() && str.back() == '(';
+        }
+
+        // Replace string and numeric literals by placeholders
+        std::string replaceLiterals(std::string_view sql)
+        {
+            std::string res;
+            res.reserve(sql.size());
+
+            for (std::size_t i{}; i < sql.size(); ++i)
+            {
+                const char c{ sql[i] };
+                if (c == '"')
+                {
+                    // quoted identifiers are kept as is
+                    const std::size_t end{ std::min(sql.find('"', i + 1), sql.size() - 1) };
+                    res.append(sql.substr(i, end - i + 1));
+                    i = end;
+                }
+                else if (c == '\'')
+                {
+                    std::size_t end{ i + 1 };
+                    while (end < sql.size())
+                    {
+                        if (sql[end] == '\'')
+                        {
+                            if (end + 1 < sql.size() && sql[end + 1] == '\'') // escaped quote
+                            {
+                                end += 2;
+                                continue;
+                            }
+                            break;
+                        }
+                        ++end;
+                    }
+
+                    res.push_back('?');
+                    i = end;
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c)) && (i == 0 || !isIdentifierChar(sql[i - 1])))
+                {
+                    std::size_t end{ i };
+                    while (end < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[end])) || sql[end] == '.'))
+                        ++end;
+
+                    res.push_back('?');
+                    i = end - 1;
+                }
+                else
+                {
+                    res.push_back(c);
+                }
+            }
+
+            return res;
+        }
+    }
+
+    void QueryStats::record(std::string_view sql, clock::duration duration)
+    {
+        std::string normalizedSql{ normalizeSql(sql) };
+
+        const std::scoped_lock lock{ entriesMutex };
+
+        auto it{ entries.find(normalizedSql) };
+        if (it == std::end(entries))
+        {
+            // Keep the memory usage bounded if a lot of distinct statements are executed
+            if (entries.size() >= maxEntryCount)
+                it = entries.try_emplace(std::string{ otherStatementsSql }, Entry{ .sql = std::string{ otherStatementsSql } }).first;
+            else
+                it = entries.try_emplace(std::move(normalizedSql), Entry{ .sql = std::string{ sql } }).first;
+        }
+
+        Entry& entry{ it->second };
+
+        entry.executionCount += 1;
+        entry.totalDuration += duration;
+        entry.maxDuration = std::max(entry.maxDuration, duration);
+    }
+
+    std::vector<QueryStats::Entry> QueryStats::getTopEntries(std::size_t maxCount)
+    {
+        std::vector<Entry> res;
+
+        {
+            const std::scoped_lock lock{ entriesMutex };
+
+            res.reserve(entries.size());
+            for (const auto& [normalizedSql, entry] : entries)
+                res.push_back(entry);
+        }
+
+        std::sort(std::begin(res), std::end(res), [](const Entry& lhs, const Entry& rhs) { return lhs.totalDuration > rhs.totalDuration; });
+        if (res.size() > maxCount)
+            res.resize(maxCount);
+
+        return res;
+    }
+
+    void QueryStats::clear()
+    {
+        const std::scoped_lock lock{ entriesMutex };
+        entries.clear();
+    }
+
+    std::string QueryStats::normalizeSql(std::string_view rawSql)
+    {
+        const std::string sql{ replaceLiterals(rawSql) };
+
+        // Collapse value lists ("(?)", "(?, ?, ?)" -> "(?, ...)")
+        std::string res;
+        res.reserve(sql.size());
+
+        for (std::size_t i{}; i < sql.size(); ++i)
+        {
+            res.push_back(sql[i]);
+            if (sql[i] != '?')
+                continue;
+
+            std::size_t listEnd{ i + 1 };
+            while (true)
+            {
+                std::size_t pos{ skipSpaces(sql, listEnd) };
+                if (pos >= sql.size() || sql[pos] != ',')
+                    break;
+
+                pos = skipSpaces(sql, pos + 1);
+                if (pos >= sql.size() || sql[pos] != '?')
+                    break;
+
+                listEnd = pos + 1;
+            }
+
+            const std::size_t nextPos{ skipSpaces(sql, listEnd) };
+            const bool isSingleValueList{ nextPos < sql.size() && sql[nextPos] == ')' && endsWithOpeningParenthesis(std::string_view{ res }.substr(0, res.size() - 1)) };
+            if (listEnd != i + 1 || isSingleValueList)
+            {
+                res += ", ...";
+                i = listEnd - 1;
+            }
+        }
+
+        return res;
+    }
+}
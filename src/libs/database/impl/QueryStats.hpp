@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lms::db
+{
+    // Process-wide execution stats per distinct statement, for debug purposes
+    // Statements only differing by their literals or by the size of their value lists share the same entry
+    class QueryStats
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            std::string sql;    // first recorded statement, can be used to get a query plan
+            std::size_t executionCount{};
+            clock::duration totalDuration{};
+            clock::duration maxDuration{};
+        };
+
+        static void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+        static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+        // Once reached, new statements are accounted in a single entry
+        static constexpr std::size_t maxEntryCount{ 1000 };
+        static constexpr std::string_view otherStatementsSql{ "<other statements>" };
+
+        static void record(std::string_view sql, clock::duration duration);
+        static std::vector<Entry> getTopEntries(std::size_t maxCount); // sorted by total duration
+        static void clear();
+
+        static std::string normalizeSql(std::string_view sql);
+
+    private:
+        static inline std::atomic<bool> _enabled{};
+    };
+
+    // Records the execution time of the query (including the time spent processing results) if stats are enabled
+    template <typename Query>
+    class ScopedQueryStats
+    {
+    public:
+        ScopedQueryStats(const Query& query)
+            : _query{ QueryStats::isEnabled() ? &query : nullptr }
+        {
+            if (_query)
+                _start = QueryStats::clock::now();
+        }
+
+        ~ScopedQueryStats()
+        {
+            if (_query)
+                QueryStats::record(_query->asString(), QueryStats::clock::now() - _start);
+        }
+
+    private:
+        ScopedQueryStats(const ScopedQueryStats&) = delete;
+        ScopedQueryStats& operator=(const ScopedQueryStats&) = delete;
+
+        const Query* _query;
+        QueryStats::clock::time_point _start;
+    };
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/ReferenceData.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+#include "database/ScanSettings.hpp"
+#include "database/Session.hpp"
+#include "core/ILogger.hpp"
+
+#include "IdTypeTraits.hpp"
+#include "PathTraits.hpp"
+#include "Utils.hpp"
+
+namespace lms::db
+{
+    namespace
+    {
+        template <typename Info, typename Predicate>
+        const Info* findInfo(const std::vector<Info>& infos, Predicate&& predicate)
+        {
+            auto it{ std::find_if(std::cbegin(infos), std::cend(infos), std::forward<Predicate>(predicate)) };
+            return it != std::cend(infos) ? &(*it) : nullptr;
+        }
+    }
+
+    const ReferenceData::ClusterTypeInfo* ReferenceData::findClusterType(std::string_view name) const
+    {
+        return findInfo(clusterTypes, [&](const ClusterTypeInfo& info) { return info.name == name; });
+    }
+
+    const ReferenceData::ClusterTypeInfo* ReferenceData::findClusterType(ClusterTypeId id) const
+    {
+        return findInfo(clusterTypes, [&](const ClusterTypeInfo& info) { return info.id == id; });
+    }
+
+    std::vector<ClusterTypeId> ReferenceData::getClusterTypeIds() const
+    {
+        std::vector<ClusterTypeId> res;
+        res.reserve(clusterTypes.size());
+        std::transform(std::cbegin(clusterTypes), std::cend(clusterTypes), std::back_inserter(res), [](const ClusterTypeInfo& info) { return info.id; });
+
+        return res;
+    }
+
+    std::shared_ptr<const ReferenceData> ReferenceDataCache::get(Session& session)
+    {
+        if (std::shared_ptr<const ReferenceData> snapshot{ getSnapshot() })
+            return snapshot;
+
+        std::scoped_lock lock{ _buildMutex };
+
+        // may have been built in the meantime
+        if (std::shared_ptr<const ReferenceData> snapshot{ getSnapshot() })
+            return snapshot;
+
+        auto transaction{ session.createReadTransaction() };
+
+        std::shared_ptr<const ReferenceData> snapshot{ build(session) };
+        setSnapshot(snapshot);
+        return snapshot;
+    }
+
+    void ReferenceDataCache::refresh(Session& session)
+    {
+        std::scoped_lock lock{ _buildMutex };
+
+        auto transaction{ session.createReadTransaction() };
+        setSnapshot(build(session));
+    }
+
+    std::shared_ptr<const ReferenceData> ReferenceDataCache::getSnapshot() const
+    {
+        std::scoped_lock lock{ _snapshotMutex };
+        return _snapshot;
+    }
+
+    void ReferenceDataCache::setSnapshot(std::shared_ptr<const ReferenceData> snapshot)
+    {
+        std::scoped_lock lock{ _snapshotMutex };
+        _snapshot.swap(snapshot); // previous snapshot is released along with the parameter, outside of the lock
+    }
+
+    std::shared_ptr<const ReferenceData> ReferenceDataCache::build(Session& session)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Database", "BuildReferenceData");
+
+        session.checkReadTransaction();
+
+        auto referenceData{ std::make_shared<ReferenceData>() };
+        referenceData->version = ++_lastVersion;
+
+        {
+            using ResultType = std::tuple<ClusterTypeId, std::string>;
+            auto query{ session.getDboSession()->query<ResultType>("SELECT id, name FROM cluster_type").orderBy("name") };
+            utils::forEachQueryResult(query, [&](ResultType&& res) {
+                referenceData->clusterTypes.emplace_back(ReferenceData::ClusterTypeInfo{ std::get<0>(res), std::move(std::get<1>(res)) });
+            });
+        }
+
+        {
+            using ResultType = std::tuple<ReleaseTypeId, std::string>;
+            auto query{ session.getDboSession()->query<ResultType>("SELECT id, name FROM release_type").orderBy("name") };
+            utils::forEachQueryResult(query, [&](ResultType&& res) {
+                referenceData->releaseTypes.emplace_back(ReferenceData::ReleaseTypeInfo{ std::get<0>(res), std::move(std::get<1>(res)) });
+            });
+        }
+
+        {
+            using ResultType = std::tuple<MediaLibraryId, std::string, std::filesystem::path>;
+            auto query{ session.getDboSession()->query<ResultType>("SELECT id, name, path FROM media_library").orderBy("id") };
+            utils::forEachQueryResult(query, [&](ResultType&& res) {
+                referenceData->mediaLibraries.emplace_back(ReferenceData::MediaLibraryInfo{ std::get<0>(res), std::move(std::get<1>(res)), std::move(std::get<2>(res)) });
+            });
+        }
+
+        if (const ScanSettings::pointer scanSettings{ ScanSettings::get(session) })
+            referenceData->libraryGeneration = scanSettings->getLibraryGeneration();
+
+        LMS_LOG(DB, DEBUG, "Reference data version " << referenceData->version << " built: " << referenceData->clusterTypes.size() << " cluster types, " << referenceData->releaseTypes.size() << " release types, " << referenceData->mediaLibraries.size() << " media libraries, library generation " << referenceData->libraryGeneration);
+
+        return referenceData;
+    }
+}
@@ -37,6 +37,8 @@ namespace lms::db
 {
     namespace
     {
+        constexpr const char* orphanIdsQuery{ "SELECT r.id FROM release r LEFT OUTER JOIN track t ON r.id = t.release_id WHERE t.id IS NULL" };
+
         template <typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Release::FindParameters& params)
         {
@@ -48,6 +50,7 @@ namespace lms::db
                 || params.sortMethod == ReleaseSortMethod::OriginalDate
                 || params.sortMethod == ReleaseSortMethod::OriginalDateDesc
                 || params.writtenAfter.isValid()
+                || params.scannedAfter.isValid()
                 || params.dateRange
                 || params.artist.isValid()
                 || params.clusters.size() == 1
@@ -69,14 +72,25 @@ namespace lms::db
             if (params.writtenAfter.isValid())
                 query.where("t.file_last_write > ?").bind(params.writtenAfter);
 
+            // the added time of the tracks is refreshed each time they are scanned
+            if (params.scannedAfter.isValid())
+                query.where("t.file_added >= ?").bind(params.scannedAfter);
+
             if (params.dateRange)
             {
                 query.where("COALESCE(CAST(SUBSTR(t.date, 1, 4) AS INTEGER), t.year) >= ?").bind(params.dateRange->begin);
                 query.where("COALESCE(CAST(SUBSTR(t.date, 1, 4) AS INTEGER), t.year) <= ?").bind(params.dateRange->end);
             }
 
-            for (std::string_view keyword : params.keywords)
-                query.where("r.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("r.id IN (SELECT rowid FROM release_fts WHERE release_fts MATCH ?)").bind(utils::buildFullTextSearchMatch(params.keywords, "name"));
+            }
+            else
+            {
+                for (std::string_view keyword : params.keywords)
+                    query.where("r.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            }
 
             if (params.starringUser.isValid())
             {
@@ -164,15 +178,21 @@ namespace lms::db
                 query.where(oss.str());
             }
 
+            assert(!params.cursor || params.sortMethod == ReleaseSortMethod::Id || params.sortMethod == ReleaseSortMethod::Name);
+
             switch (params.sortMethod)
             {
             case ReleaseSortMethod::None:
                 break;
             case ReleaseSortMethod::Id:
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "", "r.id", *params.cursor);
                 query.orderBy("r.id");
                 break;
             case ReleaseSortMethod::Name:
-                query.orderBy("r.name COLLATE NOCASE");
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "r.name COLLATE NOCASE", "r.id", *params.cursor);
+                query.orderBy("r.name COLLATE NOCASE, r.id");
                 break;
             case ReleaseSortMethod::ArtistNameThenName:
                 query.orderBy("a.name COLLATE NOCASE, r.name COLLATE NOCASE");
@@ -200,6 +220,24 @@ namespace lms::db
 
             return query;
         }
+
+        std::optional<RangeResults<ReleaseId>> sampleRandomReleaseIds(Session& session, const Release::FindParameters& params)
+        {
+            assert(params.sortMethod == ReleaseSortMethod::Random);
+            if (!params.range || params.range->offset != 0)
+                return std::nullopt;
+
+            return utils::sampleRandomRange<ReleaseId>(utils::getMaxId(session, "release"), params.range->size, [&](std::span<const IdType::ValueType> candidateIds)
+                {
+                    Release::FindParameters sampleParams{ params };
+                    sampleParams.setSortMethod(ReleaseSortMethod::None);
+                    sampleParams.setRange(std::nullopt);
+
+                    auto query{ createQuery<ReleaseId>(session, "DISTINCT r.id", sampleParams) };
+                    utils::applyIdsFilter(query, "r.id", candidateIds);
+                    return utils::fetchQueryResults(query);
+                });
+        }
     }
 
     ReleaseType::ReleaseType(std::string_view name)
@@ -282,10 +320,15 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
-        auto query{ session.getDboSession()->query<ReleaseId>("select r.id from release r LEFT OUTER JOIN Track t ON r.id = t.release_id WHERE t.id IS NULL") };
+        auto query{ session.getDboSession()->query<ReleaseId>(orphanIdsQuery) };
         return utils::execRangeQuery<ReleaseId>(query, range);
     }
 
+    std::size_t Release::removeOrphans(Session& session, std::size_t maxCount)
+    {
+        return utils::deleteIdsFromQuery(session, "release", orphanIdsQuery, maxCount);
+    }
+
     void Release::find(Session& session, ReleaseId& lastRetrievedRelease, std::size_t count, const std::function<void(const Release::pointer&)>& func, MediaLibraryId library)
     {
         session.checkReadTransaction();
@@ -312,31 +355,84 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ReleaseSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ReleaseId>> releaseIds{ sampleRandomReleaseIds(session, params) })
+            {
+                RangeResults<pointer> res;
+                res.results = utils::fetchObjects<Release>(*session.getDboSession(), std::span<const ReleaseId>{ releaseIds->results });
+                res.range = Range{ 0, res.results.size() };
+                res.moreResults = releaseIds->moreResults;
+
+                return res;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Release>>(session, "DISTINCT r", params) };
-        return utils::execRangeQuery<pointer>(query, params.range);
+        RangeResults<pointer> res{ utils::execRangeQuery<pointer>(query, params.range, params.cursor) };
+        if (res.moreResults && !res.results.empty())
+            res.nextCursor = res.results.back()->getKeysetCursor(params.sortMethod);
+
+        return res;
     }
 
     void Release::find(Session& session, const FindParameters& params, const std::function<void(const pointer&)>& func)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ReleaseSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ReleaseId>> releaseIds{ sampleRandomReleaseIds(session, params) })
+            {
+                for (const pointer& release : utils::fetchObjects<Release>(*session.getDboSession(), std::span<const ReleaseId>{ releaseIds->results }))
+                    func(release);
+                return;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Release>>(session, "DISTINCT r", params) };
-        utils::forEachQueryRangeResult(query, params.range, func);
+        utils::forEachQueryRangeResult(query, params.range, params.cursor, func);
     }
 
     RangeResults<ReleaseId> Release::findIds(Session& session, const FindParameters& params)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == ReleaseSortMethod::Random)
+        {
+            if (std::optional<RangeResults<ReleaseId>> releaseIds{ sampleRandomReleaseIds(session, params) })
+                return std::move(*releaseIds);
+        }
+
         auto query{ createQuery<ReleaseId>(session, "DISTINCT r.id", params) };
-        return utils::execRangeQuery<ReleaseId>(query, params.range);
+        RangeResults<ReleaseId> res{ utils::execRangeQuery<ReleaseId>(query, params.range, params.cursor) };
+        if (res.moreResults && !res.results.empty())
+        {
+            if (const pointer lastRelease{ find(session, res.results.back()) })
+                res.nextCursor = lastRelease->getKeysetCursor(params.sortMethod);
+        }
+
+        return res;
     }
 
     std::size_t Release::getCount(Session& session, const FindParameters& params)
     {
         session.checkReadTransaction();
 
-        return utils::fetchQuerySingleResult(createQuery<int>(session, "COUNT(r.id)", params));
+        return utils::fetchQuerySingleResult(createQuery<int>(session, "COUNT(DISTINCT r.id)", params));
+    }
+
+    std::optional<KeysetCursor> Release::getKeysetCursor(ReleaseSortMethod sortMethod) const
+    {
+        switch (sortMethod)
+        {
+        case ReleaseSortMethod::Id:
+            return KeysetCursor{ {}, getId().getValue() };
+        case ReleaseSortMethod::Name:
+            return KeysetCursor{ _name, getId().getValue() };
+        default:
+            return std::nullopt;
+        }
     }
 
     std::size_t Release::getDiscCount() const
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/ScanCheckpoint.hpp"
+
+#include "database/MediaLibrary.hpp"
+#include "database/Session.hpp"
+#include "IdTypeTraits.hpp"
+#include "PathTraits.hpp"
+#include "Utils.hpp"
+
+namespace lms::db
+{
+    ScanCheckpoint::pointer ScanCheckpoint::get(Session& session)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->find<ScanCheckpoint>());
+    }
+
+    ScanCheckpoint::pointer ScanCheckpoint::getOrCreate(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        if (pointer checkpoint{ get(session) })
+            return checkpoint;
+
+        return session.getDboSession()->add(std::make_unique<ScanCheckpoint>());
+    }
+
+    void ScanCheckpoint::clear(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        session.getDboSession()->execute("DELETE FROM scan_checkpoint");
+    }
+} // namespace lms::db
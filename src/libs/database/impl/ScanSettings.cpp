@@ -104,4 +104,9 @@ namespace lms::db
     {
         _scanVersion += 1;
     }
+
+    void ScanSettings::incLibraryGeneration()
+    {
+        _libraryGeneration += 1;
+    }
 } // namespace lms::db
@@ -19,19 +19,27 @@
 
 #include "database/Session.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <sstream>
+#include <vector>
 
 #include "core/Exception.hpp"
 #include "core/ILogger.hpp"
 #include "core/ITraceLogger.hpp"
+#include "core/String.hpp"
 
 #include "database/Artist.hpp"
 #include "database/AuthToken.hpp"
 #include "database/Cluster.hpp"
 #include "database/Db.hpp"
+#include "database/Directory.hpp"
+#include "database/Image.hpp"
 #include "database/Listen.hpp"
 #include "database/MediaLibrary.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/Release.hpp"
+#include "database/ScanCheckpoint.hpp"
 #include "database/ScanSettings.hpp"
 #include "database/StarredArtist.hpp"
 #include "database/StarredRelease.hpp"
@@ -46,11 +54,90 @@
 #include "EnumSetTraits.hpp"
 #include "PathTraits.hpp"
 #include "Migration.hpp"
+#include "QueryStats.hpp"
 #include "Utils.hpp"
 
 namespace lms::db
 {
-    WriteTransaction::WriteTransaction(core::RecursiveSharedMutex& mutex, Wt::Dbo::Session& session)
+    namespace
+    {
+        struct FullTextSearchTable
+        {
+            std::string_view contentTable;
+            std::vector<std::string> columns;
+        };
+
+        std::string joinColumns(const std::vector<std::string>& columns, std::string_view prefix)
+        {
+            std::vector<std::string> res;
+            for (const std::string& column : columns)
+                res.push_back(std::string{ prefix } + column);
+
+            return core::stringUtils::joinStrings(res, ", ");
+        }
+
+        // External content tables: only the index is stored, the content is read from the original table
+        void createFullTextSearchTable(Wt::Dbo::Session& session, const FullTextSearchTable& table, std::string_view tokenizer)
+        {
+            const std::string contentTable{ table.contentTable };
+            const std::string ftsTable{ contentTable + "_fts" };
+            const std::string columns{ joinColumns(table.columns, "") };
+            const std::string oldValues{ joinColumns(table.columns, "old.") };
+            const std::string newValues{ joinColumns(table.columns, "new.") };
+
+            std::vector<std::string> changeConditions;
+            for (const std::string& column : table.columns)
+                changeConditions.push_back("old." + column + " IS NOT new." + column);
+
+            // table + 3 triggers
+            const bool needRebuild{ utils::fetchQuerySingleResult(session.query<int>("SELECT COUNT(*) FROM sqlite_master WHERE name IN (?, ?, ?, ?)")
+                .bind(ftsTable).bind(ftsTable + "_ai").bind(ftsTable + "_ad").bind(ftsTable + "_au")) < 4 };
+
+            session.execute("CREATE VIRTUAL TABLE IF NOT EXISTS " + ftsTable + " USING fts5(" + columns + ", content='" + contentTable + "', content_rowid='id', tokenize='" + std::string{ tokenizer } + "')");
+            session.execute("CREATE TRIGGER IF NOT EXISTS " + ftsTable + "_ai AFTER INSERT ON " + contentTable + " BEGIN"
+                " INSERT INTO " + ftsTable + "(rowid, " + columns + ") VALUES (new.id, " + newValues + ");"
+                " END");
+            session.execute("CREATE TRIGGER IF NOT EXISTS " + ftsTable + "_ad AFTER DELETE ON " + contentTable + " BEGIN"
+                " INSERT INTO " + ftsTable + "(" + ftsTable + ", rowid, " + columns + ") VALUES ('delete', old.id, " + oldValues + ");"
+                " END");
+            session.execute("CREATE TRIGGER IF NOT EXISTS " + ftsTable + "_au AFTER UPDATE OF " + columns + " ON " + contentTable
+                + " WHEN " + core::stringUtils::joinStrings(changeConditions, " OR ") + " BEGIN"
+                " INSERT INTO " + ftsTable + "(" + ftsTable + ", rowid, " + columns + ") VALUES ('delete', old.id, " + oldValues + ");"
+                " INSERT INTO " + ftsTable + "(rowid, " + columns + ") VALUES (new.id, " + newValues + ");"
+                " END");
+
+            if (needRebuild)
+            {
+                LMS_LOG(DB, INFO, "Building full text search index for " << contentTable << "...");
+                session.execute("INSERT INTO " + ftsTable + "(" + ftsTable + ") VALUES ('rebuild')");
+            }
+        }
+
+        bool isFullScan(std::string_view queryPlanDetail)
+        {
+            return queryPlanDetail.starts_with("SCAN ") && queryPlanDetail.find(" USING ") == std::string_view::npos;
+        }
+
+        thread_local std::size_t activeWriteTransactionCount{};
+    }
+
+    WriteTransaction::ActiveScope::ActiveScope()
+    {
+        activeWriteTransactionCount += 1;
+    }
+
+    WriteTransaction::ActiveScope::~ActiveScope()
+    {
+        assert(activeWriteTransactionCount > 0);
+        activeWriteTransactionCount -= 1;
+    }
+
+    bool WriteTransaction::isActiveInCurrentThread()
+    {
+        return activeWriteTransactionCount > 0;
+    }
+
+    WriteTransaction::WriteTransaction(std::recursive_mutex& mutex, Wt::Dbo::Session& session)
         : _lock{ mutex },
         _transaction{ session }
     {
@@ -94,10 +181,13 @@ namespace lms::db
         _session.mapClass<AuthToken>("auth_token");
         _session.mapClass<Cluster>("cluster");
         _session.mapClass<ClusterType>("cluster_type");
+        _session.mapClass<Directory>("directory");
+        _session.mapClass<Image>("image");
         _session.mapClass<Listen>("listen");
         _session.mapClass<MediaLibrary>("media_library");
         _session.mapClass<Release>("release");
         _session.mapClass<ReleaseType>("release_type");
+        _session.mapClass<ScanCheckpoint>("scan_checkpoint");
         _session.mapClass<ScanSettings>("scan_settings");
         _session.mapClass<StarredArtist>("starred_artist");
         _session.mapClass<StarredRelease>("starred_release");
@@ -113,7 +203,7 @@ namespace lms::db
 
     WriteTransaction Session::createWriteTransaction()
     {
-        return WriteTransaction{ _db.getMutex(), _session };
+        return WriteTransaction{ _db.getWriteMutex(), _session };
     }
 
     ReadTransaction Session::createReadTransaction()
@@ -161,6 +251,13 @@ namespace lms::db
         LMS_SCOPED_TRACE_OVERVIEW("Database", "IndexCreation");
         LMS_LOG(DB, INFO, "Creating indexes... This may take a while...");
 
+        createFullTextSearchTablesIfNeeded();
+
+        {
+            auto transaction{ createWriteTransaction() };
+            Listen::createStatsTablesIfNeeded(*this);
+        }
+
         auto transaction{ createWriteTransaction() };
         _session.execute("CREATE INDEX IF NOT EXISTS artist_id_idx ON artist(id)");
         _session.execute("CREATE INDEX IF NOT EXISTS artist_name_idx ON artist(name)");
@@ -174,6 +271,12 @@ namespace lms::db
         _session.execute("CREATE INDEX IF NOT EXISTS cluster_cluster_type_idx ON cluster(cluster_type_id)");
         _session.execute("CREATE INDEX IF NOT EXISTS cluster_type_name_idx ON cluster_type(name)");
 
+        _session.execute("CREATE INDEX IF NOT EXISTS directory_absolute_path_idx ON directory(absolute_path)");
+        _session.execute("CREATE INDEX IF NOT EXISTS directory_parent_directory_idx ON directory(parent_directory_id)");
+
+        _session.execute("CREATE INDEX IF NOT EXISTS image_absolute_file_path_idx ON image(absolute_file_path)");
+        _session.execute("CREATE INDEX IF NOT EXISTS image_directory_idx ON image(directory)");
+
         _session.execute("CREATE INDEX IF NOT EXISTS listen_backend_idx ON listen(backend)");
         _session.execute("CREATE INDEX IF NOT EXISTS listen_id_idx ON listen(id)");
         _session.execute("CREATE INDEX IF NOT EXISTS listen_user_backend_idx ON listen(user_id,backend)");
@@ -233,6 +336,48 @@ namespace lms::db
         LMS_LOG(DB, INFO, "Indexes created!");
     }
 
+    void Session::createFullTextSearchTablesIfNeeded()
+    {
+        const std::vector<FullTextSearchTable> tables
+        {
+            { "artist", { "name", "sort_name" } },
+            { "release", { "name" } },
+            { "track", { "name" } },
+        };
+
+        // The trigram tokenizer allows substring matches, as LIKE '%keyword%' does (requires SQLite 3.34)
+        // Diacritics removal requires SQLite 3.45
+        for (const std::string_view tokenizer : { "trigram remove_diacritics 1", "trigram" })
+        {
+            try
+            {
+                auto transaction{ createWriteTransaction() };
+
+                for (const FullTextSearchTable& table : tables)
+                    createFullTextSearchTable(_session, table, tokenizer);
+
+                _db._fullTextSearchAvailable = true;
+                return;
+            }
+            catch (const Wt::Dbo::Exception& e)
+            {
+                LMS_LOG(DB, DEBUG, "Cannot create full text search tables using tokenizer '" << tokenizer << "': " << e.what());
+            }
+        }
+
+        LMS_LOG(DB, WARNING, "Full text search is not supported by SQLite, keyword searches will be slower");
+    }
+
+    bool Session::isFullTextSearchAvailable() const
+    {
+        return _db._fullTextSearchAvailable;
+    }
+
+    std::shared_ptr<const ReferenceData> Session::getReferenceData()
+    {
+        return _db.getReferenceDataCache().get(*this);
+    }
+
     void Session::vacuumIfNeeded()
     {
         long pageCount{};
@@ -256,7 +401,7 @@ namespace lms::db
 
         // We manually take a lock here since vacuum cannot be inside a transaction
         {
-            std::unique_lock lock{ _db.getMutex() };
+            std::unique_lock lock{ _db.getWriteMutex() };
             _db.executeSql("VACUUM");
         }
 
@@ -281,6 +426,56 @@ namespace lms::db
         traceLogger->setMetadata("db_listen_count", std::to_string(db::Listen::getCount(*this)));
         traceLogger->setMetadata("db_release_count", std::to_string(db::Release::getCount(*this)));
         traceLogger->setMetadata("db_track_count", std::to_string(db::Track::getCount(*this)));
+
+        const WriteQueue::Stats writeQueueStats{ _db.getWriteQueue().getStats() };
+        traceLogger->setMetadata("db_write_queue_request_count", std::to_string(writeQueueStats.requestCount));
+        traceLogger->setMetadata("db_write_queue_batch_count", std::to_string(writeQueueStats.batchCount));
+        traceLogger->setMetadata("db_write_queue_max_batch_size", std::to_string(writeQueueStats.maxBatchSize));
+        traceLogger->setMetadata("db_write_queue_max_wait_us", std::to_string(writeQueueStats.maxWaitDuration.count()));
+        traceLogger->setMetadata("db_write_queue_max_batch_duration_us", std::to_string(writeQueueStats.maxBatchDuration.count()));
+
+        if (QueryStats::isEnabled())
+            traceLogger->setMetadata("db_top_queries", createTopQueriesReport());
+    }
+
+    std::string Session::createTopQueriesReport()
+    {
+        using namespace std::chrono;
+
+        std::ostringstream oss;
+
+        Db::ScopedConnection connection{ _db.getReadConnectionPool() };
+
+        std::size_t rank{};
+        for (const QueryStats::Entry& entry : QueryStats::getTopEntries(20))
+        {
+            std::vector<std::string> queryPlan;
+            try
+            {
+                // unbound parameters are considered as NULL values
+                std::unique_ptr<Wt::Dbo::SqlStatement> statement{ connection->prepareStatement("EXPLAIN QUERY PLAN " + entry.sql) };
+                statement->execute();
+                while (statement->nextRow())
+                {
+                    std::string detail;
+                    if (statement->getResult(3, &detail, -1))
+                        queryPlan.push_back(std::move(detail));
+                }
+            }
+            catch (const Wt::Dbo::Exception& e)
+            {
+                LMS_LOG(DB, DEBUG, "Cannot get query plan: " << e.what());
+            }
+
+            const bool hasFullScan{ std::any_of(std::cbegin(queryPlan), std::cend(queryPlan), [](const std::string& detail) { return isFullScan(detail); }) };
+
+            oss << "#" << ++rank << ": " << entry.executionCount << " execution(s), total = " << duration_cast<microseconds>(entry.totalDuration).count() << " us, max = " << duration_cast<microseconds>(entry.maxDuration).count() << " us" << (hasFullScan ? " [FULL SCAN]" : "") << "\n";
+            oss << entry.sql << "\n";
+            for (const std::string& detail : queryPlan)
+                oss << "  " << detail << "\n";
+        }
+
+        return oss.str();
     }
 
     void Session::fullAnalyze()
@@ -72,6 +72,16 @@ namespace lms::db
             .where("backend = ?").bind(backend));
     }
 
+    std::string StarredArtist::getUserStamp(Session& session, UserId userId)
+    {
+        session.checkReadTransaction();
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<std::string>("SELECT COUNT(s_a.id) || '-' || COALESCE(MAX(s_a.date_time), '') || '-' || TOTAL(s_a.artist_id) FROM starred_artist s_a")
+            .join("user u ON u.id = s_a.user_id")
+            .where("s_a.user_id = ?").bind(userId)
+            .where("s_a.backend = u.feedback_backend")
+            .where("s_a.sync_state <> ?").bind(SyncState::PendingRemove));
+    }
+
     void StarredArtist::setDateTime(const Wt::WDateTime& dateTime)
     {
         _dateTime = utils::normalizeDateTime(dateTime);
@@ -49,8 +49,15 @@ namespace lms::db
             auto query{ session.getDboSession()->query<ResultType>("SELECT " + std::string{ itemToSelect } + " FROM track t") };
 
             assert(params.keywords.empty() || params.name.empty());
-            for (std::string_view keyword : params.keywords)
-                query.where("t.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            if (utils::canUseFullTextSearch(session, params.keywords))
+            {
+                query.where("t.id IN (SELECT rowid FROM track_fts WHERE track_fts MATCH ?)").bind(utils::buildFullTextSearchMatch(params.keywords, "name"));
+            }
+            else
+            {
+                for (std::string_view keyword : params.keywords)
+                    query.where("t.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeLikeKeyword(keyword) + "%");
+            }
 
             if (!params.name.empty())
                 query.where("t.name = ?").bind(params.name);
@@ -149,11 +156,15 @@ namespace lms::db
             if (params.mediaLibrary.isValid())
                 query.where("t.media_library_id = ?").bind(params.mediaLibrary);
 
+            assert(!params.cursor || params.sortMethod == TrackSortMethod::Id || params.sortMethod == TrackSortMethod::Name);
+
             switch (params.sortMethod)
             {
             case TrackSortMethod::None:
                 break;
             case TrackSortMethod::Id:
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "", "t.id", *params.cursor);
                 query.orderBy("t.id");
                 break;
             case TrackSortMethod::LastWritten:
@@ -167,7 +178,9 @@ namespace lms::db
                 query.orderBy("s_t.date_time DESC");
                 break;
             case TrackSortMethod::Name:
-                query.orderBy("t.name COLLATE NOCASE");
+                if (params.cursor)
+                    utils::applyKeysetCursor(query, "t.name COLLATE NOCASE", "t.id", *params.cursor);
+                query.orderBy("t.name COLLATE NOCASE, t.id");
                 break;
             case TrackSortMethod::DateDescAndRelease:
                 query.orderBy("COALESCE(t.date, CAST(t.year AS TEXT)) DESC,t.release_id,t.disc_number,t.track_number");
@@ -197,6 +210,24 @@ namespace lms::db
 
             return createQuery<ResultType>(session, itemToSelect, params);
         }
+
+        std::optional<RangeResults<TrackId>> sampleRandomTrackIds(Session& session, const Track::FindParameters& params)
+        {
+            assert(params.sortMethod == TrackSortMethod::Random);
+            if (!params.range || params.range->offset != 0)
+                return std::nullopt;
+
+            return utils::sampleRandomRange<TrackId>(utils::getMaxId(session, "track"), params.range->size, [&](std::span<const IdType::ValueType> candidateIds)
+                {
+                    Track::FindParameters sampleParams{ params };
+                    sampleParams.setSortMethod(TrackSortMethod::None);
+                    sampleParams.setRange(std::nullopt);
+
+                    auto query{ createQuery<TrackId>(session, sampleParams) };
+                    utils::applyIdsFilter(query, "t.id", candidateIds);
+                    return utils::fetchQueryResults(query);
+                });
+        }
     }
 
     Track::pointer Track::create(Session& session)
@@ -245,6 +276,23 @@ namespace lms::db
             });
     }
 
+    void Track::findInDirectory(Session& session, const std::filesystem::path& directory, bool recursive, TrackId& lastRetrievedTrack, std::size_t count, const std::function<void(const Track::pointer&)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->find<Track>()
+            .orderBy("id")
+            .where("id > ?").bind(lastRetrievedTrack)
+            .limit(static_cast<int>(count)) };
+        utils::applyDirectoryFilter(query, "absolute_file_path", directory, recursive);
+
+        utils::forEachQueryResult(query, [&](const Track::pointer& track)
+            {
+                func(track);
+                lastRetrievedTrack = track->getId();
+            });
+    }
+
     bool Track::exists(Session& session, TrackId id)
     {
         session.checkReadTransaction();
@@ -310,24 +358,64 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
+        if (parameters.sortMethod == TrackSortMethod::Random)
+        {
+            if (std::optional<RangeResults<TrackId>> trackIds{ sampleRandomTrackIds(session, parameters) })
+                return std::move(*trackIds);
+        }
+
         auto query{ createQuery<TrackId>(session, parameters) };
-        return utils::execRangeQuery<TrackId>(query, parameters.range);
+        RangeResults<TrackId> res{ utils::execRangeQuery<TrackId>(query, parameters.range, parameters.cursor) };
+        if (res.moreResults && !res.results.empty())
+        {
+            if (const pointer lastTrack{ find(session, res.results.back()) })
+                res.nextCursor = lastTrack->getKeysetCursor(parameters.sortMethod);
+        }
+
+        return res;
     }
 
     RangeResults<Track::pointer> Track::find(Session& session, const FindParameters& parameters)
     {
         session.checkReadTransaction();
 
+        if (parameters.sortMethod == TrackSortMethod::Random)
+        {
+            if (std::optional<RangeResults<TrackId>> trackIds{ sampleRandomTrackIds(session, parameters) })
+            {
+                RangeResults<Track::pointer> res;
+                res.results = utils::fetchObjects<Track>(*session.getDboSession(), std::span<const TrackId>{ trackIds->results });
+                res.range = Range{ 0, res.results.size() };
+                res.moreResults = trackIds->moreResults;
+
+                return res;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Track>>(session, parameters) };
-        return utils::execRangeQuery<Track::pointer>(query, parameters.range);
+        RangeResults<Track::pointer> res{ utils::execRangeQuery<Track::pointer>(query, parameters.range, parameters.cursor) };
+        if (res.moreResults && !res.results.empty())
+            res.nextCursor = res.results.back()->getKeysetCursor(parameters.sortMethod);
+
+        return res;
     }
 
     void Track::find(Session& session, const FindParameters& params, const std::function<void(const Track::pointer&)>& func)
     {
         session.checkReadTransaction();
 
+        if (params.sortMethod == TrackSortMethod::Random)
+        {
+            if (std::optional<RangeResults<TrackId>> trackIds{ sampleRandomTrackIds(session, params) })
+            {
+                for (const Track::pointer& track : utils::fetchObjects<Track>(*session.getDboSession(), std::span<const TrackId>{ trackIds->results }))
+                    func(track);
+                return;
+            }
+        }
+
         auto query{ createQuery<Wt::Dbo::ptr<Track>>(session, params) };
-        utils::forEachQueryRangeResult(query, params.range, func);
+        utils::forEachQueryRangeResult(query, params.range, params.cursor, func);
     }
 
     void Track::find(Session& session, const FindParameters& params, bool& moreResults, const std::function<void(const Track::pointer&)>& func)
@@ -335,7 +423,20 @@ namespace lms::db
         session.checkReadTransaction();
 
         auto query{ createQuery<Wt::Dbo::ptr<Track>>(session, params) };
-        utils::forEachQueryRangeResult(query, params.range, moreResults, func);
+        utils::forEachQueryRangeResult(query, params.range, params.cursor, moreResults, func);
+    }
+
+    std::optional<KeysetCursor> Track::getKeysetCursor(TrackSortMethod sortMethod) const
+    {
+        switch (sortMethod)
+        {
+        case TrackSortMethod::Id:
+            return KeysetCursor{ {}, getId().getValue() };
+        case TrackSortMethod::Name:
+            return KeysetCursor{ _name, getId().getValue() };
+        default:
+            return std::nullopt;
+        }
     }
 
     RangeResults<TrackId> Track::findSimilarTrackIds(Session& session, const std::vector<TrackId>& tracks, std::optional<Range> range)
@@ -72,5 +72,10 @@ namespace lms::db
             .where("id = ?").bind(id));
     }
 
+    TrackId TrackBookmark::getTrackId() const
+    {
+        return _track.id();
+    }
+
 } // namespace lms::db
 
@@ -341,4 +341,9 @@ namespace lms::db
 
         return utils::fetchQuerySingleResult(session.getDboSession()->find<TrackListEntry>().where("id = ?").bind(id));
     }
+
+    TrackId TrackListEntry::getTrackId() const
+    {
+        return _track.id();
+    }
 } // namespace lms::db
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/TrackSummary.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+
+#include <Wt/Dbo/WtSqlTraits.h>
+
+#include "database/Session.hpp"
+
+#include "IdTypeTraits.hpp"
+#include "PathTraits.hpp"
+#include "Utils.hpp"
+
+namespace lms::db
+{
+    namespace
+    {
+        // keep the number of bound parameters well below SQLite limits
+        constexpr std::size_t maxBatchSize{ 256 };
+
+        using TrackResultType = std::tuple<TrackId, std::string, std::optional<int>, std::optional<int>, std::optional<int>,
+            std::chrono::duration<int, std::milli>, int, int, int, int,
+            std::filesystem::path, std::filesystem::path, long long, Wt::WDateTime, bool, std::string,
+            std::optional<float>, std::optional<float>, std::string,
+            ReleaseId, std::string, std::string, std::string>;
+
+        using ArtistResultType = std::tuple<TrackId, ArtistId, std::string, std::string, TrackArtistLinkType, std::string>;
+        using ClusterResultType = std::tuple<TrackId, ClusterId, std::string, std::string>;
+
+        using TrackSummaryMap = std::unordered_map<TrackId, TrackSummary>;
+
+        std::optional<std::size_t> toOptionalSize(std::optional<int> value)
+        {
+            if (!value)
+                return std::nullopt;
+
+            return static_cast<std::size_t>(*value);
+        }
+
+        void fetchTracks(Session& session, std::span<const TrackId::ValueType> ids, TrackSummaryMap& summaries)
+        {
+            auto query{ session.getDboSession()->query<TrackResultType>(
+                "SELECT t.id, t.name, t.track_number, t.disc_number, t.year,"
+                " t.duration, t.bitrate, t.bits_per_sample, t.channel_count, t.sample_rate,"
+                " t.absolute_file_path, t.relative_file_path, t.file_size, t.file_last_write, t.has_cover, t.recording_mbid,"
+                " t.track_replay_gain, t.release_replay_gain, t.artist_display_name,"
+                " r.id, COALESCE(r.name, ''), COALESCE(r.mbid, ''), COALESCE(r.artist_display_name, '')"
+                " FROM track t"
+                " LEFT JOIN release r ON r.id = t.release_id") };
+            utils::applyIdsFilter(query, "t.id", ids);
+
+            utils::forEachQueryResult(query, [&](TrackResultType&& res) {
+                TrackSummary summary;
+                summary.id = std::get<0>(res);
+                summary.name = std::move(std::get<1>(res));
+                summary.trackNumber = toOptionalSize(std::get<2>(res));
+                summary.discNumber = toOptionalSize(std::get<3>(res));
+                summary.year = std::get<4>(res);
+                summary.duration = std::get<5>(res);
+                summary.bitrate = static_cast<std::size_t>(std::get<6>(res));
+                summary.bitsPerSample = static_cast<std::size_t>(std::get<7>(res));
+                summary.channelCount = static_cast<std::size_t>(std::get<8>(res));
+                summary.sampleRate = static_cast<std::size_t>(std::get<9>(res));
+                summary.absoluteFilePath = std::move(std::get<10>(res));
+                summary.relativeFilePath = std::move(std::get<11>(res));
+                summary.fileSize = std::get<12>(res);
+                summary.lastWritten = std::get<13>(res);
+                summary.hasCover = std::get<14>(res);
+                summary.recordingMBID = core::UUID::fromString(std::get<15>(res));
+                summary.trackReplayGain = std::get<16>(res);
+                summary.releaseReplayGain = std::get<17>(res);
+                summary.artistDisplayName = std::move(std::get<18>(res));
+                summary.releaseId = std::get<19>(res);
+                summary.releaseName = std::move(std::get<20>(res));
+                summary.releaseMBID = core::UUID::fromString(std::get<21>(res));
+                summary.releaseArtistDisplayName = std::move(std::get<22>(res));
+
+                const TrackId trackId{ summary.id };
+                summaries.emplace(trackId, std::move(summary));
+            });
+        }
+
+        void fetchArtists(Session& session, std::span<const TrackId::ValueType> ids, TrackSummaryMap& summaries)
+        {
+            auto query{ session.getDboSession()->query<ArtistResultType>(
+                "SELECT t_a_l.track_id, a.id, a.name, a.mbid, t_a_l.type, t_a_l.subtype"
+                " FROM track_artist_link t_a_l"
+                " INNER JOIN artist a ON a.id = t_a_l.artist_id") };
+            utils::applyIdsFilter(query, "t_a_l.track_id", ids);
+            query.orderBy("t_a_l.id");
+
+            utils::forEachQueryResult(query, [&](ArtistResultType&& res) {
+                auto itSummary{ summaries.find(std::get<0>(res)) };
+                if (itSummary == std::cend(summaries))
+                    return;
+
+                itSummary->second.artists.emplace_back(TrackSummary::Artist{
+                    std::get<1>(res),
+                    std::move(std::get<2>(res)),
+                    core::UUID::fromString(std::get<3>(res)),
+                    std::get<4>(res),
+                    std::move(std::get<5>(res)) });
+            });
+        }
+
+        void fetchClusters(Session& session, std::span<const TrackId::ValueType> ids, TrackSummaryMap& summaries)
+        {
+            auto query{ session.getDboSession()->query<ClusterResultType>(
+                "SELECT t_c.track_id, c.id, c_t.name, c.name"
+                " FROM track_cluster t_c"
+                " INNER JOIN cluster c ON c.id = t_c.cluster_id"
+                " INNER JOIN cluster_type c_t ON c_t.id = c.cluster_type_id") };
+            utils::applyIdsFilter(query, "t_c.track_id", ids);
+            query.orderBy("c.id");
+
+            utils::forEachQueryResult(query, [&](ClusterResultType&& res) {
+                auto itSummary{ summaries.find(std::get<0>(res)) };
+                if (itSummary == std::cend(summaries))
+                    return;
+
+                itSummary->second.clusters.emplace_back(TrackSummary::Cluster{
+                    std::get<1>(res),
+                    std::move(std::get<2>(res)),
+                    std::move(std::get<3>(res)) });
+            });
+        }
+    }
+
+    std::vector<const TrackSummary::Artist*> TrackSummary::getArtists(TrackArtistLinkType linkType) const
+    {
+        std::vector<const Artist*> res;
+        for (const Artist& artist : artists)
+        {
+            if (artist.linkType == linkType)
+                res.push_back(&artist);
+        }
+
+        return res;
+    }
+
+    std::vector<ArtistId> TrackSummary::getArtistIds(TrackArtistLinkType linkType) const
+    {
+        std::vector<ArtistId> res;
+        for (const Artist& artist : artists)
+        {
+            if (artist.linkType == linkType && std::find(std::cbegin(res), std::cend(res), artist.id) == std::cend(res))
+                res.push_back(artist.id);
+        }
+
+        return res;
+    }
+
+    std::vector<std::string_view> TrackSummary::getClusterNames(std::string_view clusterTypeName) const
+    {
+        std::vector<std::string_view> res;
+        for (const Cluster& cluster : clusters)
+        {
+            if (cluster.typeName == clusterTypeName)
+                res.push_back(cluster.name);
+        }
+
+        return res;
+    }
+
+    std::vector<TrackSummary> TrackSummary::find(Session& session, std::span<const TrackId> trackIds)
+    {
+        session.checkReadTransaction();
+
+        std::vector<TrackSummary> res;
+        if (trackIds.empty())
+            return res;
+
+        LMS_SCOPED_TRACE_OVERVIEW("Database", "FindTrackSummaries");
+
+        TrackSummaryMap summaries;
+        std::vector<TrackId::ValueType> ids;
+        for (std::size_t offset{}; offset < trackIds.size(); offset += maxBatchSize)
+        {
+            const std::span<const TrackId> batch{ trackIds.subspan(offset, std::min(maxBatchSize, trackIds.size() - offset)) };
+
+            ids.clear();
+            std::transform(std::cbegin(batch), std::cend(batch), std::back_inserter(ids), [](TrackId trackId) { return trackId.getValue(); });
+
+            fetchTracks(session, ids, summaries);
+            fetchArtists(session, ids, summaries);
+            fetchClusters(session, ids, summaries);
+        }
+
+        res.reserve(summaries.size());
+        for (const TrackId trackId : trackIds)
+        {
+            auto itSummary{ summaries.find(trackId) };
+            if (itSummary != std::cend(summaries))
+                res.push_back(itSummary->second); // copy: the same track may be requested several times
+        }
+
+        return res;
+    }
+}
@@ -19,6 +19,9 @@
 
 #include "Utils.hpp"
 
+#include <algorithm>
+
+#include "database/Session.hpp"
 #include "core/String.hpp"
 
 namespace lms::db::utils
@@ -28,10 +31,46 @@ namespace lms::db::utils
         return core::stringUtils::escapeString(keyword, "%_", escapeChar);
     }
 
+    bool canUseFullTextSearch(Session& session, std::span<const std::string_view> keywords)
+    {
+        if (keywords.empty() || !session.isFullTextSearchAvailable())
+            return false;
+
+        // The trigram tokenizer cannot match less than 3 characters
+        return std::all_of(std::cbegin(keywords), std::cend(keywords), [](std::string_view keyword)
+            {
+                const auto characterCount{ std::count_if(std::cbegin(keyword), std::cend(keyword), [](char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; }) };
+                return characterCount >= 3;
+            });
+    }
+
+    std::string buildFullTextSearchMatch(std::span<const std::string_view> keywords, std::string_view column)
+    {
+        // Each keyword is a quoted string: no FTS5 operator in it is interpreted
+        std::vector<std::string> phrases;
+        for (const std::string_view keyword : keywords)
+            phrases.push_back("\"" + core::stringUtils::escapeString(keyword, "\"", '"') + "\"");
+
+        return std::string{ column } + " : (" + core::stringUtils::joinStrings(phrases, " AND ") + ")";
+    }
+
+    IdType::ValueType getMaxId(Session& session, std::string_view table)
+    {
+        return fetchQuerySingleResult(session.getDboSession()->query<IdType::ValueType>("SELECT COALESCE(MAX(id), 0) FROM " + std::string{ table }));
+    }
+
     Wt::WDateTime normalizeDateTime(const Wt::WDateTime& dateTime)
     {
         // force second resolution
         return Wt::WDateTime::fromTime_t(dateTime.toTime_t());
     }
+
+    std::size_t deleteIdsFromQuery(Session& session, std::string_view table, std::string_view idsQuery, std::size_t maxCount)
+    {
+        session.checkWriteTransaction();
+
+        session.getDboSession()->execute("DELETE FROM " + std::string{ table } + " WHERE id IN (" + std::string{ idsQuery } + " LIMIT ?)").bind(static_cast<long long>(maxCount));
+        return fetchQuerySingleResult(session.getDboSession()->query<long long>("SELECT changes()"));
+    }
 } // namespace lms::db::Utils
 
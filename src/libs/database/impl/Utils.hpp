@@ -19,15 +19,30 @@
 
 #pragma once
 
+#include <algorithm>
+#include <filesystem>
 #include <functional>
+#include <optional>
+#include <random>
+#include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <Wt/Dbo/Dbo.h>
 #include <Wt/WDateTime.h>
 
 #include "database/Types.hpp"
 #include "core/ITraceLogger.hpp"
+#include "QueryStats.hpp"
+#include "core/Random.hpp"
+
+namespace lms::db
+{
+    class Session;
+}
 
 namespace lms::db::utils
 {
@@ -35,6 +50,31 @@ namespace lms::db::utils
     static inline constexpr char escapeChar{ '\\' };
     std::string escapeLikeKeyword(std::string_view keywords);
 
+    // Full text search tables can only be used if available and if all the keywords are long enough
+    bool canUseFullTextSearch(Session& session, std::span<const std::string_view> keywords);
+    // Expression to be bound to a MATCH operator, matches if the column contains all the keywords
+    std::string buildFullTextSearchMatch(std::span<const std::string_view> keywords, std::string_view column);
+
+    // Deletes at most maxCount rows of the table, whose ids are selected by the given query, in a single statement
+    // Returns the number of deleted rows (not including the ones deleted by cascade)
+    std::size_t deleteIdsFromQuery(Session& session, std::string_view table, std::string_view idsQuery, std::size_t maxCount);
+
+    // Selects the paths contained in the directory, using a range rather than LIKE so that the index on the column can be used
+    // If not recursive, only the paths directly contained in the directory are selected
+    template <typename Query>
+    void applyDirectoryFilter(Query& query, std::string_view column, const std::filesystem::path& directory, bool recursive)
+    {
+        const std::string lowerBound{ (directory / "").string() }; // always ends with a separator
+        std::string upperBound{ lowerBound };
+        upperBound.back() = '/' + 1;
+
+        query.where(std::string{ column } + " >= ?").bind(lowerBound);
+        query.where(std::string{ column } + " < ?").bind(upperBound);
+        // compared as blobs to count bytes rather than characters
+        if (!recursive)
+            query.where("INSTR(SUBSTR(CAST(" + std::string{ column } + " AS BLOB), ?), CAST('/' AS BLOB)) = 0").bind(static_cast<int>(lowerBound.size()) + 1);
+    }
+
     template <typename Query>
     void applyRange(Query& query, std::optional<Range> range)
     {
@@ -83,6 +123,7 @@ namespace lms::db::utils
     void forEachQueryResult(const Query& query, UnaryFunc&& func)
     {
         LMS_SCOPED_TRACE_DETAILED_WITH_ARG("Database", "ForEachQueryResult", "Query", query.asString());
+        const ScopedQueryStats queryStats{ query };
         forEachResult(query.resultList(), std::forward<UnaryFunc>(func));
     }
 
@@ -90,6 +131,7 @@ namespace lms::db::utils
     std::vector<T> fetchQueryResults(const Query& query)
     {
         LMS_SCOPED_TRACE_DETAILED_WITH_ARG("Database", "FetchQueryResults", "Query", query.asString());
+        const ScopedQueryStats queryStats{ query };
 
         auto collection{ query.resultList() };
         return std::vector<T>(collection.begin(), collection.end());
@@ -99,6 +141,7 @@ namespace lms::db::utils
     std::vector<typename QueryResultType<Query>::type> fetchQueryResults(const Query& query)
     {
         LMS_SCOPED_TRACE_DETAILED_WITH_ARG("Database", "FetchQueryResults", "Query", query.asString());
+        const ScopedQueryStats queryStats{ query };
 
         auto collection{ query.resultList() };
         return std::vector<typename QueryResultType<Query>::type>(collection.begin(), collection.end());
@@ -108,6 +151,7 @@ namespace lms::db::utils
     auto fetchQuerySingleResult(const Query& query)
     {
         LMS_SCOPED_TRACE_DETAILED_WITH_ARG("Database", "FetchQuerySingleResult", "Query", query.asString());
+        const ScopedQueryStats queryStats{ query };
         return query.resultValue();
     }
 
@@ -146,6 +190,38 @@ namespace lms::db::utils
         forEachQueryResult(query, std::forward<UnaryFunc>(func));
     }
 
+    // Keyset pagination, the query must be ordered by (sortExpression, idColumn)
+    // An empty sortExpression means the query is ordered by idColumn only
+    template <typename Query>
+    void applyKeysetCursor(Query& query, std::string_view sortExpression, std::string_view idColumn, const KeysetCursor& cursor)
+    {
+        if (sortExpression.empty())
+            query.where(std::string{ idColumn } + " > ?").bind(cursor.id);
+        else
+            query.where("(" + std::string{ sortExpression } + ", " + std::string{ idColumn } + ") > (?, ?)").bind(cursor.sortKey).bind(cursor.id);
+    }
+
+    // When a cursor is set, results start right after it: the range offset is only reported back
+    template <typename ResultType, typename Query>
+    RangeResults<ResultType> execRangeQuery(Query& query, std::optional<Range> range, const std::optional<KeysetCursor>& cursor)
+    {
+        if (!cursor || !range)
+            return execRangeQuery<ResultType>(query, range);
+
+        RangeResults<ResultType> res{ execRangeQuery<ResultType>(query, Range{ 0, range->size }) };
+        res.range.offset = range->offset;
+        return res;
+    }
+
+    template <typename Query, typename UnaryFunc>
+    void forEachQueryRangeResult(Query& query, std::optional<Range> range, const std::optional<KeysetCursor>& cursor, UnaryFunc&& func)
+    {
+        if (cursor && range)
+            range->offset = 0;
+
+        forEachQueryRangeResult(query, range, std::forward<UnaryFunc>(func));
+    }
+
     template <typename Query, typename UnaryFunc>
     void forEachQueryRangeResult(Query& query, std::optional<Range> range, bool& moreResults, UnaryFunc&& func)
     {
@@ -172,5 +248,135 @@ namespace lms::db::utils
         }
     }
 
+    template <typename Query, typename UnaryFunc>
+    void forEachQueryRangeResult(Query& query, std::optional<Range> range, const std::optional<KeysetCursor>& cursor, bool& moreResults, UnaryFunc&& func)
+    {
+        if (cursor && range)
+            range->offset = 0;
+
+        forEachQueryRangeResult(query, range, moreResults, std::forward<UnaryFunc>(func));
+    }
+
+    template <typename Query>
+    void applyIdsFilter(Query& query, std::string_view idColumn, std::span<const IdType::ValueType> ids)
+    {
+        assert(!ids.empty());
+
+        std::string clause{ std::string{ idColumn } + " IN (?" };
+        for (std::size_t i{ 1 }; i < ids.size(); ++i)
+            clause += ", ?";
+        clause += ")";
+
+        query.where(clause);
+        for (const IdType::ValueType id : ids)
+            query.bind(id);
+    }
+
+    // keep well below the bound parameter limit
+    inline constexpr std::size_t maxIdsFilterSize{ 256 };
+
+    // Fetches the objects using a query per batch of ids, in the order of the given ids (missing objects are skipped)
+    template <typename ObjectType, typename ObjectIdType>
+    std::vector<Wt::Dbo::ptr<ObjectType>> fetchObjects(Wt::Dbo::Session& session, std::span<const ObjectIdType> ids)
+    {
+        std::unordered_map<IdType::ValueType, Wt::Dbo::ptr<ObjectType>> objects;
+        std::vector<IdType::ValueType> batchIds;
+        for (std::size_t offset{}; offset < ids.size(); offset += maxIdsFilterSize)
+        {
+            batchIds.clear();
+            for (const ObjectIdType id : ids.subspan(offset, std::min(maxIdsFilterSize, ids.size() - offset)))
+                batchIds.push_back(id.getValue());
+
+            auto query{ session.find<ObjectType>() };
+            applyIdsFilter(query, "id", batchIds);
+            for (const Wt::Dbo::ptr<ObjectType>& object : fetchQueryResults<Wt::Dbo::ptr<ObjectType>>(query))
+                objects.emplace(object.id(), object);
+        }
+
+        std::vector<Wt::Dbo::ptr<ObjectType>> res;
+        res.reserve(objects.size());
+        for (const ObjectIdType id : ids)
+        {
+            if (auto it{ objects.find(id.getValue()) }; it != std::cend(objects))
+                res.push_back(it->second);
+        }
+
+        return res;
+    }
+
+    IdType::ValueType getMaxId(Session& session, std::string_view table);
+
+    // Random sampling, to avoid having the database sort the whole filtered set using RANDOM():
+    // random positions in [1, maxId] are probed by batches, findMatchingIds returns the candidates that pass the filters
+    // Returns std::nullopt if matching entries are too sparse to be sampled this way: callers should fall back on sorting by RANDOM()
+    template <typename ObjectIdType, typename FindMatchingIdsFunc>
+    std::optional<std::vector<ObjectIdType>> sampleRandomIds(IdType::ValueType maxId, std::size_t count, FindMatchingIdsFunc&& findMatchingIds)
+    {
+        std::vector<ObjectIdType> res;
+        if (count == 0 || maxId <= 0)
+            return res;
+
+        // small tables are cheap to sort, and would require probing most of the ids anyway
+        if (static_cast<std::size_t>(maxId) < count * 4)
+            return std::nullopt;
+
+        // Give up if less than ~1/16 of the id space matches the filters
+        const std::size_t maxProbeCount{ std::min(static_cast<std::size_t>(maxId) / 2, count * 16 + 64) };
+
+        res.reserve(count);
+
+        std::uniform_int_distribution<IdType::ValueType> distribution{ 1, maxId };
+        std::unordered_set<IdType::ValueType> probedIds;
+        std::vector<IdType::ValueType> candidateIds;
+        while (res.size() < count && probedIds.size() < maxProbeCount)
+        {
+            const std::size_t batchSize{ std::min({ (count - res.size()) * 2, maxIdsFilterSize, maxProbeCount - probedIds.size() }) };
+
+            candidateIds.clear();
+            while (candidateIds.size() < batchSize)
+            {
+                const IdType::ValueType candidateId{ distribution(core::random::getRandGenerator()) };
+                if (probedIds.insert(candidateId).second)
+                    candidateIds.push_back(candidateId);
+            }
+
+            std::vector<ObjectIdType> matchingIds{ findMatchingIds(std::span<const IdType::ValueType>{ candidateIds }) };
+            core::random::shuffleContainer(matchingIds); // the database may return them sorted
+            for (const ObjectIdType id : matchingIds)
+            {
+                if (res.size() == count)
+                    break;
+
+                res.push_back(id);
+            }
+        }
+
+        if (res.size() < count)
+            return std::nullopt;
+
+        return res;
+    }
+
+    // Random sampling of a range of entries starting at offset 0, with moreResults set as execRangeQuery would do
+    template <typename ObjectIdType, typename FindMatchingIdsFunc>
+    std::optional<RangeResults<ObjectIdType>> sampleRandomRange(IdType::ValueType maxId, std::size_t size, FindMatchingIdsFunc&& findMatchingIds)
+    {
+        // one extra entry is sampled to tell whether more results are available
+        std::optional<std::vector<ObjectIdType>> ids{ sampleRandomIds<ObjectIdType>(maxId, size + 1, std::forward<FindMatchingIdsFunc>(findMatchingIds)) };
+        if (!ids)
+            return std::nullopt;
+
+        RangeResults<ObjectIdType> res;
+        if (ids->size() > size)
+        {
+            res.moreResults = true;
+            ids->pop_back();
+        }
+        res.range = Range{ 0, ids->size() };
+        res.results = std::move(*ids);
+
+        return res;
+    }
+
     Wt::WDateTime normalizeDateTime(const Wt::WDateTime& dateTime);
 }
\ No newline at end of file
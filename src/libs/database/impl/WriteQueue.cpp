@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/WriteQueue.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "database/Db.hpp"
+#include "database/Session.hpp"
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+
+namespace lms::db
+{
+    namespace
+    {
+        std::chrono::microseconds toMicroseconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        }
+    }
+
+    WriteQueue::WriteQueue(Db& db, std::size_t maxBatchSize)
+        : _db{ db }
+        , _maxBatchSize{ maxBatchSize }
+        , _thread{ [this] { run(); } }
+    {
+        assert(_maxBatchSize > 0);
+    }
+
+    WriteQueue::~WriteQueue()
+    {
+        {
+            std::scoped_lock lock{ _mutex };
+            _stop = true;
+        }
+        _requestCondVar.notify_all();
+        _thread.join();
+    }
+
+    void WriteQueue::submit(WriteRequest request)
+    {
+        {
+            std::scoped_lock lock{ _mutex };
+            _pendingRequests.push_back(PendingRequest{ std::move(request), clock::now() });
+            _submittedCount += 1;
+        }
+        _requestCondVar.notify_one();
+    }
+
+    void WriteQueue::flush()
+    {
+        assert(std::this_thread::get_id() != _thread.get_id());
+
+        std::unique_lock lock{ _mutex };
+        const std::size_t targetCount{ _submittedCount };
+        _flushCondVar.wait(lock, [&] { return _processedCount >= targetCount; });
+    }
+
+    WriteQueue::Stats WriteQueue::getStats() const
+    {
+        std::scoped_lock lock{ _mutex };
+        return _stats;
+    }
+
+    void WriteQueue::run()
+    {
+        if (auto* traceLogger{ core::Service<core::tracing::ITraceLogger>::get() })
+            traceLogger->setThreadName(std::this_thread::get_id(), "DbWriter");
+
+        std::deque<PendingRequest> batch;
+        while (true)
+        {
+            {
+                std::unique_lock lock{ _mutex };
+                _requestCondVar.wait(lock, [this] { return _stop || !_pendingRequests.empty(); });
+
+                // pending requests are still processed when stopping
+                if (_pendingRequests.empty())
+                    break;
+
+                const std::size_t batchSize{ std::min(_pendingRequests.size(), _maxBatchSize) };
+                std::move(std::begin(_pendingRequests), std::begin(_pendingRequests) + batchSize, std::back_inserter(batch));
+                _pendingRequests.erase(std::begin(_pendingRequests), std::begin(_pendingRequests) + batchSize);
+            }
+
+            processBatch(batch);
+            batch.clear();
+        }
+    }
+
+    void WriteQueue::processRequest(Session& session, const WriteRequest& request)
+    {
+        // Each request gets its own savepoint, so that a failing request does not leave partial writes in the batch
+        Wt::Dbo::Session& dboSession{ *session.getDboSession() };
+        dboSession.execute("SAVEPOINT write_request");
+
+        try
+        {
+            request(session);
+            dboSession.flush(); // the pending writes must be part of the savepoint
+            dboSession.execute("RELEASE SAVEPOINT write_request");
+        }
+        catch (const std::exception& e)
+        {
+            LMS_LOG(DB, ERROR, "Write request failed, rolling it back: " << e.what());
+
+            dboSession.discardUnflushed();
+            dboSession.execute("ROLLBACK TO SAVEPOINT write_request");
+            dboSession.execute("RELEASE SAVEPOINT write_request");
+            dboSession.rereadAll(); // cached objects may have been modified by the rolled back writes
+        }
+    }
+
+    void WriteQueue::processBatch(std::deque<PendingRequest>& batch)
+    {
+        LMS_SCOPED_TRACE_DETAILED("Database", "WriteBatch");
+
+        Session& session{ _db.getTLSSession() };
+
+        const clock::time_point batchStart{ clock::now() };
+        std::chrono::microseconds maxWaitDuration{};
+        std::chrono::microseconds totalWaitDuration{};
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            for (PendingRequest& pendingRequest : batch)
+            {
+                const std::chrono::microseconds waitDuration{ toMicroseconds(batchStart - pendingRequest.submitTime) };
+                totalWaitDuration += waitDuration;
+                maxWaitDuration = std::max(maxWaitDuration, waitDuration);
+
+                processRequest(session, pendingRequest.request);
+            }
+        }
+
+        const std::chrono::microseconds batchDuration{ toMicroseconds(clock::now() - batchStart) };
+        LMS_LOG(DB, DEBUG, "Committed " << batch.size() << " write request(s) in " << batchDuration.count() << " us, max wait = " << maxWaitDuration.count() << " us");
+
+        {
+            std::scoped_lock lock{ _mutex };
+
+            _processedCount += batch.size();
+
+            _stats.requestCount += batch.size();
+            _stats.batchCount += 1;
+            _stats.maxBatchSize = std::max(_stats.maxBatchSize, batch.size());
+            _stats.totalWaitDuration += totalWaitDuration;
+            _stats.maxWaitDuration = std::max(_stats.maxWaitDuration, maxWaitDuration);
+            _stats.totalBatchDuration += batchDuration;
+            _stats.maxBatchDuration = std::max(_stats.maxBatchDuration, batchDuration);
+        }
+        _flushCondVar.notify_all();
+    }
+}
@@ -61,6 +61,7 @@ namespace lms::db
             std::optional<TrackArtistLinkType>	linkType;	// if set, only artists that have produced at least one track with this link type
             ArtistSortMethod					sortMethod{ ArtistSortMethod::None };
             std::optional<Range>				range;
+            std::optional<KeysetCursor>			cursor;		// if set, results start right after this position (only for Id, Name and SortName sort methods)
             Wt::WDateTime						writtenAfter;
             UserId								starringUser;	// only artists starred by this user
             std::optional<FeedbackBackend>		feedbackBackend; // and for this feedback backend
@@ -73,6 +74,7 @@ namespace lms::db
             FindParameters& setLinkType(std::optional<TrackArtistLinkType> _linkType) { linkType = _linkType; return *this; }
             FindParameters& setSortMethod(ArtistSortMethod _sortMethod) { sortMethod = _sortMethod; return *this; }
             FindParameters& setRange(std::optional<Range> _range) { range = _range; return *this; }
+            FindParameters& setCursor(const std::optional<KeysetCursor>& _cursor) { cursor = _cursor; return *this; }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after) { writtenAfter = _after; return *this; }
             FindParameters& setStarringUser(UserId _user, FeedbackBackend _feedbackBackend) { starringUser = _user; feedbackBackend = _feedbackBackend; return *this; }
             FindParameters& setTrack(TrackId _track) { track = _track; return *this; }
@@ -92,11 +94,13 @@ namespace lms::db
         static void					    find(Session& session, const FindParameters& parameters, std::function<void(const pointer&)> func);
         static RangeResults<ArtistId>	findIds(Session& session, const FindParameters& parameters);
         static RangeResults<ArtistId>	findOrphanIds(Session& session, std::optional<Range> range = std::nullopt); // No track related
+        static std::size_t              removeOrphans(Session& session, std::size_t maxCount); // returns the number of removed artists
         static bool						exists(Session& session, ArtistId id);
 
         // Accessors
         const std::string& getName() const { return _name; }
         const std::string& getSortName() const { return _sortName; }
+        std::optional<KeysetCursor> getKeysetCursor(ArtistSortMethod sortMethod) const; // position right after this artist, if supported by the sort method
         std::optional<core::UUID>	getMBID() const { return core::UUID::fromString(_MBID); }
 
         // No artistLinkTypes means get them all
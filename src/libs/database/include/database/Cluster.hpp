@@ -20,6 +20,7 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -68,11 +69,22 @@ namespace lms::db
         static RangeResults<pointer>            find(Session& session, const FindParameters& params);
         static void                             find(Session& session, const FindParameters& params, std::function<void(const pointer& cluster)> _func);
         static pointer                          find(Session& session, ClusterId id);
+        static pointer                          find(Session& session, ClusterTypeId clusterTypeId, std::string_view name);
         static RangeResults<ClusterId>          findOrphanIds(Session& session, std::optional<Range> range = std::nullopt);
+        static std::size_t                      removeOrphans(Session& session, std::size_t maxCount); // returns the number of removed clusters
 
         // May be very slow
         static std::size_t                      computeTrackCount(Session& session, ClusterId id);
         static std::size_t                      computeReleaseCount(Session& session, ClusterId id);
+        struct Counts
+        {
+            ClusterId id;
+            std::size_t trackCount{};
+            std::size_t releaseCount{};
+        };
+        // Computes the track and release counts of all the clusters in a single pass, only returns the clusters whose stored counts are outdated
+        static std::vector<Counts>              findOutdatedCounts(Session& session);
+        static void                             updateCounts(Session& session, std::span<const Counts> counts);
 
         // Accessors
         std::string_view                getName() const { return _name; }
@@ -125,6 +137,7 @@ namespace lms::db
         static pointer 						find(Session& session, std::string_view name);
         static pointer						find(Session& session, ClusterTypeId id);
         static RangeResults<ClusterTypeId>	findOrphanIds(Session& session, std::optional<Range> range = std::nullopt);
+        static std::size_t                  removeOrphans(Session& session, std::size_t maxCount); // returns the number of removed cluster types
         static RangeResults<ClusterTypeId>	findUsed(Session& session, std::optional<Range> range = std::nullopt);
 
         static void remove(Session& session, const std::string& name);
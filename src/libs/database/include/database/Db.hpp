@@ -19,11 +19,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 
 #include <Wt/Dbo/SqlConnectionPool.h>
 
-#include "core/RecursiveSharedMutex.hpp"
+#include "database/ReferenceData.hpp"
+#include "database/WriteQueue.hpp"
 
 namespace lms::db
 {
@@ -31,20 +35,42 @@ namespace lms::db
     class Db
     {
     public:
-        Db(const std::filesystem::path& dbPath, std::size_t connectionCount = 10);
+        // Default values can be overridden using the config file
+        struct ConnectionSettings
+        {
+            std::size_t mmapSizeMBytes{ 256 };
+            std::size_t readCacheSizeMBytes{ 64 };          // page cache budget, shared by all the read connections
+            bool readTempStoreInMemory{ true };             // temporary tables and indices used by read queries
+            std::size_t maxCachedStatementCount{ 512 };     // per connection
+            bool showQueries{};
+            bool queryStats{};                              // see Session::refreshTracingLoggerStats
+
+            static ConnectionSettings fromConfig();
+        };
+
+        // Read connections are used by read transactions, write transactions use a small dedicated pool
+        Db(const std::filesystem::path& dbPath, std::size_t readConnectionCount = 10, const ConnectionSettings& settings = ConnectionSettings::fromConfig());
 
         Session& getTLSSession();
 
         void executeSql(const std::string& sql);
 
+        // Preferred way to perform small writes that do not need to be waited for
+        WriteQueue& getWriteQueue() { return *_writeQueue; }
+
+        ReferenceDataCache& getReferenceDataCache() { return _referenceDataCache; }
+
     private:
         Db(const Db&) = delete;
         Db& operator=(const Db&) = delete;
 
         friend class Session;
 
-        core::RecursiveSharedMutex& getMutex() { return _sharedMutex; }
-        Wt::Dbo::SqlConnectionPool& getConnectionPool() { return *_connectionPool; }
+        // Only taken by writers, readers rely on WAL mode
+        std::recursive_mutex& getWriteMutex() { return _writeMutex; }
+        Wt::Dbo::SqlConnectionPool& getConnectionPool() { return *_connectionPool; } // dispatches to read or write connections
+        Wt::Dbo::SqlConnectionPool& getReadConnectionPool() { return *_readConnectionPool; }
+        Wt::Dbo::SqlConnectionPool& getWriteConnectionPool() { return *_writeConnectionPool; }
 
         class ScopedConnection
         {
@@ -62,11 +88,18 @@ namespace lms::db
             std::unique_ptr<Wt::Dbo::SqlConnection> _connection;
         };
 
-        core::RecursiveSharedMutex _sharedMutex;
-        std::unique_ptr<Wt::Dbo::SqlConnectionPool>	_connectionPool;
+        std::recursive_mutex _writeMutex;
+        std::unique_ptr<Wt::Dbo::SqlConnectionPool> _readConnectionPool;
+        std::unique_ptr<Wt::Dbo::SqlConnectionPool> _writeConnectionPool;
+        std::unique_ptr<Wt::Dbo::SqlConnectionPool> _connectionPool;
+
+        std::atomic<bool> _fullTextSearchAvailable{}; // set once the full text search tables are ready
+        ReferenceDataCache _referenceDataCache;
 
         std::mutex _tlsSessionsMutex;
         std::vector<std::unique_ptr<Session>> _tlsSessions;
+
+        std::unique_ptr<WriteQueue> _writeQueue; // last: its thread uses the members above
     };
 
 }
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <Wt/Dbo/Dbo.h>
+#include <Wt/WDateTime.h>
+
+#include "database/DirectoryId.hpp"
+#include "database/Object.hpp"
+
+namespace lms::db
+{
+    class Session;
+
+    // Directory found in the media libraries, as seen by the last scan
+    class Directory final : public Object<Directory, DirectoryId>
+    {
+    public:
+        Directory() = default;
+
+        // find
+        static std::size_t getCount(Session& session);
+        static pointer find(Session& session, DirectoryId id);
+        static pointer find(Session& session, const std::filesystem::path& p);
+        static std::vector<pointer> findRootDirectories(Session& session);
+        static std::vector<pointer> findChildren(Session& session, DirectoryId parentId);
+
+        // getters
+        const std::filesystem::path& getAbsolutePath() const { return _absolutePath; }
+        const Wt::WDateTime& getLastWriteTime() const { return _lastWriteTime; }
+        std::size_t getFileCount() const { return _fileCount; } // audio files directly in this directory
+        ObjectPtr<Directory> getParent() const { return _parent; }
+
+        // setters
+        void setLastWriteTime(const Wt::WDateTime& time) { _lastWriteTime = time; }
+        void setFileCount(std::size_t fileCount) { _fileCount = static_cast<int>(fileCount); }
+
+        template<class Action>
+        void persist(Action& a)
+        {
+            Wt::Dbo::field(a, _absolutePath, "absolute_path");
+            Wt::Dbo::field(a, _lastWriteTime, "last_write_time");
+            Wt::Dbo::field(a, _fileCount, "file_count");
+            Wt::Dbo::belongsTo(a, _parent, "parent_directory", Wt::Dbo::OnDeleteCascade);
+        }
+
+    private:
+        friend class Session;
+        Directory(const std::filesystem::path& p, ObjectPtr<Directory> parent);
+        static pointer create(Session& session, const std::filesystem::path& p, ObjectPtr<Directory> parent = {});
+
+        std::filesystem::path   _absolutePath;
+        Wt::WDateTime           _lastWriteTime;
+        int                     _fileCount{};
+        Wt::Dbo::ptr<Directory> _parent;
+    };
+} // namespace lms::db
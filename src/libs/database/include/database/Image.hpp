@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Wt/Dbo/Dbo.h>
+#include <Wt/WDateTime.h>
+
+#include "database/ImageId.hpp"
+#include "database/Object.hpp"
+
+namespace lms::db
+{
+    class Session;
+
+    // Image file found in the media libraries (cover art, artist pictures, ...)
+    class Image final : public Object<Image, ImageId>
+    {
+    public:
+        Image() = default;
+
+        // find
+        static std::size_t getCount(Session& session);
+        static pointer find(Session& session, ImageId id);
+        static pointer find(Session& session, const std::filesystem::path& p);
+        static void find(Session& session, ImageId& lastRetrievedImage, std::size_t count, const std::function<void(const Image::pointer&)>& func);
+        static std::vector<pointer> findByDirectory(Session& session, const std::filesystem::path& directory);
+        static void findInDirectory(Session& session, const std::filesystem::path& directory, bool recursive, ImageId& lastRetrievedImage, std::size_t count, const std::function<void(const Image::pointer&)>& func);
+
+        // getters
+        const std::filesystem::path& getAbsoluteFilePath() const { return _absoluteFilePath; }
+        const std::filesystem::path& getDirectory() const { return _directory; }
+        std::string_view getStem() const { return _stem; }
+        const Wt::WDateTime& getLastWriteTime() const { return _fileLastWrite; }
+        long long getFileSize() const { return _fileSize; }
+
+        // setters
+        void setLastWriteTime(const Wt::WDateTime& time) { _fileLastWrite = time; }
+        void setFileSize(long long fileSize) { _fileSize = fileSize; }
+
+        template<class Action>
+        void persist(Action& a)
+        {
+            Wt::Dbo::field(a, _absoluteFilePath, "absolute_file_path");
+            Wt::Dbo::field(a, _directory, "directory");
+            Wt::Dbo::field(a, _stem, "stem");
+            Wt::Dbo::field(a, _fileLastWrite, "file_last_write");
+            Wt::Dbo::field(a, _fileSize, "file_size");
+        }
+
+    private:
+        friend class Session;
+        Image(const std::filesystem::path& p);
+        static pointer create(Session& session, const std::filesystem::path& p);
+
+        std::filesystem::path   _absoluteFilePath;
+        std::filesystem::path   _directory;
+        std::string             _stem;
+        Wt::WDateTime           _fileLastWrite;
+        long long               _fileSize{};
+    };
+} // namespace lms::db
@@ -105,6 +105,10 @@ namespace lms::db
         static pointer          getMostRecentListen(Session& session, UserId userId, ScrobblingBackend backend, ReleaseId releaseId);
         static pointer          getMostRecentListen(Session& session, UserId userId, ScrobblingBackend backend, TrackId releaseId);
 
+        // Stats are aggregated per user/backend in dedicated tables, kept up to date by the database when listens, tracks or artist links change
+        // Rebuilding them from scratch is only needed to recover from inconsistencies
+        static void             rebuildStats(Session& session);
+
         SyncState               getSyncState() const { return _syncState; }
         ObjectPtr<User>         getUser() const { return _user; }
         ObjectPtr<Track>        getTrack() const { return _track; }
@@ -125,6 +129,8 @@ namespace lms::db
 
     private:
         friend class Session;
+        static void createStatsTablesIfNeeded(Session& session);
+
         Listen(ObjectPtr<User> user, ObjectPtr<Track> track, ScrobblingBackend backend, const Wt::WDateTime& dateTime);
         static pointer create(Session& session, ObjectPtr<User> user, ObjectPtr<Track> track, ScrobblingBackend backend, const Wt::WDateTime& dateTime);
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "database/ClusterId.hpp"
+#include "database/MediaLibraryId.hpp"
+#include "database/ReleaseTypeId.hpp"
+
+namespace lms::db
+{
+    class Session;
+
+    // Immutable snapshot of small and rarely changing tables
+    struct ReferenceData
+    {
+        struct ClusterTypeInfo
+        {
+            ClusterTypeId id;
+            std::string name;
+        };
+
+        struct ReleaseTypeInfo
+        {
+            ReleaseTypeId id;
+            std::string name;
+        };
+
+        struct MediaLibraryInfo
+        {
+            MediaLibraryId id;
+            std::string name;
+            std::filesystem::path path;
+        };
+
+        std::size_t version{}; // incremented on each rebuild
+        std::vector<ClusterTypeInfo> clusterTypes;      // ordered by name
+        std::vector<ReleaseTypeInfo> releaseTypes;      // ordered by name
+        std::vector<MediaLibraryInfo> mediaLibraries;   // ordered by id
+        std::size_t libraryGeneration{};                // see ScanSettings::getLibraryGeneration
+
+        const ClusterTypeInfo* findClusterType(std::string_view name) const;
+        const ClusterTypeInfo* findClusterType(ClusterTypeId id) const;
+        std::vector<ClusterTypeId> getClusterTypeIds() const;
+    };
+
+    // Process-wide cache of the reference data, readers only lock to copy the snapshot pointer and never wait for a rebuild
+    class ReferenceDataCache
+    {
+    public:
+        ReferenceDataCache() = default;
+
+        // Builds the snapshot on first use, acquires its own read transaction to do so
+        std::shared_ptr<const ReferenceData> get(Session& session);
+
+        // To be called once changes on the underlying tables are committed (scan, settings update, etc.)
+        // Acquires its own read transaction
+        void refresh(Session& session);
+
+    private:
+        ReferenceDataCache(const ReferenceDataCache&) = delete;
+        ReferenceDataCache& operator=(const ReferenceDataCache&) = delete;
+
+        std::shared_ptr<const ReferenceData> build(Session& session);
+
+        std::mutex _buildMutex;
+        std::size_t _lastVersion{}; // protected by _buildMutex
+
+        std::shared_ptr<const ReferenceData> getSnapshot() const;
+        void setSnapshot(std::shared_ptr<const ReferenceData> snapshot);
+
+        mutable std::mutex _snapshotMutex;
+        std::shared_ptr<const ReferenceData> _snapshot; // protected by _snapshotMutex
+    };
+}
@@ -87,7 +87,9 @@ namespace lms::db
             std::vector<std::string_view>       keywords; // if non empty, name must match all of these keywords
             ReleaseSortMethod                   sortMethod{ ReleaseSortMethod::None };
             std::optional<Range>                range;
+            std::optional<KeysetCursor>         cursor; // if set, results start right after this position (only for Id and Name sort methods)
             Wt::WDateTime                       writtenAfter;
+            Wt::WDateTime                       scannedAfter;   // if set, releases that have tracks added or updated by the scanner since then
             std::optional<DateRange>            dateRange;
             UserId                              starringUser;				// only releases starred by this user
             std::optional<FeedbackBackend>      feedbackBackend;		    //    and for this backend
@@ -101,7 +103,9 @@ namespace lms::db
             FindParameters& setKeywords(const std::vector<std::string_view>& _keywords) { keywords = _keywords; return *this; }
             FindParameters& setSortMethod(ReleaseSortMethod _sortMethod) { sortMethod = _sortMethod; return *this; }
             FindParameters& setRange(std::optional<Range> _range) { range = _range; return *this; }
+            FindParameters& setCursor(const std::optional<KeysetCursor>& _cursor) { cursor = _cursor; return *this; }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after) { writtenAfter = _after; return *this; }
+            FindParameters& setScannedAfter(const Wt::WDateTime& _after) { scannedAfter = _after; return *this; }
             FindParameters& setDateRange(const std::optional<DateRange>& _dateRange) { dateRange = _dateRange; return *this; }
             FindParameters& setStarringUser(UserId _user, FeedbackBackend _feedbackBackend) { starringUser = _user; feedbackBackend = _feedbackBackend; return *this; }
             FindParameters& setArtist(ArtistId _artist, core::EnumSet<TrackArtistLinkType> _trackArtistLinkTypes = {}, core::EnumSet<TrackArtistLinkType> _excludedTrackArtistLinkTypes = {})
@@ -129,6 +133,7 @@ namespace lms::db
         static RangeResults<ReleaseId>  findIds(Session& session, const FindParameters& parameters);
         static std::size_t              getCount(Session& session, const FindParameters& parameters);
         static RangeResults<ReleaseId>  findOrphanIds(Session& session, std::optional<Range> range = std::nullopt); // not track related
+        static std::size_t              removeOrphans(Session& session, std::size_t maxCount); // returns the number of removed releases
 
         // Get the cluster of the tracks that belong to this release
         // Each clusters are grouped by cluster type, sorted by the number of occurence (max to min)
@@ -147,6 +152,7 @@ namespace lms::db
         // Accessors
         std::string_view                    getName() const { return _name; }
         std::string_view                    getSortName() const { return _sortName; }
+        std::optional<KeysetCursor>         getKeysetCursor(ReleaseSortMethod sortMethod) const; // position right after this release, if supported by the sort method
         std::optional<core::UUID>                 getMBID() const { return core::UUID::fromString(_MBID); }
         std::optional<core::UUID>                 getGroupMBID() const { return core::UUID::fromString(_groupMBID); }
         std::optional<std::size_t>          getTotalDisc() const { return _totalDisc; }
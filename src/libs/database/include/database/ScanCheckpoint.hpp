@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include <Wt/Dbo/Dbo.h>
+
+#include "database/IdType.hpp"
+#include "database/Object.hpp"
+
+LMS_DECLARE_IDTYPE(ScanCheckpointId)
+
+namespace lms::db
+{
+    class MediaLibrary;
+    class Session;
+
+    // Progress of the scan in progress, used to resume it if it gets interrupted
+    // At most one checkpoint, removed once the scan completes
+    class ScanCheckpoint final : public Object<ScanCheckpoint, ScanCheckpointId>
+    {
+    public:
+        ScanCheckpoint() = default;
+
+        static pointer get(Session& session); // null if no scan was interrupted
+        static pointer getOrCreate(Session& session);
+        static void clear(Session& session);
+
+        // getters
+        std::size_t getScanVersion() const { return _scanVersion; }
+        bool isFullScan() const { return _fullScan; }
+        int getStep() const { return _step; } // defined by the scanner
+        ObjectPtr<MediaLibrary> getMediaLibrary() const { return _mediaLibrary; } // media library whose files were being scanned
+        const std::filesystem::path& getLastProcessedPath() const { return _lastProcessedPath; }
+        std::string_view getStats() const { return _stats; } // serialized by the scanner
+
+        // setters
+        void setScanVersion(std::size_t scanVersion) { _scanVersion = static_cast<int>(scanVersion); }
+        void setFullScan(bool fullScan) { _fullScan = fullScan; }
+        void setStep(int step) { _step = step; }
+        void setMediaLibrary(ObjectPtr<MediaLibrary> mediaLibrary) { _mediaLibrary = getDboPtr(mediaLibrary); }
+        void setLastProcessedPath(const std::filesystem::path& path) { _lastProcessedPath = path; }
+        void setStats(std::string_view stats) { _stats = stats; }
+
+        template<class Action>
+        void persist(Action& a)
+        {
+            Wt::Dbo::field(a, _scanVersion, "scan_version");
+            Wt::Dbo::field(a, _fullScan, "full_scan");
+            Wt::Dbo::field(a, _step, "step");
+            Wt::Dbo::field(a, _lastProcessedPath, "last_processed_path");
+            Wt::Dbo::field(a, _stats, "stats");
+            Wt::Dbo::belongsTo(a, _mediaLibrary, "media_library", Wt::Dbo::OnDeleteSetNull);
+        }
+
+    private:
+        int                         _scanVersion{};
+        bool                        _fullScan{};
+        int                         _step{};
+        std::filesystem::path       _lastProcessedPath;
+        std::string                 _stats;
+        Wt::Dbo::ptr<MediaLibrary>  _mediaLibrary;
+    };
+} // namespace lms::db
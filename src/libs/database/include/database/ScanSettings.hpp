@@ -64,6 +64,7 @@ namespace lms::db
 
         // Getters
         std::size_t                         getScanVersion() const { return _scanVersion; }
+        std::size_t                         getLibraryGeneration() const { return _libraryGeneration; } // bumped each time a scan changes the library
         Wt::WTime                           getUpdateStartTime() const { return _startTime; }
         UpdatePeriod                        getUpdatePeriod() const { return _updatePeriod; }
         std::vector<std::string_view>       getExtraTagsToScan() const;
@@ -80,6 +81,7 @@ namespace lms::db
         void setArtistTagDelimiters(std::span<const std::string_view> delimiters);
         void setDefaultTagDelimiters(std::span<const std::string_view> delimiters);
         void incScanVersion();
+        void incLibraryGeneration();
 
         template<class Action>
         void persist(Action& a)
@@ -92,6 +94,7 @@ namespace lms::db
             Wt::Dbo::field(a, _extraTagsToScan, "extra_tags_to_scan");
             Wt::Dbo::field(a, _artistTagDelimiters, "artist_tag_delimiters");
             Wt::Dbo::field(a, _defaultTagDelimiters, "default_tag_delimiters");
+            Wt::Dbo::field(a, _libraryGeneration, "library_generation");
         }
 
     private:
@@ -103,5 +106,6 @@ namespace lms::db
         std::string             _extraTagsToScan;
         std::string             _artistTagDelimiters;
         std::string             _defaultTagDelimiters;
+        long long               _libraryGeneration{};
     };
 } // namespace lms::db
@@ -22,10 +22,11 @@
 #include <Wt/Dbo/Dbo.h>
 #include <Wt/Dbo/SqlConnectionPool.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "core/ITraceLogger.hpp"
-#include "core/RecursiveSharedMutex.hpp"
 #include "database/Object.hpp"
 #include "database/TransactionChecker.hpp"
 
@@ -36,14 +37,24 @@ namespace lms::db
     public:
         ~WriteTransaction();
 
+        // Connections taken while a write transaction is active in the current thread are write connections
+        static bool isActiveInCurrentThread();
+
     private:
         friend class Session;
-        WriteTransaction(core::RecursiveSharedMutex& mutex, Wt::Dbo::Session& session);
+        WriteTransaction(std::recursive_mutex& mutex, Wt::Dbo::Session& session);
 
         WriteTransaction(const WriteTransaction&) = delete;
         WriteTransaction& operator=(const WriteTransaction&) = delete;
 
-        const std::unique_lock<core::RecursiveSharedMutex> _lock;
+        struct ActiveScope
+        {
+            ActiveScope();
+            ~ActiveScope();
+        };
+
+        const std::unique_lock<std::recursive_mutex> _lock;
+        const ActiveScope _activeScope; // before actual transaction
         const core::tracing::ScopedTrace _trace{ "Database", core::tracing::Level::Detailed, "WriteTransaction" }; // before actual transaction
         Wt::Dbo::Transaction _transaction;
     };
@@ -65,6 +76,7 @@ namespace lms::db
     };
 
     class Db;
+    struct ReferenceData;
     class Session
     {
     public:
@@ -93,10 +105,15 @@ namespace lms::db
 
         void prepareTablesIfNeeded(); // need to run only once at startup
         bool migrateSchemaIfNeeded(); // returns true if migration was performed
-        void createIndexesIfNeeded();
+        void createIndexesIfNeeded(); // also creates the full text search and listen stats tables
         void vacuumIfNeeded();
         void vacuum();
-        void refreshTracingLoggerStats();
+        void refreshTracingLoggerStats(); // also exports the top queries, if query stats are enabled
+
+        bool isFullTextSearchAvailable() const;
+
+        // Cluster types, release types, media libraries and library generation, without any database access once cached
+        std::shared_ptr<const ReferenceData> getReferenceData();
 
         // returning a ptr here to ease further wrapping using operator->
         Wt::Dbo::Session* getDboSession() { return &_session; }
@@ -120,6 +137,9 @@ namespace lms::db
         Session(const Session&) = delete;
         Session& operator=(const Session&) = delete;
 
+        void createFullTextSearchTablesIfNeeded();
+        std::string createTopQueriesReport(); // only relevant if query stats are enabled
+
         Db& _db;
         Wt::Dbo::Session	_session;
     };
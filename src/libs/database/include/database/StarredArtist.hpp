@@ -44,6 +44,7 @@ namespace lms::db
         static pointer		find(Session& session, StarredArtistId id);
         static pointer		find(Session& session, ArtistId artistId, UserId userId); // current backend
         static pointer		find(Session& session, ArtistId artistId, UserId userId, FeedbackBackend backend);
+        static std::string	getUserStamp(Session& session, UserId userId); // changes each time the user's starred artists change (current backend)
 
         // Accessors
         ObjectPtr<Artist>	getArtist() const { return _artist; }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <ostream>
 #include <optional>
@@ -67,6 +68,7 @@ namespace lms::db
             std::string							name;			// if non empty, must match this name
             TrackSortMethod						sortMethod{ TrackSortMethod::None };
             std::optional<Range>    			range;
+            std::optional<KeysetCursor>			cursor;			// if set, results start right after this position (only for Id and Name sort methods)
             Wt::WDateTime						writtenAfter;
             UserId								starringUser;	// only tracks starred by this user
             std::optional<FeedbackBackend>		feedbackBackend;	// and for this feedback backend
@@ -86,6 +88,7 @@ namespace lms::db
             FindParameters& setName(std::string_view _name) { name = _name; return *this; }
             FindParameters& setSortMethod(TrackSortMethod _method) { sortMethod = _method; return *this; }
             FindParameters& setRange(std::optional<Range> _range) { range = _range; return *this; }
+            FindParameters& setCursor(const std::optional<KeysetCursor>& _cursor) { cursor = _cursor; return *this; }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after) { writtenAfter = _after; return *this; }
             FindParameters& setStarringUser(UserId _user, FeedbackBackend _feedbackBackend) { starringUser = _user; feedbackBackend = _feedbackBackend; return *this; }
             FindParameters& setArtist(ArtistId _artist, core::EnumSet<TrackArtistLinkType> _trackArtistLinkTypes = {}) { artist = _artist; trackArtistLinkTypes = _trackArtistLinkTypes; return *this; }
@@ -112,6 +115,7 @@ namespace lms::db
         static pointer					findByPath(Session& session, const std::filesystem::path& p);
         static pointer 					find(Session& session, TrackId id);
         static void                     find(Session& session, TrackId& lastRetrievedTrack, std::size_t count, const std::function<void(const Track::pointer&)>& func, MediaLibraryId library = {});
+        static void                     findInDirectory(Session& session, const std::filesystem::path& directory, bool recursive, TrackId& lastRetrievedTrack, std::size_t count, const std::function<void(const Track::pointer&)>& func);
         static bool                     exists(Session& session, TrackId id);
         static std::vector<pointer>		findByRecordingMBID(Session& session, const core::UUID& MBID);
         static std::vector<pointer>		findByMBID(Session& session, const core::UUID& MBID);
@@ -135,6 +139,7 @@ namespace lms::db
         void setRelativeFilePath(const std::filesystem::path& filePath);
         void setFileSize(std::size_t fileSize) { _fileSize = fileSize; }
         void setLastWriteTime(Wt::WDateTime time) { _fileLastWrite = time; }
+        void setContentHash(std::optional<std::uint64_t> hash) { _contentHash = hash ? std::optional<long long>{ static_cast<long long>(*hash) } : std::nullopt; }
         void setAddedTime(Wt::WDateTime time) { _fileAdded = time; }
         void setBitrate(std::size_t bitrate) { _bitrate = bitrate; }
         void setBitsPerSample(std::size_t bitsPerSample) { _bitsPerSample = bitsPerSample; }
@@ -168,6 +173,7 @@ namespace lms::db
         const std::filesystem::path& getAbsoluteFilePath() const { return _absoluteFilePath; }
         const std::filesystem::path& getRelativeFilePath() const { return _relativeFilePath; }
         long long                       getFileSize() const { return _fileSize; }
+        std::optional<std::uint64_t>    getContentHash() const { return _contentHash ? std::optional<std::uint64_t>{ static_cast<std::uint64_t>(*_contentHash) } : std::nullopt; }
         std::size_t                     getBitrate() const { return _bitrate; }
         std::size_t                     getBitsPerSample() const { return _bitsPerSample; }
         std::size_t                     getChannelCount() const { return _channelCount; }
@@ -188,6 +194,7 @@ namespace lms::db
         std::optional<float>            getTrackReplayGain() const { return _trackReplayGain; }
         std::optional<float>            getReleaseReplayGain() const { return _releaseReplayGain; }
         std::string_view                getArtistDisplayName() const { return _artistDisplayName; }
+        std::optional<KeysetCursor>     getKeysetCursor(TrackSortMethod sortMethod) const; // position right after this track, if supported by the sort method
         // no artistLinkTypes means get all
         std::vector<ObjectPtr<Artist>>          getArtists(core::EnumSet<TrackArtistLinkType> artistLinkTypes) const; // no type means all
         std::vector<ArtistId>					getArtistIds(core::EnumSet<TrackArtistLinkType> artistLinkTypes) const; // no type means all
@@ -221,6 +228,7 @@ namespace lms::db
             Wt::Dbo::field(a, _relativeFilePath, "relative_file_path");
             Wt::Dbo::field(a, _fileSize, "file_size");
             Wt::Dbo::field(a, _fileLastWrite, "file_last_write");
+            Wt::Dbo::field(a, _contentHash, "content_hash");
             Wt::Dbo::field(a, _fileAdded, "file_added");
             Wt::Dbo::field(a, _hasCover, "has_cover");
             Wt::Dbo::field(a, _trackMBID, "mbid");
@@ -263,6 +271,7 @@ namespace lms::db
         std::filesystem::path	_relativeFilePath; // relative to root (that may be deleted)
         long long    			_fileSize{};
         Wt::WDateTime			_fileLastWrite;
+        std::optional<long long> _contentHash; // partial hash of the file, see scanner
         Wt::WDateTime			_fileAdded;
         bool					_hasCover{};
         std::string				_trackMBID;
@@ -57,6 +57,7 @@ namespace lms::db
         std::chrono::milliseconds	getOffset() const { return _offset; }
         std::string_view			getComment() const { return _comment; }
         ObjectPtr<Track>			getTrack() const { return _track; }
+        TrackId						getTrackId() const; // no database access
         ObjectPtr<User>				getUser() const { return _user; }
 
         template<class Action>
@@ -149,6 +149,7 @@ namespace lms::db
 
         // Accessors
         ObjectPtr<Track>	getTrack() const { return _track; }
+        TrackId				getTrackId() const; // no database access
         const Wt::WDateTime& getDateTime() const { return _dateTime; }
 
         template<class Action>
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Wt/WDateTime.h>
+
+#include "core/UUID.hpp"
+#include "database/ArtistId.hpp"
+#include "database/ClusterId.hpp"
+#include "database/ReleaseId.hpp"
+#include "database/TrackId.hpp"
+#include "database/Types.hpp"
+
+namespace lms::db
+{
+    class Session;
+
+    // Read-only projection of a track, along with its release, artists and clusters
+    // Meant for listings: fetched using a few set-based queries per page, without instantiating any database object
+    struct TrackSummary
+    {
+        struct Artist
+        {
+            ArtistId id;
+            std::string name;
+            std::optional<core::UUID> mbid;
+            TrackArtistLinkType linkType;
+            std::string linkSubType;
+        };
+
+        struct Cluster
+        {
+            ClusterId id;
+            std::string typeName;
+            std::string name;
+        };
+
+        TrackId id;
+        std::string name;
+        std::optional<std::size_t> trackNumber;
+        std::optional<std::size_t> discNumber;
+        std::optional<int> year;
+        std::chrono::milliseconds duration{};
+        std::size_t bitrate{}; // in bps
+        std::size_t bitsPerSample{};
+        std::size_t channelCount{};
+        std::size_t sampleRate{};
+        std::filesystem::path absoluteFilePath;
+        std::filesystem::path relativeFilePath;
+        long long fileSize{};
+        Wt::WDateTime lastWritten;
+        bool hasCover{};
+        std::optional<core::UUID> recordingMBID;
+        std::optional<float> trackReplayGain;
+        std::optional<float> releaseReplayGain;
+        std::string artistDisplayName;
+
+        ReleaseId releaseId; // not set if the track has no release
+        std::string releaseName;
+        std::optional<core::UUID> releaseMBID;
+        std::string releaseArtistDisplayName;
+
+        std::vector<Artist> artists; // all link types, in link creation order
+        std::vector<Cluster> clusters;
+
+        std::vector<const Artist*> getArtists(TrackArtistLinkType linkType) const;
+        std::vector<ArtistId> getArtistIds(TrackArtistLinkType linkType) const;
+        std::vector<std::string_view> getClusterNames(std::string_view clusterTypeName) const;
+
+        // Results are in the same order as the requested ids, missing tracks are skipped
+        static std::vector<TrackSummary> find(Session& session, std::span<const TrackId> trackIds);
+    };
+}
@@ -22,8 +22,13 @@
 #include <cstdint>
 #include <cassert>
 #include <functional>
+#include <optional>
+#include <string>
+#include <vector>
 #include <Wt/WDate.h>
 
+#include "database/IdType.hpp"
+
 namespace lms::db
 {
     // Caution: do not change enum values if they are set!
@@ -57,12 +62,24 @@ namespace lms::db
         }
     }
 
+    // Position right after an entry, in results ordered using a stable sort method
+    // Used to retrieve the following results without having the database step over all the previous ones (keyset pagination)
+    // Content is opaque for callers: use the getKeysetCursor methods of the objects to build it
+    struct KeysetCursor
+    {
+        std::string sortKey; // unused when sorting by id
+        IdType::ValueType id{};
+
+        bool operator==(const KeysetCursor& other) const = default;
+    };
+
     template <typename T>
     struct RangeResults
     {
         Range range;
         std::vector<T> results;
         bool moreResults{};
+        std::optional<KeysetCursor> nextCursor; // set if more results can be retrieved using keyset pagination
 
         RangeResults getSubRange(Range subRange)
         {
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace lms::db
+{
+    class Db;
+    class Session;
+
+    // Dedicated writer thread, owning its own session
+    // Small write requests submitted from any thread are grouped and executed in a single write transaction
+    class WriteQueue
+    {
+    public:
+        // Executed in the writer thread, within a write transaction
+        // Database objects must not be shared with other sessions: only pass ids and find the objects again
+        using WriteRequest = std::function<void(Session& session)>;
+
+        struct Stats
+        {
+            std::size_t requestCount{};                         // processed requests
+            std::size_t batchCount{};                           // committed transactions
+            std::size_t maxBatchSize{};
+            std::chrono::microseconds totalWaitDuration{};      // time spent by requests in the queue
+            std::chrono::microseconds maxWaitDuration{};
+            std::chrono::microseconds totalBatchDuration{};     // time spent executing and committing batches
+            std::chrono::microseconds maxBatchDuration{};
+        };
+
+        WriteQueue(Db& db, std::size_t maxBatchSize = 64);
+        ~WriteQueue();
+
+        // Asynchronous, exceptions thrown by the request are logged and its writes are rolled back
+        void submit(WriteRequest request);
+
+        // Blocks until all the requests submitted so far are committed
+        void flush();
+
+        Stats getStats() const;
+
+    private:
+        WriteQueue(const WriteQueue&) = delete;
+        WriteQueue& operator=(const WriteQueue&) = delete;
+
+        using clock = std::chrono::steady_clock;
+
+        struct PendingRequest
+        {
+            WriteRequest request;
+            clock::time_point submitTime;
+        };
+
+        void run();
+        void processBatch(std::deque<PendingRequest>& batch);
+        void processRequest(Session& session, const WriteRequest& request);
+
+        Db& _db;
+        const std::size_t _maxBatchSize;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _requestCondVar;
+        std::condition_variable _flushCondVar;
+        std::deque<PendingRequest> _pendingRequests;
+        std::size_t _submittedCount{};
+        std::size_t _processedCount{};
+        bool _stop{};
+        Stats _stats;
+
+        std::thread _thread;
+    };
+}
@@ -300,6 +300,36 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Artist_removeOrphans)
+    {
+        ScopedTrack track{ session };
+        ScopedArtist artist{ session, "MyArtist" };
+        ScopedArtist orphanArtist1{ session, "MyOrphanArtist1" };
+        ScopedArtist orphanArtist2{ session, "MyOrphanArtist2" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            TrackArtistLink::create(session, track.get(), artist.get(), TrackArtistLinkType::Artist);
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            EXPECT_EQ(Artist::removeOrphans(session, 1), 1);
+            EXPECT_EQ(Artist::removeOrphans(session, 10), 1);
+            EXPECT_EQ(Artist::removeOrphans(session, 10), 0);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_TRUE(Artist::exists(session, artist.getId()));
+            EXPECT_FALSE(Artist::exists(session, orphanArtist1.getId()));
+            EXPECT_FALSE(Artist::exists(session, orphanArtist2.getId()));
+            EXPECT_EQ(track->getArtistLinks().size(), 1);
+        }
+    }
+
     TEST_F(DatabaseFixture, Artist_singleTrack_mediaLibrary)
     {
         ScopedTrack track{ session };
@@ -297,6 +297,91 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Cluster_removeOrphans)
+    {
+        ScopedTrack track{ session };
+        ScopedClusterType clusterType{ session, "MyClusterType" };
+        ScopedClusterType orphanClusterType1{ session, "MyOrphanClusterType1" };
+        ScopedClusterType orphanClusterType2{ session, "MyOrphanClusterType2" };
+        ScopedCluster cluster{ session, clusterType.lockAndGet(), "MyCluster" };
+        ScopedCluster orphanCluster{ session, orphanClusterType1.lockAndGet(), "MyOrphanCluster" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            cluster.get().modify()->addTrack(track.get());
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            EXPECT_EQ(Cluster::removeOrphans(session, 10), 1);
+            EXPECT_EQ(Cluster::removeOrphans(session, 10), 0);
+
+            EXPECT_EQ(ClusterType::removeOrphans(session, 10), 2);
+            EXPECT_EQ(ClusterType::removeOrphans(session, 10), 0);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_EQ(Cluster::getCount(session), 1);
+            EXPECT_FALSE(Cluster::find(session, orphanCluster.getId()));
+            EXPECT_TRUE(ClusterType::find(session, clusterType.getId()));
+            EXPECT_FALSE(ClusterType::find(session, orphanClusterType1.getId()));
+            EXPECT_FALSE(ClusterType::find(session, orphanClusterType2.getId()));
+            EXPECT_EQ(track->getClusterIds().size(), 1);
+        }
+    }
+
+    TEST_F(DatabaseFixture, Cluster_updateCounts)
+    {
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedRelease release{ session, "MyRelease" };
+        ScopedClusterType clusterType{ session, "MyClusterType" };
+        ScopedCluster cluster1{ session, clusterType.lockAndGet(), "MyCluster1" };
+        ScopedCluster cluster2{ session, clusterType.lockAndGet(), "MyCluster2" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            track1.get().modify()->setRelease(release.get());
+            cluster1.get().modify()->addTrack(track1.get());
+            cluster1.get().modify()->addTrack(track2.get());
+            cluster2.get().modify()->setTrackCount(5);
+            cluster2.get().modify()->setReleaseCount(2);
+        }
+
+        std::vector<Cluster::Counts> outdatedCounts;
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            outdatedCounts = Cluster::findOutdatedCounts(session);
+            ASSERT_EQ(outdatedCounts.size(), 2);
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            Cluster::updateCounts(session, outdatedCounts);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_EQ(Cluster::findOutdatedCounts(session).size(), 0);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_EQ(cluster1->getTrackCount(), 2);
+            EXPECT_EQ(cluster1->getReleasesCount(), 1);
+            EXPECT_EQ(cluster2->getTrackCount(), 0);
+            EXPECT_EQ(cluster2->getReleasesCount(), 0);
+        }
+    }
+
     TEST_F(DatabaseFixture, Cluster_singleTrackSingleReleaseSingleCluster)
     {
         ScopedTrack track{ session };
@@ -106,6 +106,7 @@ namespace lms::db::tests
     using ScopedClusterType = ScopedEntity<db::ClusterType>;
     using ScopedMediaLibrary = ScopedEntity<db::MediaLibrary>;
     using ScopedRelease = ScopedEntity<db::Release>;
+    using ScopedReleaseType = ScopedEntity<db::ReleaseType>;
     using ScopedTrack = ScopedEntity<db::Track>;
     using ScopedTrackList = ScopedEntity<db::TrackList>;
     using ScopedUser = ScopedEntity<db::User>;
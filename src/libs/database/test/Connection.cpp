@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include <Wt/Dbo/Session.h>
+#include <Wt/Dbo/Transaction.h>
+
+#include "Connection.hpp"
+
+namespace lms::db::tests
+{
+    TEST(Connection, statementCacheTrim)
+    {
+        const std::filesystem::path tmpFile{ std::tmpnam(nullptr) };
+        const ScopedFileDeleter fileDeleter{ tmpFile };
+
+        Db::ConnectionSettings settings;
+        settings.maxCachedStatementCount = 16;
+
+        auto connection{ std::make_unique<Connection>(tmpFile, ConnectionType::Write, settings, 1) };
+        const Connection& connectionRef{ *connection };
+
+        Wt::Dbo::Session session;
+        session.setConnection(std::move(connection));
+
+        {
+            Wt::Dbo::Transaction transaction{ session };
+            EXPECT_EQ(session.query<int>("SELECT 1").resultValue(), 1);
+        }
+        // below the limit: cache kept
+        EXPECT_GT(connectionRef.getCachedStatementCount(), 0);
+        EXPECT_LE(connectionRef.getCachedStatementCount(), settings.maxCachedStatementCount);
+
+        {
+            Wt::Dbo::Transaction transaction{ session };
+            for (int i{}; i < 32; ++i)
+                EXPECT_EQ(session.query<int>("SELECT " + std::to_string(i)).resultValue(), i);
+
+            // not trimmed while the transaction is active
+            EXPECT_GT(connectionRef.getCachedStatementCount(), settings.maxCachedStatementCount);
+        }
+        EXPECT_EQ(connectionRef.getCachedStatementCount(), 0);
+
+        // statements can be prepared again
+        {
+            Wt::Dbo::Transaction transaction{ session };
+            EXPECT_EQ(session.query<int>("SELECT 1").resultValue(), 1);
+        }
+        EXPECT_GT(connectionRef.getCachedStatementCount(), 0);
+    }
+
+    TEST_F(DatabaseFixture, Connection_dispatch)
+    {
+        // Only read connections keep their temporary tables in memory by default
+        auto getTempStore{ [&] { return session.getDboSession()->query<int>("SELECT temp_store FROM pragma_temp_store").resultValue(); } };
+        constexpr int tempStoreDefault{ 0 };
+        constexpr int tempStoreMemory{ 2 };
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(getTempStore(), tempStoreMemory);
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            EXPECT_EQ(getTempStore(), tempStoreDefault);
+        }
+
+        // connections are returned to the right pool
+        for (std::size_t i{}; i < 32; ++i)
+        {
+            {
+                auto transaction{ session.createReadTransaction() };
+                EXPECT_EQ(getTempStore(), tempStoreMemory);
+            }
+            {
+                auto transaction{ session.createWriteTransaction() };
+                EXPECT_EQ(getTempStore(), tempStoreDefault);
+            }
+        }
+    }
+}
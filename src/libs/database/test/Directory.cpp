@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include "database/Directory.hpp"
+
+namespace lms::db::tests
+{
+    using ScopedDirectory = ScopedEntity<db::Directory>;
+
+    TEST_F(DatabaseFixture, Directory)
+    {
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Directory::getCount(session), 0);
+        }
+
+        ScopedDirectory root{ session, "/root" };
+        ScopedDirectory child{ session, "/root/foo", root.lockAndGet() };
+        ScopedDirectory otherChild{ session, "/root/bar", root.lockAndGet() };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            child.get().modify()->setFileCount(12);
+            child.get().modify()->setLastWriteTime(Wt::WDateTime{ Wt::WDate{ 2024, 1, 1 } });
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_EQ(Directory::getCount(session), 3);
+
+            const Directory::pointer found{ Directory::find(session, "/root/foo") };
+            ASSERT_TRUE(found);
+            EXPECT_EQ(found->getId(), child.getId());
+            EXPECT_EQ(found->getFileCount(), 12);
+            EXPECT_EQ(found->getLastWriteTime(), Wt::WDateTime{ Wt::WDate{ 2024, 1, 1 } });
+            ASSERT_TRUE(found->getParent());
+            EXPECT_EQ(found->getParent()->getId(), root.getId());
+
+            const auto rootDirectories{ Directory::findRootDirectories(session) };
+            ASSERT_EQ(rootDirectories.size(), 1);
+            EXPECT_EQ(rootDirectories.front()->getId(), root.getId());
+            EXPECT_FALSE(rootDirectories.front()->getParent());
+
+            const auto children{ Directory::findChildren(session, root.getId()) };
+            ASSERT_EQ(children.size(), 2);
+            EXPECT_EQ(children[0]->getId(), otherChild.getId()); // ordered by path
+            EXPECT_EQ(children[1]->getId(), child.getId());
+
+            EXPECT_TRUE(Directory::findChildren(session, child.getId()).empty());
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            root.get().remove();
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Directory::getCount(session), 0); // children removed in cascade
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include "database/Image.hpp"
+
+namespace lms::db::tests
+{
+    using ScopedImage = ScopedEntity<db::Image>;
+
+    TEST_F(DatabaseFixture, Image)
+    {
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Image::getCount(session), 0);
+        }
+
+        ScopedImage image{ session, "/root/foo/cover.jpg" };
+        ScopedImage otherImage{ session, "/root/bar/cover.jpg" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            image.get().modify()->setFileSize(1024);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_EQ(Image::getCount(session), 2);
+
+            const Image::pointer found{ Image::find(session, "/root/foo/cover.jpg") };
+            ASSERT_TRUE(found);
+            EXPECT_EQ(found->getId(), image.getId());
+            EXPECT_EQ(found->getDirectory(), "/root/foo");
+            EXPECT_EQ(found->getStem(), "cover");
+            EXPECT_EQ(found->getFileSize(), 1024);
+
+            const auto images{ Image::findByDirectory(session, "/root/foo") };
+            ASSERT_EQ(images.size(), 1);
+            EXPECT_EQ(images.front()->getId(), image.getId());
+
+            EXPECT_TRUE(Image::findByDirectory(session, "/root").empty());
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            std::size_t count{};
+            ImageId lastRetrievedImage;
+            Image::find(session, lastRetrievedImage, 1, [&](const Image::pointer&) { count++; });
+            EXPECT_EQ(count, 1);
+            EXPECT_EQ(lastRetrievedImage, image.getId());
+
+            Image::find(session, lastRetrievedImage, 10, [&](const Image::pointer&) { count++; });
+            EXPECT_EQ(count, 2);
+            EXPECT_EQ(lastRetrievedImage, otherImage.getId());
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            std::vector<ImageId> images;
+            ImageId lastRetrievedImage;
+            Image::findInDirectory(session, "/root/bar", true, lastRetrievedImage, 10, [&](const Image::pointer& image) { images.push_back(image->getId()); });
+            ASSERT_EQ(images.size(), 1);
+            EXPECT_EQ(images.front(), otherImage.getId());
+
+            images.clear();
+            lastRetrievedImage = {};
+            Image::findInDirectory(session, "/root", true, lastRetrievedImage, 10, [&](const Image::pointer& image) { images.push_back(image->getId()); });
+            EXPECT_EQ(images.size(), 2);
+
+            images.clear();
+            lastRetrievedImage = {};
+            Image::findInDirectory(session, "/root", false, lastRetrievedImage, 10, [&](const Image::pointer& image) { images.push_back(image->getId()); });
+            EXPECT_TRUE(images.empty());
+
+            lastRetrievedImage = {};
+            Image::findInDirectory(session, "/root/bar", false, lastRetrievedImage, 10, [&](const Image::pointer& image) { images.push_back(image->getId()); });
+            ASSERT_EQ(images.size(), 1);
+            EXPECT_EQ(images.front(), otherImage.getId());
+        }
+    }
+}
@@ -1680,4 +1680,138 @@ namespace lms::db::tests
             EXPECT_EQ(tracks.results[0], track.getId());
         }
     }
-}
\ No newline at end of file
+
+    TEST_F(DatabaseFixture, Listen_statsConsistency)
+    {
+        ScopedUser user{ session, "MyUser" };
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedTrack track3{ session };
+        ScopedRelease release1{ session, "MyRelease1" };
+        ScopedRelease release2{ session, "MyRelease2" };
+        ScopedArtist artist1{ session, "MyArtist1" };
+        ScopedArtist artist2{ session, "MyArtist2" };
+        const Wt::WDateTime dateTime{ Wt::WDate{ 2000, 1, 2 }, Wt::WTime{ 12, 0, 1 } };
+
+        struct Stats
+        {
+            RangeResults<ArtistId> topArtists;
+            RangeResults<ReleaseId> topReleases;
+            RangeResults<TrackId> topTracks;
+            RangeResults<ArtistId> recentArtists;
+            RangeResults<ReleaseId> recentReleases;
+            RangeResults<TrackId> recentTracks;
+            std::size_t release1Count{};
+            std::size_t track1Count{};
+        };
+
+        auto getStats{ [&]
+            {
+                auto transaction{ session.createReadTransaction() };
+
+                Listen::ArtistStatsFindParameters params;
+                params.setUser(user->getId());
+                params.setScrobblingBackend(ScrobblingBackend::Internal);
+
+                return Stats{
+                    Listen::getTopArtists(session, params),
+                    Listen::getTopReleases(session, params),
+                    Listen::getTopTracks(session, params),
+                    Listen::getRecentArtists(session, params),
+                    Listen::getRecentReleases(session, params),
+                    Listen::getRecentTracks(session, params),
+                    Listen::getCount(session, user->getId(), release1.getId()),
+                    Listen::getCount(session, user->getId(), track1.getId()),
+                };
+            } };
+
+        // stats maintained by the database must match stats rebuilt from scratch
+        auto checkStats{ [&]
+            {
+                const Stats stats{ getStats() };
+                {
+                    auto transaction{ session.createWriteTransaction() };
+                    Listen::rebuildStats(session);
+                }
+                const Stats rebuiltStats{ getStats() };
+
+                EXPECT_EQ(stats.topArtists.results, rebuiltStats.topArtists.results);
+                EXPECT_EQ(stats.topReleases.results, rebuiltStats.topReleases.results);
+                EXPECT_EQ(stats.topTracks.results, rebuiltStats.topTracks.results);
+                EXPECT_EQ(stats.recentArtists.results, rebuiltStats.recentArtists.results);
+                EXPECT_EQ(stats.recentReleases.results, rebuiltStats.recentReleases.results);
+                EXPECT_EQ(stats.recentTracks.results, rebuiltStats.recentTracks.results);
+                EXPECT_EQ(stats.release1Count, rebuiltStats.release1Count);
+                EXPECT_EQ(stats.track1Count, rebuiltStats.track1Count);
+
+                return stats;
+            } };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            track1.get().modify()->setRelease(release1.get());
+            track2.get().modify()->setRelease(release1.get());
+            track3.get().modify()->setRelease(release2.get());
+            TrackArtistLink::create(session, track1.get(), artist1.get(), TrackArtistLinkType::Artist);
+            TrackArtistLink::create(session, track1.get(), artist1.get(), TrackArtistLinkType::Composer);
+            TrackArtistLink::create(session, track3.get(), artist2.get(), TrackArtistLinkType::Artist);
+        }
+
+        ScopedListen listen1{ session, user.lockAndGet(), track1.lockAndGet(), ScrobblingBackend::Internal, dateTime };
+        ScopedListen listen2{ session, user.lockAndGet(), track1.lockAndGet(), ScrobblingBackend::Internal, dateTime.addSecs(1) };
+        ScopedListen listen3{ session, user.lockAndGet(), track2.lockAndGet(), ScrobblingBackend::Internal, dateTime.addSecs(2) };
+        ScopedListen listen4{ session, user.lockAndGet(), track3.lockAndGet(), ScrobblingBackend::ListenBrainz, dateTime.addSecs(3) };
+        {
+            const Stats stats{ checkStats() };
+            ASSERT_EQ(stats.topArtists.results.size(), 1);
+            EXPECT_EQ(stats.topArtists.results[0], artist1.getId());
+            ASSERT_EQ(stats.topTracks.results.size(), 2);
+            EXPECT_EQ(stats.topTracks.results[0], track1.getId());
+            ASSERT_EQ(stats.recentTracks.results.size(), 2);
+            EXPECT_EQ(stats.recentTracks.results[0], track2.getId());
+            EXPECT_EQ(stats.release1Count, 1);
+            EXPECT_EQ(stats.track1Count, 2);
+        }
+
+        {
+            ScopedListen listen5{ session, user.lockAndGet(), track3.lockAndGet(), ScrobblingBackend::Internal, dateTime.addSecs(4) };
+            ScopedListen listen6{ session, user.lockAndGet(), track3.lockAndGet(), ScrobblingBackend::Internal, dateTime.addSecs(5) };
+            ScopedListen listen7{ session, user.lockAndGet(), track3.lockAndGet(), ScrobblingBackend::Internal, dateTime.addSecs(6) };
+            {
+                const Stats stats{ checkStats() };
+                ASSERT_EQ(stats.topArtists.results.size(), 2);
+                EXPECT_EQ(stats.topArtists.results[0], artist2.getId());
+                ASSERT_EQ(stats.recentReleases.results.size(), 2);
+                EXPECT_EQ(stats.recentReleases.results[0], release2.getId());
+            }
+
+            // track moved to another release, linked to other artists
+            {
+                auto transaction{ session.createWriteTransaction() };
+
+                track3.get().modify()->setRelease(release1.get());
+                TrackArtistLink::create(session, track3.get(), artist1.get(), TrackArtistLinkType::Artist);
+            }
+            {
+                const Stats stats{ checkStats() };
+                ASSERT_EQ(stats.topReleases.results.size(), 1);
+                EXPECT_EQ(stats.topReleases.results[0], release1.getId());
+                ASSERT_EQ(stats.topArtists.results.size(), 2);
+                EXPECT_EQ(stats.topArtists.results[0], artist1.getId());
+            }
+        }
+
+        // listens removed
+        checkStats();
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            listen1.get().remove();
+        }
+        {
+            const Stats stats{ checkStats() };
+            EXPECT_EQ(stats.track1Count, 1);
+        }
+    }
+}
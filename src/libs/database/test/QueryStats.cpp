@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "QueryStats.hpp"
+
+namespace lms::db::tests
+{
+    TEST(QueryStats, normalizeSql_valueLists)
+    {
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?, ?, ?)"), "SELECT id FROM track WHERE id IN (?, ...)");
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?,?)"), QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?, ?, ?)"));
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?)"), QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?, ?, ?)"));
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id = ? AND name = ?"), "SELECT id FROM track WHERE id = ? AND name = ?");
+    }
+
+    TEST(QueryStats, normalizeSql_literals)
+    {
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id = 12"), "SELECT id FROM track WHERE id = ?");
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE name = 'it''s'"), "SELECT id FROM track WHERE name = ?");
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track LIMIT 10 OFFSET 2.5"), "SELECT id FROM track LIMIT ? OFFSET ?");
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (1, 2, 3)"), QueryStats::normalizeSql("SELECT id FROM track WHERE id IN (?)"));
+        EXPECT_EQ(QueryStats::normalizeSql("SELECT id FROM track WHERE name IN ('a', 'b')"), QueryStats::normalizeSql("SELECT id FROM track WHERE name IN (?)"));
+
+        // identifiers are kept
+        EXPECT_EQ(QueryStats::normalizeSql(R"(SELECT t1.col2 FROM "table 3" t1)"), R"(SELECT t1.col2 FROM "table 3" t1)");
+    }
+
+    TEST(QueryStats, record)
+    {
+        QueryStats::clear();
+
+        QueryStats::record("SELECT id FROM track WHERE id IN (?, ?)", std::chrono::milliseconds{ 1 });
+        QueryStats::record("SELECT id FROM track WHERE id IN (?)", std::chrono::milliseconds{ 3 });
+        QueryStats::record("SELECT id FROM release", std::chrono::milliseconds{ 2 });
+
+        const std::vector<QueryStats::Entry> entries{ QueryStats::getTopEntries(10) };
+        ASSERT_EQ(entries.size(), 2);
+        EXPECT_EQ(entries[0].sql, "SELECT id FROM track WHERE id IN (?, ?)"); // first recorded statement
+        EXPECT_EQ(entries[0].executionCount, 2);
+        EXPECT_EQ(entries[0].totalDuration, std::chrono::milliseconds{ 4 });
+        EXPECT_EQ(entries[0].maxDuration, std::chrono::milliseconds{ 3 });
+        EXPECT_EQ(entries[1].sql, "SELECT id FROM release");
+
+        EXPECT_EQ(QueryStats::getTopEntries(1).size(), 1);
+
+        QueryStats::clear();
+        EXPECT_TRUE(QueryStats::getTopEntries(10).empty());
+    }
+
+    TEST(QueryStats, maxEntryCount)
+    {
+        QueryStats::clear();
+
+        constexpr std::size_t extraStatementCount{ 10 };
+        for (std::size_t i{}; i < QueryStats::maxEntryCount + extraStatementCount; ++i)
+            QueryStats::record("SELECT col" + std::to_string(i) + " FROM track", std::chrono::milliseconds{ 1 });
+
+        const std::vector<QueryStats::Entry> entries{ QueryStats::getTopEntries(QueryStats::maxEntryCount * 2) };
+        EXPECT_EQ(entries.size(), QueryStats::maxEntryCount + 1);
+
+        auto itOther{ std::find_if(std::cbegin(entries), std::cend(entries), [](const QueryStats::Entry& entry) { return entry.sql == QueryStats::otherStatementsSql; }) };
+        ASSERT_NE(itOther, std::cend(entries));
+        EXPECT_EQ(itOther->executionCount, extraStatementCount);
+        EXPECT_EQ(entries.front().sql, QueryStats::otherStatementsSql); // highest total duration
+
+        // already known statements are still accounted in their own entry
+        QueryStats::record("SELECT col0 FROM track", std::chrono::milliseconds{ 1 });
+        const std::vector<QueryStats::Entry> updatedEntries{ QueryStats::getTopEntries(QueryStats::maxEntryCount * 2) };
+        EXPECT_EQ(updatedEntries.size(), QueryStats::maxEntryCount + 1);
+        auto itFirst{ std::find_if(std::cbegin(updatedEntries), std::cend(updatedEntries), [](const QueryStats::Entry& entry) { return entry.sql == "SELECT col0 FROM track"; }) };
+        ASSERT_NE(itFirst, std::cend(updatedEntries));
+        EXPECT_EQ(itFirst->executionCount, 2);
+
+        QueryStats::clear();
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include "database/ReferenceData.hpp"
+#include "database/ScanSettings.hpp"
+
+namespace lms::db::tests
+{
+    TEST_F(DatabaseFixture, ReferenceData)
+    {
+        ReferenceDataCache& cache{ session.getDb().getReferenceDataCache() };
+        cache.refresh(session);
+
+        std::shared_ptr<const ReferenceData> initialData;
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            initialData = session.getReferenceData();
+            ASSERT_TRUE(initialData);
+            EXPECT_EQ(initialData->clusterTypes.size(), 0);
+            EXPECT_EQ(initialData->releaseTypes.size(), 0);
+            EXPECT_EQ(initialData->mediaLibraries.size(), 0);
+            EXPECT_EQ(initialData->findClusterType("GENRE"), nullptr);
+        }
+
+        ScopedClusterType genre{ session, "GENRE" };
+        ScopedClusterType mood{ session, "MOOD" };
+        ScopedReleaseType releaseType{ session, "Album" };
+        ScopedMediaLibrary library{ session, "/root", "MyLibrary" };
+
+        {
+            // not refreshed yet
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(session.getReferenceData(), initialData);
+        }
+
+        cache.refresh(session);
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const std::shared_ptr<const ReferenceData> data{ session.getReferenceData() };
+            ASSERT_TRUE(data);
+            EXPECT_GT(data->version, initialData->version);
+
+            ASSERT_EQ(data->clusterTypes.size(), 2);
+            EXPECT_EQ(data->clusterTypes[0].name, "GENRE");
+            EXPECT_EQ(data->clusterTypes[1].name, "MOOD");
+
+            const ReferenceData::ClusterTypeInfo* genreInfo{ data->findClusterType("GENRE") };
+            ASSERT_NE(genreInfo, nullptr);
+            EXPECT_EQ(genreInfo->id, genre.getId());
+            EXPECT_EQ(data->findClusterType(mood.getId()), &data->clusterTypes[1]);
+
+            ASSERT_EQ(data->releaseTypes.size(), 1);
+            EXPECT_EQ(data->releaseTypes[0].id, releaseType.getId());
+            EXPECT_EQ(data->releaseTypes[0].name, "Album");
+
+            ASSERT_EQ(data->mediaLibraries.size(), 1);
+            EXPECT_EQ(data->mediaLibraries[0].id, library.getId());
+            EXPECT_EQ(data->mediaLibraries[0].name, "MyLibrary");
+            EXPECT_EQ(data->mediaLibraries[0].path, "/root");
+        }
+
+        const std::size_t libraryGeneration{ session.getReferenceData()->libraryGeneration };
+        {
+            auto transaction{ session.createWriteTransaction() };
+            ScanSettings::get(session).modify()->incLibraryGeneration();
+        }
+
+        // not refreshed yet
+        EXPECT_EQ(session.getReferenceData()->libraryGeneration, libraryGeneration);
+
+        cache.refresh(session);
+        EXPECT_EQ(session.getReferenceData()->libraryGeneration, libraryGeneration + 1);
+    }
+}
@@ -227,6 +227,33 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Release_removeOrphans)
+    {
+        ScopedTrack track{ session };
+        ScopedRelease release{ session, "MyRelease" };
+        ScopedRelease orphanRelease{ session, "MyOrphanRelease" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track.get().modify()->setRelease(release.get());
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            EXPECT_EQ(Release::removeOrphans(session, 10), 1);
+            EXPECT_EQ(Release::removeOrphans(session, 10), 0);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            EXPECT_TRUE(Release::exists(session, release.getId()));
+            EXPECT_FALSE(Release::exists(session, orphanRelease.getId()));
+            EXPECT_EQ(track->getRelease()->getId(), release.getId());
+        }
+    }
+
     TEST_F(DatabaseFixture, Release_singleTrack_mediaLibrary)
     {
         ScopedTrack track{ session };
@@ -626,6 +653,46 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Release_scannedAfter)
+    {
+        ScopedRelease release1{ session, "MyRelease1" };
+        ScopedRelease release2{ session, "MyRelease2" };
+        ScopedRelease release3{ session, "MyRelease3" };
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedTrack track3{ session };
+        ScopedTrack track4{ session };
+
+        const Wt::WDateTime dateTime{ Wt::WDate {1950, 1, 1}, Wt::WTime {12, 30, 20} };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track1.get().modify()->setAddedTime(dateTime.addSecs(-1));
+            track1.get().modify()->setRelease(release1.get());
+            track2.get().modify()->setAddedTime(dateTime);
+            track2.get().modify()->setRelease(release2.get());
+            track3.get().modify()->setAddedTime(dateTime.addSecs(1));
+            track3.get().modify()->setRelease(release3.get());
+            track4.get().modify()->setAddedTime(dateTime.addSecs(2));
+            track4.get().modify()->setRelease(release3.get());
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            const auto releases{ Release::findIds(session, Release::FindParameters {}.setScannedAfter(dateTime).setSortMethod(ReleaseSortMethod::Id)) };
+            ASSERT_EQ(releases.results.size(), 2);
+            EXPECT_EQ(releases.results[0], release2.getId());
+            EXPECT_EQ(releases.results[1], release3.getId());
+            EXPECT_EQ(Release::getCount(session, Release::FindParameters {}.setScannedAfter(dateTime)), 2);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            const auto releases{ Release::findIds(session, Release::FindParameters {}.setScannedAfter(dateTime.addSecs(3))) };
+            EXPECT_EQ(releases.results.size(), 0);
+        }
+    }
+
     TEST_F(DatabaseFixture, Release_artist)
     {
         ScopedRelease release{ session, "MyRelease" };
@@ -876,6 +943,64 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Release_keysetCursor)
+    {
+        ScopedRelease release1{ session, "b" };
+        ScopedRelease release2{ session, "A" };
+        ScopedRelease release3{ session, "a" };
+        ScopedRelease release4{ session, "C" };
+
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedTrack track3{ session };
+        ScopedTrack track4{ session };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            track1.get().modify()->setRelease(release1.get());
+            track2.get().modify()->setRelease(release2.get());
+            track3.get().modify()->setRelease(release3.get());
+            track4.get().modify()->setRelease(release4.get());
+        }
+
+        for (const ReleaseSortMethod sortMethod : { ReleaseSortMethod::Id, ReleaseSortMethod::Name })
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto allReleases{ Release::findIds(session, Release::FindParameters{}.setSortMethod(sortMethod)) };
+            ASSERT_EQ(allReleases.results.size(), 4);
+            EXPECT_FALSE(allReleases.nextCursor);
+
+            std::vector<ReleaseId> visitedReleases;
+            std::optional<KeysetCursor> cursor;
+            do
+            {
+                const auto releases{ Release::findIds(session, Release::FindParameters{}.setSortMethod(sortMethod).setRange(Range{ visitedReleases.size(), 1 }).setCursor(cursor)) };
+                ASSERT_EQ(releases.results.size(), 1);
+                visitedReleases.push_back(releases.results.front());
+                EXPECT_EQ(releases.moreResults, releases.nextCursor.has_value());
+
+                cursor = releases.nextCursor;
+            } while (cursor);
+
+            EXPECT_EQ(visitedReleases, allReleases.results);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto releases{ Release::findIds(session, Release::FindParameters{}.setSortMethod(ReleaseSortMethod::Name)) };
+            ASSERT_EQ(releases.results.size(), 4);
+            EXPECT_EQ(releases.results[0], release2.getId());
+            EXPECT_EQ(releases.results[1], release3.getId());
+            EXPECT_EQ(releases.results[2], release1.getId());
+            EXPECT_EQ(releases.results[3], release4.getId());
+
+            EXPECT_FALSE(release1.get()->getKeysetCursor(ReleaseSortMethod::Random));
+        }
+    }
+
     TEST_F(DatabaseFixture, Release_meanBitrate)
     {
         ScopedRelease release1{ session, "MyRelease1" };
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include "database/MediaLibrary.hpp"
+#include "database/ScanCheckpoint.hpp"
+
+namespace lms::db::tests
+{
+    TEST_F(DatabaseFixture, ScanCheckpoint)
+    {
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_FALSE(ScanCheckpoint::get(session));
+        }
+
+        ScopedMediaLibrary library{ session, "/root" };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            ScanCheckpoint::pointer checkpoint{ ScanCheckpoint::getOrCreate(session) };
+            ASSERT_TRUE(checkpoint);
+            checkpoint.modify()->setScanVersion(3);
+            checkpoint.modify()->setFullScan(true);
+            checkpoint.modify()->setStep(5);
+            checkpoint.modify()->setMediaLibrary(library.get());
+            checkpoint.modify()->setLastProcessedPath("/root/foo/bar.mp3");
+            checkpoint.modify()->setStats("stats");
+
+            EXPECT_EQ(ScanCheckpoint::getOrCreate(session), checkpoint); // single checkpoint
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const ScanCheckpoint::pointer checkpoint{ ScanCheckpoint::get(session) };
+            ASSERT_TRUE(checkpoint);
+            EXPECT_EQ(checkpoint->getScanVersion(), 3);
+            EXPECT_TRUE(checkpoint->isFullScan());
+            EXPECT_EQ(checkpoint->getStep(), 5);
+            ASSERT_TRUE(checkpoint->getMediaLibrary());
+            EXPECT_EQ(checkpoint->getMediaLibrary()->getId(), library.getId());
+            EXPECT_EQ(checkpoint->getLastProcessedPath(), "/root/foo/bar.mp3");
+            EXPECT_EQ(checkpoint->getStats(), "stats");
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            library.get().remove();
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const ScanCheckpoint::pointer checkpoint{ ScanCheckpoint::get(session) };
+            ASSERT_TRUE(checkpoint);
+            EXPECT_FALSE(checkpoint->getMediaLibrary()); // set to null on library removal
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            ScanCheckpoint::clear(session);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_FALSE(ScanCheckpoint::get(session));
+        }
+    }
+}
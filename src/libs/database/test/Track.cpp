@@ -20,6 +20,10 @@
 #include "Common.hpp"
 
 #include <algorithm>
+#include <list>
+#include <set>
+
+#include "database/TrackSummary.hpp"
 
 namespace lms::db::tests
 {
@@ -171,6 +175,71 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, Track_randomSortMethod)
+    {
+        std::list<ScopedTrack> tracks;
+        ScopedMediaLibrary library{ session };
+
+        for (std::size_t i{}; i < 64; ++i)
+            tracks.emplace_back(session);
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+
+            std::size_t i{};
+            for (ScopedTrack& track : tracks)
+            {
+                if (i++ % 2 == 0)
+                    track.get().modify()->setMediaLibrary(library.get());
+            }
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto trackIds{ Track::findIds(session, Track::FindParameters{}.setSortMethod(TrackSortMethod::Random).setRange(Range{ 0, 8 })) };
+            ASSERT_EQ(trackIds.results.size(), 8);
+            EXPECT_TRUE(trackIds.moreResults);
+            EXPECT_EQ(std::set<TrackId>(std::cbegin(trackIds.results), std::cend(trackIds.results)).size(), 8);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto randomTracks{ Track::find(session, Track::FindParameters{}.setSortMethod(TrackSortMethod::Random).setRange(Range{ 0, 8 })) };
+            ASSERT_EQ(randomTracks.results.size(), 8);
+            EXPECT_EQ(randomTracks.range.size, 8);
+            EXPECT_TRUE(randomTracks.moreResults);
+
+            std::set<TrackId> trackIds;
+            for (const Track::pointer& track : randomTracks.results)
+            {
+                ASSERT_TRUE(track);
+                trackIds.insert(track->getId());
+            }
+            EXPECT_EQ(trackIds.size(), 8);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto trackIds{ Track::findIds(session, Track::FindParameters{}.setSortMethod(TrackSortMethod::Random).setMediaLibrary(library.getId()).setRange(Range{ 0, 8 })) };
+            ASSERT_EQ(trackIds.results.size(), 8);
+            EXPECT_EQ(std::set<TrackId>(std::cbegin(trackIds.results), std::cend(trackIds.results)).size(), 8);
+            for (const TrackId trackId : trackIds.results)
+                EXPECT_EQ(Track::find(session, trackId)->getMediaLibrary()->getId(), library.getId());
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            // more than what can be found
+            const auto trackIds{ Track::findIds(session, Track::FindParameters{}.setSortMethod(TrackSortMethod::Random).setMediaLibrary(library.getId()).setRange(Range{ 0, 40 })) };
+            EXPECT_EQ(trackIds.results.size(), 32);
+            EXPECT_FALSE(trackIds.moreResults);
+        }
+    }
+
     TEST_F(DatabaseFixture, Track_noMediaLibrary)
     {
         ScopedTrack track{ session };
@@ -258,6 +327,56 @@ namespace lms::db::tests
         }
     }
 
+    TEST_F(DatabaseFixture, MultipleTracksSearchByKeywords)
+    {
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedTrack track3{ session };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track1.get().modify()->setName("Foo Bar");
+            track2.get().modify()->setName("Bar \"Foo\"");
+            track3.get().modify()->setName("Foobar");
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            {
+                const auto tracks{ Track::findIds(session, Track::FindParameters {}.setKeywords({"foo", "bar"})) };
+                EXPECT_EQ(tracks.results.size(), 3);
+            }
+            {
+                const auto tracks{ Track::findIds(session, Track::FindParameters {}.setKeywords({"Foo ", "bar"})) };
+                ASSERT_EQ(tracks.results.size(), 1);
+                EXPECT_EQ(tracks.results[0], track1.getId());
+            }
+            {
+                const auto tracks{ Track::findIds(session, Track::FindParameters {}.setKeywords({"\"Foo\""})) };
+                ASSERT_EQ(tracks.results.size(), 1);
+                EXPECT_EQ(tracks.results[0], track2.getId());
+            }
+            {
+                // short keywords
+                const auto tracks{ Track::findIds(session, Track::FindParameters {}.setKeywords({"oo", "r"})) };
+                EXPECT_EQ(tracks.results.size(), 3);
+            }
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track3.get().modify()->setName("Baz");
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const auto tracks{ Track::findIds(session, Track::FindParameters {}.setKeywords({"foo"})) };
+            EXPECT_EQ(tracks.results.size(), 2);
+        }
+    }
+
     TEST_F(DatabaseFixture, Track_date)
     {
         ScopedTrack track{ session };
@@ -344,6 +463,44 @@ namespace lms::db::tests
     }
 
 
+    TEST_F(DatabaseFixture, Track_findInDirectory)
+    {
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedTrack track3{ session };
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track1.get().modify()->setAbsoluteFilePath("/root/foo/file.mp3");
+            track2.get().modify()->setAbsoluteFilePath("/root/foo/bar/file.mp3");
+            track3.get().modify()->setAbsoluteFilePath("/root/foo_bar/file.mp3");
+        }
+
+        auto findInDirectory{ [&](const std::filesystem::path& directory, std::size_t count, bool recursive = true) {
+            std::vector<TrackId> res;
+
+            auto transaction{ session.createReadTransaction() };
+
+            TrackId lastRetrievedTrack;
+            Track::findInDirectory(session, directory, recursive, lastRetrievedTrack, count, [&](const Track::pointer& track) { res.push_back(track->getId()); });
+            return res;
+        } };
+
+        EXPECT_EQ(findInDirectory("/root/foo", 10), (std::vector<TrackId>{ track1.getId(), track2.getId() }));
+        EXPECT_EQ(findInDirectory("/root/foo/", 10), (std::vector<TrackId>{ track1.getId(), track2.getId() }));
+        EXPECT_EQ(findInDirectory("/root/foo", 1), (std::vector<TrackId>{ track1.getId() }));
+        EXPECT_EQ(findInDirectory("/root/foo/bar", 10), (std::vector<TrackId>{ track2.getId() }));
+        EXPECT_EQ(findInDirectory("/root", 10), (std::vector<TrackId>{ track1.getId(), track2.getId(), track3.getId() }));
+        EXPECT_TRUE(findInDirectory("/root/fo", 10).empty());
+        EXPECT_TRUE(findInDirectory("/Root/foo", 10).empty()); // case sensitive
+
+        // non recursive
+        EXPECT_EQ(findInDirectory("/root/foo", 10, false), (std::vector<TrackId>{ track1.getId() }));
+        EXPECT_EQ(findInDirectory("/root/foo/", 10, false), (std::vector<TrackId>{ track1.getId() }));
+        EXPECT_EQ(findInDirectory("/root/foo/bar", 10, false), (std::vector<TrackId>{ track2.getId() }));
+        EXPECT_TRUE(findInDirectory("/root", 10, false).empty());
+    }
+
     TEST_F(DatabaseFixture, Track_audioProperties)
     {
         ScopedTrack track{ session };
@@ -366,4 +523,97 @@ namespace lms::db::tests
             EXPECT_EQ(track->getSampleRate(), 44100);
         }
     }
+
+    TEST_F(DatabaseFixture, Track_contentHash)
+    {
+        ScopedTrack track{ session };
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_FALSE(track->getContentHash().has_value());
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track.get().modify()->setContentHash(0xFBCEA83C8A378BF1ULL); // does not fit in a signed 64 bits integer
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(track->getContentHash(), 0xFBCEA83C8A378BF1ULL);
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track.get().modify()->setContentHash(std::nullopt);
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_FALSE(track->getContentHash().has_value());
+        }
+    }
+
+    TEST_F(DatabaseFixture, Track_summary)
+    {
+        ScopedTrack track1{ session };
+        ScopedTrack track2{ session };
+        ScopedRelease release{ session, "MyRelease" };
+        ScopedArtist artist{ session, "MyArtist" };
+        ScopedArtist composer{ session, "MyComposer" };
+        ScopedClusterType clusterType{ session, "GENRE" };
+        ScopedCluster cluster{ session, clusterType.lockAndGet(), "Rock" };
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_TRUE(TrackSummary::find(session, std::vector<TrackId>{}).empty());
+        }
+
+        {
+            auto transaction{ session.createWriteTransaction() };
+            track1.get().modify()->setName("MyTrack");
+            track1.get().modify()->setTrackNumber(3);
+            track1.get().modify()->setDuration(std::chrono::seconds{ 42 });
+            track1.get().modify()->setRelease(release.get());
+            track1.get().modify()->setArtistDisplayName("MyArtist");
+            TrackArtistLink::create(session, track1.get(), artist.get(), TrackArtistLinkType::Artist);
+            TrackArtistLink::create(session, track1.get(), composer.get(), TrackArtistLinkType::Composer);
+            cluster.get().modify()->addTrack(track1.get());
+        }
+
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            const std::vector<TrackId> trackIds{ track2.getId(), track1.getId(), TrackId{ track1.getId().getValue() + track2.getId().getValue() } };
+            const std::vector<TrackSummary> summaries{ TrackSummary::find(session, trackIds) };
+            ASSERT_EQ(summaries.size(), 2);
+
+            EXPECT_EQ(summaries[0].id, track2.getId());
+            EXPECT_FALSE(summaries[0].releaseId.isValid());
+            EXPECT_TRUE(summaries[0].artists.empty());
+            EXPECT_TRUE(summaries[0].clusters.empty());
+
+            const TrackSummary& summary{ summaries[1] };
+            EXPECT_EQ(summary.id, track1.getId());
+            EXPECT_EQ(summary.name, "MyTrack");
+            EXPECT_EQ(summary.trackNumber, 3);
+            EXPECT_FALSE(summary.discNumber.has_value());
+            EXPECT_EQ(summary.duration, std::chrono::seconds{ 42 });
+            EXPECT_EQ(summary.artistDisplayName, "MyArtist");
+            EXPECT_EQ(summary.releaseId, release.getId());
+            EXPECT_EQ(summary.releaseName, "MyRelease");
+
+            ASSERT_EQ(summary.artists.size(), 2);
+            EXPECT_EQ(summary.artists[0].id, artist.getId());
+            EXPECT_EQ(summary.artists[0].name, "MyArtist");
+            EXPECT_EQ(summary.artists[0].linkType, TrackArtistLinkType::Artist);
+            EXPECT_EQ(summary.getArtistIds(TrackArtistLinkType::Composer), std::vector<ArtistId>{ composer.getId() });
+            EXPECT_TRUE(summary.getArtistIds(TrackArtistLinkType::Producer).empty());
+
+            ASSERT_EQ(summary.clusters.size(), 1);
+            EXPECT_EQ(summary.clusters[0].id, cluster.getId());
+            EXPECT_EQ(summary.getClusterNames("GENRE"), std::vector<std::string_view>{ "Rock" });
+            EXPECT_TRUE(summary.getClusterNames("MOOD").empty());
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "database/TrackId.hpp"
+#include "Utils.hpp"
+
+namespace lms::db::tests
+{
+    TEST(DatabaseUtils, sampleRandomRange)
+    {
+        std::size_t callCount{};
+        const auto res{ utils::sampleRandomRange<TrackId>(1000, 10, [&](std::span<const IdType::ValueType> candidateIds)
+            {
+                callCount++;
+                return std::vector<TrackId>(std::cbegin(candidateIds), std::cend(candidateIds));
+            }) };
+
+        ASSERT_TRUE(res);
+        EXPECT_EQ(callCount, 1); // every candidate matches
+        ASSERT_EQ(res->results.size(), 10);
+        EXPECT_EQ(res->range.offset, 0);
+        EXPECT_EQ(res->range.size, 10);
+        EXPECT_TRUE(res->moreResults);
+
+        const std::set<TrackId> ids(std::cbegin(res->results), std::cend(res->results));
+        EXPECT_EQ(ids.size(), 10);
+        for (const TrackId id : ids)
+        {
+            EXPECT_GE(id.getValue(), 1);
+            EXPECT_LE(id.getValue(), 1000);
+        }
+    }
+
+    TEST(DatabaseUtils, sampleRandomRange_filtered)
+    {
+        const auto res{ utils::sampleRandomRange<TrackId>(1000, 10, [&](std::span<const IdType::ValueType> candidateIds)
+            {
+                std::vector<TrackId> matchingIds;
+                for (const IdType::ValueType id : candidateIds)
+                {
+                    if (id % 2 == 0)
+                        matchingIds.push_back(id);
+                }
+                return matchingIds;
+            }) };
+
+        ASSERT_TRUE(res);
+        ASSERT_EQ(res->results.size(), 10);
+        EXPECT_EQ(std::set<TrackId>(std::cbegin(res->results), std::cend(res->results)).size(), 10);
+        for (const TrackId id : res->results)
+            EXPECT_EQ(id.getValue() % 2, 0);
+    }
+
+    TEST(DatabaseUtils, sampleRandomRange_fallback)
+    {
+        std::size_t callCount{};
+        auto findMatchingIds{ [&](std::span<const IdType::ValueType> candidateIds)
+            {
+                callCount++;
+                std::vector<TrackId> matchingIds;
+                for (const IdType::ValueType id : candidateIds)
+                {
+                    if (id == 1)
+                        matchingIds.push_back(id);
+                }
+                return matchingIds;
+            } };
+
+        // too sparse
+        EXPECT_FALSE(utils::sampleRandomRange<TrackId>(1000, 10, findMatchingIds));
+        EXPECT_GT(callCount, 0);
+
+        // too small
+        callCount = 0;
+        EXPECT_FALSE(utils::sampleRandomRange<TrackId>(20, 10, findMatchingIds));
+        EXPECT_EQ(callCount, 0);
+    }
+}
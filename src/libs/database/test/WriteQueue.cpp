@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Common.hpp"
+
+namespace lms::db::tests
+{
+    TEST_F(DatabaseFixture, WriteQueue)
+    {
+        WriteQueue& writeQueue{ session.getDb().getWriteQueue() };
+        const WriteQueue::Stats initialStats{ writeQueue.getStats() };
+
+        constexpr std::size_t threadCount{ 4 };
+        constexpr std::size_t requestCountPerThread{ 50 };
+
+        {
+            std::vector<std::thread> threads;
+            for (std::size_t i{}; i < threadCount; ++i)
+            {
+                threads.emplace_back([&, i]
+                    {
+                        for (std::size_t j{}; j < requestCountPerThread; ++j)
+                        {
+                            writeQueue.submit([name = "MyArtist" + std::to_string(i) + "_" + std::to_string(j)](Session& writeSession)
+                                {
+                                    writeSession.create<Artist>(name);
+                                });
+                        }
+                    });
+            }
+
+            for (std::thread& thread : threads)
+                thread.join();
+        }
+
+        // failing requests must not prevent others from being committed
+        writeQueue.submit([](Session&) { throw std::runtime_error{ "failure" }; });
+        writeQueue.flush();
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Artist::getCount(session), threadCount * requestCountPerThread);
+        }
+
+        {
+            const WriteQueue::Stats stats{ writeQueue.getStats() };
+            EXPECT_EQ(stats.requestCount - initialStats.requestCount, threadCount * requestCountPerThread + 1);
+            EXPECT_GT(stats.batchCount, initialStats.batchCount);
+            EXPECT_LE(stats.batchCount - initialStats.batchCount, stats.requestCount - initialStats.requestCount);
+            EXPECT_GE(stats.maxBatchSize, 1);
+        }
+
+        writeQueue.submit([](Session& writeSession)
+            {
+                for (const ArtistId artistId : Artist::findIds(writeSession, Artist::FindParameters{}).results)
+                    Artist::find(writeSession, artistId).remove();
+            });
+        writeQueue.flush();
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Artist::getCount(session), 0);
+        }
+    }
+
+    TEST_F(DatabaseFixture, WriteQueue_failingRequestRolledBack)
+    {
+        WriteQueue& writeQueue{ session.getDb().getWriteQueue() };
+
+        // block the writer so that the following requests are processed in the same batch
+        std::promise<void> unblock;
+        writeQueue.submit([future = unblock.get_future().share()](Session&) { future.wait(); });
+
+        writeQueue.submit([](Session& writeSession) { writeSession.create<Artist>("MyArtist1"); });
+        writeQueue.submit([](Session& writeSession)
+            {
+                writeSession.create<Artist>("MyFailingArtist");
+                writeSession.getDboSession()->flush();
+                throw std::runtime_error{ "failure" };
+            });
+        writeQueue.submit([](Session& writeSession)
+            {
+                writeSession.create<Artist>("MyUnflushedFailingArtist");
+                throw std::runtime_error{ "failure" };
+            });
+        writeQueue.submit([](Session& writeSession) { writeSession.create<Artist>("MyArtist2"); });
+
+        unblock.set_value();
+        writeQueue.flush();
+
+        {
+            auto transaction{ session.createReadTransaction() };
+            EXPECT_EQ(Artist::getCount(session), 2);
+            EXPECT_EQ(Artist::find(session, "MyArtist1").size(), 1);
+            EXPECT_EQ(Artist::find(session, "MyArtist2").size(), 1);
+            EXPECT_TRUE(Artist::find(session, "MyFailingArtist").empty());
+            EXPECT_TRUE(Artist::find(session, "MyUnflushedFailingArtist").empty());
+        }
+
+        writeQueue.submit([](Session& writeSession)
+            {
+                for (const ArtistId artistId : Artist::findIds(writeSession, Artist::FindParameters{}).results)
+                    Artist::find(writeSession, artistId).remove();
+            });
+        writeQueue.flush();
+    }
+}
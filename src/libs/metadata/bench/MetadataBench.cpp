@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include <taglib/attachedpictureframe.h>
+#include <taglib/apetag.h>
+#include <taglib/flacfile.h>
+#include <taglib/flacpicture.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/mp4file.h>
+#include <taglib/mpegfile.h>
+#include <taglib/opusfile.h>
+#include <taglib/tpropertymap.h>
+#include <taglib/wavpackfile.h>
+#include <taglib/xiphcomment.h>
+
+#include "Parser.hpp"
+
+// Parser benchmarks, run on a synthetic corpus generated at startup
+// The ffmpeg binary is used to encode the audio streams: LMS_BENCH_FFMPEG=/path/to/ffmpeg bench-metadata (defaults to /usr/bin/ffmpeg)
+namespace
+{
+    std::atomic<std::size_t> allocationCount{};
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr{ std::malloc(size == 0 ? 1 : size) })
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace lms::metadata::benchs
+{
+    namespace
+    {
+        struct Format
+        {
+            const char* name;
+            const char* extension;
+            const char* ffmpegCodec;
+        };
+
+        constexpr std::array formats{
+            Format{ "mp3", "mp3", "libmp3lame" },
+            Format{ "flac", "flac", "flac" },
+            Format{ "opus", "opus", "libopus" },
+            Format{ "m4a", "m4a", "aac" },
+            Format{ "wavpack", "wv", "wavpack" },
+        };
+
+        struct Reader
+        {
+            const char* name;
+            ParserBackend backend;
+            ParserReadStyle readStyle;
+        };
+
+        constexpr std::array readers{
+            Reader{ "taglib_fast", ParserBackend::TagLib, ParserReadStyle::Fast },
+            Reader{ "taglib_average", ParserBackend::TagLib, ParserReadStyle::Average },
+            Reader{ "taglib_accurate", ParserBackend::TagLib, ParserReadStyle::Accurate },
+            Reader{ "avformat", ParserBackend::AvFormat, ParserReadStyle::Average }, // read style not used
+        };
+
+        constexpr std::size_t filesPerFormat{ 16 };
+        constexpr std::size_t durationSeconds{ 240 };
+        constexpr std::size_t coverSize{ 600 }; // pixels
+
+        std::filesystem::path getFFmpegPath()
+        {
+            const char* ffmpegPath{ std::getenv("LMS_BENCH_FFMPEG") };
+            return ffmpegPath ? ffmpegPath : "/usr/bin/ffmpeg";
+        }
+
+        bool runFFmpeg(const std::string& args)
+        {
+            const std::string command{ "\"" + getFFmpegPath().string() + "\" -hide_banner -loglevel error -y " + args };
+            return std::system(command.c_str()) == 0;
+        }
+
+        TagLib::ByteVector readFile(const std::filesystem::path& p)
+        {
+            std::ifstream ifs{ p, std::ios::binary };
+            const std::vector<char> data{ std::istreambuf_iterator<char>{ ifs }, std::istreambuf_iterator<char>{} };
+
+            return TagLib::ByteVector{ data.data(), static_cast<unsigned int>(data.size()) };
+        }
+
+        // Tag counts and layout close to what MusicBrainz Picard writes
+        TagLib::PropertyMap createProperties(std::size_t index)
+        {
+            const std::string suffix{ std::to_string(index) };
+
+            TagLib::PropertyMap properties;
+            auto add{ [&](const char* key, std::initializer_list<std::string> values) {
+                TagLib::StringList list;
+                for (const std::string& value : values)
+                    list.append(TagLib::String{ value, TagLib::String::UTF8 });
+                properties.insert(key, list);
+            } };
+
+            add("TITLE", { "My Track Title " + suffix });
+            add("ALBUM", { "My Album Title" });
+            add("ARTIST", { "Artist A feat. Artist B & Artist C" });
+            add("ARTISTS", { "Artist A", "Artist B", "Artist C" });
+            add("ARTISTSORT", { "A, Artist feat. B, Artist & C, Artist" });
+            add("ALBUMARTIST", { "Artist A" });
+            add("ALBUMARTISTSORT", { "A, Artist" });
+            add("COMPOSER", { "Composer A", "Composer B" });
+            add("LYRICIST", { "Lyricist A" });
+            add("PRODUCER", { "Producer A", "Producer B" });
+            add("CONDUCTOR", { "Conductor A" });
+            add("REMIXER", { "Remixer A" });
+            add("GENRE", { "Rock", "Alternative Rock", "Indie" });
+            add("MOOD", { "Energetic" });
+            add("LABEL", { "My Label" });
+            add("LANGUAGE", { "eng" });
+            add("DATE", { "2019-05-17" });
+            add("ORIGINALDATE", { "2018-11-02" });
+            add("TRACKNUMBER", { std::to_string(index + 1) });
+            add("TRACKTOTAL", { std::to_string(filesPerFormat) });
+            add("DISCNUMBER", { "1" });
+            add("DISCTOTAL", { "1" });
+            add("MEDIA", { "Digital Media" });
+            add("RELEASETYPE", { "album" });
+            add("MUSICBRAINZ_TRACKID", { "a7f3b3b3-1a5b-4c83-bd6a-" + std::string(12 - suffix.size(), '0') + suffix });
+            add("MUSICBRAINZ_RELEASETRACKID", { "0f1c1c6c-6d1e-4f1a-9d54-5a9c4e1b2d3f" });
+            add("MUSICBRAINZ_ALBUMID", { "8e0e1b8a-8d3b-4f1e-b8a7-7c7c2a2b5f1d" });
+            add("MUSICBRAINZ_RELEASEGROUPID", { "3c1e4f5a-2b7d-4e1f-9a8b-6d5c4b3a2f1e" });
+            add("MUSICBRAINZ_ARTISTID", { "5b11f4ce-a62d-471e-81fc-a69a8278c7da", "6c22f4ce-a62d-471e-81fc-a69a8278c7db", "7d33f4ce-a62d-471e-81fc-a69a8278c7dc" });
+            add("MUSICBRAINZ_ALBUMARTISTID", { "5b11f4ce-a62d-471e-81fc-a69a8278c7da" });
+            add("ACOUSTID_ID", { "e987a441-e134-4960-8019-274eddacc418" });
+            add("REPLAYGAIN_TRACK_GAIN", { "-7.89 dB" });
+            add("REPLAYGAIN_ALBUM_GAIN", { "-8.12 dB" });
+            add("COPYRIGHT", { "2019 My Label" });
+
+            return properties;
+        }
+
+        TagLib::FLAC::Picture* createFlacPicture(const TagLib::ByteVector& cover)
+        {
+            auto* picture{ new TagLib::FLAC::Picture };
+            picture->setType(TagLib::FLAC::Picture::FrontCover);
+            picture->setMimeType("image/jpeg");
+            picture->setData(cover);
+            picture->setWidth(coverSize);
+            picture->setHeight(coverSize);
+            return picture;
+        }
+
+        bool tagFile(const std::filesystem::path& p, std::string_view formatName, const TagLib::PropertyMap& properties, const TagLib::ByteVector& cover)
+        {
+            const TagLib::FileName fileName{ p.c_str() };
+
+            if (formatName == "mp3")
+            {
+                TagLib::MPEG::File file{ fileName };
+                file.setProperties(properties);
+                auto* frame{ new TagLib::ID3v2::AttachedPictureFrame };
+                frame->setType(TagLib::ID3v2::AttachedPictureFrame::FrontCover);
+                frame->setMimeType("image/jpeg");
+                frame->setPicture(cover);
+                file.ID3v2Tag(true)->addFrame(frame);
+                return file.save();
+            }
+            if (formatName == "flac")
+            {
+                TagLib::FLAC::File file{ fileName };
+                file.setProperties(properties);
+                file.addPicture(createFlacPicture(cover));
+                return file.save();
+            }
+            if (formatName == "opus")
+            {
+                TagLib::Ogg::Opus::File file{ fileName };
+                file.setProperties(properties);
+                file.tag()->addPicture(createFlacPicture(cover));
+                return file.save();
+            }
+            if (formatName == "m4a")
+            {
+                TagLib::MP4::File file{ fileName };
+                file.setProperties(properties);
+                TagLib::MP4::CoverArtList covers;
+                covers.append(TagLib::MP4::CoverArt{ TagLib::MP4::CoverArt::JPEG, cover });
+                file.tag()->setItem("covr", covers);
+                return file.save();
+            }
+            if (formatName == "wavpack")
+            {
+                TagLib::WavPack::File file{ fileName };
+                file.setProperties(properties);
+                file.APETag(true)->setData("Cover Art (Front)", TagLib::ByteVector{ "cover.jpg", 10 /* with trailing nul */ } + cover);
+                return file.save();
+            }
+
+            return false;
+        }
+
+        class Corpus
+        {
+        public:
+            Corpus()
+                : _directory{ std::filesystem::temp_directory_path() / ("lms-bench-metadata-" + std::to_string(std::random_device{}())) }
+            {
+                std::filesystem::create_directories(_directory);
+                _valid = generate();
+            }
+
+            ~Corpus()
+            {
+                std::error_code ec;
+                std::filesystem::remove_all(_directory, ec);
+            }
+
+            bool isValid() const { return _valid; }
+            const std::vector<std::filesystem::path>& getFiles(std::size_t formatIndex) const { return _files[formatIndex]; }
+
+        private:
+            Corpus(const Corpus&) = delete;
+            Corpus& operator=(const Corpus&) = delete;
+
+            bool generate()
+            {
+                const std::filesystem::path coverPath{ _directory / "cover.jpg" };
+                if (!runFFmpeg("-f lavfi -i \"testsrc=size=" + std::to_string(coverSize) + "x" + std::to_string(coverSize) + "\" -frames:v 1 \"" + coverPath.string() + "\""))
+                    return false;
+
+                const TagLib::ByteVector cover{ readFile(coverPath) };
+
+                for (std::size_t formatIndex{}; formatIndex < formats.size(); ++formatIndex)
+                {
+                    const Format& format{ formats[formatIndex] };
+
+                    // encode once, then copy and tag each file differently
+                    const std::filesystem::path encodedPath{ _directory / (std::string{ "encoded." } + format.extension) };
+                    if (!runFFmpeg("-f lavfi -i \"sine=frequency=440:sample_rate=44100:duration=" + std::to_string(durationSeconds) + "\" -ac 2 -c:a " + format.ffmpegCodec + " \"" + encodedPath.string() + "\""))
+                        return false;
+
+                    for (std::size_t i{}; i < filesPerFormat; ++i)
+                    {
+                        const std::filesystem::path p{ _directory / (std::string{ format.name } + "_" + std::to_string(i) + "." + format.extension) };
+                        std::filesystem::copy_file(encodedPath, p, std::filesystem::copy_options::overwrite_existing);
+                        if (!tagFile(p, format.name, createProperties(i), cover))
+                            return false;
+
+                        _files[formatIndex].push_back(p);
+                    }
+                }
+
+                return true;
+            }
+
+            const std::filesystem::path _directory;
+            std::array<std::vector<std::filesystem::path>, formats.size()> _files;
+            bool _valid{};
+        };
+
+        const Corpus& getCorpus()
+        {
+            static const Corpus corpus;
+            return corpus;
+        }
+    }
+
+    static void BM_Parser_parse(benchmark::State& state)
+    {
+        const Corpus& corpus{ getCorpus() };
+        if (!corpus.isValid())
+        {
+            state.SkipWithError("Cannot generate corpus, check LMS_BENCH_FFMPEG");
+            return;
+        }
+
+        const Format& format{ formats[state.range(0)] };
+        const Reader& reader{ readers[state.range(1)] };
+        state.SetLabel(std::string{ format.name } + "/" + reader.name);
+
+        const std::vector<std::filesystem::path>& files{ corpus.getFiles(state.range(0)) };
+        Parser parser{ reader.backend, reader.readStyle };
+
+        std::size_t fileIndex{};
+        const std::size_t allocationCountBefore{ allocationCount.load(std::memory_order_relaxed) };
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(parser.parse(files[fileIndex]));
+            fileIndex = (fileIndex + 1) % files.size();
+        }
+        const std::size_t allocationCountAfter{ allocationCount.load(std::memory_order_relaxed) };
+
+        state.counters["files_per_second"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+        state.counters["allocs_per_file"] = benchmark::Counter(static_cast<double>(allocationCountAfter - allocationCountBefore), benchmark::Counter::kAvgIterations);
+    }
+
+    // Args: format index, reader index
+    BENCHMARK(BM_Parser_parse)->ArgsProduct({ benchmark::CreateDenseRange(0, formats.size() - 1, 1), benchmark::CreateDenseRange(0, readers.size() - 1, 1) })->ArgNames({ "format", "reader" })->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK_MAIN();
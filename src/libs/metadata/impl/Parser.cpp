@@ -28,6 +28,7 @@
 #include "AvFormatTagReader.hpp"
 #include "TagLibTagReader.hpp"
 #include "Utils.hpp"
+#include "XiphTagReader.hpp"
 
 namespace lms::metadata
 {
@@ -212,7 +213,10 @@ namespace lms::metadata
             switch (_parserBackend)
             {
             case ParserBackend::TagLib:
-                tagReader = std::make_unique<TagLibTagReader>(p, _readStyle, debug);
+                // Native FLAC/Ogg files are handled without TagLib, this is way cheaper
+                tagReader = XiphTagReader::create(p, debug);
+                if (!tagReader)
+                    tagReader = std::make_unique<TagLibTagReader>(p, _readStyle, debug);
                 break;
 
             case ParserBackend::AvFormat:
@@ -19,8 +19,6 @@
 
 #include "TagLibTagReader.hpp"
 
-#include <unordered_map>
-
 #include <taglib/apeproperties.h>
 #include <taglib/apetag.h>
 #include <taglib/asffile.h>
@@ -44,118 +42,14 @@
 #include "core/ITraceLogger.hpp"
 #include "core/String.hpp"
 
+#include "TagMapping.hpp"
+
 namespace lms::metadata
 {
     namespace
     {
         class ParsingFailedException : public Exception {};
 
-        // Mapping to internal taglib names and/or common alternative custom names
-        static const std::unordered_map<TagType, std::vector<std::string>> tagMapping
-        {
-            { TagType::AcoustID, { "ACOUSTID_ID", "ACOUSTID ID" } },
-            { TagType::Album, { "ALBUM" } },
-            { TagType::AlbumArtist, { "ALBUMARTIST" } },
-            { TagType::AlbumArtistSortOrder, { "ALBUMARTISTSORT" } },
-            { TagType::AlbumArtists, { "ALBUMARTISTS" } },
-            { TagType::AlbumArtistsSortOrder, { "ALBUMARTISTSSORT" } },
-            { TagType::AlbumSortOrder, { "ALBUMSORT" } },
-            { TagType::Arranger, { "ARRANGER" } },
-            { TagType::Artist, { "ARTIST" } },
-            { TagType::ArtistSortOrder, { "ARTISTSORT" } },
-            { TagType::Artists, { "ARTISTS" } },
-            { TagType::ASIN, { "ASIN" } },
-            { TagType::Barcode, { "BARCODE" } },
-            { TagType::BPM, { "BPM" } },
-            { TagType::CatalogNumber, { "CATALOGNUMBER" } },
-            { TagType::Comment, { "COMMENT" } },
-            { TagType::Compilation, { "COMPILATION" } },
-            { TagType::Composer, { "COMPOSER" } },
-            { TagType::Composers, { "COMPOSERS" } },
-            { TagType::ComposerSortOrder, { "COMPOSERSORT" } },
-            { TagType::ComposersSortOrder, { "COMPOSERSSORT" } },
-            { TagType::Conductor, { "CONDUCTOR" } },
-            { TagType::ConductorSortOrder, { "CONDUCTORSORT" } },
-            { TagType::Conductors, { "CONDUCTORS" } },
-            { TagType::ConductorsSortOrder, { "CONDUCTORSSORT" } },
-            { TagType::Copyright, { "COPYRIGHT" } },
-            { TagType::CopyrightURL, { "COPYRIGHTURL" } },
-            { TagType::Date, { "DATE", "YEAR" } },
-            { TagType::Director, { "DIRECTOR" } },
-            { TagType::DiscNumber, { "DISCNUMBER", "DISC" } },
-            { TagType::DiscSubtitle, { "DISCSUBTITLE", "SETSUBTITLE" } },
-            { TagType::EncodedBy, { "ENCODEDBY" } },
-            { TagType::Engineer, { "ENGINEER" } },
-            { TagType::GaplessPlayback, { "GAPLESSPLAYBACK" } },
-            { TagType::Genre, { "GENRE" } },
-            { TagType::Grouping, { "GROUPING", "ALBUMGROUPING" } },
-            { TagType::InitialKey, { "INITIALKEY" } },
-            { TagType::ISRC, { "ISRC" } },
-            { TagType::Language, { "LANGUAGE" } },
-            { TagType::License, { "LICENSE" } },
-            { TagType::Lyricist, { "LYRICIST" } },
-            { TagType::LyricistSortOrder, { "LYRICISTSORT" } },
-            { TagType::Lyricists, { "LYRICISTS" } },
-            { TagType::LyricistsSortOrder, { "LYRICISTSSORT" } },
-            { TagType::Lyrics, { "LYRICS" } },
-            { TagType::Media, { "MEDIA" } },
-            { TagType::MixDJ, { "DJMIXER" } },
-            { TagType::Mixer, { "MIXER" } },
-            { TagType::MixerSortOrder, { "MIXERSORT" } },
-            { TagType::Mixers, { "MIXERS" } },
-            { TagType::MixersSortOrder, { "MIXERSSORT" } },
-            { TagType::Mood, { "MOOD" } },
-            { TagType::Movement, { "MOVEMENT", "MOVEMENTNAME" } },
-            { TagType::MovementCount, { "MOVEMENTCOUNT" } },
-            { TagType::MovementNumber, { "MOVEMENTNUMBER" } },
-            { TagType::MusicBrainzArtistID, { "MUSICBRAINZ_ARTISTID", "MUSICBRAINZ ARTIST ID", "MUSICBRAINZ/ARTIST ID" } },
-            { TagType::MusicBrainzDiscID, { "MUSICBRAINZ_DISCID", "MUSICBRAINZ DISC ID", "MUSICBRAINZ/DISC ID" } },
-            { TagType::MusicBrainzOriginalArtistID, { "MUSICBRAINZ_ORIGINALARTISTID", "MUSICBRAINZ ORIGINAL ARTIST ID", "MUSICBRAINZ/ORIGINAL ARTIST ID" } },
-            { TagType::MusicBrainzOriginalReleaseID, { "MUSICBRAINZ_ORIGINALRELEASEID", "MUSICBRAINZ ORIGINAL RELEASE ID", "MUSICBRAINZ/ORIGINAL RELEASE ID" } },
-            { TagType::MusicBrainzRecordingID, { "MUSICBRAINZ_TRACKID", "MUSICBRAINZ TRACK ID", "MUSICBRAINZ/TRACK ID" } },
-            { TagType::MusicBrainzReleaseArtistID, { "MUSICBRAINZ_ALBUMARTISTID", "MUSICBRAINZ ALBUM ARTIST ID", "MUSICBRAINZ/ALBUM ARTIST ID" } },
-            { TagType::MusicBrainzReleaseGroupID, { "MUSICBRAINZ_RELEASEGROUPID", "MUSICBRAINZ RELEASE GROUP ID", "MUSICBRAINZ/RELEASE GROUP ID" } },
-            { TagType::MusicBrainzReleaseID, { "MUSICBRAINZ_ALBUMID", "MUSICBRAINZ ALBUM ID", "MUSICBRAINZ/ALBUM ID" } },
-            { TagType::MusicBrainzTrackID, { "MUSICBRAINZ_RELEASETRACKID", "MUSICBRAINZ RELEASE TRACK ID", "MUSICBRAINZ/RELEASE TRACK ID" } },
-            { TagType::MusicBrainzWorkID, { "MUSICBRAINZ_WORKID", "MUSICBRAINZ WORK ID", "MUSICBRAINZ/WORK ID" } },
-            { TagType::OriginalArtist, { "ORIGINALARTIST" } },
-            { TagType::OriginalFilename, { "ORIGINALFILENAME" } },
-            { TagType::OriginalReleaseDate, { "ORIGINALDATE" } },
-            { TagType::OriginalReleaseYear, { "ORIGINALYEAR" } },
-            { TagType::Podcast, { "PODCAST" } },
-            { TagType::PodcastURL, { "PODCASTURL" } },
-            { TagType::Producer, { "PRODUCER" } },
-            { TagType::ProducerSortOrder, { "PRODUCERSORTORDER" } },
-            { TagType::Producers, { "PRODUCERS" } },
-            { TagType::ProducersSortOrder, { "PRODUCERSSORTORDER" } },
-            { TagType::RecordLabel, { "LABEL" } },
-            { TagType::ReleaseCountry, { "RELEASECOUNTRY" } },
-            { TagType::ReleaseDate, { "RELEASEDATE" } },
-            { TagType::ReleaseStatus, { "RELEASESTATUS" } },
-            { TagType::ReleaseType, { "RELEASETYPE", "MUSICBRAINZ_ALBUMTYPE", "MUSICBRAINZ ALBUM TYPE", "MUSICBRAINZ/ALBUM TYPE" } },
-            { TagType::Remixer, { "REMIXER", "MODIFIEDBY", "MIXARTIST" } },
-            { TagType::RemixerSortOrder, { "REMIXERSORTORDER", "MIXARTISTSORTORDER" } },
-            { TagType::Remixers, { "REMIXERS" } },
-            { TagType::RemixersSortOrder, { "REMIXERSSORTORDER", "MIXARTISTSSORTORDER" } },
-            { TagType::ReplayGainAlbumGain, { "REPLAYGAIN_ALBUM_GAIN" } },
-            { TagType::ReplayGainAlbumPeak, { "REPLAYGAIN_ALBUM_PEAK" } },
-            { TagType::ReplayGainAlbumRange, { "REPLAYGAIN_ALBUM_RANGE" } },
-            { TagType::ReplayGainReferenceLoudness, { "REPLAYGAIN_REFERENCE_LOUDNESS" } },
-            { TagType::ReplayGainTrackGain, { "REPLAYGAIN_TRACK_GAIN" } },
-            { TagType::ReplayGainTrackPeak, { "REPLAYGAIN_TRACK_PEAK" } },
-            { TagType::ReplayGainTrackRange, { "REPLAYGAIN_TRACK_RANGE" } },
-            { TagType::Script, { "SCRIPT" } },
-            { TagType::ShowWorkAndMovement, { "SHOWWORKMOVEMENT", "SHOWMOVEMENT" } },
-            { TagType::Subtitle, { "SUBTITLE" } },
-            { TagType::TotalDiscs, { "DISCTOTAL", "TOTALDISCS"} },
-            { TagType::TotalTracks, { "TRACKTOTAL", "TOTALTRACKS" } },
-            { TagType::TrackNumber, { "TRACKNUMBER" } },
-            { TagType::TrackTitle, { "TITLE" } },
-            { TagType::TrackTitleSortOrder, { "TITLESORT" } },
-            { TagType::WorkTitle, { "WORK" } },
-            { TagType::Writer, { "WRITER" } },
-        };
-
         TagLib::AudioProperties::ReadStyle readStyleToTagLibReadStyle(ParserReadStyle readStyle)
         {
             switch (readStyle)
@@ -339,11 +233,7 @@ namespace lms::metadata
 
     void TagLibTagReader::visitTagValues(TagType tag, TagValueVisitor visitor) const
     {
-        auto itTagNames{ tagMapping.find(tag) };
-        if (itTagNames == std::cend(tagMapping))
-            return;
-
-        for (const std::string& tagName : itTagNames->second)
+        for (const std::string& tagName : getTagNames(tag))
         {
             bool visited{};
 
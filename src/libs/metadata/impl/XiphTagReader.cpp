@@ -0,0 +1,526 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "XiphTagReader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+#include "core/String.hpp"
+
+#include "TagMapping.hpp"
+
+namespace lms::metadata
+{
+    namespace
+    {
+        // The file cannot be handled by this reader (unexpected layout, truncated data, etc.)
+        class UnsupportedFileException {};
+
+        // Guard against huge allocations on corrupted files
+        constexpr std::size_t maxMetadataSize{ 64 * 1024 * 1024 };
+
+        std::uint16_t readLE16(std::string_view data, std::size_t offset)
+        {
+            return static_cast<std::uint16_t>(static_cast<std::uint8_t>(data[offset]))
+                | static_cast<std::uint16_t>(static_cast<std::uint8_t>(data[offset + 1])) << 8;
+        }
+
+        std::uint32_t readLE32(std::string_view data, std::size_t offset)
+        {
+            return static_cast<std::uint32_t>(readLE16(data, offset))
+                | static_cast<std::uint32_t>(readLE16(data, offset + 2)) << 16;
+        }
+
+        std::uint64_t readLE64(std::string_view data, std::size_t offset)
+        {
+            return static_cast<std::uint64_t>(readLE32(data, offset))
+                | static_cast<std::uint64_t>(readLE32(data, offset + 4)) << 32;
+        }
+
+        std::uint32_t readBE24(std::string_view data, std::size_t offset)
+        {
+            return static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[offset])) << 16
+                | static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[offset + 1])) << 8
+                | static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[offset + 2]));
+        }
+
+        class FileReader
+        {
+        public:
+            FileReader(const std::filesystem::path& p)
+                : _stream{ p, std::ios::binary }
+            {
+                if (!_stream)
+                    throw UnsupportedFileException{};
+
+                _stream.seekg(0, std::ios::end);
+                _fileSize = static_cast<std::uint64_t>(_stream.tellg());
+                _stream.seekg(0, std::ios::beg);
+            }
+
+            std::uint64_t getFileSize() const { return _fileSize; }
+            std::uint64_t getOffset() { return static_cast<std::uint64_t>(_stream.tellg()); }
+
+            void seek(std::uint64_t offset)
+            {
+                if (offset > _fileSize)
+                    throw UnsupportedFileException{};
+
+                _stream.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+            }
+
+            void skip(std::uint64_t size)
+            {
+                seek(getOffset() + size);
+            }
+
+            void read(char* dst, std::size_t size)
+            {
+                if (!_stream.read(dst, static_cast<std::streamsize>(size)))
+                    throw UnsupportedFileException{};
+            }
+
+            void append(std::string& dst, std::size_t size)
+            {
+                if (dst.size() + size > maxMetadataSize)
+                    throw UnsupportedFileException{};
+
+                const std::size_t prevSize{ dst.size() };
+                dst.resize(prevSize + size);
+                read(dst.data() + prevSize, size);
+            }
+
+            std::string read(std::size_t size)
+            {
+                std::string res;
+                append(res, size);
+                return res;
+            }
+
+        private:
+            std::ifstream _stream;
+            std::uint64_t _fileSize{};
+        };
+
+        struct ParsedFile
+        {
+            std::string commentData;
+            std::size_t commentOffset{}; // where the vorbis comment starts in commentData
+            AudioProperties audioProperties;
+            bool hasEmbeddedCover{};
+        };
+
+        // Same computation as TagLib to get consistent results between both readers
+        void setDurationAndBitrate(AudioProperties& audioProperties, std::uint64_t frameCount, std::size_t sampleRate, std::uint64_t streamLength)
+        {
+            if (frameCount == 0 || sampleRate == 0)
+                return;
+
+            const double lengthMs{ static_cast<double>(frameCount) * 1000.0 / static_cast<double>(sampleRate) };
+            audioProperties.duration = std::chrono::milliseconds{ static_cast<std::chrono::milliseconds::rep>(lengthMs + 0.5) };
+            audioProperties.bitrate = static_cast<std::size_t>(static_cast<double>(streamLength) * 8.0 / lengthMs + 0.5) * 1000;
+        }
+
+        ParsedFile parseFlac(FileReader& reader)
+        {
+            enum BlockType : std::uint8_t
+            {
+                StreamInfo = 0,
+                VorbisComment = 4,
+                Picture = 6,
+                Invalid = 127,
+            };
+
+            // files with leading ID3v2 tags are left to TagLib
+            if (reader.read(4) != "fLaC")
+                throw UnsupportedFileException{};
+
+            ParsedFile res;
+            bool streamInfoFound{};
+            bool commentFound{};
+            std::uint64_t frameCount{};
+
+            bool isLastBlock{};
+            while (!isLastBlock)
+            {
+                const std::string header{ reader.read(4) };
+                isLastBlock = (static_cast<std::uint8_t>(header[0]) & 0x80) != 0;
+                const std::uint8_t blockType = static_cast<std::uint8_t>(header[0]) & 0x7F;
+                const std::uint32_t blockLength{ readBE24(header, 1) };
+
+                switch (blockType)
+                {
+                case BlockType::StreamInfo:
+                {
+                    if (streamInfoFound || blockLength < 34)
+                        throw UnsupportedFileException{};
+
+                    const std::string streamInfo{ reader.read(blockLength) };
+                    const auto byteAt{ [&](std::size_t offset) { return static_cast<std::uint64_t>(static_cast<std::uint8_t>(streamInfo[offset])); } };
+
+                    // 20 bits sample rate, 3 bits channel count - 1, 5 bits bits per sample - 1, 36 bits total samples
+                    res.audioProperties.sampleRate = static_cast<std::size_t>((byteAt(10) << 12) | (byteAt(11) << 4) | (byteAt(12) >> 4));
+                    res.audioProperties.channelCount = static_cast<std::size_t>(((byteAt(12) >> 1) & 0x07) + 1);
+                    res.audioProperties.bitsPerSample = static_cast<std::size_t>((((byteAt(12) & 0x01) << 4) | (byteAt(13) >> 4)) + 1);
+                    frameCount = ((byteAt(13) & 0x0F) << 32) | (byteAt(14) << 24) | (byteAt(15) << 16) | (byteAt(16) << 8) | byteAt(17);
+                    streamInfoFound = true;
+                    break;
+                }
+
+                case BlockType::VorbisComment:
+                    // only the first comment block is taken into account, as TagLib does
+                    if (!commentFound)
+                    {
+                        res.commentData = reader.read(blockLength);
+                        commentFound = true;
+                    }
+                    else
+                        reader.skip(blockLength);
+                    break;
+
+                case BlockType::Picture:
+                    res.hasEmbeddedCover = true;
+                    reader.skip(blockLength);
+                    break;
+
+                case BlockType::Invalid:
+                    throw UnsupportedFileException{};
+
+                default:
+                    reader.skip(blockLength);
+                    break;
+                }
+            }
+
+            if (!streamInfoFound)
+                throw UnsupportedFileException{};
+
+            setDurationAndBitrate(res.audioProperties, frameCount, res.audioProperties.sampleRate, reader.getFileSize() - reader.getOffset());
+
+            return res;
+        }
+
+        // Reassembles the packets of a single logical stream
+        class OggPacketReader
+        {
+        public:
+            OggPacketReader(FileReader& reader)
+                : _reader{ reader }
+            {
+            }
+
+            std::uint32_t getSerialNumber() const { return _serialNumber; }
+            std::int64_t getFirstGranulePosition() const { return _firstGranulePosition; }
+
+            std::string readPacket()
+            {
+                std::string packet;
+
+                while (true)
+                {
+                    if (_segmentIndex == _segmentCount)
+                        readPageHeader();
+
+                    // read all the consecutive segments of this packet in the current page at once
+                    std::size_t size{};
+                    bool packetComplete{};
+                    while (_segmentIndex < _segmentCount && !packetComplete)
+                    {
+                        const std::uint8_t segmentSize{ _segmentTable[_segmentIndex++] };
+                        size += segmentSize;
+                        packetComplete = segmentSize < 255;
+                    }
+                    _reader.append(packet, size);
+
+                    if (packetComplete)
+                        return packet;
+                }
+            }
+
+        private:
+            void readPageHeader()
+            {
+                const std::string header{ _reader.read(27) };
+                if (!header.starts_with("OggS") || header[4] != 0)
+                    throw UnsupportedFileException{};
+
+                const bool firstPage{ _pageCount++ == 0 };
+                const std::uint32_t serialNumber{ readLE32(header, 14) };
+                if (firstPage)
+                {
+                    _serialNumber = serialNumber;
+                    _firstGranulePosition = static_cast<std::int64_t>(readLE64(header, 6));
+                }
+                else if (serialNumber != _serialNumber) // multiplexed streams are left to TagLib
+                    throw UnsupportedFileException{};
+
+                _segmentCount = static_cast<std::uint8_t>(header[26]);
+                _segmentIndex = 0;
+                _reader.read(reinterpret_cast<char*>(_segmentTable.data()), _segmentCount);
+            }
+
+            FileReader& _reader;
+            std::size_t _pageCount{};
+            std::uint32_t _serialNumber{};
+            std::int64_t _firstGranulePosition{};
+            std::array<std::uint8_t, 255> _segmentTable;
+            std::size_t _segmentCount{};
+            std::size_t _segmentIndex{};
+        };
+
+        std::optional<std::int64_t> findLastGranulePosition(FileReader& reader, std::uint32_t serialNumber)
+        {
+            // the last page necessarily starts in the last max page size bytes
+            constexpr std::uint64_t maxPageSize{ 27 + 255 + 255 * 255 };
+            const std::uint64_t tailSize{ std::min(reader.getFileSize(), maxPageSize) };
+
+            reader.seek(reader.getFileSize() - tailSize);
+            const std::string tail{ reader.read(static_cast<std::size_t>(tailSize)) };
+
+            for (std::size_t pos{ tail.rfind("OggS") }; pos != std::string::npos; pos = (pos == 0 ? std::string::npos : tail.rfind("OggS", pos - 1)))
+            {
+                if (tail.size() - pos < 27 || readLE32(tail, pos + 14) != serialNumber)
+                    continue;
+
+                return static_cast<std::int64_t>(readLE64(tail, pos + 6));
+            }
+
+            return std::nullopt;
+        }
+
+        ParsedFile parseOgg(FileReader& reader)
+        {
+            using namespace std::string_view_literals;
+
+            ParsedFile res;
+
+            OggPacketReader packetReader{ reader };
+            const std::string identification{ packetReader.readPacket() };
+
+            std::uint64_t headersSize{ identification.size() };
+            std::size_t sampleRate{};
+            std::uint64_t preSkip{};
+            std::size_t nominalBitrate{};
+
+            if (identification.starts_with("OpusHead"sv))
+            {
+                if (identification.size() < 19)
+                    throw UnsupportedFileException{};
+
+                res.audioProperties.channelCount = static_cast<std::uint8_t>(identification[9]);
+                preSkip = readLE16(identification, 10);
+                sampleRate = 48000; // opus always decodes at 48kHz
+
+                res.commentData = packetReader.readPacket();
+                if (!res.commentData.starts_with("OpusTags"sv))
+                    throw UnsupportedFileException{};
+                res.commentOffset = 8;
+                headersSize += res.commentData.size();
+            }
+            else if (identification.starts_with("\x01vorbis"sv))
+            {
+                if (identification.size() < 30)
+                    throw UnsupportedFileException{};
+
+                res.audioProperties.channelCount = static_cast<std::uint8_t>(identification[11]);
+                sampleRate = readLE32(identification, 12);
+                const std::int32_t bitrate{ static_cast<std::int32_t>(readLE32(identification, 20)) };
+                if (bitrate > 0)
+                    nominalBitrate = static_cast<std::size_t>(bitrate);
+
+                res.commentData = packetReader.readPacket();
+                if (!res.commentData.starts_with("\x03vorbis"sv))
+                    throw UnsupportedFileException{};
+                res.commentOffset = 7;
+                headersSize += res.commentData.size();
+
+                // setup header, only needed to compute the bitrate the same way TagLib does
+                headersSize += packetReader.readPacket().size();
+            }
+            else
+                throw UnsupportedFileException{};
+
+            res.audioProperties.sampleRate = sampleRate;
+
+            const std::int64_t start{ packetReader.getFirstGranulePosition() };
+            const std::optional<std::int64_t> end{ findLastGranulePosition(reader, packetReader.getSerialNumber()) };
+            if (start >= 0 && end && *end >= 0 && static_cast<std::uint64_t>(*end - start) > preSkip && reader.getFileSize() > headersSize)
+                setDurationAndBitrate(res.audioProperties, static_cast<std::uint64_t>(*end - start) - preSkip, sampleRate, reader.getFileSize() - headersSize);
+
+            if (res.audioProperties.bitrate == 0 && nominalBitrate > 0)
+                res.audioProperties.bitrate = static_cast<std::size_t>(nominalBitrate / 1000.0 + 0.5) * 1000;
+
+            return res;
+        }
+
+        std::optional<ParsedFile> parseFile(const std::filesystem::path& p)
+        {
+            LMS_SCOPED_TRACE_DETAILED("MetaData", "XiphParseFile");
+
+            const std::string extension{ core::stringUtils::stringToLower(p.extension().string()) };
+            const bool isFlac{ extension == ".flac" };
+            const bool isOgg{ extension == ".ogg" || extension == ".oga" || extension == ".opus" };
+            if (!isFlac && !isOgg)
+                return std::nullopt;
+
+            try
+            {
+                FileReader reader{ p };
+                return isFlac ? parseFlac(reader) : parseOgg(reader);
+            }
+            catch (const UnsupportedFileException&)
+            {
+                LMS_LOG(METADATA, DEBUG, "File '" << p.string() << "': not handled by the Xiph reader");
+                return std::nullopt;
+            }
+        }
+    }
+
+    std::unique_ptr<XiphTagReader> XiphTagReader::create(const std::filesystem::path& p, bool debug)
+    {
+        std::optional<ParsedFile> parsedFile{ parseFile(p) };
+        if (!parsedFile)
+            return nullptr;
+
+        std::unique_ptr<XiphTagReader> tagReader{ new XiphTagReader };
+        tagReader->_audioProperties = parsedFile->audioProperties;
+        tagReader->_hasEmbeddedCover = parsedFile->hasEmbeddedCover;
+        tagReader->_commentData = std::move(parsedFile->commentData);
+
+        try
+        {
+            tagReader->parseComments(std::string_view{ tagReader->_commentData }.substr(parsedFile->commentOffset));
+        }
+        catch (const UnsupportedFileException&)
+        {
+            LMS_LOG(METADATA, DEBUG, "File '" << p.string() << "': cannot parse vorbis comments");
+            return nullptr;
+        }
+
+        if (debug && core::Service<core::logging::ILogger>::get()->isSeverityActive(core::logging::Severity::DEBUG))
+        {
+            for (const auto& [key, values] : tagReader->_tags)
+            {
+                for (std::string_view value : values)
+                    LMS_LOG(METADATA, DEBUG, "Key = '" << key << "', value = '" << value << "'");
+            }
+        }
+
+        return tagReader;
+    }
+
+    void XiphTagReader::parseComments(std::string_view comments)
+    {
+        // little endian length prefixed strings: vendor string, field count, then "KEY=value" fields
+        std::size_t offset{};
+        auto readLength{ [&]
+        {
+            if (comments.size() - offset < 4)
+                throw UnsupportedFileException{};
+
+            const std::uint32_t length{ readLE32(comments, offset) };
+            offset += 4;
+            return length;
+        } };
+        auto readString{ [&]
+        {
+            const std::uint32_t length{ readLength() };
+            if (comments.size() - offset < length)
+                throw UnsupportedFileException{};
+
+            const std::string_view str{ comments.substr(offset, length) };
+            offset += length;
+            return str;
+        } };
+
+        if (comments.empty()) // FLAC files may not have any comment block
+            return;
+
+        readString(); // vendor
+        const std::uint32_t fieldCount{ readLength() };
+        for (std::uint32_t i{}; i < fieldCount; ++i)
+        {
+            const std::string_view field{ readString() };
+            const std::size_t separatorPos{ field.find('=') };
+            if (separatorPos == std::string_view::npos || separatorPos == 0)
+                continue;
+
+            std::string key{ core::stringUtils::stringToUpper(std::string{ field.substr(0, separatorPos) }) };
+            if (key == "METADATA_BLOCK_PICTURE" || key == "COVERART")
+            {
+                _hasEmbeddedCover = true;
+                continue;
+            }
+
+            _tags[std::move(key)].push_back(field.substr(separatorPos + 1));
+        }
+    }
+
+    void XiphTagReader::visitTagValues(TagType tag, TagValueVisitor visitor) const
+    {
+        for (const std::string& tagName : getTagNames(tag))
+        {
+            bool visited{};
+
+            visitTagValues(tagName, [&](std::string_view value)
+                {
+                    visited = true;
+                    visitor(value);
+                });
+
+            if (visited)
+                break;
+        }
+    }
+
+    void XiphTagReader::visitTagValues(std::string_view tag, TagValueVisitor visitor) const
+    {
+        auto itValues{ _tags.find(core::stringUtils::stringToUpper(std::string{ tag })) };
+        if (itValues == std::cend(_tags))
+            return;
+
+        for (std::string_view value : itValues->second)
+            visitor(value);
+    }
+
+    void XiphTagReader::visitPerformerTags(PerformerVisitor visitor) const
+    {
+        visitTagValues("PERFORMER", [&](std::string_view value)
+            {
+                visitor("", value);
+            });
+
+        for (const auto& [key, values] : _tags)
+        {
+            if (!key.starts_with("PERFORMER:"))
+                continue;
+
+            const std::string_view role{ std::string_view{ key }.substr(std::string_view{ "PERFORMER:" }.size()) };
+            for (std::string_view value : values)
+                visitor(role, value);
+        }
+    }
+} // namespace lms::metadata
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "metadata/IParser.hpp"
+#include "ITagReader.hpp"
+
+namespace lms::metadata
+{
+    // Lightweight reader for Vorbis comments in native FLAC and Ogg (Vorbis, Opus) files
+    // Only the metadata blocks/header packets are read, audio properties are computed from the stream headers
+    class XiphTagReader : public ITagReader
+    {
+    public:
+        // Returns nullptr if the file is not handled by this reader: the caller is expected to fall back on a full featured reader
+        static std::unique_ptr<XiphTagReader> create(const std::filesystem::path& path, bool debug);
+
+    private:
+        XiphTagReader() = default;
+        XiphTagReader(const XiphTagReader&) = delete;
+        XiphTagReader& operator=(const XiphTagReader&) = delete;
+
+        void parseComments(std::string_view comments);
+        void visitTagValues(TagType tag, TagValueVisitor visitor) const override;
+        void visitTagValues(std::string_view tag, TagValueVisitor visitor) const override;
+        void visitPerformerTags(PerformerVisitor visitor) const override;
+        bool hasEmbeddedCover() const override { return _hasEmbeddedCover; }
+
+        const AudioProperties& getAudioProperties() const override { return _audioProperties; }
+
+        std::string _commentData; // tag values are views on this buffer
+        std::unordered_map<std::string, std::vector<std::string_view>> _tags; // upper case keys
+        AudioProperties _audioProperties;
+        bool _hasEmbeddedCover{};
+    };
+} // namespace lms::metadata
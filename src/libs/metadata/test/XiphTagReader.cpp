@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "XiphTagReader.hpp"
+
+namespace lms::metadata::tests
+{
+    namespace
+    {
+        class ScopedTestFile
+        {
+        public:
+            ScopedTestFile(std::string_view extension, std::string_view content)
+                : _path{ std::filesystem::temp_directory_path() / ("lms-test-xiph-" + std::to_string(std::random_device{}()) + std::string{ extension }) }
+            {
+                std::ofstream file{ _path, std::ios::binary };
+                file.write(content.data(), content.size());
+            }
+            ~ScopedTestFile() { std::filesystem::remove(_path); }
+
+            ScopedTestFile(const ScopedTestFile&) = delete;
+            ScopedTestFile& operator=(const ScopedTestFile&) = delete;
+
+            const std::filesystem::path& getPath() const { return _path; }
+
+        private:
+            const std::filesystem::path _path;
+        };
+
+        void appendLE32(std::string& dst, std::uint32_t value)
+        {
+            for (unsigned i{}; i < 4; ++i)
+                dst.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+
+        std::string createVorbisComment(const std::vector<std::string>& fields)
+        {
+            std::string res;
+            appendLE32(res, 3);
+            res += "lms";
+            appendLE32(res, fields.size());
+            for (const std::string& field : fields)
+            {
+                appendLE32(res, field.size());
+                res += field;
+            }
+
+            return res;
+        }
+
+        std::string createFlacBlock(std::uint8_t type, std::string_view data, bool isLast)
+        {
+            std::string res;
+            res.push_back(static_cast<char>(type | (isLast ? 0x80 : 0x00)));
+            res.push_back(static_cast<char>((data.size() >> 16) & 0xFF));
+            res.push_back(static_cast<char>((data.size() >> 8) & 0xFF));
+            res.push_back(static_cast<char>(data.size() & 0xFF));
+            res += data;
+
+            return res;
+        }
+
+        // 44.1kHz, stereo, 16 bits
+        std::string createFlacStreamInfo(std::uint64_t sampleCount)
+        {
+            std::string res(34, '\0');
+            res[10] = static_cast<char>(0x0A);                                      // 44100 = 0x0AC44
+            res[11] = static_cast<char>(0xC4);
+            res[12] = static_cast<char>(0x40 | (1 << 1) | 0);                       // sample rate low bits, 2 channels, bps high bit
+            res[13] = static_cast<char>((15 << 4) | ((sampleCount >> 32) & 0x0F));  // 16 bits per sample
+            res[14] = static_cast<char>((sampleCount >> 24) & 0xFF);
+            res[15] = static_cast<char>((sampleCount >> 16) & 0xFF);
+            res[16] = static_cast<char>((sampleCount >> 8) & 0xFF);
+            res[17] = static_cast<char>(sampleCount & 0xFF);
+
+            return res;
+        }
+
+        std::string createOggPage(std::string_view packet, std::uint64_t granulePosition, std::uint32_t sequenceNumber, bool firstPage)
+        {
+            std::string res{ "OggS" };
+            res.push_back(0); // version
+            res.push_back(firstPage ? 0x02 : 0x00);
+            appendLE32(res, granulePosition & 0xFFFFFFFF);
+            appendLE32(res, granulePosition >> 32);
+            appendLE32(res, 0x1234); // serial number
+            appendLE32(res, sequenceNumber);
+            appendLE32(res, 0); // crc, not checked
+
+            std::string segmentTable;
+            std::size_t remainingSize{ packet.size() };
+            while (true)
+            {
+                const std::size_t segmentSize{ std::min<std::size_t>(remainingSize, 255) };
+                segmentTable.push_back(static_cast<char>(segmentSize));
+                remainingSize -= segmentSize;
+                if (segmentSize < 255)
+                    break;
+            }
+            res.push_back(static_cast<char>(segmentTable.size()));
+            res += segmentTable;
+            res += packet;
+
+            return res;
+        }
+    }
+
+    TEST(XiphTagReader, flac)
+    {
+        const std::string comments{ createVorbisComment({
+            "TITLE=MyTitle",
+            "artist=MyArtist",
+            "ARTISTS=MyArtist1",
+            "ARTISTS=MyArtist2",
+            "YEAR=2020",
+            "PERFORMER=MyPerformer (MyRole)",
+            "PERFORMER:piano=MyPianist",
+            "MyCustomTag=MyValue",
+            "InvalidField",
+        }) };
+
+        std::string content{ "fLaC" };
+        content += createFlacBlock(0, createFlacStreamInfo(441000), false); // 10 seconds
+        content += createFlacBlock(4, comments, false);
+        content += createFlacBlock(6, std::string(64, 'p'), true);
+        content += std::string(12500, 'a'); // 10 kbps
+
+        const ScopedTestFile file{ ".flac", content };
+        const std::unique_ptr<ITagReader> tagReader{ XiphTagReader::create(file.getPath(), false) };
+        ASSERT_NE(tagReader, nullptr);
+
+        const AudioProperties& audioProperties{ tagReader->getAudioProperties() };
+        EXPECT_EQ(audioProperties.bitrate, 10000);
+        EXPECT_EQ(audioProperties.bitsPerSample, 16);
+        EXPECT_EQ(audioProperties.channelCount, 2);
+        EXPECT_EQ(audioProperties.duration, std::chrono::seconds{ 10 });
+        EXPECT_EQ(audioProperties.sampleRate, 44100);
+        EXPECT_TRUE(tagReader->hasEmbeddedCover());
+
+        auto getValues{ [&](auto tag) {
+            std::vector<std::string> values;
+            tagReader->visitTagValues(tag, [&](std::string_view value) { values.emplace_back(value); });
+            return values;
+        } };
+        EXPECT_EQ(getValues(TagType::TrackTitle), std::vector<std::string>{ "MyTitle" });
+        EXPECT_EQ(getValues(TagType::Artist), std::vector<std::string>{ "MyArtist" });
+        EXPECT_EQ(getValues(TagType::Artists), (std::vector<std::string>{ "MyArtist1", "MyArtist2" }));
+        EXPECT_EQ(getValues(TagType::Date), std::vector<std::string>{ "2020" }); // alternative tag name
+        EXPECT_TRUE(getValues(TagType::Album).empty());
+        EXPECT_EQ(getValues("MYCUSTOMTAG"), std::vector<std::string>{ "MyValue" });
+        EXPECT_EQ(getValues("mycustomtag"), std::vector<std::string>{ "MyValue" });
+
+        std::vector<std::pair<std::string, std::string>> performers;
+        tagReader->visitPerformerTags([&](std::string_view role, std::string_view artist) { performers.emplace_back(role, artist); });
+        EXPECT_EQ(performers, (std::vector<std::pair<std::string, std::string>>{ { "", "MyPerformer (MyRole)" }, { "PIANO", "MyPianist" } }));
+    }
+
+    TEST(XiphTagReader, opus)
+    {
+        std::string opusHead{ "OpusHead" };
+        opusHead.push_back(1); // version
+        opusHead.push_back(2); // channels
+        opusHead.push_back(static_cast<char>(312 & 0xFF)); // pre skip
+        opusHead.push_back(static_cast<char>(312 >> 8));
+        appendLE32(opusHead, 44100); // input sample rate, not used
+        opusHead += std::string(3, '\0');
+
+        // comment packet spanning several segments
+        const std::string opusTags{ "OpusTags" + createVorbisComment({ "TITLE=" + std::string(600, 't'), "METADATA_BLOCK_PICTURE=abcd" }) };
+
+        std::string content;
+        content += createOggPage(opusHead, 0, 0, true);
+        content += createOggPage(opusTags, 0, 1, false);
+        content += createOggPage(std::string(200, 'a'), 48000 * 5 + 312, 2, false); // 5 seconds
+
+        const ScopedTestFile file{ ".opus", content };
+        const std::unique_ptr<ITagReader> tagReader{ XiphTagReader::create(file.getPath(), false) };
+        ASSERT_NE(tagReader, nullptr);
+
+        const AudioProperties& audioProperties{ tagReader->getAudioProperties() };
+        EXPECT_EQ(audioProperties.channelCount, 2);
+        EXPECT_EQ(audioProperties.duration, std::chrono::seconds{ 5 });
+        EXPECT_EQ(audioProperties.sampleRate, 48000);
+        EXPECT_EQ(audioProperties.bitrate, static_cast<std::size_t>((content.size() - opusHead.size() - opusTags.size()) * 8.0 / 5000 + 0.5) * 1000);
+        EXPECT_TRUE(tagReader->hasEmbeddedCover());
+
+        std::vector<std::string> titles;
+        tagReader->visitTagValues(TagType::TrackTitle, [&](std::string_view value) { titles.emplace_back(value); });
+        EXPECT_EQ(titles, std::vector<std::string>{ std::string(600, 't') });
+    }
+
+    TEST(XiphTagReader, unsupportedFiles)
+    {
+        {
+            // leading ID3v2 tags are left to TagLib
+            const ScopedTestFile file{ ".flac", "ID3\x04\x00" };
+            EXPECT_EQ(XiphTagReader::create(file.getPath(), false), nullptr);
+        }
+
+        {
+            // truncated file
+            std::string content{ "fLaC" };
+            content += createFlacBlock(0, createFlacStreamInfo(441000), false);
+            const ScopedTestFile file{ ".flac", content };
+            EXPECT_EQ(XiphTagReader::create(file.getPath(), false), nullptr);
+        }
+
+        {
+            const ScopedTestFile file{ ".mp3", "fLaC" };
+            EXPECT_EQ(XiphTagReader::create(file.getPath(), false), nullptr);
+        }
+    }
+}
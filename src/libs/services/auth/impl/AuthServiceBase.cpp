@@ -79,12 +79,11 @@ namespace lms::auth
                 return;
         }
 
-        {
-            auto transaction{ session.createWriteTransaction() };
-
-            if (User::pointer user{ User::find(session, userId) })
-                user.modify()->setLastLogin(Wt::WDateTime::currentDateTime());
-        }
+        _db.getWriteQueue().submit([userId, lastLogin = Wt::WDateTime::currentDateTime()](Session& session)
+            {
+                if (User::pointer user{ User::find(session, userId) })
+                    user.modify()->setLastLogin(lastLogin);
+            });
     }
 
     Session& AuthServiceBase::getDbSession()
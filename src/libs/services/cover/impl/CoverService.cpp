@@ -20,11 +20,13 @@
 #include "CoverService.hpp"
 
 #include <set>
+#include <thread>
 
 #include "av/IAudioFile.hpp"
 
 #include "database/Db.hpp"
 #include "database/Artist.hpp"
+#include "database/Image.hpp"
 #include "database/Release.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
@@ -37,6 +39,7 @@
 #include "core/Random.hpp"
 #include "core/String.hpp"
 #include "core/Utils.hpp"
+#include "CoverSizes.hpp"
 
 namespace lms::cover
 {
@@ -47,6 +50,7 @@ namespace lms::cover
             bool hasCover{};
             bool isMultiDisc{};
             std::filesystem::path trackPath;
+            Wt::WDateTime trackLastWriteTime;
             std::optional<db::ReleaseId> releaseId;
         };
 
@@ -64,6 +68,7 @@ namespace lms::cover
 
             res->hasCover = track->hasCover();
             res->trackPath = track->getAbsoluteFilePath();
+            res->trackLastWriteTime = track->getLastWriteTime();
 
             if (const db::Release::pointer & release{ track->getRelease() })
             {
@@ -75,6 +80,31 @@ namespace lms::cover
             return res;
         }
 
+        struct ReleaseInfo
+        {
+            db::TrackId firstTrackId;
+            std::filesystem::path releaseDirectory;
+        };
+
+        std::optional<ReleaseInfo> getReleaseInfo(db::Session& dbSession, db::ReleaseId releaseId)
+        {
+            std::optional<ReleaseInfo> res;
+
+            auto transaction{ dbSession.createReadTransaction() };
+
+            // get a track in this release, consider the release is in a single directory
+            const auto tracks{ db::Track::find(dbSession, db::Track::FindParameters{}.setRelease(releaseId).setRange(db::Range{ 0, 1 }).setSortMethod(db::TrackSortMethod::Release)) };
+            if (!tracks.results.empty())
+            {
+                const db::Track::pointer& track{ tracks.results.front() };
+                res = ReleaseInfo{};
+                res->firstTrackId = track->getId();
+                res->releaseDirectory = track->getAbsoluteFilePath().parent_path();
+            }
+
+            return res;
+        }
+
         std::vector<std::string> constructPreferredFileNames()
         {
             std::vector<std::string> res;
@@ -105,6 +135,35 @@ namespace lms::cover
         {
             return (std::find(std::cbegin(extensions), std::cend(extensions), file.extension()) != std::cend(extensions));
         }
+
+        std::ptrdiff_t getMaxConcurrentGenerations()
+        {
+            // By default, keep half of the logical CPUs for other tasks, such as serving HTTP requests
+            const unsigned long maxConcurrentGenerations{ core::Service<core::IConfig>::get()->getULong("cover-max-concurrent-generations", 0) };
+            return maxConcurrentGenerations ? maxConcurrentGenerations : std::max<unsigned long>(1, std::thread::hardware_concurrency() / 2);
+        }
+
+        // Only held while decoding/encoding images, never while waiting for another generation to avoid deadlocks
+        class GenerationSlotGuard
+        {
+        public:
+            GenerationSlotGuard(std::counting_semaphore<>& slots)
+                : _slots{ slots }
+            {
+                _slots.acquire();
+            }
+
+            ~GenerationSlotGuard()
+            {
+                _slots.release();
+            }
+
+        private:
+            GenerationSlotGuard(const GenerationSlotGuard&) = delete;
+            GenerationSlotGuard& operator=(const GenerationSlotGuard&) = delete;
+
+            std::counting_semaphore<>& _slots;
+        };
     }
 
     std::unique_ptr<ICoverService> createCoverService(db::Db& db, const std::filesystem::path& defaultSvgCoverPath)
@@ -112,20 +171,29 @@ namespace lms::cover
         return std::make_unique<CoverService>(db, defaultSvgCoverPath);
     }
 
+    const std::vector<std::filesystem::path>& getSupportedFileExtensions()
+    {
+        static const std::vector<std::filesystem::path> fileExtensions{ ".jpg", ".jpeg", ".png", ".bmp" }; // TODO parametrize
+        return fileExtensions;
+    }
+
     using namespace image;
 
     CoverService::CoverService(db::Db& db,
         const std::filesystem::path& defaultSvgCoverPath)
         : _db{ db }
         , _cache{ core::Service<core::IConfig>::get()->getULong("cover-max-cache-size", 30) * 1000 * 1000 }
+        , _diskCache{ core::Service<core::IConfig>::get()->getPath("working-dir") / "cache" / "covers", core::Service<core::IConfig>::get()->getULong("cover-max-disk-cache-size", 500) * 1000 * 1000 }
         , _maxFileSize{ core::Service<core::IConfig>::get()->getULong("cover-max-file-size", 10) * 1000 * 1000 }
         , _preferredFileNames{ constructPreferredFileNames() }
         , _artistFileNames{ constructArtistFileNames() }
+        , _generationSlots{ getMaxConcurrentGenerations() }
     {
         setJpegQuality(core::Service<core::IConfig>::get()->getULong("cover-jpeg-quality", 75));
 
         LMS_LOG(COVER, INFO, "Default cover path = '" << defaultSvgCoverPath.string() << "'");
         LMS_LOG(COVER, INFO, "Max cache size = " << _cache.getMaxCacheSize());
+        LMS_LOG(COVER, INFO, "Max disk cache size = " << _diskCache.getMaxCacheSize());
         LMS_LOG(COVER, INFO, "Max file size = " << _maxFileSize);
         LMS_LOG(COVER, INFO, "Preferred file names: " << core::stringUtils::joinStrings(_preferredFileNames, ","));
 
@@ -156,12 +224,19 @@ namespace lms::cover
         return image;
     }
 
-    std::unique_ptr<IEncodedImage> CoverService::getFromCoverFile(const std::filesystem::path& p, ImageSize width) const
+    std::unique_ptr<IEncodedImage> CoverService::getFromCoverFile(const CoverFile& coverFile, ImageSize width) const
     {
-        std::unique_ptr<IEncodedImage> image;
+        const std::filesystem::path& p{ coverFile.path };
+        const DiskImageCache::EntryDesc diskCacheEntryDesc{ p, coverFile.lastWriteTime, width, _jpegQuality };
+
+        std::unique_ptr<IEncodedImage> image{ _diskCache.getImage(diskCacheEntryDesc) };
+        if (image)
+            return image;
 
         try
         {
+            const GenerationSlotGuard slotGuard{ _generationSlots };
+
             std::unique_ptr<IRawImage> rawImage{ decodeImage(p) };
             rawImage->resize(width);
             image = rawImage->encodeToJPEG(_jpegQuality);
@@ -171,9 +246,65 @@ namespace lms::cover
             LMS_LOG(COVER, ERROR, "Cannot read cover in file '" << p.string() << "': " << e.what());
         }
 
+        if (image)
+            _diskCache.addImage(diskCacheEntryDesc, *image);
+
+        return image;
+    }
+
+    std::unique_ptr<IEncodedImage> CoverService::getFromLargerCachedImage(const ImageCache::EntryDesc& entryDesc) const
+    {
+        std::unique_ptr<IEncodedImage> image;
+
+        // Downscaling an already resized cover is much cheaper than extracting and decoding the original one
+        for (std::size_t i{ getSizeBucketIndex(entryDesc.size) + 1 }; i < coverSizeBuckets.size(); ++i)
+        {
+            const std::shared_ptr<IEncodedImage> largerImage{ _cache.peekImage(ImageCache::EntryDesc{ entryDesc.id, coverSizeBuckets[i] }) };
+            if (!largerImage)
+                continue;
+
+            try
+            {
+                const GenerationSlotGuard slotGuard{ _generationSlots };
+
+                std::unique_ptr<IRawImage> rawImage{ decodeImage(largerImage->getData(), largerImage->getDataSize()) };
+                rawImage->resize(entryDesc.size);
+                image = rawImage->encodeToJPEG(_jpegQuality);
+            }
+            catch (const image::Exception& e)
+            {
+                LMS_LOG(COVER, ERROR, "Cannot downscale cached cover: " << e.what());
+            }
+
+            break;
+        }
+
         return image;
     }
 
+    std::shared_ptr<IEncodedImage> CoverService::getOrGenerate(const ImageCache::EntryDesc& entryDesc, bool allowFallback, const GenerateFunc& generateFunc)
+    {
+        if (std::shared_ptr<IEncodedImage> cover{ _cache.getImage(entryDesc) })
+            return cover;
+
+        return _pendingGenerations.run(GenerationKey{ entryDesc, allowFallback }, [&]
+            {
+                // may have been generated in the meantime
+                std::shared_ptr<IEncodedImage> cover{ _cache.peekImage(entryDesc) };
+                if (cover)
+                    return cover;
+
+                cover = getFromLargerCachedImage(entryDesc);
+                if (!cover)
+                    cover = generateFunc();
+
+                if (cover)
+                    _cache.addImage(entryDesc, cover);
+
+                return cover;
+            });
+    }
+
     std::shared_ptr<IEncodedImage> CoverService::getDefaultSvgCover()
     {
         return _defaultCover;
@@ -181,13 +312,13 @@ namespace lms::cover
 
     std::unique_ptr<IEncodedImage> CoverService::getFromDirectory(const std::filesystem::path& directory, ImageSize width, const std::vector<std::string>& preferredFileNames, bool allowPickRandom) const
     {
-        const std::multimap<std::string, std::filesystem::path> coverPaths{ getCoverPaths(directory) };
+        const std::multimap<std::string, CoverFile> coverFiles{ getCoverFiles(directory) };
 
         auto tryLoadImageFromFilename = [&](std::string_view fileName)
             {
                 std::unique_ptr<IEncodedImage> image;
 
-                auto range{ coverPaths.equal_range(std::string {fileName}) };
+                auto range{ coverFiles.equal_range(std::string {fileName}) };
                 for (auto it{ range.first }; it != range.second; ++it)
                 {
                     image = getFromCoverFile(it->second, width);
@@ -208,9 +339,9 @@ namespace lms::cover
 
         if (allowPickRandom)
         {
-            for (const auto& [filename, coverPath] : coverPaths)
+            for (const auto& [filename, coverFile] : coverFiles)
             {
-                image = getFromCoverFile(coverPath, width);
+                image = getFromCoverFile(coverFile, width);
                 if (image)
                     return image;
             }
@@ -223,15 +354,12 @@ namespace lms::cover
     {
         std::unique_ptr<IEncodedImage> res;
 
-        std::filesystem::path coverPath{ filePath };
-        for (const std::filesystem::path& extension : _fileExtensions)
-        {
-            coverPath.replace_extension(extension);
-
-            if (!checkCoverFile(coverPath))
-                continue;
+        const std::multimap<std::string, CoverFile> coverFiles{ getCoverFiles(filePath.parent_path()) };
 
-            res = getFromCoverFile(coverPath, width);
+        auto range{ coverFiles.equal_range(filePath.stem().string()) };
+        for (auto it{ range.first }; it != range.second; ++it)
+        {
+            res = getFromCoverFile(it->second, width);
             if (res)
                 break;
         }
@@ -239,54 +367,49 @@ namespace lms::cover
         return res;
     }
 
-    bool CoverService::checkCoverFile(const std::filesystem::path& filePath) const
+    bool CoverService::checkCoverFile(const db::Image& image) const
     {
-        std::error_code ec;
-
-        if (!isFileSupported(filePath, _fileExtensions))
-            return false;
-
-        if (!std::filesystem::exists(filePath, ec))
-            return false;
-
-        if (!std::filesystem::is_regular_file(filePath, ec))
+        if (!isFileSupported(image.getAbsoluteFilePath(), getSupportedFileExtensions()))
             return false;
 
-        if (std::filesystem::file_size(filePath, ec) > _maxFileSize && !ec)
+        if (static_cast<std::size_t>(image.getFileSize()) > _maxFileSize)
         {
-            LMS_LOG(COVER, INFO, "Image file '" << filePath.string() << " is too big (" << std::filesystem::file_size(filePath, ec) << "), limit is " << _maxFileSize);
+            LMS_LOG(COVER, INFO, "Image file '" << image.getAbsoluteFilePath().string() << " is too big (" << image.getFileSize() << "), limit is " << _maxFileSize);
             return false;
         }
 
         return true;
     }
 
-    std::multimap<std::string, std::filesystem::path> CoverService::getCoverPaths(const std::filesystem::path& directoryPath) const
+    std::multimap<std::string, CoverService::CoverFile> CoverService::getCoverFiles(const std::filesystem::path& directoryPath) const
     {
-        std::multimap<std::string, std::filesystem::path> res;
-        std::error_code ec;
+        // Image files are indexed by the scanner, no need to list the directory
+        std::multimap<std::string, CoverFile> res;
 
-        std::filesystem::directory_iterator itPath(directoryPath, ec);
-        const std::filesystem::directory_iterator itEnd;
-        while (!ec && itPath != itEnd)
-        {
-            const std::filesystem::path& path{ *itPath };
-
-            if (checkCoverFile(path))
-                res.emplace(std::filesystem::path{ path }.filename().replace_extension("").string(), path);
+        db::Session& dbSession{ _db.getTLSSession() };
+        auto transaction{ dbSession.createReadTransaction() };
 
-            itPath.increment(ec);
+        for (const db::Image::pointer& image : db::Image::findByDirectory(dbSession, directoryPath))
+        {
+            if (checkCoverFile(*image))
+                res.emplace(image->getStem(), CoverFile{ image->getAbsoluteFilePath(), image->getLastWriteTime() });
         }
 
         return res;
     }
 
-    std::unique_ptr<IEncodedImage> CoverService::getFromTrack(const std::filesystem::path& p, ImageSize width) const
+    std::unique_ptr<IEncodedImage> CoverService::getFromTrack(const std::filesystem::path& p, const Wt::WDateTime& lastWriteTime, ImageSize width) const
     {
-        std::unique_ptr<IEncodedImage> image;
+        const DiskImageCache::EntryDesc diskCacheEntryDesc{ p, lastWriteTime, width, _jpegQuality };
+
+        std::unique_ptr<IEncodedImage> image{ _diskCache.getImage(diskCacheEntryDesc) };
+        if (image)
+            return image;
 
         try
         {
+            const GenerationSlotGuard slotGuard{ _generationSlots };
+
             image = getFromAvMediaFile(*av::parseAudioFile(p), width);
         }
         catch (av::Exception& e)
@@ -294,28 +417,35 @@ namespace lms::cover
             LMS_LOG(COVER, ERROR, "Cannot get covers from track " << p.string() << ": " << e.what());
         }
 
+        if (image)
+            _diskCache.addImage(diskCacheEntryDesc, *image);
+
         return image;
     }
 
     std::shared_ptr<IEncodedImage> CoverService::getFromTrack(db::TrackId trackId, ImageSize width)
     {
-        return getFromTrack(_db.getTLSSession(), trackId, width, true /* allow release fallback*/);
+        return getFromTrack(_db.getTLSSession(), trackId, getSizeBucket(width), true /* allow release fallback*/);
     }
 
     std::shared_ptr<IEncodedImage> CoverService::getFromTrack(db::Session& dbSession, db::TrackId trackId, ImageSize width, bool allowReleaseFallback)
     {
-        using namespace db;
-
         const ImageCache::EntryDesc cacheEntryDesc{ trackId, width };
 
-        std::shared_ptr<IEncodedImage> cover{ _cache.getImage(cacheEntryDesc) };
-        if (cover)
-            return cover;
+        return getOrGenerate(cacheEntryDesc, allowReleaseFallback, [&]
+            {
+                return generateFromTrack(dbSession, trackId, width, allowReleaseFallback);
+            });
+    }
+
+    std::shared_ptr<IEncodedImage> CoverService::generateFromTrack(db::Session& dbSession, db::TrackId trackId, ImageSize width, bool allowReleaseFallback)
+    {
+        std::shared_ptr<IEncodedImage> cover;
 
         if (const std::optional<TrackInfo> trackInfo{ getTrackInfo(dbSession, trackId) })
         {
             if (trackInfo->hasCover)
-                cover = getFromTrack(trackInfo->trackPath, width);
+                cover = getFromTrack(trackInfo->trackPath, trackInfo->trackLastWriteTime, width);
 
             if (!cover)
                 cover = getFromSameNamedFile(trackInfo->trackPath, width);
@@ -330,163 +460,160 @@ namespace lms::cover
             }
         }
 
-        if (cover)
-            _cache.addImage(cacheEntryDesc, cover);
-
         return cover;
     }
 
     std::shared_ptr<IEncodedImage> CoverService::getFromRelease(db::ReleaseId releaseId, ImageSize width)
     {
         using namespace db;
-        const ImageCache::EntryDesc cacheEntryDesc{ releaseId, width };
 
-        std::shared_ptr<IEncodedImage> cover{ _cache.getImage(cacheEntryDesc) };
-        if (cover)
-            return cover;
-
-        struct ReleaseInfo
-        {
-            TrackId firstTrackId;
-            std::filesystem::path releaseDirectory;
-        };
+        width = getSizeBucket(width);
+        const ImageCache::EntryDesc cacheEntryDesc{ releaseId, width };
 
-        Session& session{ _db.getTLSSession() };
+        return getOrGenerate(cacheEntryDesc, true, [&]
+            {
+                std::shared_ptr<IEncodedImage> cover;
 
-        auto getReleaseInfo{ [&]
-        {
-            std::optional<ReleaseInfo> res;
+                Session& session{ _db.getTLSSession() };
+                if (const std::optional<ReleaseInfo> releaseInfo{ getReleaseInfo(session, releaseId) })
+                {
+                    cover = getFromDirectory(releaseInfo->releaseDirectory, width, _preferredFileNames, true);
+                    if (!cover)
+                        cover = getFromTrack(session, releaseInfo->firstTrackId, width, false /* no release fallback */);
+                }
 
-            auto transaction{ session.createReadTransaction() };
+                return cover;
+            });
+    }
 
-            // get a track in this release, consider the release is in a single directory
-            const auto tracks{ Track::find(session, Track::FindParameters {}.setRelease(releaseId).setRange(Range{ 0, 1 }).setSortMethod(TrackSortMethod::Release)) };
-            if (!tracks.results.empty())
-            {
-                const Track::pointer& track{ tracks.results.front() };
-                res = ReleaseInfo{};
-                res->firstTrackId = track->getId();
-                res->releaseDirectory = track->getAbsoluteFilePath().parent_path();
-            }
+    void CoverService::pregenerateReleaseCover(db::ReleaseId releaseId, ImageSize width)
+    {
+        using namespace db;
 
-            return res;
-        } };
+        width = getSizeBucket(width);
 
-        if (const std::optional<ReleaseInfo> releaseInfo{ getReleaseInfo() })
+        // Same sources as getFromRelease, each of them fills the disk cache
+        Session& session{ _db.getTLSSession() };
+        if (const std::optional<ReleaseInfo> releaseInfo{ getReleaseInfo(session, releaseId) })
         {
-            cover = getFromDirectory(releaseInfo->releaseDirectory, width, _preferredFileNames, true);
-            if (!cover)
-                cover = getFromTrack(session, releaseInfo->firstTrackId, width, false /* no release fallback */);
+            if (!getFromDirectory(releaseInfo->releaseDirectory, width, _preferredFileNames, true))
+                generateFromTrack(session, releaseInfo->firstTrackId, width, false /* no release fallback */);
         }
-
-        if (cover)
-            _cache.addImage(cacheEntryDesc, cover);
-
-        return cover;
     }
 
     std::shared_ptr<IEncodedImage> CoverService::getFromArtist(db::ArtistId artistId, ImageSize width)
     {
         using namespace db;
+
+        width = getSizeBucket(width);
         const ImageCache::EntryDesc cacheEntryDesc{ artistId, width };
 
-        std::shared_ptr<IEncodedImage> artistImage{ _cache.getImage(cacheEntryDesc) };
-        if (artistImage)
-            return artistImage;
+        return getOrGenerate(cacheEntryDesc, true, [&]
+            {
+                std::shared_ptr<IEncodedImage> artistImage;
 
-        std::string artistName;
-        std::string artistMBID;
+                std::string artistName;
+                std::string artistMBID;
 
-        std::set<std::filesystem::path> releasePaths;
-        std::set<std::filesystem::path> multiArtistReleasePaths;
+                std::set<std::filesystem::path> releasePaths;
+                std::set<std::filesystem::path> multiArtistReleasePaths;
 
-        {
-            Session& session{ _db.getTLSSession() };
+                {
+                    Session& session{ _db.getTLSSession() };
 
-            auto transaction{ session.createReadTransaction() };
+                    auto transaction{ session.createReadTransaction() };
 
-            const Artist::pointer artist{ Artist::find(session, artistId) };
-            if (!artist)
-                return artistImage;
+                    const Artist::pointer artist{ Artist::find(session, artistId) };
+                    if (!artist)
+                        return artistImage;
 
-            artistName = artist->getName();
-            if (auto mbid{ artist->getMBID() })
-                artistMBID = mbid->getAsString();
+                    artistName = artist->getName();
+                    if (auto mbid{ artist->getMBID() })
+                        artistMBID = mbid->getAsString();
 
-            Track::FindParameters params;
-            params.setArtist(artistId, { TrackArtistLinkType::ReleaseArtist });
+                    Track::FindParameters params;
+                    params.setArtist(artistId, { TrackArtistLinkType::ReleaseArtist });
 
-            Track::find(session, params, [&](const Track::pointer& track)
-                {
-                    Artist::FindParameters artistFindParams;
-                    artistFindParams.setTrack(track->getId());
-                    artistFindParams.setLinkType(TrackArtistLinkType::ReleaseArtist);
-
-                    const auto releaseArtists{ Artist::findIds(session, artistFindParams) };
-                    if (releaseArtists.results.size() == 1)
-                        releasePaths.insert(track->getAbsoluteFilePath().parent_path());
-                    else
-                        multiArtistReleasePaths.insert(track->getAbsoluteFilePath().parent_path());
-                });
-        }
+                    Track::find(session, params, [&](const Track::pointer& track)
+                        {
+                            Artist::FindParameters artistFindParams;
+                            artistFindParams.setTrack(track->getId());
+                            artistFindParams.setLinkType(TrackArtistLinkType::ReleaseArtist);
 
-        std::vector<std::string> artistFileNames;
-        if (!artistMBID.empty())
-            artistFileNames.push_back(artistMBID);
-        artistFileNames.push_back(artistName);
+                            const auto releaseArtists{ Artist::findIds(session, artistFindParams) };
+                            if (releaseArtists.results.size() == 1)
+                                releasePaths.insert(track->getAbsoluteFilePath().parent_path());
+                            else
+                                multiArtistReleasePaths.insert(track->getAbsoluteFilePath().parent_path());
+                        });
+                }
 
-        std::vector<std::string> artistFileNamesWithGenericNames{ artistFileNames };
-        artistFileNamesWithGenericNames.insert(artistFileNamesWithGenericNames.end(), std::cbegin(_artistFileNames), std::cend(_artistFileNames));
+                std::vector<std::string> artistFileNames;
+                if (!artistMBID.empty())
+                    artistFileNames.push_back(artistMBID);
+                artistFileNames.push_back(artistName);
 
-        // Expect layout like this:
-        // ReleaseArtist/Release/Tracks'
-        //              /artist-mbid.jpg
-        //              /artist-name.jpg
-        //              /artist.jpg
-        if (!releasePaths.empty())
-        {
-            const std::filesystem::path artistPath{ releasePaths.size() == 1 ? releasePaths.begin()->parent_path() : core::pathUtils::getLongestCommonPath(std::cbegin(releasePaths), std::cend(releasePaths)) };
-            artistImage = getFromDirectory(artistPath, width, artistFileNamesWithGenericNames, false);
-        }
+                std::vector<std::string> artistFileNamesWithGenericNames{ artistFileNames };
+                artistFileNamesWithGenericNames.insert(artistFileNamesWithGenericNames.end(), std::cbegin(_artistFileNames), std::cend(_artistFileNames));
 
-        // Expect layout like this:
-        // ReleaseArtist/Release/Tracks'
-        //                      /artist-mbid.jpg
-        //                      /artist-name.jpg
-        //                      /artist.jpg
-        if (!artistImage)
-        {
-            for (const std::filesystem::path& releasePath : releasePaths)
-            {
-                artistImage = getFromDirectory(releasePath, width, artistFileNamesWithGenericNames, false);
-                if (artistImage)
-                    break;
-            }
-        }
+                // Expect layout like this:
+                // ReleaseArtist/Release/Tracks'
+                //              /artist-mbid.jpg
+                //              /artist-name.jpg
+                //              /artist.jpg
+                if (!releasePaths.empty())
+                {
+                    const std::filesystem::path artistPath{ releasePaths.size() == 1 ? releasePaths.begin()->parent_path() : core::pathUtils::getLongestCommonPath(std::cbegin(releasePaths), std::cend(releasePaths)) };
+                    artistImage = getFromDirectory(artistPath, width, artistFileNamesWithGenericNames, false);
+                }
 
-        // Expect layout like this:
-        // Only search for the artist's name in the release path, as we can't map a generic name to several artists
-        // ReleaseArtist/Release/Tracks'
-        //                      /artist-name.jpg
-        //                      /artist-mbid.jpg
-        if (!artistImage)
-        {
-            for (const std::filesystem::path& releasePath : multiArtistReleasePaths)
-            {
-                artistImage = getFromDirectory(releasePath, width, artistFileNames, false);
-                if (artistImage)
-                    break;
-            }
-        }
+                // Expect layout like this:
+                // ReleaseArtist/Release/Tracks'
+                //                      /artist-mbid.jpg
+                //                      /artist-name.jpg
+                //                      /artist.jpg
+                if (!artistImage)
+                {
+                    for (const std::filesystem::path& releasePath : releasePaths)
+                    {
+                        artistImage = getFromDirectory(releasePath, width, artistFileNamesWithGenericNames, false);
+                        if (artistImage)
+                            break;
+                    }
+                }
 
-        if (artistImage)
-            _cache.addImage(cacheEntryDesc, artistImage);
+                // Expect layout like this:
+                // Only search for the artist's name in the release path, as we can't map a generic name to several artists
+                // ReleaseArtist/Release/Tracks'
+                //                      /artist-name.jpg
+                //                      /artist-mbid.jpg
+                if (!artistImage)
+                {
+                    for (const std::filesystem::path& releasePath : multiArtistReleasePaths)
+                    {
+                        artistImage = getFromDirectory(releasePath, width, artistFileNames, false);
+                        if (artistImage)
+                            break;
+                    }
+                }
 
-        return artistImage;
+                return artistImage;
+            });
     }
 
     void CoverService::flushCache()
     {
+        _cache.flush();
+        _diskCache.prune();
+    }
+
+    CacheStats CoverService::getCacheStats() const
+    {
+        CacheStats stats;
+        _cache.fillStats(stats);
+        _diskCache.fillStats(stats);
+
+        return stats;
     }
 
     void CoverService::setJpegQuality(unsigned quality)
@@ -20,16 +20,23 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <semaphore>
 #include <vector>
 
+#include <Wt/WDateTime.h>
+
 #include "services/cover/ICoverService.hpp"
 #include "image/IEncodedImage.hpp"
 #include "database/Types.hpp"
+#include "DiskImageCache.hpp"
 #include "ImageCache.hpp"
+#include "SingleFlight.hpp"
 
 namespace lms::db
 {
+    class Image;
     class Session;
 }
 
@@ -52,27 +59,58 @@ namespace lms::cover
         std::shared_ptr<image::IEncodedImage>   getFromTrack(db::TrackId trackId, image::ImageSize width) override;
         std::shared_ptr<image::IEncodedImage>   getFromRelease(db::ReleaseId releaseId, image::ImageSize width) override;
         std::shared_ptr<image::IEncodedImage>   getFromArtist(db::ArtistId artistId, image::ImageSize width) override;
+        void                                    pregenerateReleaseCover(db::ReleaseId releaseId, image::ImageSize width) override;
         std::shared_ptr<image::IEncodedImage>   getDefaultSvgCover() override;
         void                                    flushCache() override;
+        CacheStats                              getCacheStats() const override;
         void                                    setJpegQuality(unsigned quality) override;
 
         std::shared_ptr<image::IEncodedImage>   getFromTrack(db::Session& dbSession, db::TrackId trackId, image::ImageSize width, bool allowReleaseFallback);
+        std::shared_ptr<image::IEncodedImage>   generateFromTrack(db::Session& dbSession, db::TrackId trackId, image::ImageSize width, bool allowReleaseFallback); // bypasses the in-memory cache, except for the release fallback
         std::unique_ptr<image::IEncodedImage>   getFromAvMediaFile(const av::IAudioFile& input, image::ImageSize width) const;
-        std::unique_ptr<image::IEncodedImage>   getFromCoverFile(const std::filesystem::path& p, image::ImageSize width) const;
-
-        std::unique_ptr<image::IEncodedImage>   getFromTrack(const std::filesystem::path& path, image::ImageSize width) const;
-        std::multimap<std::string, std::filesystem::path>   getCoverPaths(const std::filesystem::path& directoryPath) const;
+        struct CoverFile
+        {
+            std::filesystem::path path;
+            Wt::WDateTime lastWriteTime;
+        };
+        std::unique_ptr<image::IEncodedImage>   getFromCoverFile(const CoverFile& coverFile, image::ImageSize width) const;
+        std::unique_ptr<image::IEncodedImage>   getFromLargerCachedImage(const ImageCache::EntryDesc& entryDesc) const;
+
+        using GenerateFunc = std::function<std::shared_ptr<image::IEncodedImage>()>;
+        std::shared_ptr<image::IEncodedImage>   getOrGenerate(const ImageCache::EntryDesc& entryDesc, bool allowFallback, const GenerateFunc& generateFunc);
+
+        std::unique_ptr<image::IEncodedImage>   getFromTrack(const std::filesystem::path& path, const Wt::WDateTime& lastWriteTime, image::ImageSize width) const;
+        std::multimap<std::string, CoverFile>   getCoverFiles(const std::filesystem::path& directoryPath) const;
         std::unique_ptr<image::IEncodedImage>   getFromDirectory(const std::filesystem::path& directory, image::ImageSize width, const std::vector<std::string>& preferredFileNames, bool allowPickRandom) const;
         std::unique_ptr<image::IEncodedImage>   getFromSameNamedFile(const std::filesystem::path& filePath, image::ImageSize width) const;
 
-        bool                                    checkCoverFile(const std::filesystem::path& filePath) const;
+        bool                                    checkCoverFile(const db::Image& image) const;
 
         db::Db& _db;
 
         ImageCache _cache;
+        DiskImageCache _diskCache;
+
+        // Concurrent generations of the same cover are coalesced
+        // Generations with and without fallbacks are kept apart, as the former may wait for the latter (track -> release -> track)
+        struct GenerationKey
+        {
+            ImageCache::EntryDesc entryDesc;
+            bool allowFallback;
+
+            bool operator==(const GenerationKey& other) const = default;
+        };
+        struct GenerationKeyHasher
+        {
+            std::size_t operator()(const GenerationKey& key) const
+            {
+                return ImageCache::EntryHasher{}(key.entryDesc) ^ std::hash<bool>{}(key.allowFallback);
+            }
+        };
+        SingleFlight<GenerationKey, std::shared_ptr<image::IEncodedImage>, GenerationKeyHasher> _pendingGenerations;
+        mutable std::counting_semaphore<> _generationSlots; // limits the number of threads busy decoding and encoding images
         std::shared_ptr<image::IEncodedImage> _defaultCover;
 
-        static inline const std::vector<std::filesystem::path> _fileExtensions{ ".jpg", ".jpeg", ".png", ".bmp" }; // TODO parametrize
         const std::size_t _maxFileSize;
         const std::vector<std::string> _preferredFileNames;
         const std::vector<std::string> _artistFileNames;
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CoverSizes.hpp"
+
+#include <algorithm>
+
+namespace lms::cover
+{
+    std::size_t getSizeBucketIndex(image::ImageSize size)
+    {
+        const auto it{ std::lower_bound(std::cbegin(coverSizeBuckets), std::cend(coverSizeBuckets), size) };
+        if (it == std::cend(coverSizeBuckets))
+            return coverSizeBuckets.size() - 1;
+
+        return std::distance(std::cbegin(coverSizeBuckets), it);
+    }
+
+    image::ImageSize getSizeBucket(image::ImageSize size)
+    {
+        return coverSizeBuckets[getSizeBucketIndex(size)];
+    }
+}
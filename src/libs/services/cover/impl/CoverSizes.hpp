@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "image/IEncodedImage.hpp"
+
+namespace lms::cover
+{
+    // Covers are only generated using these sizes: requests are served using the smallest size that is greater or equal
+    // Consecutive sizes are at most 1.5x apart (2x for the small ones), so that served covers are never much larger than requested
+    inline constexpr std::array<image::ImageSize, 11> coverSizeBuckets{ 32, 64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048 };
+
+    std::size_t getSizeBucketIndex(image::ImageSize size);
+    image::ImageSize getSizeBucket(image::ImageSize size);
+}
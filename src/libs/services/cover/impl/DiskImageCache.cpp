@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DiskImageCache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "core/Fnv1a64Calculator.hpp"
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+
+namespace lms::cover
+{
+    namespace
+    {
+        // Entries are touched when used, at most once per period, to keep track of the least recently used ones
+        constexpr std::chrono::hours touchPeriod{ 24 };
+
+        class CachedImage : public image::IEncodedImage
+        {
+        public:
+            CachedImage(std::vector<std::byte>&& data) : _data{ std::move(data) } {}
+
+        private:
+            const std::byte* getData() const override { return _data.data(); }
+            std::size_t getDataSize() const override { return _data.size(); }
+            std::string_view getMimeType() const override { return "image/jpeg"; }
+
+            const std::vector<std::byte> _data;
+        };
+
+        std::unique_ptr<image::IEncodedImage> readImage(const std::filesystem::path& path, std::uintmax_t fileSize)
+        {
+            std::ifstream ifs{ path, std::ios::binary };
+            if (!ifs)
+                return nullptr;
+
+            std::vector<std::byte> data(fileSize);
+            if (!ifs.read(reinterpret_cast<char*>(data.data()), data.size()))
+                return nullptr;
+
+            return std::make_unique<CachedImage>(std::move(data));
+        }
+    }
+
+    DiskImageCache::DiskImageCache(const std::filesystem::path& cacheDirectory, std::size_t maxCacheSize)
+        : _cacheDirectory{ cacheDirectory }
+        , _maxCacheSize{ maxCacheSize }
+    {
+        if (!isEnabled())
+            return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(_cacheDirectory, ec);
+        if (ec)
+            LMS_LOG(COVER, ERROR, "Cannot create cover cache directory '" << _cacheDirectory.string() << "': " << ec.message());
+
+        for (const Entry& entry : listEntries())
+            _cacheSize += entry.size;
+    }
+
+    std::filesystem::path DiskImageCache::getEntryPath(const EntryDesc& entryDesc) const
+    {
+        if (!entryDesc.sourceLastWriteTime.isValid())
+            return {};
+
+        std::ostringstream key;
+        key << entryDesc.sourcePath.string() << '\0' << entryDesc.sourceLastWriteTime.toTime_t() << '\0' << entryDesc.size << '\0' << entryDesc.jpegQuality;
+
+        // entry names must be stable across runs and platforms
+        const std::string keyStr{ key.str() };
+        core::Fnv1a64Calculator calculator;
+        calculator.processBytes(reinterpret_cast<const std::byte*>(keyStr.data()), keyStr.size());
+
+        std::ostringstream fileName;
+        fileName << std::hex << std::setw(16) << std::setfill('0') << calculator.getResult();
+
+        const std::string entryName{ fileName.str() };
+        return _cacheDirectory / entryName.substr(0, 2) / (entryName + ".jpg");
+    }
+
+    std::unique_ptr<image::IEncodedImage> DiskImageCache::getImage(const EntryDesc& entryDesc) const
+    {
+        if (!isEnabled())
+            return nullptr;
+
+        LMS_SCOPED_TRACE_DETAILED("Cover", "DiskCacheGet");
+
+        std::unique_ptr<image::IEncodedImage> image;
+
+        const std::filesystem::path entryPath{ getEntryPath(entryDesc) };
+        if (!entryPath.empty())
+        {
+            std::error_code ec;
+            const std::uintmax_t fileSize{ std::filesystem::file_size(entryPath, ec) };
+            if (!ec && fileSize > 0)
+                image = readImage(entryPath, fileSize);
+
+            if (image)
+            {
+                const auto now{ std::filesystem::file_time_type::clock::now() };
+                const std::filesystem::file_time_type lastWriteTime{ std::filesystem::last_write_time(entryPath, ec) };
+                if (!ec && lastWriteTime + touchPeriod < now)
+                    std::filesystem::last_write_time(entryPath, now, ec);
+            }
+        }
+
+        if (image)
+            ++_cacheHits;
+        else
+            ++_cacheMisses;
+
+        return image;
+    }
+
+    void DiskImageCache::addImage(const EntryDesc& entryDesc, const image::IEncodedImage& image)
+    {
+        if (!isEnabled() || image.getDataSize() == 0)
+            return;
+
+        LMS_SCOPED_TRACE_DETAILED("Cover", "DiskCacheAdd");
+
+        const std::filesystem::path entryPath{ getEntryPath(entryDesc) };
+        if (entryPath.empty())
+            return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(entryPath.parent_path(), ec);
+        if (ec)
+        {
+            LMS_LOG(COVER, ERROR, "Cannot create cover cache directory '" << entryPath.parent_path().string() << "': " << ec.message());
+            return;
+        }
+
+        // Write in a temporary file first, so that concurrent readers never see a partial entry
+        std::filesystem::path tmpPath{ entryPath };
+        tmpPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream ofs{ tmpPath, std::ios::binary | std::ios::trunc };
+            if (!ofs || !ofs.write(reinterpret_cast<const char*>(image.getData()), image.getDataSize()))
+            {
+                LMS_LOG(COVER, ERROR, "Cannot write cover cache entry '" << tmpPath.string() << "'");
+                std::filesystem::remove(tmpPath, ec);
+                return;
+            }
+        }
+
+        // may replace an entry written concurrently
+        const std::uintmax_t replacedEntrySize{ std::filesystem::file_size(entryPath, ec) };
+        const bool entryReplaced{ !ec };
+
+        std::filesystem::rename(tmpPath, entryPath, ec);
+        if (ec)
+        {
+            LMS_LOG(COVER, ERROR, "Cannot rename cover cache entry '" << tmpPath.string() << "': " << ec.message());
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+
+        updateCacheSize(entryReplaced ? static_cast<std::size_t>(replacedEntrySize) : 0, image.getDataSize());
+    }
+
+    void DiskImageCache::updateCacheSize(std::size_t removedSize, std::size_t addedSize)
+    {
+        // the removed size may be larger than the tracked size if a prune ran concurrently
+        std::size_t cacheSize{ _cacheSize.load() };
+        while (!_cacheSize.compare_exchange_weak(cacheSize, cacheSize - std::min(removedSize, cacheSize) + addedSize))
+            ;
+    }
+
+    std::vector<DiskImageCache::Entry> DiskImageCache::listEntries() const
+    {
+        std::vector<Entry> entries;
+
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator itPath{ _cacheDirectory, ec }, itEnd; !ec && itPath != itEnd; itPath.increment(ec))
+        {
+            if (!itPath->is_regular_file(ec))
+                continue;
+
+            Entry entry{ itPath->path(), itPath->file_size(ec), itPath->last_write_time(ec) };
+            if (ec)
+                continue;
+
+            entries.push_back(std::move(entry));
+        }
+
+        return entries;
+    }
+
+    void DiskImageCache::prune()
+    {
+        if (!isEnabled())
+            return;
+
+        // No need to list the whole cache directory as long as it fits
+        if (_cacheSize <= _maxCacheSize)
+            return;
+
+        LMS_SCOPED_TRACE_OVERVIEW("Cover", "DiskCachePrune");
+
+        std::vector<Entry> entries{ listEntries() };
+        std::uintmax_t totalSize{};
+        for (const Entry& entry : entries)
+            totalSize += entry.size;
+
+        LMS_LOG(COVER, DEBUG, "Disk cache stats: hits = " << _cacheHits.load() << ", misses = " << _cacheMisses.load() << ", nb entries = " << entries.size() << ", size = " << totalSize);
+
+        if (totalSize <= _maxCacheSize)
+        {
+            _cacheSize = totalSize;
+            return;
+        }
+
+        // Leave some room to avoid pruning again too soon
+        const std::uintmax_t targetSize{ _maxCacheSize - _maxCacheSize / 10 };
+
+        std::sort(std::begin(entries), std::end(entries), [](const Entry& lhs, const Entry& rhs) { return lhs.lastWriteTime < rhs.lastWriteTime; });
+
+        std::size_t removedCount{};
+        for (const Entry& entry : entries)
+        {
+            if (totalSize <= targetSize)
+                break;
+
+            std::error_code ec;
+            if (std::filesystem::remove(entry.path, ec))
+            {
+                totalSize -= entry.size;
+                removedCount++;
+            }
+        }
+        _cacheSize = totalSize;
+
+        LMS_LOG(COVER, INFO, "Removed " << removedCount << " entries from the cover disk cache");
+    }
+
+    void DiskImageCache::fillStats(CacheStats& stats) const
+    {
+        stats.diskCacheMaxSize = _maxCacheSize;
+        stats.diskCacheHits = _cacheHits.load();
+        stats.diskCacheMisses = _cacheMisses.load();
+    }
+}
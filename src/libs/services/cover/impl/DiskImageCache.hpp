@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <Wt/WDateTime.h>
+
+#include "image/IEncodedImage.hpp"
+#include "services/cover/ICoverService.hpp"
+
+namespace lms::cover
+{
+    // Persistent store of resized and encoded images, keyed by their source file
+    // Entries are invalidated as soon as the source file is modified
+    class DiskImageCache
+    {
+    public:
+        DiskImageCache(const std::filesystem::path& cacheDirectory, std::size_t maxCacheSize);
+
+        struct EntryDesc
+        {
+            const std::filesystem::path& sourcePath; // file the image has been extracted from
+            Wt::WDateTime sourceLastWriteTime; // as indexed in the database, so that lookups do not need to access the source file
+            image::ImageSize size;
+            unsigned jpegQuality;
+        };
+
+        bool isEnabled() const { return _maxCacheSize > 0; }
+        std::size_t getMaxCacheSize() const { return _maxCacheSize; }
+        std::size_t getCacheSize() const { return _cacheSize; }
+
+        std::unique_ptr<image::IEncodedImage> getImage(const EntryDesc& entryDesc) const;
+        void addImage(const EntryDesc& entryDesc, const image::IEncodedImage& image);
+
+        // Remove the least recently used entries until the cache fits in its max size
+        // Does nothing if the cache already fits in its max size
+        void prune();
+
+        void fillStats(CacheStats& stats) const;
+
+    private:
+        std::filesystem::path getEntryPath(const EntryDesc& entryDesc) const;
+        void updateCacheSize(std::size_t removedSize, std::size_t addedSize);
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::uintmax_t size;
+            std::filesystem::file_time_type lastWriteTime;
+        };
+        std::vector<Entry> listEntries() const;
+
+        const std::filesystem::path _cacheDirectory;
+        const std::size_t _maxCacheSize;
+        std::atomic<std::size_t> _cacheSize{}; // kept up to date when adding entries, only computed from the cache directory at startup and when pruning
+
+        mutable std::atomic<std::size_t> _cacheMisses{};
+        mutable std::atomic<std::size_t> _cacheHits{};
+    };
+}
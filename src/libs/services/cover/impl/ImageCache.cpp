@@ -19,55 +19,206 @@
 
 #include "ImageCache.hpp"
 
-#include <mutex>
-
-#include "core/Random.hpp"
 #include "core/ILogger.hpp"
 
 namespace lms::cover
 {
-    ImageCache::ImageCache(std::size_t maxCacheSize)
-        : _maxCacheSize{ maxCacheSize }
+    namespace
+    {
+        // share of each shard reserved to entries that have been hit at least once after their insertion
+        constexpr std::size_t protectedSegmentPercent{ 80 };
+    }
+
+    ImageCache::Shard::Shard(std::atomic<std::size_t>& cacheSize, std::size_t maxCacheSize)
+        : _cacheSize{ cacheSize }
+        , _maxCacheSize{ maxCacheSize }
     {}
 
-    void ImageCache::addImage(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image)
+    void ImageCache::Shard::add(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image)
     {
-        const std::unique_lock lock{ _mutex };
+        const std::scoped_lock lock{ _mutex };
 
-        while (_cacheSize + image->getDataSize() > _maxCacheSize && !_cache.empty())
-        {
-            auto itRandom{ core::random::pickRandom(_cache) };
-            _cacheSize -= itRandom->second->getDataSize();
-            _cache.erase(itRandom);
-        }
+        if (auto it{ _entries.find(entryDesc) }; it != std::cend(_entries))
+            erase(it->second);
 
+        _probation.push_front(Entry{ entryDesc, image, Segment::Probation });
+        _probationSize += image->getDataSize();
         _cacheSize += image->getDataSize();
-        _cache[entryDesc] = image;
+        _entries.emplace(entryDesc, std::begin(_probation));
     }
 
-    std::shared_ptr<image::IEncodedImage> ImageCache::getImage(const EntryDesc& entryDesc) const
+    std::size_t ImageCache::Shard::evict(Segment segment, std::size_t requiredSize)
     {
-        const std::shared_lock lock{ _mutex };
+        const std::scoped_lock lock{ _mutex };
+
+        EntryList& list{ getList(segment) };
 
-        const auto it{ _cache.find(entryDesc) };
-        if (it == std::cend(_cache))
+        std::size_t evictionCount{};
+        while (_cacheSize + requiredSize > _maxCacheSize && !list.empty())
         {
-            ++_cacheMisses;
+            erase(std::prev(std::end(list)));
+            evictionCount++;
+        }
+
+        return evictionCount;
+    }
+
+    std::shared_ptr<image::IEncodedImage> ImageCache::Shard::get(const EntryDesc& entryDesc)
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        const auto it{ _entries.find(entryDesc) };
+        if (it == std::cend(_entries))
             return nullptr;
+
+        const EntryList::iterator itEntry{ it->second };
+        moveToFront(itEntry, Segment::Protected);
+
+        // demote the least recently used protected entries
+        while (_protectedSize > (_probationSize + _protectedSize) * protectedSegmentPercent / 100 && _protected.size() > 1)
+            moveToFront(std::prev(std::end(_protected)), Segment::Probation);
+
+        return itEntry->image;
+    }
+
+    std::shared_ptr<image::IEncodedImage> ImageCache::Shard::peek(const EntryDesc& entryDesc) const
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        const auto it{ _entries.find(entryDesc) };
+        if (it == std::cend(_entries))
+            return nullptr;
+
+        return it->second->image;
+    }
+
+    void ImageCache::Shard::clear()
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        _cacheSize -= _probationSize + _protectedSize;
+        _entries.clear();
+        _probation.clear();
+        _protected.clear();
+        _probationSize = 0;
+        _protectedSize = 0;
+    }
+
+    std::size_t ImageCache::Shard::getSize() const
+    {
+        const std::scoped_lock lock{ _mutex };
+        return _probationSize + _protectedSize;
+    }
+
+    std::size_t ImageCache::Shard::getEntryCount() const
+    {
+        const std::scoped_lock lock{ _mutex };
+        return _entries.size();
+    }
+
+    void ImageCache::Shard::moveToFront(EntryList::iterator it, Segment segment)
+    {
+        const std::size_t entrySize{ it->image->getDataSize() };
+
+        getSegmentSize(it->segment) -= entrySize;
+        getList(segment).splice(std::begin(getList(segment)), getList(it->segment), it);
+        getSegmentSize(segment) += entrySize;
+        it->segment = segment;
+    }
+
+    void ImageCache::Shard::erase(EntryList::iterator it)
+    {
+        getSegmentSize(it->segment) -= it->image->getDataSize();
+        _cacheSize -= it->image->getDataSize();
+        _entries.erase(it->desc);
+        getList(it->segment).erase(it);
+    }
+
+    ImageCache::ImageCache(std::size_t maxCacheSize)
+        : _maxCacheSize{ maxCacheSize }
+    {
+        _shards.reserve(_shardCount);
+        for (std::size_t i{}; i < _shardCount; ++i)
+            _shards.push_back(std::make_unique<Shard>(_cacheSize, _maxCacheSize));
+    }
+
+    std::size_t ImageCache::getShardIndex(const EntryDesc& entryDesc) const
+    {
+        return EntryHasher{}(entryDesc) % _shardCount;
+    }
+
+    void ImageCache::addImage(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image)
+    {
+        const std::size_t imageSize{ image->getDataSize() };
+        if (imageSize > _maxCacheSize)
+            return;
+
+        // Make room first: probationary entries of all the shards are evicted before the protected ones
+        const std::size_t shardIndex{ getShardIndex(entryDesc) };
+        std::size_t evictionCount{};
+        for (const Segment segment : { Segment::Probation, Segment::Protected })
+        {
+            for (std::size_t i{}; i < _shardCount && _cacheSize + imageSize > _maxCacheSize; ++i)
+                evictionCount += _shards[(shardIndex + i) % _shardCount]->evict(segment, imageSize);
         }
+        _evictions += evictionCount;
 
-        ++_cacheHits;
-        return it->second;
+        _shards[shardIndex]->add(entryDesc, image);
+    }
+
+    std::shared_ptr<image::IEncodedImage> ImageCache::getImage(const EntryDesc& entryDesc)
+    {
+        std::shared_ptr<image::IEncodedImage> image{ _shards[getShardIndex(entryDesc)]->get(entryDesc) };
+
+        const std::size_t bucketIndex{ getSizeBucketIndex(entryDesc.size) };
+        if (image)
+            ++_cacheHits[bucketIndex];
+        else
+            ++_cacheMisses[bucketIndex];
+
+        return image;
+    }
+
+    std::shared_ptr<image::IEncodedImage> ImageCache::peekImage(const EntryDesc& entryDesc) const
+    {
+        return _shards[getShardIndex(entryDesc)]->peek(entryDesc);
     }
 
     void ImageCache::flush()
     {
-        const std::unique_lock lock{ _mutex };
+        CacheStats stats;
+        fillStats(stats);
+        LMS_LOG(COVER, DEBUG, "Cache stats: hits = " << stats.hits << ", misses = " << stats.misses << ", evictions = " << stats.evictions << ", nb entries = " << stats.entryCount << ", size = " << stats.size);
+
+        for (auto& shard : _shards)
+            shard->clear();
+    }
+
+    void ImageCache::fillStats(CacheStats& stats) const
+    {
+        stats.maxSize = _maxCacheSize;
+        stats.size = 0;
+        stats.entryCount = 0;
+        for (const auto& shard : _shards)
+        {
+            stats.size += shard->getSize();
+            stats.entryCount += shard->getEntryCount();
+        }
+
+        stats.hits = 0;
+        stats.misses = 0;
+        stats.sizeStats.clear();
+        for (std::size_t i{}; i < coverSizeBuckets.size(); ++i)
+        {
+            const std::size_t hits{ _cacheHits[i].load() };
+            const std::size_t misses{ _cacheMisses[i].load() };
+
+            stats.hits += hits;
+            stats.misses += misses;
+            if (hits + misses > 0)
+                stats.sizeStats.push_back(CacheStats::SizeStats{ coverSizeBuckets[i], hits, misses });
+        }
 
-        LMS_LOG(COVER, DEBUG, "Cache stats: hits = " << _cacheHits.load() << ", misses = " << _cacheMisses.load() << ", nb entries = " << _cache.size() << ", size = " << _cacheSize);
-        _cacheHits = 0;
-        _cacheMisses = 0;
-        _cacheSize = 0;
-        _cache.clear();
+        stats.evictions = _evictions.load();
     }
-}
\ No newline at end of file
+}
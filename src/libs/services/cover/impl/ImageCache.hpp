@@ -19,18 +19,28 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
-#include <shared_mutex>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "database/ArtistId.hpp"
 #include "database/ReleaseId.hpp"
 #include "database/TrackId.hpp"
 #include "image/IEncodedImage.hpp"
+#include "services/cover/ICoverService.hpp"
+#include "CoverSizes.hpp"
 
 namespace lms::cover
 {
+    // Sharded segmented LRU cache:
+    // new entries go in a probationary segment, and are promoted to a protected segment when hit again
+    // Evictions are taken from the probationary segment first, so that popular entries are not evicted by one-off ones
+    // The max size is shared by all the shards: a single entry may use up to the whole cache
     class ImageCache
     {
     public:
@@ -45,28 +55,81 @@ namespace lms::cover
             bool operator==(const EntryDesc& other) const = default;
         };
 
+        struct EntryHasher
+        {
+            std::size_t operator()(const EntryDesc& entry) const
+            {
+                return std::hash<EntryDesc::VariantType>{}(entry.id) ^ std::hash<std::size_t>{}(entry.size);
+            }
+        };
+
         std::size_t getMaxCacheSize() const { return _maxCacheSize; }
 
         void addImage(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image);
-        std::shared_ptr<image::IEncodedImage> getImage(const EntryDesc& entryDesc) const;
+        std::shared_ptr<image::IEncodedImage> getImage(const EntryDesc& entryDesc);
+        std::shared_ptr<image::IEncodedImage> peekImage(const EntryDesc& entryDesc) const; // does not update stats nor recency
         void flush();
 
-    private:
-        const std::size_t _maxCacheSize;
+        void fillStats(CacheStats& stats) const;
 
-        mutable std::shared_mutex _mutex;
+    private:
+        enum class Segment
+        {
+            Probation,
+            Protected,
+        };
 
-        struct EntryHasher
+        class Shard
         {
-            std::size_t operator()(const EntryDesc& entry) const
+        public:
+            Shard(std::atomic<std::size_t>& cacheSize, std::size_t maxCacheSize);
+
+            void add(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image);
+            // Evicts the least recently used entries of the segment in this shard until the cache has room for requiredSize, returns the number of evicted entries
+            std::size_t evict(Segment segment, std::size_t requiredSize);
+            std::shared_ptr<image::IEncodedImage> get(const EntryDesc& entryDesc);
+            std::shared_ptr<image::IEncodedImage> peek(const EntryDesc& entryDesc) const;
+            void clear();
+
+            std::size_t getSize() const;
+            std::size_t getEntryCount() const;
+
+        private:
+            struct Entry
             {
-                return std::hash<EntryDesc::VariantType>{}(entry.id) ^ std::hash<std::size_t>{}(entry.size);
-            }
+                EntryDesc desc;
+                std::shared_ptr<image::IEncodedImage> image;
+                Segment segment;
+            };
+            using EntryList = std::list<Entry>; // most recently used first
+
+            EntryList& getList(Segment segment) { return segment == Segment::Probation ? _probation : _protected; }
+            std::size_t& getSegmentSize(Segment segment) { return segment == Segment::Probation ? _probationSize : _protectedSize; }
+            void moveToFront(EntryList::iterator it, Segment segment);
+            void erase(EntryList::iterator it);
+
+            std::atomic<std::size_t>& _cacheSize;
+            const std::size_t _maxCacheSize;
+
+            mutable std::mutex _mutex;
+            EntryList _probation;
+            EntryList _protected;
+            std::size_t _probationSize{};
+            std::size_t _protectedSize{};
+            std::unordered_map<EntryDesc, EntryList::iterator, EntryHasher> _entries;
         };
 
-        std::unordered_map<EntryDesc, std::shared_ptr<image::IEncodedImage>, EntryHasher> _cache;
-        std::size_t                 _cacheSize{};
-        mutable std::atomic<std::size_t>    _cacheMisses{};
-        mutable std::atomic<std::size_t>    _cacheHits{};
+        std::size_t getShardIndex(const EntryDesc& entryDesc) const;
+
+        static constexpr std::size_t _shardCount{ 16 };
+
+        const std::size_t _maxCacheSize;
+        std::atomic<std::size_t> _cacheSize{}; // sum of the shard sizes
+        std::vector<std::unique_ptr<Shard>> _shards;
+
+        // per size bucket
+        std::array<std::atomic<std::size_t>, coverSizeBuckets.size()>   _cacheMisses{};
+        std::array<std::atomic<std::size_t>, coverSizeBuckets.size()>   _cacheHits{};
+        std::atomic<std::size_t>                                        _evictions{};
     };
-}
\ No newline at end of file
+}
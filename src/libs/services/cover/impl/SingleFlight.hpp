@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace lms::cover
+{
+    // Coalesces concurrent calls for the same key: only one caller actually runs the function,
+    // the other ones wait for its result
+    template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+    class SingleFlight
+    {
+    public:
+        template <typename Func>
+        Value run(const Key& key, Func&& func)
+        {
+            std::promise<Value> promise;
+            std::shared_future<Value> pendingResult;
+            {
+                const std::scoped_lock lock{ _mutex };
+
+                if (auto it{ _inProgress.find(key) }; it != std::cend(_inProgress))
+                    pendingResult = it->second;
+                else
+                    _inProgress.emplace(key, promise.get_future().share());
+            }
+
+            if (pendingResult.valid())
+                return pendingResult.get();
+
+            try
+            {
+                Value value{ func() };
+                promise.set_value(value);
+                remove(key);
+                return value;
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+                remove(key);
+                throw;
+            }
+        }
+
+    private:
+        void remove(const Key& key)
+        {
+            const std::scoped_lock lock{ _mutex };
+            _inProgress.erase(key);
+        }
+
+        std::mutex _mutex;
+        std::unordered_map<Key, std::shared_future<Value>, Hasher> _inProgress;
+    };
+}
@@ -21,6 +21,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 #include "database/ArtistId.hpp"
 #include "database/ReleaseId.hpp"
@@ -34,6 +35,29 @@ namespace lms::db
 
 namespace lms::cover
 {
+    // Counters are accumulated since startup
+    struct CacheStats
+    {
+        std::size_t maxSize{};
+        std::size_t size{};
+        std::size_t entryCount{};
+        std::size_t hits{};
+        std::size_t misses{};
+        std::size_t evictions{};
+
+        struct SizeStats
+        {
+            image::ImageSize size;
+            std::size_t hits;
+            std::size_t misses;
+        };
+        std::vector<SizeStats> sizeStats; // only sizes that have been requested
+
+        std::size_t diskCacheMaxSize{}; // 0 if disabled
+        std::size_t diskCacheHits{};
+        std::size_t diskCacheMisses{};
+    };
+
     class ICoverService
     {
     public:
@@ -43,14 +67,21 @@ namespace lms::cover
         virtual std::shared_ptr<image::IEncodedImage> getFromRelease(db::ReleaseId releaseId, image::ImageSize width) = 0;
         virtual std::shared_ptr<image::IEncodedImage> getFromArtist(db::ArtistId artistId, image::ImageSize width) = 0;
 
+        // Only fills the disk cache, so that the in-memory cache is left to the covers that are actually requested
+        virtual void pregenerateReleaseCover(db::ReleaseId releaseId, image::ImageSize width) = 0;
+
         virtual std::shared_ptr<image::IEncodedImage> getDefaultSvgCover() = 0;
 
         virtual void flushCache() = 0;
+        virtual CacheStats getCacheStats() const = 0;
 
         virtual void setJpegQuality(unsigned quality) = 0; // from 1 to 100
     };
 
     std::unique_ptr<ICoverService> createCoverService(db::Db& db, const std::filesystem::path& defaultSvgCoverPath);
 
+    // Extensions of the image files that can be used as covers
+    const std::vector<std::filesystem::path>& getSupportedFileExtensions();
+
 } // namespace lms::coverArt
 
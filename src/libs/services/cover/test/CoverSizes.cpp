@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "CoverSizes.hpp"
+
+namespace lms::cover::tests
+{
+    TEST(CoverSizes, bucketsAreSortedAndClose)
+    {
+        for (std::size_t i{ 1 }; i < coverSizeBuckets.size(); ++i)
+        {
+            EXPECT_LT(coverSizeBuckets[i - 1], coverSizeBuckets[i]);
+            // served covers are never much larger than requested
+            if (coverSizeBuckets[i - 1] >= 128)
+                EXPECT_LE(coverSizeBuckets[i] * 2, coverSizeBuckets[i - 1] * 3) << "bucket " << coverSizeBuckets[i];
+            else
+                EXPECT_LE(coverSizeBuckets[i], coverSizeBuckets[i - 1] * 2) << "bucket " << coverSizeBuckets[i];
+        }
+    }
+
+    TEST(CoverSizes, getSizeBucket)
+    {
+        // exact sizes
+        for (const image::ImageSize size : coverSizeBuckets)
+            EXPECT_EQ(getSizeBucket(size), size);
+
+        // smallest bucket greater or equal
+        EXPECT_EQ(getSizeBucket(0), 32);
+        EXPECT_EQ(getSizeBucket(1), 32);
+        EXPECT_EQ(getSizeBucket(33), 64);
+        EXPECT_EQ(getSizeBucket(300), 384);
+        EXPECT_EQ(getSizeBucket(1025), 1536);
+
+        // capped to the largest bucket
+        EXPECT_EQ(getSizeBucket(2049), 2048);
+        EXPECT_EQ(getSizeBucket(10000), 2048);
+    }
+
+    TEST(CoverSizes, getSizeBucketIndex)
+    {
+        EXPECT_EQ(getSizeBucketIndex(32), 0);
+        EXPECT_EQ(getSizeBucketIndex(100), 2);
+        EXPECT_EQ(getSizeBucketIndex(10000), coverSizeBuckets.size() - 1);
+
+        // different requested sizes share the same cache entries
+        EXPECT_EQ(getSizeBucketIndex(257), getSizeBucketIndex(384));
+    }
+}
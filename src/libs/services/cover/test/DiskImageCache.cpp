@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include "DiskImageCache.hpp"
+
+namespace lms::cover::tests
+{
+    namespace
+    {
+        class TestImage : public image::IEncodedImage
+        {
+        public:
+            TestImage(std::size_t size, std::byte value) : _data(size, value) {}
+
+        private:
+            const std::byte* getData() const override { return _data.data(); }
+            std::size_t getDataSize() const override { return _data.size(); }
+            std::string_view getMimeType() const override { return "image/jpeg"; }
+
+            const std::vector<std::byte> _data;
+        };
+
+        class DiskImageCacheTest : public ::testing::Test
+        {
+        protected:
+            void SetUp() override
+            {
+                std::filesystem::remove_all(_cacheDirectory);
+            }
+
+            void TearDown() override
+            {
+                std::filesystem::remove_all(_cacheDirectory);
+            }
+
+            // make the entries already in cache look older than the next ones
+            void ageEntries()
+            {
+                const auto oldTime{ std::filesystem::file_time_type::clock::now() - std::chrono::hours{ 2 } };
+                for (const auto& entry : std::filesystem::recursive_directory_iterator{ _cacheDirectory })
+                {
+                    if (entry.is_regular_file())
+                        std::filesystem::last_write_time(entry.path(), oldTime);
+                }
+            }
+
+            const std::filesystem::path _cacheDirectory{ std::filesystem::temp_directory_path() / ("lms-test-disk-cache-" + std::to_string(::getpid())) };
+            const std::filesystem::path _sourcePath{ "/music/artist/release/cover.jpg" };
+            const Wt::WDateTime _sourceLastWriteTime{ Wt::WDate{ 2024, 1, 1 } };
+        };
+    }
+
+    TEST_F(DiskImageCacheTest, hit)
+    {
+        DiskImageCache cache{ _cacheDirectory, 1000 };
+
+        const DiskImageCache::EntryDesc entryDesc{ _sourcePath, _sourceLastWriteTime, 128, 75 };
+        EXPECT_EQ(cache.getImage(entryDesc), nullptr);
+
+        cache.addImage(entryDesc, TestImage{ 100, std::byte{ 42 } });
+        EXPECT_EQ(cache.getCacheSize(), 100);
+
+        const std::unique_ptr<image::IEncodedImage> image{ cache.getImage(entryDesc) };
+        ASSERT_NE(image, nullptr);
+        ASSERT_EQ(image->getDataSize(), 100);
+        EXPECT_EQ(image->getData()[0], std::byte{ 42 });
+
+        // other sizes and qualities are different entries
+        EXPECT_EQ(cache.getImage(DiskImageCache::EntryDesc{ _sourcePath, _sourceLastWriteTime, 256, 75 }), nullptr);
+        EXPECT_EQ(cache.getImage(DiskImageCache::EntryDesc{ _sourcePath, _sourceLastWriteTime, 128, 50 }), nullptr);
+
+        CacheStats stats;
+        cache.fillStats(stats);
+        EXPECT_EQ(stats.diskCacheHits, 1);
+        EXPECT_EQ(stats.diskCacheMisses, 3);
+    }
+
+    TEST_F(DiskImageCacheTest, persistence)
+    {
+        const DiskImageCache::EntryDesc entryDesc{ _sourcePath, _sourceLastWriteTime, 128, 75 };
+        {
+            DiskImageCache cache{ _cacheDirectory, 1000 };
+            cache.addImage(entryDesc, TestImage{ 100, std::byte{ 42 } });
+        }
+
+        DiskImageCache cache{ _cacheDirectory, 1000 };
+        EXPECT_EQ(cache.getCacheSize(), 100);
+        EXPECT_NE(cache.getImage(entryDesc), nullptr);
+    }
+
+    TEST_F(DiskImageCacheTest, sourceModified)
+    {
+        DiskImageCache cache{ _cacheDirectory, 1000 };
+
+        cache.addImage(DiskImageCache::EntryDesc{ _sourcePath, _sourceLastWriteTime, 128, 75 }, TestImage{ 100, std::byte{ 42 } });
+        EXPECT_EQ(cache.getImage(DiskImageCache::EntryDesc{ _sourcePath, _sourceLastWriteTime.addSecs(1), 128, 75 }), nullptr);
+
+        // unknown last write time: not cached
+        const DiskImageCache::EntryDesc unknownLastWriteEntryDesc{ _sourcePath, Wt::WDateTime{}, 128, 75 };
+        cache.addImage(unknownLastWriteEntryDesc, TestImage{ 100, std::byte{ 42 } });
+        EXPECT_EQ(cache.getImage(unknownLastWriteEntryDesc), nullptr);
+        EXPECT_EQ(cache.getCacheSize(), 100);
+    }
+
+    TEST_F(DiskImageCacheTest, prune)
+    {
+        DiskImageCache cache{ _cacheDirectory, 1000 };
+
+        const DiskImageCache::EntryDesc entryDesc1{ _sourcePath, _sourceLastWriteTime, 128, 75 };
+        const DiskImageCache::EntryDesc entryDesc2{ _sourcePath, _sourceLastWriteTime, 256, 75 };
+        const DiskImageCache::EntryDesc entryDesc3{ _sourcePath, _sourceLastWriteTime, 512, 75 };
+
+        cache.addImage(entryDesc1, TestImage{ 400, std::byte{ 1 } });
+        ageEntries();
+        cache.addImage(entryDesc2, TestImage{ 400, std::byte{ 2 } });
+
+        // fits: nothing removed
+        cache.prune();
+        EXPECT_EQ(cache.getCacheSize(), 800);
+        EXPECT_NE(cache.getImage(entryDesc1), nullptr);
+
+        cache.addImage(entryDesc3, TestImage{ 400, std::byte{ 3 } });
+        EXPECT_EQ(cache.getCacheSize(), 1200);
+
+        // least recently used entry removed first
+        cache.prune();
+        EXPECT_EQ(cache.getCacheSize(), 800);
+        EXPECT_EQ(cache.getImage(entryDesc1), nullptr);
+        EXPECT_NE(cache.getImage(entryDesc2), nullptr);
+        EXPECT_NE(cache.getImage(entryDesc3), nullptr);
+    }
+}
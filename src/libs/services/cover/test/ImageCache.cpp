@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ImageCache.hpp"
+
+namespace lms::cover::tests
+{
+    namespace
+    {
+        class TestImage : public image::IEncodedImage
+        {
+        public:
+            TestImage(std::size_t size) : _data(size) {}
+
+        private:
+            const std::byte* getData() const override { return _data.data(); }
+            std::size_t getDataSize() const override { return _data.size(); }
+            std::string_view getMimeType() const override { return "image/jpeg"; }
+
+            const std::vector<std::byte> _data;
+        };
+
+        ImageCache::EntryDesc createEntryDesc(db::TrackId::ValueType trackId)
+        {
+            return ImageCache::EntryDesc{ db::TrackId{ trackId }, 128 };
+        }
+
+        CacheStats getStats(const ImageCache& cache)
+        {
+            CacheStats stats;
+            cache.fillStats(stats);
+            return stats;
+        }
+    }
+
+    TEST(ImageCache, hitMiss)
+    {
+        ImageCache cache{ 1000 };
+
+        EXPECT_EQ(cache.getImage(createEntryDesc(1)), nullptr);
+
+        const auto image{ std::make_shared<TestImage>(100) };
+        cache.addImage(createEntryDesc(1), image);
+        EXPECT_EQ(cache.getImage(createEntryDesc(1)), image);
+        EXPECT_EQ(cache.getImage(ImageCache::EntryDesc{ db::TrackId{ 1 }, 256 }), nullptr);
+        EXPECT_EQ(cache.getImage(ImageCache::EntryDesc{ db::ReleaseId{ 1 }, 128 }), nullptr);
+
+        // peek does not count
+        EXPECT_EQ(cache.peekImage(createEntryDesc(1)), image);
+
+        const CacheStats stats{ getStats(cache) };
+        EXPECT_EQ(stats.hits, 1);
+        EXPECT_EQ(stats.misses, 3);
+        EXPECT_EQ(stats.entryCount, 1);
+        EXPECT_EQ(stats.size, 100);
+
+        cache.flush();
+        EXPECT_EQ(cache.getImage(createEntryDesc(1)), nullptr);
+        EXPECT_EQ(getStats(cache).size, 0);
+    }
+
+    TEST(ImageCache, replace)
+    {
+        ImageCache cache{ 1000 };
+
+        cache.addImage(createEntryDesc(1), std::make_shared<TestImage>(100));
+        const auto image{ std::make_shared<TestImage>(200) };
+        cache.addImage(createEntryDesc(1), image);
+
+        EXPECT_EQ(cache.getImage(createEntryDesc(1)), image);
+        EXPECT_EQ(getStats(cache).entryCount, 1);
+        EXPECT_EQ(getStats(cache).size, 200);
+    }
+
+    TEST(ImageCache, eviction)
+    {
+        ImageCache cache{ 1000 };
+
+        for (db::TrackId::ValueType i{}; i < 100; ++i)
+        {
+            cache.addImage(createEntryDesc(i), std::make_shared<TestImage>(100));
+            EXPECT_LE(getStats(cache).size, 1000);
+        }
+
+        const CacheStats stats{ getStats(cache) };
+        EXPECT_EQ(stats.entryCount, 10);
+        EXPECT_EQ(stats.size, 1000);
+        EXPECT_EQ(stats.evictions, 90);
+    }
+
+    TEST(ImageCache, frequentEntriesKept)
+    {
+        ImageCache cache{ 1000 };
+
+        // hit after its insertion: protected
+        const ImageCache::EntryDesc frequentEntryDesc{ createEntryDesc(0) };
+        cache.addImage(frequentEntryDesc, std::make_shared<TestImage>(100));
+        ASSERT_NE(cache.getImage(frequentEntryDesc), nullptr);
+
+        // one-off entries, more than the cache can hold
+        for (db::TrackId::ValueType i{ 1 }; i < 100; ++i)
+            cache.addImage(createEntryDesc(i), std::make_shared<TestImage>(100));
+
+        EXPECT_LE(getStats(cache).size, 1000);
+        EXPECT_NE(cache.peekImage(frequentEntryDesc), nullptr);
+    }
+
+    TEST(ImageCache, sizeLimit)
+    {
+        ImageCache cache{ 1000 };
+
+        // larger than the cache: never cached
+        cache.addImage(createEntryDesc(1), std::make_shared<TestImage>(1001));
+        EXPECT_EQ(cache.peekImage(createEntryDesc(1)), nullptr);
+        EXPECT_EQ(getStats(cache).size, 0);
+
+        // entries may be much larger than a shard share of the cache
+        for (db::TrackId::ValueType i{ 2 }; i < 10; ++i)
+            cache.addImage(createEntryDesc(i), std::make_shared<TestImage>(100));
+
+        cache.addImage(createEntryDesc(10), std::make_shared<TestImage>(1000));
+        EXPECT_NE(cache.peekImage(createEntryDesc(10)), nullptr);
+
+        const CacheStats stats{ getStats(cache) };
+        EXPECT_EQ(stats.entryCount, 1);
+        EXPECT_EQ(stats.size, 1000);
+    }
+}
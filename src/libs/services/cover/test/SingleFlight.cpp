@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "SingleFlight.hpp"
+
+namespace lms::cover::tests
+{
+    TEST(SingleFlight, sequentialCallsAreNotCoalesced)
+    {
+        SingleFlight<int, int> singleFlight;
+
+        std::size_t callCount{};
+        EXPECT_EQ(singleFlight.run(1, [&] { return static_cast<int>(++callCount); }), 1);
+        EXPECT_EQ(singleFlight.run(1, [&] { return static_cast<int>(++callCount); }), 2);
+        EXPECT_EQ(callCount, 2);
+    }
+
+    TEST(SingleFlight, concurrentCallsAreCoalesced)
+    {
+        SingleFlight<int, int> singleFlight;
+
+        constexpr std::size_t waiterCount{ 8 };
+        std::atomic<std::size_t> callCount{};
+        std::latch leaderStarted{ 1 };
+        std::latch waitersStarted{ waiterCount };
+
+        std::thread leader{ [&]
+            {
+                EXPECT_EQ(singleFlight.run(1, [&]
+                    {
+                        ++callCount;
+                        leaderStarted.count_down();
+                        waitersStarted.wait();
+                        // give the waiters some time to actually wait for the result
+                        std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+                        return 42;
+                    }), 42);
+            } };
+
+        leaderStarted.wait();
+
+        std::vector<std::thread> waiters;
+        for (std::size_t i{}; i < waiterCount; ++i)
+        {
+            waiters.emplace_back([&]
+                {
+                    waitersStarted.count_down();
+                    EXPECT_EQ(singleFlight.run(1, [&] { ++callCount; return 0; }), 42);
+                });
+        }
+
+        // other keys are not blocked
+        EXPECT_EQ(singleFlight.run(2, [] { return 2; }), 2);
+
+        leader.join();
+        for (std::thread& waiter : waiters)
+            waiter.join();
+
+        EXPECT_EQ(callCount, 1);
+    }
+
+    TEST(SingleFlight, exception)
+    {
+        SingleFlight<int, int> singleFlight;
+
+        EXPECT_THROW(singleFlight.run(1, []() -> int { throw std::runtime_error{ "failure" }; }), std::runtime_error);
+
+        // not kept once failed
+        EXPECT_EQ(singleFlight.run(1, [] { return 1; }), 1);
+    }
+}
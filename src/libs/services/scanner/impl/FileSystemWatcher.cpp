@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileSystemWatcher.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <tuple>
+
+#include "core/Exception.hpp"
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+#include "ScanStepBase.hpp"
+
+namespace lms::scanner
+{
+    namespace
+    {
+        constexpr std::uint32_t watchMask{ IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR };
+
+        // Changes are reported even if events keep coming, so that long copies are progressively scanned
+        constexpr unsigned maxDebounceDelayFactor{ 10 };
+    }
+
+    bool isSameOrSubDirectory(const std::filesystem::path& directory, const std::filesystem::path& parentDirectory)
+    {
+        auto itDirectory{ std::cbegin(directory) };
+        for (const std::filesystem::path& parentElement : parentDirectory)
+        {
+            if (parentElement.empty()) // trailing separator
+                break;
+
+            if (itDirectory == std::cend(directory) || *itDirectory != parentElement)
+                return false;
+
+            ++itDirectory;
+        }
+
+        return true;
+    }
+
+    std::vector<DirectoryChange> coalesceDirectoryChanges(std::vector<DirectoryChange> changes)
+    {
+        // recursive changes first, so that they are kept when merging duplicates
+        std::sort(std::begin(changes), std::end(changes), [](const DirectoryChange& lhs, const DirectoryChange& rhs) { return std::tie(lhs.directory, rhs.recursive) < std::tie(rhs.directory, lhs.recursive); });
+
+        // sub directories are sorted right after their parent directory
+        std::vector<DirectoryChange> res;
+        const DirectoryChange* lastRecursiveChange{};
+        for (const DirectoryChange& change : changes)
+        {
+            if (!res.empty() && res.back().directory == change.directory)
+                continue;
+
+            if (lastRecursiveChange && isSameOrSubDirectory(change.directory, lastRecursiveChange->directory))
+                continue;
+
+            if (change.recursive)
+                lastRecursiveChange = &change;
+
+            res.push_back(change);
+        }
+
+        return res;
+    }
+
+    FileSystemWatcher::FileSystemWatcher(std::span<const std::filesystem::path> rootDirectories, std::chrono::milliseconds debounceDelay, ChangeCallback callback)
+        : _rootDirectories(std::cbegin(rootDirectories), std::cend(rootDirectories))
+        , _debounceDelay{ debounceDelay }
+        , _callback{ std::move(callback) }
+    {
+        _inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotifyFd < 0)
+            throw core::LmsException{ std::string{ "inotify_init1 failed: " } + ::strerror(errno) };
+
+        _wakeUpFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_wakeUpFd < 0)
+        {
+            const int err{ errno };
+            ::close(_inotifyFd);
+            throw core::LmsException{ std::string{ "eventfd failed: " } + ::strerror(err) };
+        }
+
+        // watches are set up by the thread, as it may take a while on large libraries
+        _thread = std::thread{ [this] { run(); } };
+    }
+
+    FileSystemWatcher::~FileSystemWatcher()
+    {
+        {
+            std::scoped_lock lock{ _requestMutex };
+            _stopRequested = true;
+        }
+
+        const std::uint64_t value{ 1 };
+        if (::write(_wakeUpFd, &value, sizeof(value)) != sizeof(value))
+            LMS_LOG(DBUPDATER, ERROR, "Cannot stop file system watcher: " << ::strerror(errno));
+
+        _thread.join();
+
+        ::close(_wakeUpFd);
+        ::close(_inotifyFd);
+    }
+
+    void FileSystemWatcher::setRootDirectories(std::span<const std::filesystem::path> rootDirectories)
+    {
+        {
+            std::scoped_lock lock{ _requestMutex };
+            _requestedRootDirectories.emplace(std::cbegin(rootDirectories), std::cend(rootDirectories));
+        }
+
+        const std::uint64_t value{ 1 };
+        if (::write(_wakeUpFd, &value, sizeof(value)) != sizeof(value))
+            LMS_LOG(DBUPDATER, ERROR, "Cannot update watched directories: " << ::strerror(errno));
+    }
+
+    void FileSystemWatcher::run()
+    {
+        if (auto* traceLogger{ core::Service<core::tracing::ITraceLogger>::get() })
+            traceLogger->setThreadName(std::this_thread::get_id(), "FsWatcher");
+
+        for (const std::filesystem::path& rootDirectory : _rootDirectories)
+            addWatchRecursive(rootDirectory);
+
+        LMS_LOG(DBUPDATER, INFO, "Watching " << _watchedDirectories.size() << " directories for changes");
+
+        while (true)
+        {
+            int timeout{ -1 };
+            if (!_pendingDirectories.empty())
+            {
+                const clock::time_point now{ clock::now() };
+                const clock::time_point deadline{ std::min(_lastPendingEventTime + _debounceDelay, _firstPendingEventTime + maxDebounceDelayFactor * _debounceDelay) };
+                if (now >= deadline)
+                {
+                    reportPendingDirectories();
+                    continue;
+                }
+
+                timeout = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count());
+            }
+
+            std::array<::pollfd, 2> fds{ { { _inotifyFd, POLLIN, 0 }, { _wakeUpFd, POLLIN, 0 } } };
+            if (::poll(fds.data(), fds.size(), timeout) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                LMS_LOG(DBUPDATER, ERROR, "File system watcher stopped, poll failed: " << ::strerror(errno));
+                break;
+            }
+
+            if ((fds[1].revents & POLLIN) && !processRequests())
+                break;
+
+            if (fds[0].revents & POLLIN)
+                readEvents();
+        }
+    }
+
+    bool FileSystemWatcher::processRequests()
+    {
+        std::uint64_t value;
+        if (::read(_wakeUpFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+            LMS_LOG(DBUPDATER, ERROR, "Cannot read file system watcher requests: " << ::strerror(errno));
+
+        std::optional<std::vector<std::filesystem::path>> rootDirectories;
+        {
+            std::scoped_lock lock{ _requestMutex };
+            if (_stopRequested)
+                return false;
+
+            rootDirectories.swap(_requestedRootDirectories);
+        }
+
+        if (rootDirectories)
+            applyRootDirectories(std::move(*rootDirectories));
+
+        return true;
+    }
+
+    void FileSystemWatcher::applyRootDirectories(std::vector<std::filesystem::path> rootDirectories)
+    {
+        auto contains{ [](std::span<const std::filesystem::path> directories, const std::filesystem::path& directory) { return std::find(std::cbegin(directories), std::cend(directories), directory) != std::cend(directories); } };
+
+        std::vector<std::filesystem::path> removedRootDirectories;
+        for (const std::filesystem::path& rootDirectory : _rootDirectories)
+        {
+            if (!contains(rootDirectories, rootDirectory))
+                removedRootDirectories.push_back(rootDirectory);
+        }
+
+        for (const std::filesystem::path& removedRootDirectory : removedRootDirectories)
+        {
+            LMS_LOG(DBUPDATER, DEBUG, "No longer watching '" << removedRootDirectory.string() << "'");
+            removeWatchRecursive(removedRootDirectory);
+        }
+
+        for (const std::filesystem::path& rootDirectory : rootDirectories)
+        {
+            // nested root directories may have lost their watches along with a removed root directory
+            const bool added{ !contains(_rootDirectories, rootDirectory) };
+            const bool unwatched{ std::any_of(std::cbegin(removedRootDirectories), std::cend(removedRootDirectories), [&](const std::filesystem::path& removedRootDirectory)
+                {
+                    return isSameOrSubDirectory(rootDirectory, removedRootDirectory) || isSameOrSubDirectory(removedRootDirectory, rootDirectory);
+                }) };
+
+            if (added || unwatched)
+            {
+                LMS_LOG(DBUPDATER, DEBUG, "Watching '" << rootDirectory.string() << "'");
+                addWatchRecursive(rootDirectory);
+            }
+        }
+
+        _rootDirectories = std::move(rootDirectories);
+        LMS_LOG(DBUPDATER, INFO, "Watching " << _watchedDirectories.size() << " directories for changes");
+    }
+
+    void FileSystemWatcher::readEvents()
+    {
+        alignas(::inotify_event) std::array<char, 16 * 1024> buffer;
+
+        while (true)
+        {
+            const ssize_t readSize{ ::read(_inotifyFd, buffer.data(), buffer.size()) };
+            if (readSize < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                if (errno != EAGAIN)
+                    LMS_LOG(DBUPDATER, ERROR, "Cannot read file system events: " << ::strerror(errno));
+                break;
+            }
+
+            for (const char* ptr{ buffer.data() }; ptr < buffer.data() + readSize;)
+            {
+                const ::inotify_event* event{ reinterpret_cast<const ::inotify_event*>(ptr) };
+                processEvent(event->wd, event->mask, event->len > 0 ? event->name : nullptr);
+
+                ptr += sizeof(::inotify_event) + event->len;
+            }
+        }
+    }
+
+    void FileSystemWatcher::processEvent(int watchDescriptor, std::uint32_t mask, const char* name)
+    {
+        if (mask & IN_Q_OVERFLOW)
+        {
+            // Events have been lost, including directory creations: start over
+            LMS_LOG(DBUPDATER, INFO, "File system event queue overflow, all the watched directories will be scanned");
+            resetWatches();
+            for (const std::filesystem::path& rootDirectory : _rootDirectories)
+                addPendingDirectory(rootDirectory, true);
+
+            return;
+        }
+
+        const auto itWatchedDirectory{ _watchedDirectories.find(watchDescriptor) };
+        if (itWatchedDirectory == std::cend(_watchedDirectories))
+            return; // removed watch
+
+        if (mask & IN_IGNORED)
+        {
+            _watchedDirectories.erase(itWatchedDirectory);
+            return;
+        }
+
+        const std::filesystem::path directory{ itWatchedDirectory->second };
+
+        // Only useful for root directories, other directories are handled from their parent events
+        if (mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+        {
+            if (std::find(std::cbegin(_rootDirectories), std::cend(_rootDirectories), directory) != std::cend(_rootDirectories))
+            {
+                LMS_LOG(DBUPDATER, INFO, "Media library directory '" << directory.string() << "' removed or moved, no longer watched");
+                addPendingDirectory(directory, true);
+            }
+            return;
+        }
+
+        if (!name)
+            return;
+
+        const std::filesystem::path path{ directory / name };
+        if (mask & IN_ISDIR)
+        {
+            // the whole tree has to be scanned: new files, or files to be removed from the database
+            if (mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                addWatchRecursive(path);
+                addPendingDirectory(path, true);
+            }
+            else if (mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                removeWatchRecursive(path);
+                addPendingDirectory(path, true);
+            }
+        }
+        else
+            addPendingDirectory(directory, false); // only the files of this directory
+    }
+
+    void FileSystemWatcher::addWatchRecursive(const std::filesystem::path& directory)
+    {
+        if (!addWatch(directory))
+            return;
+
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator itPath{ directory, std::filesystem::directory_options::follow_directory_symlink | std::filesystem::directory_options::skip_permission_denied, ec };
+        for (const std::filesystem::recursive_directory_iterator itEnd; !ec && itPath != itEnd; itPath.increment(ec))
+        {
+            if (!itPath->is_directory(ec) || ec)
+                continue;
+
+            if (!addWatch(itPath->path()))
+                itPath.disable_recursion_pending();
+        }
+
+        if (ec)
+            LMS_LOG(DBUPDATER, ERROR, "Cannot watch directory '" << directory.string() << "': " << ec.message());
+    }
+
+    bool FileSystemWatcher::addWatch(const std::filesystem::path& directory)
+    {
+        // Excluded directories are not scanned, no need to watch them
+        std::error_code ec;
+        if (std::filesystem::exists(directory / ScanStepBase::excludeDirFileName, ec))
+            return false;
+
+        const int watchDescriptor{ ::inotify_add_watch(_inotifyFd, directory.c_str(), watchMask) };
+        if (watchDescriptor < 0)
+        {
+            if (errno != ENOSPC)
+                LMS_LOG(DBUPDATER, ERROR, "Cannot watch directory '" << directory.string() << "': " << ::strerror(errno));
+            else if (!_watchLimitReached)
+            {
+                LMS_LOG(DBUPDATER, ERROR, "Cannot watch more directories, changes in the other directories are only detected by scheduled scans. Consider raising fs.inotify.max_user_watches");
+                _watchLimitReached = true;
+            }
+
+            return false;
+        }
+
+        _watchedDirectories[watchDescriptor] = directory;
+        return true;
+    }
+
+    void FileSystemWatcher::removeWatchRecursive(const std::filesystem::path& directory)
+    {
+        for (auto it{ std::begin(_watchedDirectories) }; it != std::end(_watchedDirectories);)
+        {
+            if (isSameOrSubDirectory(it->second, directory))
+            {
+                ::inotify_rm_watch(_inotifyFd, it->first); // may already be removed by the kernel
+                it = _watchedDirectories.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    void FileSystemWatcher::resetWatches()
+    {
+        for (const auto& [watchDescriptor, directory] : _watchedDirectories)
+            ::inotify_rm_watch(_inotifyFd, watchDescriptor);
+
+        _watchedDirectories.clear();
+        _watchLimitReached = false;
+
+        for (const std::filesystem::path& rootDirectory : _rootDirectories)
+            addWatchRecursive(rootDirectory);
+    }
+
+    void FileSystemWatcher::addPendingDirectory(const std::filesystem::path& directory, bool recursive)
+    {
+        const clock::time_point now{ clock::now() };
+
+        if (_pendingDirectories.empty())
+            _firstPendingEventTime = now;
+        _lastPendingEventTime = now;
+
+        _pendingDirectories[directory] |= recursive;
+    }
+
+    void FileSystemWatcher::reportPendingDirectories()
+    {
+        std::vector<DirectoryChange> changes;
+        for (const auto& [directory, recursive] : _pendingDirectories)
+            changes.push_back(DirectoryChange{ directory, recursive });
+        _pendingDirectories.clear();
+
+        changes = coalesceDirectoryChanges(std::move(changes));
+
+        LMS_LOG(DBUPDATER, DEBUG, "Changes detected in " << changes.size() << " directories");
+        _callback(std::move(changes));
+    }
+}
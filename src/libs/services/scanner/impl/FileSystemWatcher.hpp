@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lms::scanner
+{
+    // Lexical check, paths are expected to be normalized
+    bool isSameOrSubDirectory(const std::filesystem::path& directory, const std::filesystem::path& parentDirectory);
+
+    struct DirectoryChange
+    {
+        std::filesystem::path directory;
+        bool recursive{}; // sub directories have to be scanned too (created, moved or removed directories), otherwise only the files of the directory changed
+
+        bool operator==(const DirectoryChange& other) const = default;
+    };
+
+    // Sorted by directory, without duplicates, and without the changes already covered by a recursive change of a parent directory
+    std::vector<DirectoryChange> coalesceDirectoryChanges(std::vector<DirectoryChange> changes);
+
+    // Watches directory trees for changes using inotify, from a dedicated thread
+    // Changes are coalesced per directory and reported once no more event has been received during the debounce delay
+    class FileSystemWatcher
+    {
+    public:
+        // Called from the watcher thread
+        using ChangeCallback = std::function<void(std::vector<DirectoryChange> changes)>;
+
+        FileSystemWatcher(std::span<const std::filesystem::path> rootDirectories, std::chrono::milliseconds debounceDelay, ChangeCallback callback);
+        ~FileSystemWatcher();
+
+        std::chrono::milliseconds getDebounceDelay() const { return _debounceDelay; }
+
+        // Asynchronous, only the watches of the added or removed root directories are updated
+        void setRootDirectories(std::span<const std::filesystem::path> rootDirectories);
+
+    private:
+        FileSystemWatcher(const FileSystemWatcher&) = delete;
+        FileSystemWatcher& operator=(const FileSystemWatcher&) = delete;
+
+        using clock = std::chrono::steady_clock;
+
+        void run();
+        bool processRequests(); // returns false if stop is requested
+        void applyRootDirectories(std::vector<std::filesystem::path> rootDirectories);
+        void readEvents();
+        void processEvent(int watchDescriptor, std::uint32_t mask, const char* name);
+        void addWatchRecursive(const std::filesystem::path& directory);
+        bool addWatch(const std::filesystem::path& directory);
+        void removeWatchRecursive(const std::filesystem::path& directory);
+        void resetWatches();
+        void addPendingDirectory(const std::filesystem::path& directory, bool recursive);
+        void reportPendingDirectories();
+
+        std::vector<std::filesystem::path> _rootDirectories; // only accessed by the watcher thread
+        const std::chrono::milliseconds _debounceDelay;
+        const ChangeCallback _callback;
+
+        int _inotifyFd{ -1 };
+        int _wakeUpFd{ -1 };
+
+        std::mutex _requestMutex;
+        bool _stopRequested{};
+        std::optional<std::vector<std::filesystem::path>> _requestedRootDirectories;
+
+        std::unordered_map<int, std::filesystem::path> _watchedDirectories; // by watch descriptor
+        bool _watchLimitReached{};
+
+        std::map<std::filesystem::path, bool> _pendingDirectories; // recursive flag, by directory
+        clock::time_point _firstPendingEventTime;
+        clock::time_point _lastPendingEventTime;
+
+        std::thread _thread;
+    };
+}
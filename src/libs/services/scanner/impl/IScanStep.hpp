@@ -19,8 +19,14 @@
 
 #pragma once
 
+#include <filesystem>
+#include <optional>
 #include <vector>
 
+#include <Wt/WDateTime.h>
+
+#include "database/MediaLibraryId.hpp"
+#include "core/EnumSet.hpp"
 #include "core/LiteralString.hpp"
 #include "services/scanner/ScannerOptions.hpp"
 #include "services/scanner/ScannerStats.hpp"
@@ -35,12 +41,61 @@ namespace lms::scanner
         virtual ScanStep getStep() const = 0;
         virtual core::LiteralString getStepName() const = 0;
 
+        // Data read or written by the steps: a step waits for the previous steps it conflicts with, other steps run concurrently
+        enum class ScanData
+        {
+            MediaFiles,     // files found in the media libraries
+            Tracks,         // tracks, releases, artists, clusters and images stored in database, along with their change counters
+            ClusterStats,   // track and release counts of the clusters
+            ListenStats,    // listen counts of the tracks, releases and artists
+            Duplicates,     // duplicated tracks
+            Covers,         // cover cache
+            DatabaseStats,  // statistics used by the query planner
+        };
+        using ScanDataSet = core::EnumSet<ScanData>;
+        virtual ScanDataSet getInputs() const = 0;
+        virtual ScanDataSet getOutputs() const = 0;
+
+        // Directory whose content changed since the previous scan
+        struct ChangedDirectory
+        {
+            db::MediaLibraryId mediaLibraryId;
+            std::filesystem::path path;
+            std::filesystem::path parentPath; // empty for media library root directories
+            Wt::WDateTime lastWriteTime; // invalid if the directory has to be checked again during the next scan
+            std::size_t fileCount{};
+            std::vector<std::filesystem::path> subDirectories;
+            bool excluded{}; // contains an exclude file
+        };
+
+        struct TargetDirectory
+        {
+            std::filesystem::path path;
+            bool recursive{}; // otherwise, only the files directly in the directory are scanned
+        };
+
         struct ScanContext
         {
             ScanOptions scanOptions;
             ScanStats stats;
-            ScanStepStats currentStepStats;
+
+            // If not empty, only these directories are scanned
+            std::vector<TargetDirectory> targetDirectories;
+
+            // Only set when unchanged directories are skipped
+            std::optional<std::vector<ChangedDirectory>> changedDirectories;
+            std::size_t unchangedDirectoryFileCount{};
+
+            // Only set when resuming an interrupted scan, whose stats were restored
+            struct ResumePoint
+            {
+                ScanStep step; // step to resume
+                db::MediaLibraryId mediaLibraryId; // media library whose files were being scanned
+                std::filesystem::path lastProcessedPath; // files up to this one, in walk order, are already processed
+            };
+            std::optional<ResumePoint> resumePoint;
         };
-        virtual void process(ScanContext& context) = 0;
+        // May be called concurrently with other steps that do not conflict with this one
+        virtual void process(ScanContext& context, ScanStepStats& stepStats) = 0;
     };
 }
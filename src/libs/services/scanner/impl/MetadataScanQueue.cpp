@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MetadataScanQueue.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+
+#include "metadata/Exception.hpp"
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+#include "core/XxHash64Calculator.hpp"
+
+namespace lms::scanner
+{
+    namespace
+    {
+        std::chrono::nanoseconds getThreadCpuTime()
+        {
+            timespec ts;
+            if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+                return std::chrono::nanoseconds{};
+
+            return std::chrono::seconds{ ts.tv_sec } + std::chrono::nanoseconds{ ts.tv_nsec };
+        }
+
+        // Partial hash of the file: size, beginning and end of the file (where tags are usually stored)
+        std::optional<std::uint64_t> computeFileContentHash(const std::filesystem::path& file)
+        {
+            LMS_SCOPED_TRACE_DETAILED("Scanner", "ComputeContentHash");
+
+            constexpr std::size_t headSize{ 256 * 1024 };
+            constexpr std::size_t tailSize{ 128 * 1024 };
+
+            std::ifstream stream{ file, std::ios::binary };
+            if (!stream)
+                return std::nullopt;
+
+            stream.seekg(0, std::ios::end);
+            const std::streamoff fileSize{ stream.tellg() };
+            if (fileSize < 0)
+                return std::nullopt;
+
+            core::XxHash64Calculator hashCalculator{ static_cast<std::uint64_t>(fileSize) };
+            std::vector<std::byte> buffer;
+            auto hashRange{ [&](std::streamoff offset, std::size_t size)
+            {
+                buffer.resize(size);
+                stream.seekg(offset, std::ios::beg);
+                if (!stream.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size)))
+                    return false;
+
+                hashCalculator.processBytes(buffer.data(), size);
+                return true;
+            } };
+
+            const bool success{ static_cast<std::size_t>(fileSize) <= headSize + tailSize
+                ? hashRange(0, static_cast<std::size_t>(fileSize))
+                : hashRange(0, headSize) && hashRange(fileSize - static_cast<std::streamoff>(tailSize), tailSize) };
+            if (!success)
+            {
+                LMS_LOG(DBUPDATER, ERROR, "Cannot compute content hash for '" << file.string() << "'");
+                return std::nullopt;
+            }
+
+            return hashCalculator.getResult();
+        }
+
+        constexpr std::chrono::seconds threadCountAdjustmentPeriod{ 2 };
+    } // namespace
+
+    std::size_t computeThreadCount(std::size_t threadCount, double usedCpuCount, bool requestsWaited, std::size_t cpuThreadBudget, std::size_t minThreadCount, std::size_t maxThreadCount)
+    {
+        // scale the thread count so that the number of busy CPUs matches the budget
+        std::size_t targetThreadCount{ usedCpuCount > 0 ? static_cast<std::size_t>(std::lround(static_cast<double>(threadCount) * static_cast<double>(cpuThreadBudget) / usedCpuCount)) : maxThreadCount };
+
+        // no need for more threads if they are not even kept busy
+        if (!requestsWaited)
+            targetThreadCount = std::min(targetThreadCount, threadCount);
+
+        targetThreadCount = std::clamp(targetThreadCount, minThreadCount, maxThreadCount);
+
+        // converge progressively to avoid oscillations
+        if (targetThreadCount > threadCount)
+            return threadCount + (targetThreadCount - threadCount + 1) / 2;
+
+        return threadCount - (threadCount - targetThreadCount + 1) / 2;
+    }
+
+    MetadataScanQueue::MetadataScanQueue(metadata::IParser& parser, std::size_t minThreadCount, std::size_t maxThreadCount, std::size_t cpuThreadBudget, bool& abort)
+        : _metadataParser{ parser }
+        , _minThreadCount{ minThreadCount }
+        , _maxThreadCount{ maxThreadCount }
+        , _cpuThreadBudget{ cpuThreadBudget }
+        , _threadCount{ std::clamp(cpuThreadBudget, minThreadCount, maxThreadCount) }
+        // threads are started on demand: more are only added when the thread count grows
+        , _scanContextRunner{ _scanContext, _threadCount, "ScannerMetadata" }
+        , _abort{ abort }
+        , _measureStartTime{ std::chrono::steady_clock::now() }
+    {}
+
+    std::size_t MetadataScanQueue::getThreadCount() const
+    {
+        std::scoped_lock lock{ _mutex };
+        return _threadCount;
+    }
+
+    void MetadataScanQueue::pushScanRequest(const std::filesystem::path& path, bool computeContentHash, std::optional<std::uint64_t> knownContentHash)
+    {
+        std::scoped_lock lock{ _mutex };
+
+        _ongoingScanCount += 1;
+        _scanRequests.emplace_back(ScanRequest{ path, computeContentHash, knownContentHash });
+        dispatchScanRequests();
+    }
+
+    void MetadataScanQueue::dispatchScanRequests()
+    {
+        // Only dispatch what the allowed threads can handle right away, the others wait here in order
+        while (_runningScanCount < _threadCount && !_scanRequests.empty())
+        {
+            _runningScanCount += 1;
+            _scanContext.post([this, request = std::move(_scanRequests.front())]
+                {
+                    processScanRequest(request);
+                });
+            _scanRequests.pop_front();
+        }
+
+        if (!_scanRequests.empty())
+            _requestsWaited = true;
+    }
+
+    void MetadataScanQueue::processScanRequest(const ScanRequest& request)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "AudioFileParseJob");
+
+        if (_abort)
+        {
+            {
+                std::scoped_lock lock{ _mutex };
+                _runningScanCount -= 1;
+                _ongoingScanCount -= 1;
+                dispatchScanRequests();
+            }
+
+            _condVar.notify_all();
+            return;
+        }
+
+        const auto startTime{ std::chrono::steady_clock::now() };
+        const std::chrono::nanoseconds startCpuTime{ getThreadCpuTime() };
+
+        std::unique_ptr<metadata::Track> track;
+        std::optional<std::uint64_t> contentHash;
+
+        if (request.computeContentHash)
+            contentHash = computeFileContentHash(request.path);
+
+        const bool contentUnchanged{ contentHash && request.knownContentHash && *contentHash == *request.knownContentHash };
+        if (!contentUnchanged)
+        {
+            try
+            {
+                track = _metadataParser.parse(request.path);
+            }
+            catch (const metadata::Exception& e)
+            {
+                LMS_LOG(DBUPDATER, INFO, "Failed to parse '" << request.path.string() << "'");
+            }
+        }
+
+        const std::chrono::nanoseconds cpuTime{ getThreadCpuTime() - startCpuTime };
+        const auto parseTime{ std::chrono::steady_clock::now() - startTime };
+
+        {
+            std::scoped_lock lock{ _mutex };
+
+            _scanResults.emplace_back(ScanResult{ request.path, std::move(track), contentHash, contentUnchanged });
+
+            _measuredParseTime += std::chrono::duration_cast<std::chrono::nanoseconds>(parseTime);
+            _measuredCpuTime += cpuTime;
+            _measuredScanCount += 1;
+            adaptThreadCount();
+
+            _runningScanCount -= 1;
+            _ongoingScanCount -= 1;
+            dispatchScanRequests();
+        }
+
+        _condVar.notify_all();
+    }
+
+    void MetadataScanQueue::adaptThreadCount()
+    {
+        const auto now{ std::chrono::steady_clock::now() };
+        const std::chrono::duration<double> elapsed{ now - _measureStartTime };
+        if (elapsed < threadCountAdjustmentPeriod || _measuredScanCount < _threadCount)
+            return;
+
+        const double usedCpuCount{ std::chrono::duration<double>{ _measuredCpuTime }.count() / elapsed.count() };
+        const std::size_t newThreadCount{ computeThreadCount(_threadCount, usedCpuCount, _requestsWaited, _cpuThreadBudget, _minThreadCount, _maxThreadCount) };
+        if (newThreadCount > _scanContextRunner.getThreadCount())
+            _scanContextRunner.addThreads(newThreadCount - _scanContextRunner.getThreadCount());
+
+        const std::chrono::duration<double, std::milli> averageParseTime{ _measuredParseTime / _measuredScanCount };
+        const double cpuUsage{ _measuredParseTime.count() > 0 ? 100. * static_cast<double>(_measuredCpuTime.count()) / static_cast<double>(_measuredParseTime.count()) : 0. };
+        LMS_LOG(DBUPDATER, DEBUG, "Parsed " << _measuredScanCount << " files, average parse time = " << averageParseTime.count() << " ms, CPU usage = " << cpuUsage << "%, using " << newThreadCount << " threads (was " << _threadCount << ")");
+
+        _threadCount = newThreadCount;
+        _measureStartTime = now;
+        _measuredParseTime = {};
+        _measuredCpuTime = {};
+        _measuredScanCount = 0;
+        _requestsWaited = false;
+    }
+
+    std::size_t MetadataScanQueue::getOngoingScanCount() const
+    {
+        std::scoped_lock lock{ _mutex };
+        return _ongoingScanCount;
+    }
+
+    std::size_t MetadataScanQueue::getResultsCount() const
+    {
+        std::scoped_lock lock{ _mutex };
+        return _scanResults.size();
+    }
+
+    size_t MetadataScanQueue::popResults(std::vector<ScanResult>& results, std::size_t maxCount)
+    {
+        results.clear();
+        results.reserve(maxCount);
+
+        {
+            std::scoped_lock lock{ _mutex };
+
+            while (results.size() < maxCount && !_scanResults.empty())
+            {
+                results.push_back(std::move(_scanResults.front()));
+                _scanResults.pop_front();
+            }
+        }
+
+        return results.size();
+    }
+
+    void MetadataScanQueue::wait(std::size_t maxScanRequestCount)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "WaitParseResults");
+
+        std::unique_lock lock{ _mutex };
+        _condVar.wait(lock, [=, this] { return _ongoingScanCount <= maxScanRequestCount; });
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "metadata/IParser.hpp"
+#include "core/IOContextRunner.hpp"
+
+namespace lms::scanner
+{
+    // Thread count policy, applied periodically:
+    // - usedCpuCount: number of CPUs kept busy by the parsing threads during the last period
+    // - requestsWaited: some requests had to wait for a thread during the last period
+    // Converges progressively to the thread count that keeps cpuThreadBudget CPUs busy, never grows if the threads were not all kept busy
+    std::size_t computeThreadCount(std::size_t threadCount, double usedCpuCount, bool requestsWaited, std::size_t cpuThreadBudget, std::size_t minThreadCount, std::size_t maxThreadCount);
+
+    // Parses the files using a thread count adjusted between bounds: more threads when parsing is I/O bound (network storage), fewer when it is CPU bound
+    class MetadataScanQueue
+    {
+    public:
+        struct ScanResult
+        {
+            std::filesystem::path path;
+            std::unique_ptr<metadata::Track> trackMetaData;
+            std::optional<std::uint64_t> contentHash;
+            bool contentUnchanged{}; // no metadata parsed in that case
+        };
+
+        MetadataScanQueue(metadata::IParser& parser, std::size_t minThreadCount, std::size_t maxThreadCount, std::size_t cpuThreadBudget, bool& abort);
+
+        std::size_t getThreadCount() const; // threads currently allowed to parse files
+        std::size_t getMinThreadCount() const { return _minThreadCount; }
+        std::size_t getMaxThreadCount() const { return _maxThreadCount; }
+
+        // Requests are parsed in push order, so that files of a same directory are read together
+        // If knownContentHash is set and matches the content hash of the file, the file is not parsed
+        void pushScanRequest(const std::filesystem::path& path, bool computeContentHash, std::optional<std::uint64_t> knownContentHash);
+
+        std::size_t getOngoingScanCount() const; // queued or being parsed
+        std::size_t getResultsCount() const;
+        size_t popResults(std::vector<ScanResult>& results, std::size_t maxCount);
+
+        void wait(std::size_t maxScanRequestCount = 0); // wait until ongoing scan request count <= maxScanRequestCount
+
+    private:
+        MetadataScanQueue(const MetadataScanQueue&) = delete;
+        MetadataScanQueue& operator=(const MetadataScanQueue&) = delete;
+
+        struct ScanRequest
+        {
+            std::filesystem::path path;
+            bool computeContentHash{};
+            std::optional<std::uint64_t> knownContentHash;
+        };
+        void dispatchScanRequests(); // _mutex must be held
+        void processScanRequest(const ScanRequest& request);
+        void adaptThreadCount(); // _mutex must be held
+
+        metadata::IParser& _metadataParser;
+        const std::size_t _minThreadCount;
+        const std::size_t _maxThreadCount;
+        const std::size_t _cpuThreadBudget; // number of CPUs the parsing threads are allowed to keep busy
+        std::size_t _threadCount;
+        boost::asio::io_context _scanContext;
+        core::IOContextRunner _scanContextRunner; // started with _threadCount threads, more are added when it grows (up to _maxThreadCount), none are removed
+
+        mutable std::mutex _mutex;
+        std::size_t _ongoingScanCount{};
+        std::size_t _runningScanCount{};
+        std::deque<ScanRequest> _scanRequests;
+        std::deque<ScanResult> _scanResults;
+        std::condition_variable _condVar;
+        bool& _abort;
+
+        // measured since the last thread count adjustment
+        std::chrono::steady_clock::time_point _measureStartTime;
+        std::chrono::nanoseconds _measuredParseTime{};
+        std::chrono::nanoseconds _measuredCpuTime{};
+        std::size_t _measuredScanCount{};
+        bool _requestsWaited{}; // requests had to wait for a thread
+    };
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProcessedFileTracker.hpp"
+
+#include <algorithm>
+
+namespace lms::scanner
+{
+    bool isBeforeInWalkOrder(const std::filesystem::path& file, const std::filesystem::path& lastFile)
+    {
+        const int directoryCompare{ file.parent_path().compare(lastFile.parent_path()) };
+        if (directoryCompare != 0)
+            return directoryCompare < 0;
+
+        return file.filename() <= lastFile.filename();
+    }
+
+    void ProcessedFileTracker::reset()
+    {
+        _pendingFiles.clear();
+        _lastExploredFile.clear();
+    }
+
+    void ProcessedFileTracker::onFileExplored(const std::filesystem::path& file, bool scanPending)
+    {
+        if (scanPending)
+            _pendingFiles.emplace_back(PendingFile{ file, _lastExploredFile });
+
+        _lastExploredFile = file;
+    }
+
+    void ProcessedFileTracker::onFileScanned(const std::filesystem::path& file)
+    {
+        auto it{ std::find_if(std::begin(_pendingFiles), std::end(_pendingFiles), [&](const PendingFile& pendingFile) { return pendingFile.file == file; }) };
+        if (it != std::end(_pendingFiles))
+            it->scanned = true;
+
+        while (!_pendingFiles.empty() && _pendingFiles.front().scanned)
+            _pendingFiles.pop_front();
+    }
+
+    const std::filesystem::path& ProcessedFileTracker::getLastProcessedFile() const
+    {
+        return _pendingFiles.empty() ? _lastExploredFile : _pendingFiles.front().previousFile;
+    }
+} // namespace lms::scanner
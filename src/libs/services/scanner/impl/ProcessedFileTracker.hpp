@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <deque>
+#include <filesystem>
+
+namespace lms::scanner
+{
+    // Directories are walked depth first, in name order, files of a directory before its sub directories
+    bool isBeforeInWalkOrder(const std::filesystem::path& file, const std::filesystem::path& lastFile);
+
+    // Tracks the last file up to which all the explored files, in walk order, have been processed
+    class ProcessedFileTracker
+    {
+    public:
+        void reset();
+        void onFileExplored(const std::filesystem::path& file, bool scanPending);
+        void onFileScanned(const std::filesystem::path& file);
+
+        const std::filesystem::path& getLastProcessedFile() const;
+
+    private:
+        struct PendingFile
+        {
+            std::filesystem::path file;
+            std::filesystem::path previousFile; // last explored file before this one
+            bool scanned{};
+        };
+        std::deque<PendingFile> _pendingFiles;
+        std::filesystem::path _lastExploredFile;
+    };
+} // namespace lms::scanner
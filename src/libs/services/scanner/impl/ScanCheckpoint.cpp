@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanCheckpoint.hpp"
+
+#include <array>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "database/MediaLibrary.hpp"
+#include "database/ScanCheckpoint.hpp"
+#include "database/Session.hpp"
+#include "core/ILogger.hpp"
+#include "core/String.hpp"
+
+namespace lms::scanner
+{
+    namespace
+    {
+        constexpr char recordDelimiter{ '\n' };
+        constexpr char fieldDelimiter{ ';' };
+        constexpr char escapeChar{ '\\' };
+
+        const std::array<std::pair<std::string_view, std::size_t ScanStats::*>, 10> statsCounters
+        { {
+            { "skips", &ScanStats::skips },
+            { "scans", &ScanStats::scans },
+            { "additions", &ScanStats::additions },
+            { "deletions", &ScanStats::deletions },
+            { "updates", &ScanStats::updates },
+            { "featuresFetched", &ScanStats::featuresFetched },
+            { "orphanArtistsRemoved", &ScanStats::orphanArtistsRemoved },
+            { "orphanReleasesRemoved", &ScanStats::orphanReleasesRemoved },
+            { "orphanClustersRemoved", &ScanStats::orphanClustersRemoved },
+            { "orphanClusterTypesRemoved", &ScanStats::orphanClusterTypesRemoved },
+        } };
+
+        // One record per line: start time, counters, then errors
+        std::string serializeStats(const ScanStats& stats)
+        {
+            std::vector<std::string> records;
+
+            {
+                const std::string value{ std::to_string(stats.startTime.toTime_t()) };
+                const std::array<std::string_view, 2> fields{ "startTime", value };
+                records.push_back(core::stringUtils::escapeAndJoinStrings(fields, fieldDelimiter, escapeChar));
+            }
+
+            for (const auto& [name, counter] : statsCounters)
+            {
+                const std::string value{ std::to_string(stats.*counter) };
+                const std::array<std::string_view, 2> fields{ name, value };
+                records.push_back(core::stringUtils::escapeAndJoinStrings(fields, fieldDelimiter, escapeChar));
+            }
+
+            for (const ScanError& error : stats.errors)
+            {
+                const std::string type{ std::to_string(static_cast<int>(error.error)) };
+                const std::string file{ error.file.string() };
+                const std::array<std::string_view, 4> fields{ "error", type, file, error.systemError };
+                records.push_back(core::stringUtils::escapeAndJoinStrings(fields, fieldDelimiter, escapeChar));
+            }
+
+            const std::vector<std::string_view> recordViews(std::cbegin(records), std::cend(records));
+            return core::stringUtils::escapeAndJoinStrings(recordViews, recordDelimiter, escapeChar);
+        }
+
+        void deserializeStats(std::string_view str, ScanStats& stats)
+        {
+            for (const std::string& record : core::stringUtils::splitEscapedStrings(str, recordDelimiter, escapeChar))
+            {
+                const std::vector<std::string> fields{ core::stringUtils::splitEscapedStrings(record, fieldDelimiter, escapeChar) };
+                if (fields.size() < 2)
+                    continue;
+
+                if (fields[0] == "error")
+                {
+                    const std::optional<int> type{ core::stringUtils::readAs<int>(fields[1]) };
+                    if (!type || fields.size() < 3)
+                        continue;
+
+                    // trailing empty system error is not serialized
+                    stats.errors.emplace_back(fields[2], static_cast<ScanErrorType>(*type), fields.size() > 3 ? fields[3] : "");
+                    continue;
+                }
+
+                // a resumed scan started with the interrupted one
+                if (fields[0] == "startTime")
+                {
+                    if (const std::optional<std::time_t> value{ core::stringUtils::readAs<std::time_t>(fields[1]) })
+                        stats.startTime = Wt::WDateTime::fromTime_t(*value);
+                    continue;
+                }
+
+                for (const auto& [name, counter] : statsCounters)
+                {
+                    if (fields[0] != name)
+                        continue;
+
+                    if (const std::optional<std::size_t> value{ core::stringUtils::readAs<std::size_t>(fields[1]) })
+                        stats.*counter = *value;
+                    break;
+                }
+            }
+        }
+    }
+
+    void saveScanCheckpoint(db::Session& session, const IScanStep::ScanContext& context, std::size_t scanVersion, ScanStep step, db::MediaLibraryId mediaLibraryId, const std::filesystem::path& lastProcessedPath)
+    {
+        db::ScanCheckpoint::pointer checkpoint{ db::ScanCheckpoint::getOrCreate(session) };
+
+        checkpoint.modify()->setScanVersion(scanVersion);
+        checkpoint.modify()->setFullScan(context.scanOptions.fullScan);
+        checkpoint.modify()->setStep(static_cast<int>(step));
+        checkpoint.modify()->setMediaLibrary(mediaLibraryId.isValid() ? db::MediaLibrary::find(session, mediaLibraryId) : db::MediaLibrary::pointer{});
+        checkpoint.modify()->setLastProcessedPath(lastProcessedPath);
+        checkpoint.modify()->setStats(serializeStats(context.stats));
+    }
+
+    void restoreScanCheckpoint(db::Session& session, IScanStep::ScanContext& context, std::size_t scanVersion)
+    {
+        auto transaction{ session.createWriteTransaction() };
+
+        const db::ScanCheckpoint::pointer checkpoint{ db::ScanCheckpoint::get(session) };
+        if (!checkpoint)
+            return;
+
+        // Files processed before the interruption must have been processed the same way
+        if (checkpoint->getScanVersion() != scanVersion || (context.scanOptions.fullScan && !checkpoint->isFullScan()))
+        {
+            LMS_LOG(DBUPDATER, INFO, "Interrupted scan cannot be resumed, discarding its checkpoint");
+            db::ScanCheckpoint::clear(session);
+            return;
+        }
+
+        context.scanOptions.fullScan = checkpoint->isFullScan();
+
+        const db::MediaLibrary::pointer mediaLibrary{ checkpoint->getMediaLibrary() };
+        context.resumePoint = IScanStep::ScanContext::ResumePoint{ static_cast<ScanStep>(checkpoint->getStep()), mediaLibrary ? mediaLibrary->getId() : db::MediaLibraryId{}, checkpoint->getLastProcessedPath() };
+        deserializeStats(checkpoint->getStats(), context.stats);
+
+        LMS_LOG(DBUPDATER, INFO, "Resuming interrupted scan" << (context.scanOptions.fullScan ? " (full scan)" : "") << " after '" << context.resumePoint->lastProcessedPath.string() << "'");
+    }
+
+    void clearScanCheckpoint(db::Session& session)
+    {
+        auto transaction{ session.createWriteTransaction() };
+
+        db::ScanCheckpoint::clear(session);
+    }
+
+    std::optional<ScanOptions> getInterruptedScanOptions(db::Session& session, std::size_t scanVersion)
+    {
+        auto transaction{ session.createReadTransaction() };
+
+        const db::ScanCheckpoint::pointer checkpoint{ db::ScanCheckpoint::get(session) };
+        if (!checkpoint || checkpoint->getScanVersion() != scanVersion)
+            return std::nullopt;
+
+        return ScanOptions{ .fullScan = checkpoint->isFullScan() };
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+#include "database/MediaLibraryId.hpp"
+#include "services/scanner/ScannerOptions.hpp"
+#include "IScanStep.hpp"
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::scanner
+{
+    // Must be called within the write transaction that commits the progress, so that the checkpoint never gets ahead of the database
+    void saveScanCheckpoint(db::Session& session, const IScanStep::ScanContext& context, std::size_t scanVersion, ScanStep step, db::MediaLibraryId mediaLibraryId = {}, const std::filesystem::path& lastProcessedPath = {});
+
+    // Sets the resume point and restores the stats, if the interrupted scan can be resumed by this one (the checkpoint is discarded otherwise)
+    void restoreScanCheckpoint(db::Session& session, IScanStep::ScanContext& context, std::size_t scanVersion);
+    void clearScanCheckpoint(db::Session& session);
+
+    // Options of the interrupted scan that can be resumed, if any
+    std::optional<ScanOptions> getInterruptedScanOptions(db::Session& session, std::size_t scanVersion);
+}
@@ -20,7 +20,9 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
+#include "core/Path.hpp"
 #include "services/scanner/ScannerStats.hpp"
 #include "IScanStep.hpp"
 #include "ScannerSettings.hpp"
@@ -53,6 +55,32 @@ namespace lms::scanner
 			{}
 
 		protected:
+			// Directories to explore in the media library: its root directory, or the targeted directories it contains
+			std::vector<TargetDirectory> getDirectoriesToExplore(const ScanContext& context, const ScannerSettings::MediaLibraryInfo& mediaLibrary) const
+			{
+				if (context.targetDirectories.empty())
+					return { TargetDirectory{ mediaLibrary.rootDirectory, true } };
+
+				std::vector<TargetDirectory> res;
+				for (const TargetDirectory& directory : context.targetDirectories)
+				{
+					std::error_code ec;
+					if (std::filesystem::is_directory(directory.path, ec) && core::pathUtils::isPathInRootPath(directory.path, mediaLibrary.rootDirectory, &excludeDirFileName))
+						res.push_back(directory);
+				}
+
+				return res;
+			}
+
+			// returns false if aborted by the callback
+			static bool exploreDirectory(const TargetDirectory& directory, const std::function<bool(std::error_code, const std::filesystem::path&)>& cb)
+			{
+				if (directory.recursive)
+					return core::pathUtils::exploreFilesRecursive(directory.path, cb, &excludeDirFileName);
+
+				return core::pathUtils::exploreFiles(directory.path, cb);
+			}
+
 			const ScannerSettings&	_settings;
 			ProgressCallback		_progressCallback;
 			bool&					_abortScan;
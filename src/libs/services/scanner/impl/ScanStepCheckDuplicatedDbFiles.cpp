@@ -26,7 +26,7 @@
 
 namespace lms::scanner
 {
-    void ScanStepCheckDuplicatedDbFiles::process(ScanContext& context)
+    void ScanStepCheckDuplicatedDbFiles::process(ScanContext& context, ScanStepStats& stepStats)
     {
         using namespace db;
 
@@ -47,11 +47,11 @@ namespace lms::scanner
             {
                 LMS_LOG(DBUPDATER, INFO, "Found duplicated track MBID [" << trackMBID->getAsString() << "], file: " << track->getAbsoluteFilePath().string() << " - " << track->getName());
                 context.stats.duplicates.emplace_back(ScanDuplicate{ track->getId(), DuplicateReason::SameTrackMBID });
-                context.currentStepStats.processedElems++;
-                _progressCallback(context.currentStepStats);
+                stepStats.processedElems++;
+                _progressCallback(stepStats);
             }
         }
 
-        LMS_LOG(DBUPDATER, DEBUG, "Found " << context.currentStepStats.processedElems << " duplicated audio files");
+        LMS_LOG(DBUPDATER, DEBUG, "Found " << stepStats.processedElems << " duplicated audio files");
     }
 }
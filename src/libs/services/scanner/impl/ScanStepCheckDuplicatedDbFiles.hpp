@@ -31,6 +31,8 @@ namespace lms::scanner
 		private:
 			core::LiteralString getStepName() const override { return "Check for duplicated files"; }
 			ScanStep getStep() const override { return ScanStep::CheckForDuplicateFiles; }
-			void process(ScanContext& context) override;
+			ScanDataSet getInputs() const override { return { ScanData::Tracks }; }
+			ScanDataSet getOutputs() const override { return { ScanData::Duplicates }; }
+			void process(ScanContext& context, ScanStepStats& stepStats) override;
 	};
 }
@@ -24,7 +24,7 @@
 
 namespace lms::scanner
 {
-    void ScanStepCompact::process(ScanContext& context)
+    void ScanStepCompact::process(ScanContext& context, ScanStepStats&)
     {
         // Don't auto compact as it may be too annoying to block the whole application
         if (context.scanOptions.compact)
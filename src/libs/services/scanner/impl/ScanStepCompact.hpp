@@ -30,7 +30,9 @@ namespace lms::scanner
 
 		private:
 			ScanStep getStep() const override { return ScanStep::Compact; }
+			ScanDataSet getInputs() const override { return {}; }
+			ScanDataSet getOutputs() const override { return { ScanData::Tracks, ScanData::ClusterStats, ScanData::ListenStats, ScanData::DatabaseStats }; }
 			core::LiteralString getStepName() const override { return "Compact"; }
-			void process(ScanContext& context) override;
+			void process(ScanContext& context, ScanStepStats& stepStats) override;
 	};
 }
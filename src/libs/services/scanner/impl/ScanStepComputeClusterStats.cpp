@@ -26,65 +26,33 @@
 
 namespace lms::scanner
 {
-    void ScanStepComputeClusterStats::process(ScanContext& context)
+    void ScanStepComputeClusterStats::process(ScanContext& context, ScanStepStats& stepStats)
     {
         using namespace db;
 
-        if (context.stats.nbChanges() == 0)
-            return;
-
         Session& dbSession{ _db.getTLSSession() };
 
-        const std::size_t clusterCount{ [&] {
-            auto transaction{ dbSession.createReadTransaction() };
-            return Cluster::getCount(dbSession);
-            }() };
-
-        context.currentStepStats.totalElems = clusterCount;
-
-        foreachSubRange(Range{ 0, clusterCount }, 100, [&](Range range)
-            {
-                const std::vector<ClusterId> clusterIds{ [&]
-                {
-                    Cluster::FindParameters params;
-                    params.setRange(range);
-
-                    {
-                        auto transaction{ dbSession.createReadTransaction() };
-                        return std::move(Cluster::findIds(dbSession, params).results);
-                    }
-                }() };
-
-                for (const ClusterId clusterId : clusterIds)
-                {
-                    if (_abortScan)
-                        break;
-
-                    std::size_t trackCount;
-                    std::size_t releaseCount;
-
-                    {
-                        auto transaction{ dbSession.createReadTransaction() };
-
-                        trackCount = Cluster::computeTrackCount(dbSession, clusterId);
-                        releaseCount = Cluster::computeReleaseCount(dbSession, clusterId);
-                    }
-
-                    {
-                        auto transaction{ dbSession.createWriteTransaction() };
+        // Cheap enough to also be used on full scans to recover from inconsistencies
+        if (context.stats.nbChanges() == 0 && !context.scanOptions.fullScan)
+            return;
 
-                        auto cluster{ Cluster::find(dbSession, clusterId) };
-                        cluster.modify()->setTrackCount(trackCount);
-                        cluster.modify()->setReleaseCount(releaseCount);
-                    }
+        // Single aggregate pass in a read transaction, the write lock is only taken if some counts changed
+        std::vector<Cluster::Counts> outdatedCounts;
+        {
+            auto transaction{ dbSession.createReadTransaction() };
+            outdatedCounts = Cluster::findOutdatedCounts(dbSession);
+        }
 
-                    context.currentStepStats.processedElems++;
-                    _progressCallback(context.currentStepStats);
-                }
+        if (!outdatedCounts.empty())
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
+            Cluster::updateCounts(dbSession, outdatedCounts);
+        }
 
-                return true;
-            });
+        stepStats.totalElems = outdatedCounts.size();
+        stepStats.processedElems = outdatedCounts.size();
+        _progressCallback(stepStats);
 
-        LMS_LOG(DBUPDATER, DEBUG, "Recomputed stats for " << context.currentStepStats.processedElems << " clusters!");
+        LMS_LOG(DBUPDATER, DEBUG, "Updated stats for " << outdatedCounts.size() << " clusters!");
     }
 }
@@ -30,7 +30,9 @@ namespace lms::scanner
 
     private:
         ScanStep getStep() const override { return ScanStep::ComputeClusterStats; }
+        ScanDataSet getInputs() const override { return { ScanData::Tracks }; }
+        ScanDataSet getOutputs() const override { return { ScanData::ClusterStats }; }
         core::LiteralString getStepName() const override { return "Compute cluster stats"; }
-        void process(ScanContext& context) override;
+        void process(ScanContext& context, ScanStepStats& stepStats) override;
     };
 }
@@ -19,38 +19,189 @@
 
 #include "ScanStepDiscoverFiles.hpp"
 
+#include <algorithm>
+
+#include "database/Db.hpp"
+#include "database/Directory.hpp"
+#include "database/Session.hpp"
+#include "core/Exception.hpp"
 #include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
 #include "core/Path.hpp"
 
 namespace lms::scanner
 {
-    void ScanStepDiscoverFiles::process(ScanContext& context)
+    void ScanStepDiscoverFiles::process(ScanContext& context, ScanStepStats& stepStats)
     {
         context.stats.filesScanned = 0;
 
-        for (const ScannerSettings::MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
+        // Targeted scans only check the given directories, as if they had changed
+        if (_settings.skipUnchangedDirectories && context.targetDirectories.empty())
+        {
+            context.changedDirectories.emplace();
+
+            const bool fullValidation{ context.scanOptions.fullScan
+                || !_fullValidationDone
+                || (_settings.fullValidationScanInterval > 0 && _scanCountSinceFullValidation >= _settings.fullValidationScanInterval) };
+
+            if (fullValidation)
+            {
+                LMS_LOG(DBUPDATER, DEBUG, "Performing a full validation of all the directories");
+                _fullValidationDone = true;
+                _scanCountSinceFullValidation = 0;
+            }
+            else
+                _scanCountSinceFullValidation++;
+
+            for (const ScannerSettings::MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
+            {
+                if (!discoverDirectory(context, stepStats, mediaLibrary, mediaLibrary.rootDirectory, {}, fullValidation))
+                    break;
+            }
+
+            LMS_LOG(DBUPDATER, DEBUG, "Found " << context.changedDirectories->size() << " changed directories, " << context.unchangedDirectoryFileCount << " files in unchanged directories");
+        }
+        else
         {
-            std::size_t currentDirectoryProcessElemsCount{};
-            core::pathUtils::exploreFilesRecursive(mediaLibrary.rootDirectory, [&](std::error_code ec, const std::filesystem::path& path)
+            for (const ScannerSettings::MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
+            {
+                for (const TargetDirectory& directory : getDirectoriesToExplore(context, mediaLibrary))
                 {
-                    if (_abortScan)
-                        return false;
+                    std::size_t currentDirectoryProcessElemsCount{};
+                    exploreDirectory(directory, [&](std::error_code ec, const std::filesystem::path& path)
+                        {
+                            if (_abortScan)
+                                return false;
 
-                    if (!ec && core::pathUtils::hasFileAnyExtension(path, _settings.supportedExtensions))
-                    {
-                        context.currentStepStats.processedElems++;
-                        currentDirectoryProcessElemsCount++;
-                        _progressCallback(context.currentStepStats);
-                    }
+                            if (!ec && core::pathUtils::hasFileAnyExtension(path, _settings.supportedExtensions))
+                            {
+                                stepStats.processedElems++;
+                                currentDirectoryProcessElemsCount++;
+                                _progressCallback(stepStats);
+                            }
 
-                    return true;
-                }, &excludeDirFileName);
+                            return true;
+                        });
 
-            LMS_LOG(DBUPDATER, DEBUG, "Discovered " << currentDirectoryProcessElemsCount << " files in '" << mediaLibrary.rootDirectory << "'");
+                    LMS_LOG(DBUPDATER, DEBUG, "Discovered " << currentDirectoryProcessElemsCount << " files in '" << directory.path << "'" << (directory.recursive ? " (recursive)" : ""));
+                }
+            }
         }
 
-        context.stats.filesScanned = context.currentStepStats.processedElems;
+        context.stats.filesScanned = stepStats.processedElems;
 
         LMS_LOG(DBUPDATER, DEBUG, "Discovered " << context.stats.filesScanned << " files in all directories");
     }
+
+    bool ScanStepDiscoverFiles::discoverDirectory(ScanContext& context, ScanStepStats& stepStats, const ScannerSettings::MediaLibraryInfo& mediaLibrary, const std::filesystem::path& directory, const std::filesystem::path& parentDirectory, bool fullValidation)
+    {
+        LMS_SCOPED_TRACE_DETAILED("Scanner", "DiscoverDirectory");
+
+        if (_abortScan)
+            return false;
+
+        Wt::WDateTime lastWriteTime;
+        try
+        {
+            lastWriteTime = core::pathUtils::getLastWriteTime(directory);
+        }
+        catch (const core::LmsException& e)
+        {
+            LMS_LOG(DBUPDATER, ERROR, "Cannot get last write time: " << e.what());
+            return true; // try to continue exploring anyway
+        }
+
+        // Unchanged directory: same entries as during the previous scan, no need to list them
+        {
+            std::optional<std::size_t> fileCount;
+            std::vector<std::filesystem::path> subDirectories;
+            {
+                db::Session& session{ _db.getTLSSession() };
+                auto transaction{ session.createReadTransaction() };
+
+                const db::Directory::pointer dbDirectory{ db::Directory::find(session, directory) };
+                if (!fullValidation && dbDirectory && dbDirectory->getLastWriteTime().isValid() && dbDirectory->getLastWriteTime() == lastWriteTime)
+                {
+                    fileCount = dbDirectory->getFileCount();
+                    for (const db::Directory::pointer& child : db::Directory::findChildren(session, dbDirectory->getId()))
+                        subDirectories.push_back(child->getAbsolutePath());
+                }
+            }
+
+            if (fileCount)
+            {
+                context.unchangedDirectoryFileCount += *fileCount;
+                stepStats.processedElems += *fileCount;
+                _progressCallback(stepStats);
+
+                std::sort(std::begin(subDirectories), std::end(subDirectories));
+                for (const std::filesystem::path& subDirectory : subDirectories)
+                {
+                    if (!discoverDirectory(context, stepStats, mediaLibrary, subDirectory, directory, fullValidation))
+                        return false;
+                }
+
+                return true;
+            }
+        }
+
+        ChangedDirectory changedDirectory{ .mediaLibraryId = mediaLibrary.id, .path = directory, .parentPath = parentDirectory, .lastWriteTime = lastWriteTime };
+
+        // The directory may be modified again within the same second, make sure it is checked again during the next scan
+        if (lastWriteTime.toTime_t() + 1 >= context.stats.startTime.toTime_t())
+            changedDirectory.lastWriteTime = {};
+
+        std::error_code ec;
+        if (std::filesystem::exists(directory / excludeDirFileName, ec))
+        {
+            LMS_LOG(DBUPDATER, DEBUG, "Found '" << (directory / excludeDirFileName).string() << "': skipping directory");
+            changedDirectory.excluded = true;
+            context.changedDirectories->push_back(std::move(changedDirectory));
+            return true;
+        }
+
+        std::filesystem::directory_iterator itPath{ directory, std::filesystem::directory_options::follow_directory_symlink, ec };
+        if (ec)
+        {
+            LMS_LOG(DBUPDATER, ERROR, "Cannot list directory '" << directory.string() << "': " << ec.message());
+            return true; // errors reported by the scan step
+        }
+
+        for (const std::filesystem::directory_iterator itEnd; itPath != itEnd; itPath.increment(ec))
+        {
+            if (ec)
+                break;
+
+            if (std::filesystem::is_regular_file(*itPath, ec))
+            {
+                if (core::pathUtils::hasFileAnyExtension(itPath->path(), _settings.supportedExtensions))
+                {
+                    changedDirectory.fileCount++;
+                    stepStats.processedElems++;
+                    _progressCallback(stepStats);
+                }
+            }
+            else if (std::filesystem::is_directory(*itPath, ec))
+                changedDirectory.subDirectories.push_back(itPath->path());
+        }
+
+        if (ec)
+        {
+            LMS_LOG(DBUPDATER, ERROR, "Cannot list directory '" << directory.string() << "': " << ec.message());
+            changedDirectory.lastWriteTime = {};
+        }
+
+        // Same walk order as the scan step
+        std::sort(std::begin(changedDirectory.subDirectories), std::end(changedDirectory.subDirectories));
+        const std::vector<std::filesystem::path> subDirectories{ changedDirectory.subDirectories };
+        context.changedDirectories->push_back(std::move(changedDirectory));
+
+        for (const std::filesystem::path& subDirectory : subDirectories)
+        {
+            if (!discoverDirectory(context, stepStats, mediaLibrary, subDirectory, directory, fullValidation))
+                return false;
+        }
+
+        return true;
+    }
 }
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <filesystem>
+
 #include "ScanStepBase.hpp"
 
 namespace lms::scanner
@@ -30,7 +32,15 @@ namespace lms::scanner
 
 		private:
 			ScanStep getStep() const override { return ScanStep::DiscoverFiles; }
+			ScanDataSet getInputs() const override { return {}; }
+			ScanDataSet getOutputs() const override { return { ScanData::MediaFiles }; }
 			core::LiteralString getStepName() const override { return "Discover files"; }
-			void process(ScanContext& context) override;
+			void process(ScanContext& context, ScanStepStats& stepStats) override;
+
+			// returns false if aborted
+			bool discoverDirectory(ScanContext& context, ScanStepStats& stepStats, const ScannerSettings::MediaLibraryInfo& mediaLibrary, const std::filesystem::path& directory, const std::filesystem::path& parentDirectory, bool fullValidation);
+
+			std::size_t _scanCountSinceFullValidation{};
+			bool _fullValidationDone{};
 	};
 }
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanStepGenerateCovers.hpp"
+
+#include "database/Db.hpp"
+#include "database/Release.hpp"
+#include "database/Session.hpp"
+#include "services/cover/ICoverService.hpp"
+#include "core/IConfig.hpp"
+#include "core/ILogger.hpp"
+#include "core/Service.hpp"
+#include "core/String.hpp"
+
+namespace lms::scanner
+{
+    ScanStepGenerateCovers::ScanStepGenerateCovers(InitParams& initParams)
+        : ScanStepBase{ initParams }
+    {
+        core::Service<core::IConfig>::get()->visitStrings("cover-pregenerate-sizes", [this](std::string_view str)
+            {
+                if (const std::optional<image::ImageSize> size{ core::stringUtils::readAs<image::ImageSize>(str) })
+                    _sizes.push_back(*size);
+                else
+                    LMS_LOG(DBUPDATER, ERROR, "Invalid cover size '" << str << "' in 'cover-pregenerate-sizes'");
+            });
+    }
+
+    void ScanStepGenerateCovers::process(ScanContext& context, ScanStepStats& stepStats)
+    {
+        using namespace db;
+
+        // Covers of releases that did not change are already in the cover disk cache
+        if (_sizes.empty() || context.stats.nbChanges() == 0)
+            return;
+
+        Session& dbSession{ _db.getTLSSession() };
+
+        Release::FindParameters params;
+        params.setScannedAfter(context.stats.startTime);
+        params.setSortMethod(ReleaseSortMethod::Id);
+
+        stepStats.totalElems = [&] {
+            auto transaction{ dbSession.createReadTransaction() };
+            return Release::getCount(dbSession, params);
+            }();
+
+        // Keyset pagination: releases added or removed meanwhile do not shift the next pages
+        constexpr std::size_t batchSize{ 100 };
+        params.setRange(Range{ 0, batchSize });
+
+        bool moreResults{ true };
+        while (moreResults && !_abortScan)
+        {
+            const RangeResults<ReleaseId> releaseIds{ [&]
+            {
+                auto transaction{ dbSession.createReadTransaction() };
+                return Release::findIds(dbSession, params);
+            }() };
+
+            for (const ReleaseId releaseId : releaseIds.results)
+            {
+                if (_abortScan)
+                    break;
+
+                for (const image::ImageSize size : _sizes)
+                    core::Service<cover::ICoverService>::get()->pregenerateReleaseCover(releaseId, size);
+
+                stepStats.processedElems++;
+                _progressCallback(stepStats);
+            }
+
+            moreResults = releaseIds.moreResults && releaseIds.nextCursor;
+            params.setCursor(releaseIds.nextCursor);
+        }
+
+        LMS_LOG(DBUPDATER, DEBUG, "Generated covers for " << stepStats.processedElems << " releases!");
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "image/IEncodedImage.hpp"
+#include "ScanStepBase.hpp"
+
+namespace lms::scanner
+{
+	class ScanStepGenerateCovers : public ScanStepBase
+	{
+		public:
+			ScanStepGenerateCovers(InitParams& initParams);
+
+		private:
+			ScanStep getStep() const override { return ScanStep::GenerateCovers; }
+			ScanDataSet getInputs() const override { return { ScanData::Tracks }; }
+			ScanDataSet getOutputs() const override { return { ScanData::Covers }; }
+			core::LiteralString getStepName() const override { return "Generate covers"; }
+			void process(ScanContext& context, ScanStepStats& stepStats) override;
+
+			std::vector<image::ImageSize> _sizes;
+	};
+}
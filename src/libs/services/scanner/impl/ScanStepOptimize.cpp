@@ -25,7 +25,7 @@
 
 namespace lms::scanner
 {
-    void ScanStepOptimize::process(ScanContext& context)
+    void ScanStepOptimize::process(ScanContext& context, ScanStepStats& stepStats)
     {
         ScanStats& stats{ context.stats };
 
@@ -37,8 +37,8 @@ namespace lms::scanner
 
             std::vector<std::string> entries;
             session.retrieveEntriesToAnalyze(entries);
-            context.currentStepStats.totalElems = entries.size();
-            _progressCallback(context.currentStepStats);
+            stepStats.totalElems = entries.size();
+            _progressCallback(stepStats);
 
             for (const std::string& entry : entries)
             {
@@ -46,8 +46,8 @@ namespace lms::scanner
                     break;
 
                 _db.getTLSSession().analyzeEntry(entry);
-                context.currentStepStats.processedElems++;
-                _progressCallback(context.currentStepStats);
+                stepStats.processedElems++;
+                _progressCallback(stepStats);
             }
 
             LMS_LOG(DBUPDATER, INFO, "Database analyze complete");
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanStepRebuildListenStats.hpp"
+#include "database/Db.hpp"
+#include "database/Listen.hpp"
+#include "database/Session.hpp"
+#include "core/ILogger.hpp"
+
+namespace lms::scanner
+{
+    void ScanStepRebuildListenStats::process(ScanContext& context, ScanStepStats&)
+    {
+        // Listen stats are maintained by the database, full scans are used as a way to recover from inconsistencies
+        if (!context.scanOptions.fullScan)
+            return;
+
+        db::Session& dbSession{ _db.getTLSSession() };
+
+        LMS_LOG(DBUPDATER, INFO, "Rebuilding listen stats...");
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
+            db::Listen::rebuildStats(dbSession);
+        }
+        LMS_LOG(DBUPDATER, INFO, "Rebuilding listen stats done");
+    }
+}
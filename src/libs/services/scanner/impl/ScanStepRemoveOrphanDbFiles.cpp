@@ -19,13 +19,23 @@
 
 #include "ScanStepRemoveOrphanDbFiles.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <boost/asio/post.hpp>
+
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
 #include "database/Db.hpp"
+#include "database/Image.hpp"
 #include "database/Release.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
+#include "core/IConfig.hpp"
 #include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
 #include "core/Path.hpp"
 
 namespace lms::scanner
@@ -34,52 +44,59 @@ namespace lms::scanner
 
     namespace
     {
-        constexpr std::size_t batchSize = 100;
+        constexpr std::size_t fileBatchSize{ 1000 }; // files checked in parallel, outside of any transaction
+        constexpr std::size_t orphanBatchSize{ 1000 }; // orphan entries removed per statement
+
+        std::size_t getFileCheckThreadCount()
+        {
+            std::size_t threadCount{ core::Service<core::IConfig>::get()->getULong("scanner-file-check-thread-count", 0) };
+
+            if (threadCount == 0)
+                threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+            return threadCount;
+        }
 
         template <typename T>
-        void removeOrphanEntries(Session& session, bool& abortScan)
+        std::size_t removeOrphanEntries(Session& session, bool& abortScan)
         {
-            using IdType = typename T::IdType;
+            std::size_t removedCount{};
 
-            RangeResults<IdType> entries;
             while (!abortScan)
             {
-                {
-                    auto transaction{ session.createReadTransaction() };
-
-                    entries = T::findOrphanIds(session, Range{ 0, batchSize });
-                };
-
+                std::size_t batchRemovedCount{};
                 {
                     auto transaction{ session.createWriteTransaction() };
 
-                    for (const IdType objectId : entries.results)
-                    {
-                        if (abortScan)
-                            break;
-
-                        typename T::pointer entry{ T::find(session, objectId) };
-
-                        entry.remove();
-                    }
+                    batchRemovedCount = T::removeOrphans(session, orphanBatchSize);
                 }
 
-                if (!entries.moreResults)
+                removedCount += batchRemovedCount;
+                if (batchRemovedCount < orphanBatchSize)
                     break;
             }
+
+            return removedCount;
         }
     }
 
-    void ScanStepRemoveOrphanDbFiles::process(ScanContext& context)
+    ScanStepRemoveOrphanDbFiles::ScanStepRemoveOrphanDbFiles(InitParams& initParams)
+        : ScanStepBase{ initParams }
+        , _checkContextRunner{ _checkContext, getFileCheckThreadCount(), "ScannerFileCheck" }
     {
-        removeOrphanTracks(context);
-        removeOrphanClusters();
-        removeOrphanClusterTypes();
-        removeOrphanArtists();
-        removeOrphanReleases();
     }
 
-    void ScanStepRemoveOrphanDbFiles::removeOrphanTracks(ScanContext& context)
+    void ScanStepRemoveOrphanDbFiles::process(ScanContext& context, ScanStepStats& stepStats)
+    {
+        removeOrphanTracks(context, stepStats);
+        removeOrphanImages(context);
+        removeOrphanClusters(context);
+        removeOrphanClusterTypes(context);
+        removeOrphanArtists(context);
+        removeOrphanReleases(context);
+    }
+
+    void ScanStepRemoveOrphanDbFiles::removeOrphanTracks(ScanContext& context, ScanStepStats& stepStats)
     {
         using namespace db;
 
@@ -89,84 +106,212 @@ namespace lms::scanner
         Session& session{ _db.getTLSSession() };
 
         LMS_LOG(DBUPDATER, DEBUG, "Checking tracks to be removed...");
+
+        // Targeted scans only have to check the files of the targeted directories
+        if (!context.targetDirectories.empty())
         {
-            auto transaction{ session.createReadTransaction() };
-            context.currentStepStats.totalElems = Track::getCount(session);
+            for (const TargetDirectory& directory : context.targetDirectories)
+                removeOrphanTracks(context, stepStats, directory.path, directory.recursive);
+        }
+        else
+        {
+            {
+                auto transaction{ session.createReadTransaction() };
+                stepStats.totalElems = Track::getCount(session);
+            }
+            LMS_LOG(DBUPDATER, DEBUG, stepStats.totalElems << " tracks to be checked...");
+
+            removeOrphanTracks(context, stepStats, {}, true);
         }
-        LMS_LOG(DBUPDATER, DEBUG, context.currentStepStats.totalElems << " tracks to be checked...");
 
-        // TODO handle only files in context.directory?
-        std::vector<Track::pointer> tracksToRemove;
+        LMS_LOG(DBUPDATER, DEBUG, stepStats.processedElems << " tracks checked!");
+    }
+
+    void ScanStepRemoveOrphanDbFiles::removeOrphanTracks(ScanContext& context, ScanStepStats& stepStats, const std::filesystem::path& directory, bool recursive)
+    {
+        using namespace db;
+
+        Session& session{ _db.getTLSSession() };
+
+        std::vector<Track::pointer> tracks;
+        std::vector<std::filesystem::path> trackPaths;
 
         TrackId lastCheckedTrackID;
-        bool endReached{};
-        while (!endReached)
+        while (!_abortScan)
         {
+            tracks.clear();
+            trackPaths.clear();
+            {
+                auto transaction{ session.createReadTransaction() };
+
+                auto addTrack{ [&](const Track::pointer& track)
+                    {
+                        tracks.push_back(track);
+                        trackPaths.push_back(track->getAbsoluteFilePath());
+                    } };
+
+                if (directory.empty())
+                    Track::find(session, lastCheckedTrackID, fileBatchSize, addTrack);
+                else
+                    Track::findInDirectory(session, directory, recursive, lastCheckedTrackID, fileBatchSize, addTrack);
+            }
+
+            if (tracks.empty())
+                break;
+
+            const std::vector<bool> validTracks{ checkFiles(trackPaths, _settings.supportedExtensions) };
             if (_abortScan)
                 break;
 
-            tracksToRemove.clear();
+            if (std::find(std::cbegin(validTracks), std::cend(validTracks), false) != std::cend(validTracks))
             {
-                auto transaction{ session.createReadTransaction() };
+                auto transaction{ session.createWriteTransaction() };
 
-                endReached = true;
-                Track::find(session, lastCheckedTrackID, batchSize, [&](const Track::pointer& track)
+                for (std::size_t i{}; i < tracks.size(); ++i)
+                {
+                    if (!validTracks[i])
                     {
-                        endReached = false;
+                        tracks[i].remove();
+                        context.stats.deletions++;
+                    }
+                }
+            }
+
+            stepStats.processedElems += tracks.size();
+            _progressCallback(stepStats);
+        }
+    }
+
+    void ScanStepRemoveOrphanDbFiles::removeOrphanImages(ScanContext& context)
+    {
+        if (_abortScan)
+            return;
+
+        LMS_LOG(DBUPDATER, DEBUG, "Checking images to be removed...");
+
+        if (!context.targetDirectories.empty())
+        {
+            for (const TargetDirectory& directory : context.targetDirectories)
+                removeOrphanImages(context, directory.path, directory.recursive);
+        }
+        else
+            removeOrphanImages(context, {}, true);
+    }
+
+    void ScanStepRemoveOrphanDbFiles::removeOrphanImages(ScanContext& context, const std::filesystem::path& directory, bool recursive)
+    {
+        Session& session{ _db.getTLSSession() };
 
-                        if (!checkFile(track->getAbsoluteFilePath()))
-                            tracksToRemove.push_back(track);
+        std::vector<Image::pointer> images;
+        std::vector<std::filesystem::path> imagePaths;
 
-                        context.currentStepStats.processedElems++;
-                    });
+        ImageId lastCheckedImageID;
+        while (!_abortScan)
+        {
+            images.clear();
+            imagePaths.clear();
+            {
+                auto transaction{ session.createReadTransaction() };
+
+                auto addImage{ [&](const Image::pointer& image)
+                    {
+                        images.push_back(image);
+                        imagePaths.push_back(image->getAbsoluteFilePath());
+                    } };
+
+                if (directory.empty())
+                    Image::find(session, lastCheckedImageID, fileBatchSize, addImage);
+                else
+                    Image::findInDirectory(session, directory, recursive, lastCheckedImageID, fileBatchSize, addImage);
             }
 
-            if (!tracksToRemove.empty())
+            if (images.empty())
+                break;
+
+            const std::vector<bool> validImages{ checkFiles(imagePaths, _settings.supportedImageExtensions) };
+            if (_abortScan)
+                break;
+
+            if (std::find(std::cbegin(validImages), std::cend(validImages), false) != std::cend(validImages))
             {
                 auto transaction{ session.createWriteTransaction() };
 
-                for (Track::pointer& track : tracksToRemove)
+                for (std::size_t i{}; i < images.size(); ++i)
                 {
-                    track.remove();
-                    context.stats.deletions++;
+                    if (!validImages[i])
+                    {
+                        images[i].remove();
+                        context.stats.deletions++;
+                    }
                 }
             }
-
-            _progressCallback(context.currentStepStats);
         }
-
-        LMS_LOG(DBUPDATER, DEBUG, context.currentStepStats.processedElems << " tracks checked!");
     }
 
-    void ScanStepRemoveOrphanDbFiles::removeOrphanClusters()
+    void ScanStepRemoveOrphanDbFiles::removeOrphanClusters(ScanContext& context)
     {
         LMS_LOG(DBUPDATER, DEBUG, "Checking orphan clusters...");
-        removeOrphanEntries<db::Cluster>(_db.getTLSSession(), _abortScan);
+        context.stats.orphanClustersRemoved += removeOrphanEntries<db::Cluster>(_db.getTLSSession(), _abortScan);
+        LMS_LOG(DBUPDATER, DEBUG, "Removed " << context.stats.orphanClustersRemoved << " orphan clusters");
     }
 
-    void ScanStepRemoveOrphanDbFiles::removeOrphanClusterTypes()
+    void ScanStepRemoveOrphanDbFiles::removeOrphanClusterTypes(ScanContext& context)
     {
         LMS_LOG(DBUPDATER, DEBUG, "Checking orphan cluster types...");
-        removeOrphanEntries<db::ClusterType>(_db.getTLSSession(), _abortScan);
+        context.stats.orphanClusterTypesRemoved += removeOrphanEntries<db::ClusterType>(_db.getTLSSession(), _abortScan);
+        LMS_LOG(DBUPDATER, DEBUG, "Removed " << context.stats.orphanClusterTypesRemoved << " orphan cluster types");
     }
 
-    void ScanStepRemoveOrphanDbFiles::removeOrphanArtists()
+    void ScanStepRemoveOrphanDbFiles::removeOrphanArtists(ScanContext& context)
     {
         LMS_LOG(DBUPDATER, DEBUG, "Checking orphan artists...");
-        removeOrphanEntries<db::Artist>(_db.getTLSSession(), _abortScan);
+        context.stats.orphanArtistsRemoved += removeOrphanEntries<db::Artist>(_db.getTLSSession(), _abortScan);
+        LMS_LOG(DBUPDATER, DEBUG, "Removed " << context.stats.orphanArtistsRemoved << " orphan artists");
     }
 
-    void ScanStepRemoveOrphanDbFiles::removeOrphanReleases()
+    void ScanStepRemoveOrphanDbFiles::removeOrphanReleases(ScanContext& context)
     {
         LMS_LOG(DBUPDATER, DEBUG, "Checking orphan releases...");
-        removeOrphanEntries<db::Release>(_db.getTLSSession(), _abortScan);
+        context.stats.orphanReleasesRemoved += removeOrphanEntries<db::Release>(_db.getTLSSession(), _abortScan);
+        LMS_LOG(DBUPDATER, DEBUG, "Removed " << context.stats.orphanReleasesRemoved << " orphan releases");
+    }
+
+    std::vector<bool> ScanStepRemoveOrphanDbFiles::checkFiles(std::span<const std::filesystem::path> files, const std::vector<std::filesystem::path>& supportedExtensions)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "CheckFiles");
+
+        std::vector<char> results(files.size(), true); // not std::vector<bool>, written concurrently
+        std::size_t pendingCount{ files.size() };
+        std::mutex mutex;
+        std::condition_variable condVar;
+
+        for (std::size_t i{}; i < files.size(); ++i)
+        {
+            boost::asio::post(_checkContext, [&, i]
+                {
+                    // keep files if aborted
+                    if (!_abortScan)
+                        results[i] = checkFile(files[i], supportedExtensions);
+
+                    std::scoped_lock lock{ mutex };
+                    pendingCount -= 1;
+                    condVar.notify_all();
+                });
+        }
+
+        {
+            std::unique_lock lock{ mutex };
+            condVar.wait(lock, [&] { return pendingCount == 0; });
+        }
+
+        return std::vector<bool>(std::cbegin(results), std::cend(results));
     }
 
-    bool ScanStepRemoveOrphanDbFiles::checkFile(const std::filesystem::path& p)
+    bool ScanStepRemoveOrphanDbFiles::checkFile(const std::filesystem::path& p, const std::vector<std::filesystem::path>& supportedExtensions)
     {
         try
         {
-            // For each track, make sure the the file still exists
+            // For each file, make sure the the file still exists
             // and still belongs to a media directory
             if (!std::filesystem::exists(p) || !std::filesystem::is_regular_file(p))
             {
@@ -184,7 +329,7 @@ namespace lms::scanner
                 return false;
             }
 
-            if (!core::pathUtils::hasFileAnyExtension(p, _settings.supportedExtensions))
+            if (!core::pathUtils::hasFileAnyExtension(p, supportedExtensions))
             {
                 LMS_LOG(DBUPDATER, INFO, "Removing '" << p.string() << "': file format no longer handled");
                 return false;
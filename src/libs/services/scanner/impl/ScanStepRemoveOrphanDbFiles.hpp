@@ -20,7 +20,12 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
+#include <vector>
 
+#include <boost/asio/io_context.hpp>
+
+#include "core/IOContextRunner.hpp"
 #include "ScanStepBase.hpp"
 
 namespace lms::scanner
@@ -28,18 +33,29 @@ namespace lms::scanner
 	class ScanStepRemoveOrphanDbFiles : public ScanStepBase
 	{
 		public:
-			using ScanStepBase::ScanStepBase;
+			ScanStepRemoveOrphanDbFiles(InitParams& initParams);
 
 		private:
 			core::LiteralString getStepName() const override { return "Check orphaned entries"; }
 			ScanStep getStep() const override { return ScanStep::CheckForMissingFiles; }
-			void process(ScanContext& context) override;
-
-			void removeOrphanTracks(ScanContext& context);
-			void removeOrphanClusters();
-			void removeOrphanClusterTypes();
-			void removeOrphanArtists();
-			void removeOrphanReleases();
-			bool checkFile(const std::filesystem::path& p);
+			ScanDataSet getInputs() const override { return { ScanData::Tracks }; }
+			ScanDataSet getOutputs() const override { return { ScanData::Tracks }; }
+			void process(ScanContext& context, ScanStepStats& stepStats) override;
+
+			void removeOrphanTracks(ScanContext& context, ScanStepStats& stepStats);
+			void removeOrphanTracks(ScanContext& context, ScanStepStats& stepStats, const std::filesystem::path& directory, bool recursive); // all tracks if empty
+			void removeOrphanImages(ScanContext& context);
+			void removeOrphanImages(ScanContext& context, const std::filesystem::path& directory, bool recursive); // all images if empty
+			void removeOrphanClusters(ScanContext& context);
+			void removeOrphanClusterTypes(ScanContext& context);
+			void removeOrphanArtists(ScanContext& context);
+			void removeOrphanReleases(ScanContext& context);
+
+			// Checks the files in parallel, blocks until all the files are checked
+			std::vector<bool> checkFiles(std::span<const std::filesystem::path> files, const std::vector<std::filesystem::path>& supportedExtensions);
+			bool checkFile(const std::filesystem::path& p, const std::vector<std::filesystem::path>& supportedExtensions);
+
+			boost::asio::io_context _checkContext;
+			core::IOContextRunner _checkContextRunner;
 	};
 }
@@ -19,22 +19,31 @@
 
 #include "ScanStepScanFiles.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
 #include "database/Db.hpp"
+#include "database/Directory.hpp"
+#include "database/Image.hpp"
 #include "database/MediaLibrary.hpp"
 #include "database/Release.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "database/TrackFeatures.hpp"
 #include "database/TrackArtistLink.hpp"
-#include "metadata/Exception.hpp"
 #include "metadata/IParser.hpp"
 #include "core/Exception.hpp"
 #include "core/IConfig.hpp"
 #include "core/ILogger.hpp"
 #include "core/Path.hpp"
 #include "core/ITraceLogger.hpp"
+#include "MetadataScanQueue.hpp"
+#include "ProcessedFileTracker.hpp"
+#include "ScanCheckpoint.hpp"
 
 namespace lms::scanner
 {
@@ -291,108 +300,53 @@ namespace lms::scanner
             throw core::LmsException{ "Invalid value for 'scanner-parser-read-style'" };
         }
 
-        std::size_t getScanMetaDataThreadCount()
+        std::size_t getCpuCount()
         {
-            std::size_t threadCount{ core::Service<core::IConfig>::get()->getULong("scanner-metadata-thread-count", 0) };
-
-            if (threadCount == 0)
-                threadCount = std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1);
-
-            return threadCount;
+            return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
         }
-    } // namespace
 
-    ScanStepScanFiles::MetadataScanQueue::MetadataScanQueue(metadata::IParser& parser, std::size_t threadCount, bool& abort)
-        : _metadataParser{ parser }
-        , _scanContextRunner{ _scanContext, threadCount, "ScannerMetadata" }
-        , _abort{ abort }
-    {}
-
-    void ScanStepScanFiles::MetadataScanQueue::pushScanRequest(const std::filesystem::path& path)
-    {
+        // Number of CPUs the metadata threads are allowed to keep busy, leaving some for the other services
+        std::size_t getScanMetaDataCpuThreadBudget()
         {
-            std::scoped_lock lock{ _mutex };
-            _ongoingScanCount += 1;
+            return std::max<std::size_t>(getCpuCount() / 2, 1);
         }
 
-        _scanContext.post([=, this]
-            {
-                LMS_SCOPED_TRACE_OVERVIEW("Scanner", "AudioFileParseJob");
-
-                std::unique_ptr<metadata::Track> track;
-
-                if (_abort)
-                {
-                    std::scoped_lock lock{ _mutex };
-                    _ongoingScanCount -= 1;
-                }
-                else
-                {
-                    try
-                    {
-                        track = _metadataParser.parse(path);
-                    }
-                    catch (const metadata::Exception& e)
-                    {
-                        LMS_LOG(DBUPDATER, INFO, "Failed to parse '" << path.string() << "'");
-                    }
-
-                    {
-                        std::scoped_lock lock{ _mutex };
-
-                        _scanResults.emplace_back(MetaDataScanResult{ std::move(path), std::move(track) });
-                        _ongoingScanCount -= 1;
-                    }
-                }
-
-                _condVar.notify_all();
-            });
-    }
+        std::size_t getScanMetaDataMaxThreadCount()
+        {
+            if (const std::size_t threadCount{ core::Service<core::IConfig>::get()->getULong("scanner-metadata-thread-count", 0) }; threadCount != 0)
+                return threadCount;
 
-    std::size_t ScanStepScanFiles::MetadataScanQueue::getResultsCount() const
-    {
-        std::scoped_lock lock{ _mutex };
-        return _scanResults.size();
-    }
+            std::size_t threadCount{ core::Service<core::IConfig>::get()->getULong("scanner-metadata-max-thread-count", 0) };
+            if (threadCount == 0)
+                threadCount = 4 * getCpuCount();
 
-    size_t ScanStepScanFiles::MetadataScanQueue::popResults(std::vector<MetaDataScanResult>& results, std::size_t maxCount)
-    {
-        results.clear();
-        results.reserve(maxCount);
+            return threadCount;
+        }
 
+        std::size_t getScanMetaDataMinThreadCount()
         {
-            std::scoped_lock lock{ _mutex };
+            if (const std::size_t threadCount{ core::Service<core::IConfig>::get()->getULong("scanner-metadata-thread-count", 0) }; threadCount != 0)
+                return threadCount;
 
-            while (results.size() < maxCount && !_scanResults.empty())
-            {
-                results.push_back(std::move(_scanResults.front()));
-                _scanResults.pop_front();
-            }
+            return std::clamp<std::size_t>(core::Service<core::IConfig>::get()->getULong("scanner-metadata-min-thread-count", 1), 1, getScanMetaDataMaxThreadCount());
         }
 
-        return results.size();
-    }
-
-    void ScanStepScanFiles::MetadataScanQueue::wait(std::size_t maxScanRequestCount)
-    {
-        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "WaitParseResults");
-
-        std::unique_lock lock{ _mutex };
-        _condVar.wait(lock, [=, this] { return _ongoingScanCount <= maxScanRequestCount; });
-    }
+        constexpr std::chrono::seconds checkpointPeriod{ 1 };
+        constexpr std::size_t scanQueueRequestCountPerThread{ 100 };
+    } // namespace
 
     ScanStepScanFiles::ScanStepScanFiles(InitParams& initParams)
         : ScanStepBase{ initParams }
         , _metadataParser{ metadata::createParser(metadata::ParserBackend::TagLib, getParserReadStyle()) } // For now, always use TagLib
-        , _metadataScanQueue{ *_metadataParser, getScanMetaDataThreadCount(), _abortScan }
+        , _metadataScanQueue{ *_metadataParser, getScanMetaDataMinThreadCount(), getScanMetaDataMaxThreadCount(), getScanMetaDataCpuThreadBudget(), _abortScan }
     {
-        LMS_LOG(DBUPDATER, INFO, "Using " << _metadataScanQueue.getThreadCount() << " thread(s) for scanning file metadata");
+        LMS_LOG(DBUPDATER, INFO, "Using " << _metadataScanQueue.getMinThreadCount() << " to " << _metadataScanQueue.getMaxThreadCount() << " thread(s) for scanning file metadata");
     }
 
-    void ScanStepScanFiles::process(ScanContext& context)
+    void ScanStepScanFiles::process(ScanContext& context, ScanStepStats& stepStats)
     {
-        const std::size_t scanQueueMaxScanRequestCount{ 100 * _metadataScanQueue.getThreadCount() };
         const std::size_t processMetaDataBatchSize{ 5 };
+        const std::size_t processImageBatchSize{ 50 };
 
         {
             std::vector<std::string> tagsToParse{ _extraTagsToParse };
@@ -402,12 +356,43 @@ namespace lms::scanner
             _metadataParser->setDefaultTagDelimiters(_settings.defaultTagDelimiters);
         }
 
-        std::vector<MetaDataScanResult> scanResults;
-        context.currentStepStats.totalElems = context.stats.filesScanned;
+        // The interrupted scan was already done with this step
+        if (context.resumePoint && context.resumePoint->step != ScanStep::ScanFiles)
+        {
+            LMS_LOG(DBUPDATER, DEBUG, "Files already scanned by the interrupted scan");
+            return;
+        }
+
+        std::vector<MetadataScanQueue::ScanResult> scanResults;
+        stepStats.totalElems = context.stats.filesScanned;
+
+        // files in unchanged directories are not even listed (already accounted in the restored stats when resuming)
+        if (!context.resumePoint)
+            context.stats.skips += context.unchangedDirectoryFileCount;
+        stepStats.processedElems += context.unchangedDirectoryFileCount;
+
+        // Media libraries are processed in order: the ones before the resume point are already processed
+        std::optional<IScanStep::ScanContext::ResumePoint> resumePoint{ context.resumePoint };
+        if (resumePoint && std::none_of(std::cbegin(_settings.mediaLibraries), std::cend(_settings.mediaLibraries), [&](const ScannerSettings::MediaLibraryInfo& libraryInfo) { return libraryInfo.id == resumePoint->mediaLibraryId; }))
+            resumePoint.reset();
+
+        _lastCheckpointTime = std::chrono::steady_clock::now();
 
         for (const ScannerSettings::MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
         {
-            core::pathUtils::exploreFilesRecursive(mediaLibrary.rootDirectory, [&](std::error_code ec, const std::filesystem::path& path)
+            if (resumePoint && resumePoint->mediaLibraryId != mediaLibrary.id)
+                continue;
+
+            std::filesystem::path resumeAfterFile;
+            if (resumePoint)
+            {
+                resumeAfterFile = resumePoint->lastProcessedPath;
+                resumePoint.reset();
+            }
+
+            _processedFileTracker.reset();
+
+            auto onFile{ [&](std::error_code ec, const std::filesystem::path& path)
                 {
                     LMS_SCOPED_TRACE_DETAILED("Scanner", "OnExploreFile");
 
@@ -418,16 +403,43 @@ namespace lms::scanner
                     {
                         LMS_LOG(DBUPDATER, ERROR, "Cannot process entry '" << path.string() << "': " << ec.message());
                         context.stats.errors.emplace_back(ScanError{ path, ScanErrorType::CannotReadFile, ec.message() });
+                        return true;
                     }
-                    else if (core::pathUtils::hasFileAnyExtension(path, _settings.supportedExtensions))
+
+                    if (!resumeAfterFile.empty() && isBeforeInWalkOrder(path, resumeAfterFile))
                     {
-                        if (checkFileNeedScan(context, path, mediaLibrary))
-                            _metadataScanQueue.pushScanRequest(path);
+                        if (core::pathUtils::hasFileAnyExtension(path, _settings.supportedExtensions))
+                            stepStats.processedElems++;
+
+                        return true;
+                    }
 
-                        context.currentStepStats.processedElems++;
-                        _progressCallback(context.currentStepStats);
+                    bool scanPending{};
+                    if (core::pathUtils::hasFileAnyExtension(path, _settings.supportedExtensions))
+                    {
+                        std::optional<std::uint64_t> knownContentHash;
+                        if (checkFileNeedScan(context, path, mediaLibrary, knownContentHash))
+                        {
+                            _metadataScanQueue.pushScanRequest(path, _settings.skipUnchangedFiles, knownContentHash);
+                            scanPending = true;
+                        }
+
+                        stepStats.processedElems++;
+                        stepStats.threadCount = _metadataScanQueue.getThreadCount();
+                        stepStats.queuedElems = _metadataScanQueue.getOngoingScanCount();
+                        _progressCallback(stepStats);
+                    }
+                    else if (core::pathUtils::hasFileAnyExtension(path, _settings.supportedImageExtensions))
+                    {
+                        scanPending = queueImageFile(path);
                     }
+                    _processedFileTracker.onFileExplored(path, scanPending);
+
+                    if (_pendingImageFiles.size() >= processImageBatchSize)
+                        processImageFiles(context);
 
+                    // the thread count may be adjusted during the scan
+                    const std::size_t scanQueueMaxScanRequestCount{ scanQueueRequestCountPerThread * _metadataScanQueue.getThreadCount() };
                     while (_metadataScanQueue.getResultsCount() > (scanQueueMaxScanRequestCount / 2))
                     {
                         _metadataScanQueue.popResults(scanResults, processMetaDataBatchSize);
@@ -437,18 +449,114 @@ namespace lms::scanner
                     _metadataScanQueue.wait(scanQueueMaxScanRequestCount);
 
                     return true;
-                }, &excludeDirFileName);
+                } };
+
+            if (context.changedDirectories)
+            {
+                for (const ChangedDirectory& changedDirectory : *context.changedDirectories)
+                {
+                    if (changedDirectory.mediaLibraryId != mediaLibrary.id || changedDirectory.excluded)
+                        continue;
+
+                    if (!core::pathUtils::exploreFiles(changedDirectory.path, onFile))
+                        break;
+                }
+            }
+            else
+            {
+                for (const TargetDirectory& directory : getDirectoriesToExplore(context, mediaLibrary))
+                {
+                    if (!exploreDirectory(directory, onFile))
+                        break;
+                }
+            }
 
             _metadataScanQueue.wait();
 
             while (!_abortScan && _metadataScanQueue.popResults(scanResults, processMetaDataBatchSize) > 0)
                 processMetaDataScanResults(context, scanResults, mediaLibrary);
+
+            if (_abortScan)
+                _pendingImageFiles.clear();
+            else
+                processImageFiles(context);
+        }
+
+        if (_abortScan)
+            return;
+
+        // Only once all the files have been processed, so that an aborted scan cannot mark directories as up to date
+        if (context.changedDirectories)
+            updateDirectories(*context.changedDirectories);
+
+        if (context.targetDirectories.empty())
+        {
+            db::Session& dbSession{ _db.getTLSSession() };
+            auto transaction{ dbSession.createWriteTransaction() };
+
+            saveScanCheckpoint(dbSession, context, _settings.scanVersion, ScanStep::CheckForMissingFiles);
         }
     }
 
-    bool ScanStepScanFiles::checkFileNeedScan(ScanContext& context, const std::filesystem::path& file, const ScannerSettings::MediaLibraryInfo& libraryInfo)
+    void ScanStepScanFiles::updateDirectories(std::span<const ChangedDirectory> changedDirectories)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "UpdateDirectories");
+
+        db::Session& dbSession{ _db.getTLSSession() };
+
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
+
+            // directories of removed media libraries
+            for (Directory::pointer& directory : Directory::findRootDirectories(dbSession))
+            {
+                if (std::none_of(std::cbegin(_settings.mediaLibraries), std::cend(_settings.mediaLibraries),
+                    [&](const ScannerSettings::MediaLibraryInfo& libraryInfo) { return libraryInfo.rootDirectory == directory->getAbsolutePath(); }))
+                {
+                    directory.remove();
+                }
+            }
+        }
+
+        // parents are always processed before their children
+        constexpr std::size_t batchSize{ 100 };
+        for (std::size_t offset{}; offset < changedDirectories.size(); offset += batchSize)
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
+
+            for (const ChangedDirectory& changedDirectory : changedDirectories.subspan(offset, std::min(batchSize, changedDirectories.size() - offset)))
+            {
+                Directory::pointer directory{ Directory::find(dbSession, changedDirectory.path) };
+                if (!directory)
+                {
+                    Directory::pointer parent;
+                    if (!changedDirectory.parentPath.empty())
+                    {
+                        parent = Directory::find(dbSession, changedDirectory.parentPath);
+                        if (!parent)
+                            continue; // will be handled in the next scan
+                    }
+
+                    directory = dbSession.create<Directory>(changedDirectory.path, parent);
+                }
+
+                directory.modify()->setLastWriteTime(changedDirectory.lastWriteTime);
+                directory.modify()->setFileCount(changedDirectory.fileCount);
+
+                // removed or excluded subdirectories
+                for (Directory::pointer& child : Directory::findChildren(dbSession, directory->getId()))
+                {
+                    if (std::find(std::cbegin(changedDirectory.subDirectories), std::cend(changedDirectory.subDirectories), child->getAbsolutePath()) == std::cend(changedDirectory.subDirectories))
+                        child.remove();
+                }
+            }
+        }
+    }
+
+    bool ScanStepScanFiles::checkFileNeedScan(ScanContext& context, const std::filesystem::path& file, const ScannerSettings::MediaLibraryInfo& libraryInfo, std::optional<std::uint64_t>& knownContentHash)
     {
         ScanStats& stats{ context.stats };
+        knownContentHash.reset();
 
         Wt::WDateTime lastWriteTime{ retrieveFileGetLastWrite(file) };
         // Should rarely fail as we are currently iterating it
@@ -467,20 +575,27 @@ namespace lms::scanner
 
             const Track::pointer track{ Track::findByPath(dbSession, file) };
 
-            if (track
-                && track->getLastWriteTime().toTime_t() == lastWriteTime.toTime_t()
-                && track->getScanVersion() == _settings.scanVersion
-                )
+            if (track && track->getScanVersion() == _settings.scanVersion)
             {
-                // this file may have been moved from one library to another, then we just need to update the media library id instead of a full rescan
                 const auto trackMediaLibrary{ track->getMediaLibrary() };
-                if (trackMediaLibrary && trackMediaLibrary->getId() == libraryInfo.id)
+                const bool sameMediaLibrary{ trackMediaLibrary && trackMediaLibrary->getId() == libraryInfo.id };
+
+                if (track->getLastWriteTime().toTime_t() == lastWriteTime.toTime_t())
                 {
-                    stats.skips++;
-                    return false;
-                }
+                    // this file may have been moved from one library to another, then we just need to update the media library id instead of a full rescan
+                    if (sameMediaLibrary)
+                    {
+                        stats.skips++;
+                        return false;
+                    }
 
-                needUpdateLibrary = true;
+                    needUpdateLibrary = true;
+                }
+                else if (_settings.skipUnchangedFiles && sameMediaLibrary)
+                {
+                    // the file may just have been touched: its content will be checked before parsing it
+                    knownContentHash = track->getContentHash();
+                }
             }
         }
 
@@ -499,34 +614,139 @@ namespace lms::scanner
         return true; // need to scan
     }
 
-    void ScanStepScanFiles::processMetaDataScanResults(ScanContext& context, std::span<const MetaDataScanResult> scanResults, const ScannerSettings::MediaLibraryInfo& libraryInfo)
+    bool ScanStepScanFiles::queueImageFile(const std::filesystem::path& file)
+    {
+        const Wt::WDateTime lastWriteTime{ retrieveFileGetLastWrite(file) };
+        if (!lastWriteTime.isValid())
+            return false;
+
+        std::error_code ec;
+        const std::uintmax_t fileSize{ std::filesystem::file_size(file, ec) };
+        if (ec)
+        {
+            LMS_LOG(DBUPDATER, ERROR, "Cannot get file size for '" << file.string() << "': " << ec.message());
+            return false;
+        }
+
+        _pendingImageFiles.emplace_back(ImageFileInfo{ file, lastWriteTime, fileSize });
+        return true;
+    }
+
+    void ScanStepScanFiles::processImageFiles(ScanContext& context)
+    {
+        if (_pendingImageFiles.empty())
+            return;
+
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "ProcessImageFiles");
+
+        ScanStats& stats{ context.stats };
+        db::Session& dbSession{ _db.getTLSSession() };
+
+        // Most of the images are usually unchanged: only take the write lock if needed
+        std::vector<const ImageFileInfo*> changedImageFiles;
+        {
+            auto transaction{ dbSession.createReadTransaction() };
+
+            for (const ImageFileInfo& imageFile : _pendingImageFiles)
+            {
+                const Image::pointer image{ Image::find(dbSession, imageFile.path) };
+                if (!image
+                    || image->getLastWriteTime().toTime_t() != imageFile.lastWriteTime.toTime_t()
+                    || image->getFileSize() != static_cast<long long>(imageFile.fileSize))
+                {
+                    changedImageFiles.push_back(&imageFile);
+                }
+            }
+        }
+
+        if (!changedImageFiles.empty())
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
+
+            for (const ImageFileInfo* imageFile : changedImageFiles)
+            {
+                Image::pointer image{ Image::find(dbSession, imageFile->path) };
+                if (!image)
+                {
+                    image = dbSession.create<Image>(imageFile->path);
+                    LMS_LOG(DBUPDATER, DEBUG, "Added image '" << imageFile->path.string() << "'");
+                    stats.additions++;
+                }
+                else
+                {
+                    LMS_LOG(DBUPDATER, DEBUG, "Updated image '" << imageFile->path.string() << "'");
+                    stats.updates++;
+                }
+
+                image.modify()->setLastWriteTime(imageFile->lastWriteTime);
+                image.modify()->setFileSize(static_cast<long long>(imageFile->fileSize));
+            }
+        }
+
+        for (const ImageFileInfo& imageFile : _pendingImageFiles)
+            _processedFileTracker.onFileScanned(imageFile.path);
+
+        _pendingImageFiles.clear();
+    }
+
+    void ScanStepScanFiles::processMetaDataScanResults(ScanContext& context, std::span<const MetadataScanQueue::ScanResult> scanResults, const ScannerSettings::MediaLibraryInfo& libraryInfo)
     {
         LMS_SCOPED_TRACE_OVERVIEW("Scanner", "ProcessScanResults");
 
         db::Session& dbSession{ _db.getTLSSession() };
         auto transaction{ dbSession.createWriteTransaction() };
 
-        for (const MetaDataScanResult& scanResult : scanResults)
+        for (const MetadataScanQueue::ScanResult& scanResult : scanResults)
         {
             LMS_SCOPED_TRACE_DETAILED("Scanner", "ProcessScanResult");
 
             if (_abortScan)
                 return;
 
-            if (scanResult.trackMetaData)
+            if (scanResult.contentUnchanged)
+            {
+                processUnchangedFile(context, scanResult.path);
+            }
+            else if (scanResult.trackMetaData)
             {
                 context.stats.scans++;
 
-                processFileMetaData(context, scanResult.path, *scanResult.trackMetaData, libraryInfo);
+                processFileMetaData(context, scanResult.path, *scanResult.trackMetaData, scanResult.contentHash, libraryInfo);
             }
             else
             {
                 context.stats.errors.emplace_back(scanResult.path, ScanErrorType::CannotParseFile);
             }
+
+            _processedFileTracker.onFileScanned(scanResult.path);
+        }
+
+        // Saved along with the processed files, so that an interrupted scan can be resumed from here
+        const auto now{ std::chrono::steady_clock::now() };
+        if (context.targetDirectories.empty() && now - _lastCheckpointTime >= checkpointPeriod)
+        {
+            saveScanCheckpoint(dbSession, context, _settings.scanVersion, ScanStep::ScanFiles, libraryInfo.id, _processedFileTracker.getLastProcessedFile());
+            _lastCheckpointTime = now;
         }
     }
 
-    void ScanStepScanFiles::processFileMetaData(ScanContext& context, const std::filesystem::path& file, const metadata::Track& trackMetadata, const ScannerSettings::MediaLibraryInfo& libraryInfo)
+    void ScanStepScanFiles::processUnchangedFile(ScanContext& context, const std::filesystem::path& file)
+    {
+        ScanStats& stats{ context.stats };
+
+        db::Session& dbSession{ _db.getTLSSession() };
+        Track::pointer track{ Track::findByPath(dbSession, file) };
+        const Wt::WDateTime lastWriteTime{ retrieveFileGetLastWrite(file) };
+
+        // only refresh the last write time, so that the next scans skip this file right away
+        if (track && lastWriteTime.isValid())
+            track.modify()->setLastWriteTime(lastWriteTime);
+
+        LMS_LOG(DBUPDATER, DEBUG, "Skipped '" << file.string() << "' (content unchanged)");
+        stats.skips++;
+    }
+
+    void ScanStepScanFiles::processFileMetaData(ScanContext& context, const std::filesystem::path& file, const metadata::Track& trackMetadata, std::optional<std::uint64_t> contentHash, const ScannerSettings::MediaLibraryInfo& libraryInfo)
     {
         ScanStats& stats{ context.stats };
 
@@ -637,6 +857,7 @@ namespace lms::scanner
         track.modify()->setRelativeFilePath(fileInfo->relativePath);
         track.modify()->setFileSize(fileInfo->fileSize);
         track.modify()->setLastWriteTime(fileInfo->lastWriteTime);
+        track.modify()->setContentHash(contentHash);
 
         track.modify()->setMediaLibrary(MediaLibrary::find(dbSession, libraryInfo.id)); // may be null if settings are updated in // => next scan will correct this
         track.modify()->clearArtistLinks();
@@ -19,16 +19,20 @@
 
 #pragma once
 
-#include <condition_variable>
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <filesystem>
-#include <mutex>
+#include <optional>
 #include <span>
 #include <string>
 #include <vector>
 
+#include <Wt/WDateTime.h>
+
 #include "metadata/IParser.hpp"
-#include "core/IOContextRunner.hpp"
+#include "MetadataScanQueue.hpp"
+#include "ProcessedFileTracker.hpp"
 #include "ScanStepBase.hpp"
 
 namespace lms::scanner
@@ -40,48 +44,37 @@ namespace lms::scanner
 
     private:
         ScanStep getStep() const override { return ScanStep::ScanFiles; }
+        ScanDataSet getInputs() const override { return { ScanData::MediaFiles, ScanData::Tracks }; }
+        ScanDataSet getOutputs() const override { return { ScanData::Tracks }; }
         core::LiteralString getStepName() const override { return "Scan files"; }
-        void process(ScanContext& context) override;
+        void process(ScanContext& context, ScanStepStats& stepStats) override;
 
-        bool checkFileNeedScan(ScanContext& context, const std::filesystem::path& file, const ScannerSettings::MediaLibraryInfo& libraryInfo);
-        struct MetaDataScanResult
-        {
-            std::filesystem::path path;
-            std::unique_ptr<metadata::Track> trackMetaData;
-        };
-        void processMetaDataScanResults(ScanContext& context, std::span<const MetaDataScanResult> scanResults, const ScannerSettings::MediaLibraryInfo& libraryInfo);
-        void processFileMetaData(ScanContext& context, const std::filesystem::path& file, const metadata::Track& trackMetadata, const ScannerSettings::MediaLibraryInfo& libraryInfo);
+        // knownContentHash is set if the file only needs to be parsed in case its content changed
+        bool checkFileNeedScan(ScanContext& context, const std::filesystem::path& file, const ScannerSettings::MediaLibraryInfo& libraryInfo, std::optional<std::uint64_t>& knownContentHash);
+        bool queueImageFile(const std::filesystem::path& file); // returns false if the file cannot be processed
+        void processImageFiles(ScanContext& context);
+        void updateDirectories(std::span<const ChangedDirectory> changedDirectories);
+        void processMetaDataScanResults(ScanContext& context, std::span<const MetadataScanQueue::ScanResult> scanResults, const ScannerSettings::MediaLibraryInfo& libraryInfo);
+        void processUnchangedFile(ScanContext& context, const std::filesystem::path& file);
+        void processFileMetaData(ScanContext& context, const std::filesystem::path& file, const metadata::Track& trackMetadata, std::optional<std::uint64_t> contentHash, const ScannerSettings::MediaLibraryInfo& libraryInfo);
 
         std::unique_ptr<metadata::IParser>  _metadataParser;
         const std::vector<std::string>      _extraTagsToParse;
 
-        class MetadataScanQueue
-        {
-            public:
-                MetadataScanQueue(metadata::IParser& parser, std::size_t threadCount, bool& abort);
-
-                std::size_t getThreadCount() const { return _scanContextRunner.getThreadCount(); }
-
-                void pushScanRequest(const std::filesystem::path& path);
-
-                std::size_t getResultsCount() const;
-                size_t popResults(std::vector<MetaDataScanResult>& results, std::size_t maxCount);
-
-                void wait(std::size_t maxScanRequestCount = 0); // wait until ongoing scan request count <= maxScanRequestCount
+        MetadataScanQueue _metadataScanQueue;
 
-            private:
-                metadata::IParser& _metadataParser;
-                boost::asio::io_context _scanContext;
-                core::IOContextRunner _scanContextRunner;
+        std::deque<MetadataScanQueue::ScanResult> _metaDataScanResults;
 
-                mutable std::mutex _mutex ;
-                std::size_t _ongoingScanCount{};
-                std::deque<MetaDataScanResult> _scanResults;
-                std::condition_variable _condVar;
-                bool& _abort;
+        // Image files are written in batches, to avoid a write transaction per file
+        struct ImageFileInfo
+        {
+            std::filesystem::path path;
+            Wt::WDateTime lastWriteTime;
+            std::uintmax_t fileSize{};
         };
-        MetadataScanQueue _metadataScanQueue;
+        std::vector<ImageFileInfo> _pendingImageFiles;
 
-        std::deque<MetaDataScanResult> _metaDataScanResults;
+        ProcessedFileTracker _processedFileTracker;
+        std::chrono::steady_clock::time_point _lastCheckpointTime;
     };
 }
@@ -19,8 +19,12 @@
 
 #include "ScannerService.hpp"
 
+#include <algorithm>
+#include <condition_variable>
 #include <ctime>
 
+#include <boost/asio/post.hpp>
+
 #include "database/MediaLibrary.hpp"
 #include "database/TrackFeatures.hpp"
 #include "database/ScanSettings.hpp"
@@ -30,11 +34,14 @@
 #include "core/ILogger.hpp"
 #include "core/ITraceLogger.hpp"
 
+#include "ScanCheckpoint.hpp"
 #include "ScanStepCheckDuplicatedDbFiles.hpp"
 #include "ScanStepCompact.hpp"
 #include "ScanStepComputeClusterStats.hpp"
 #include "ScanStepDiscoverFiles.hpp"
+#include "ScanStepGenerateCovers.hpp"
 #include "ScanStepOptimize.hpp"
+#include "ScanStepRebuildListenStats.hpp"
 #include "ScanStepRemoveOrphanDbFiles.hpp"
 #include "ScanStepScanFiles.hpp"
 
@@ -44,6 +51,32 @@ namespace lms::scanner
 
     namespace
     {
+        constexpr std::size_t scanStepThreadCount{ 4 }; // only a few steps are independent from each other
+
+        bool isConflicting(const IScanStep& previousStep, const IScanStep& step)
+        {
+            const auto intersects{ [](IScanStep::ScanDataSet lhs, IScanStep::ScanDataSet rhs) { return (lhs.getBitfield() & rhs.getBitfield()) != 0; } };
+
+            return intersects(previousStep.getOutputs(), step.getInputs())    // read after write
+                || intersects(previousStep.getInputs(), step.getOutputs())    // write after read
+                || intersects(previousStep.getOutputs(), step.getOutputs());  // write after write
+        }
+
+        // Steps that can be restricted to some directories, the other ones work on the whole database and are left to the regular scans
+        bool isDirectoryScanStep(ScanStep step)
+        {
+            switch (step)
+            {
+            case ScanStep::DiscoverFiles:
+            case ScanStep::ScanFiles:
+            case ScanStep::CheckForMissingFiles:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
         Wt::WDate getNextMonday(Wt::WDate current)
         {
             do
@@ -71,7 +104,8 @@ namespace lms::scanner
     }
 
     ScannerService::ScannerService(Db& db)
-        : _db{ db }
+        : _scanStepContextRunner{ _scanStepContext, scanStepThreadCount, "ScannerStep" }
+        , _db{ db }
     {
         _ioService.setThreadCount(1);
 
@@ -83,6 +117,7 @@ namespace lms::scanner
     ScannerService::~ScannerService()
     {
         LMS_LOG(DBUPDATER, INFO, "Stopping service...");
+        _watcher.reset();
         stop();
         LMS_LOG(DBUPDATER, INFO, "Service stopped!");
     }
@@ -96,7 +131,14 @@ namespace lms::scanner
                 if (_abortScan)
                     return;
 
-                scheduleNextScan();
+                // Resume the scan interrupted by the previous shutdown, if any
+                if (const std::optional<ScanOptions> interruptedScanOptions{ getInterruptedScanOptions(_db.getTLSSession(), _settings.scanVersion) })
+                {
+                    LMS_LOG(DBUPDATER, INFO, "Previous scan was interrupted, resuming it");
+                    scheduleScan(*interruptedScanOptions);
+                }
+                else
+                    scheduleNextScan();
             });
 
         _ioService.start();
@@ -153,6 +195,9 @@ namespace lms::scanner
         abortScan();
         _ioService.post([this]()
             {
+                // media libraries may have been updated
+                _db.getReferenceDataCache().refresh(_db.getTLSSession());
+
                 if (_abortScan)
                     return;
 
@@ -170,6 +215,7 @@ namespace lms::scanner
         res.nextScheduledScan = _nextScheduledScan;
         res.lastCompleteScanStats = _lastCompleteScanStats;
         res.currentScanStepStats = _currentScanStepStats;
+        res.currentScanStepCount = _currentScanStepCount;
 
         return res;
     }
@@ -255,6 +301,91 @@ namespace lms::scanner
         }
     }
 
+    void ScannerService::onWatchedDirectoriesChanged(std::vector<DirectoryChange> changes)
+    {
+        {
+            std::scoped_lock lock{ _watchedDirectoriesMutex };
+            _watchedDirectoryChanges.insert(std::end(_watchedDirectoryChanges), std::make_move_iterator(std::begin(changes)), std::make_move_iterator(std::end(changes)));
+        }
+
+        // Several posted scans may be merged into the first one, the others then have nothing to do
+        _ioService.post([this]
+            {
+                if (_abortScan)
+                    return;
+
+                scanWatchedDirectories();
+            });
+    }
+
+    void ScannerService::scanWatchedDirectories()
+    {
+        std::vector<DirectoryChange> changes;
+        {
+            std::scoped_lock lock{ _watchedDirectoriesMutex };
+            changes.swap(_watchedDirectoryChanges);
+        }
+
+        if (changes.empty())
+            return;
+
+        // several reports may have been merged
+        changes = coalesceDirectoryChanges(std::move(changes));
+
+        LMS_LOG(DBUPDATER, INFO, "Changes detected in " << changes.size() << " directories, scanning them");
+        scanDirectories(changes);
+    }
+
+    void ScannerService::scanDirectories(std::span<const DirectoryChange> changes)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", "ScanDirectories");
+
+        // the scheduled scan, if any, is left untouched
+        State previousState{ State::NotScheduled };
+        {
+            std::unique_lock lock{ _statusMutex };
+            previousState = _curState;
+            _curState = State::InProgress;
+        }
+
+        refreshScanSettings();
+
+        IScanStep::ScanContext scanContext{ ScanOptions{}, ScanStats {} };
+        for (const DirectoryChange& change : changes)
+            scanContext.targetDirectories.push_back(IScanStep::TargetDirectory{ change.directory, change.recursive });
+        ScanStats& stats{ scanContext.stats };
+        stats.startTime = Wt::WDateTime::currentDateTime();
+
+        processScanSteps(scanContext, true /* directory steps only */);
+
+        // Invalidate the cache validators handed to HTTP clients, published along with the reference data
+        if (!_abortScan && stats.nbChanges() > 0)
+        {
+            auto transaction{ _db.getTLSSession().createWriteTransaction() };
+            ScanSettings::get(_db.getTLSSession()).modify()->incLibraryGeneration();
+        }
+
+        // even if aborted, some cluster types or release types may have been added
+        _db.getReferenceDataCache().refresh(_db.getTLSSession());
+
+        Wt::WDateTime nextScheduledScan;
+        {
+            std::unique_lock lock{ _statusMutex };
+
+            _curState = previousState;
+            _currentScanStepStats.clear(); // must be sync with _curState
+            nextScheduledScan = _nextScheduledScan;
+        }
+
+        LMS_LOG(DBUPDATER, INFO, "Directory scan " << (_abortScan ? "aborted" : "complete") << ". Changes = " << stats.nbChanges() << " (added = " << stats.additions << ", removed = " << stats.deletions << ", updated = " << stats.updates << "), Not changed = " << stats.skips << ", Scanned = " << stats.scans << " (errors = " << stats.errors.size() << ")");
+
+        if (_abortScan)
+            return;
+
+        // let the listeners refresh the status, the schedule did not change
+        _events.scanScheduled.emit(nextScheduledScan);
+    }
+
     void ScannerService::scan(const ScanOptions& scanOptions)
     {
         LMS_SCOPED_TRACE_OVERVIEW("Scanner", "Scan");
@@ -272,37 +403,40 @@ namespace lms::scanner
 
         refreshScanSettings();
 
-        IScanStep::ScanContext scanContext{ scanOptions, ScanStats {}, ScanStepStats {} };
+        IScanStep::ScanContext scanContext{ scanOptions, ScanStats {} };
         ScanStats& stats{ scanContext.stats };
         stats.startTime = Wt::WDateTime::currentDateTime();
 
-        std::size_t stepIndex{};
-        for (auto& scanStep : _scanSteps)
-        {
-            LMS_SCOPED_TRACE_OVERVIEW("Scanner", scanStep->getStepName());
+        restoreScanCheckpoint(_db.getTLSSession(), scanContext, _settings.scanVersion);
 
-            LMS_LOG(DBUPDATER, DEBUG, "Starting scan step '" << scanStep->getStepName() << "'");
-            scanContext.currentStepStats = ScanStepStats{ .startTime = Wt::WDateTime::currentDateTime(), .stepIndex = stepIndex++, .currentStep = scanStep->getStep() };
+        processScanSteps(scanContext, false /* all steps */);
 
-            notifyInProgress(scanContext.currentStepStats);
-            scanStep->process(scanContext);
-            notifyInProgress(scanContext.currentStepStats);
-            LMS_LOG(DBUPDATER, DEBUG, "Completed scan step '" << scanStep->getStepName() << "'");
+        // Invalidate the cache validators handed to HTTP clients, published along with the reference data
+        if (!_abortScan && stats.nbChanges() > 0)
+        {
+            auto transaction{ _db.getTLSSession().createWriteTransaction() };
+            ScanSettings::get(_db.getTLSSession()).modify()->incLibraryGeneration();
         }
 
+        // even if aborted, some cluster types or release types may have been added
+        _db.getReferenceDataCache().refresh(_db.getTLSSession());
+
         {
             std::unique_lock lock{ _statusMutex };
 
             _curState = State::NotScheduled;
-            _currentScanStepStats.reset(); // must be sync with _curState
+            _currentScanStepStats.clear(); // must be sync with _curState
         }
 
-        LMS_LOG(DBUPDATER, INFO, "Scan " << (_abortScan ? "aborted" : "complete") << ". Changes = " << stats.nbChanges() << " (added = " << stats.additions << ", removed = " << stats.deletions << ", updated = " << stats.updates << "), Not changed = " << stats.skips << ", Scanned = " << stats.scans << " (errors = " << stats.errors.size() << "), features fetched = " << stats.featuresFetched << ",  duplicates = " << stats.duplicates.size());
+        LMS_LOG(DBUPDATER, INFO, "Scan " << (_abortScan ? "aborted" : "complete") << ". Changes = " << stats.nbChanges() << " (added = " << stats.additions << ", removed = " << stats.deletions << ", updated = " << stats.updates << "), Not changed = " << stats.skips << ", Scanned = " << stats.scans << " (errors = " << stats.errors.size() << "), features fetched = " << stats.featuresFetched << ",  duplicates = " << stats.duplicates.size()
+            << ", orphans removed: artists = " << stats.orphanArtistsRemoved << ", releases = " << stats.orphanReleasesRemoved << ", clusters = " << stats.orphanClustersRemoved << ", cluster types = " << stats.orphanClusterTypesRemoved);
 
         if (!_abortScan)
         {
             stats.stopTime = Wt::WDateTime::currentDateTime();
 
+            clearScanCheckpoint(_db.getTLSSession());
+
             {
                 std::unique_lock lock{ _statusMutex };
                 _lastCompleteScanStats = stats;
@@ -319,6 +453,98 @@ namespace lms::scanner
         }
     }
 
+    void ScannerService::processScanSteps(IScanStep::ScanContext& context, bool directoryStepsOnly)
+    {
+        const std::size_t stepCount{ _scanSteps.size() };
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<bool> startedSteps(stepCount);
+        std::vector<bool> completedSteps(stepCount);
+        std::vector<std::optional<ScanStepStats>> stepStats(stepCount);
+        std::vector<std::size_t> displayedStepIndexes(stepCount); // only the processed steps are reported
+        std::size_t runningStepCount{};
+        std::size_t completedStepCount{};
+
+        std::size_t processedStepCount{};
+        for (std::size_t stepIndex{}; stepIndex < stepCount; ++stepIndex)
+        {
+            // skipped steps are considered complete, without stats
+            if (directoryStepsOnly && !isDirectoryScanStep(_scanSteps[stepIndex]->getStep()))
+            {
+                startedSteps[stepIndex] = true;
+                completedSteps[stepIndex] = true;
+            }
+            else
+                displayedStepIndexes[stepIndex] = processedStepCount++;
+        }
+
+        {
+            std::unique_lock lock{ _statusMutex };
+            _currentScanStepStats.clear();
+            _currentScanStepCount = processedStepCount;
+        }
+
+        std::unique_lock lock{ mutex };
+        while (true)
+        {
+            // start all the steps whose dependencies are complete
+            for (std::size_t stepIndex{}; stepIndex < stepCount && !_abortScan; ++stepIndex)
+            {
+                if (startedSteps[stepIndex])
+                    continue;
+
+                const std::vector<std::size_t>& dependencies{ _scanStepDependencies[stepIndex] };
+                if (!std::all_of(std::cbegin(dependencies), std::cend(dependencies), [&](std::size_t dependency) { return completedSteps[dependency]; }))
+                    continue;
+
+                startedSteps[stepIndex] = true;
+                runningStepCount++;
+                boost::asio::post(_scanStepContext, [&, stepIndex]
+                    {
+                        ScanStepStats stats{ processScanStep(*_scanSteps[stepIndex], displayedStepIndexes[stepIndex], context) };
+
+                        // notify while holding the lock: once it is released, the waiting thread may return and destroy cv
+                        std::scoped_lock completionLock{ mutex };
+                        stepStats[stepIndex] = std::move(stats);
+                        completedSteps[stepIndex] = true;
+                        runningStepCount--;
+                        completedStepCount++;
+                        cv.notify_all();
+                    });
+            }
+
+            if (runningStepCount == 0)
+                break;
+
+            const std::size_t previousCompletedStepCount{ completedStepCount };
+            cv.wait(lock, [&] { return completedStepCount != previousCompletedStepCount; });
+        }
+
+        for (std::optional<ScanStepStats>& stats : stepStats)
+        {
+            if (stats)
+                context.stats.stepStats.push_back(std::move(*stats));
+        }
+    }
+
+    ScanStepStats ScannerService::processScanStep(IScanStep& scanStep, std::size_t stepIndex, IScanStep::ScanContext& context)
+    {
+        LMS_SCOPED_TRACE_OVERVIEW("Scanner", scanStep.getStepName());
+
+        LMS_LOG(DBUPDATER, DEBUG, "Starting scan step '" << scanStep.getStepName() << "'");
+        ScanStepStats stepStats{ .startTime = Wt::WDateTime::currentDateTime(), .stepIndex = stepIndex, .currentStep = scanStep.getStep() };
+
+        notifyInProgress(stepStats);
+        scanStep.process(context, stepStats);
+        stepStats.stopTime = Wt::WDateTime::currentDateTime();
+        notifyInProgress(stepStats);
+
+        LMS_LOG(DBUPDATER, DEBUG, "Completed scan step '" << scanStep.getStepName() << "' in " << std::chrono::duration_cast<std::chrono::milliseconds>(stepStats.stopTime.toTimePoint() - stepStats.startTime.toTimePoint()).count() << " ms");
+
+        return stepStats;
+    }
+
     void ScannerService::refreshScanSettings()
     {
         ScannerSettings newSettings{ readSettings() };
@@ -327,6 +553,9 @@ namespace lms::scanner
 
         LMS_LOG(DBUPDATER, DEBUG, "Scanner settings updated");
         LMS_LOG(DBUPDATER, DEBUG, "skipDuplicateMBID = " << newSettings.skipDuplicateMBID);
+        LMS_LOG(DBUPDATER, DEBUG, "skipUnchangedFiles = " << newSettings.skipUnchangedFiles);
+        LMS_LOG(DBUPDATER, DEBUG, "skipUnchangedDirectories = " << newSettings.skipUnchangedDirectories << ", full validation every " << newSettings.fullValidationScanInterval << " scan(s)");
+        LMS_LOG(DBUPDATER, DEBUG, "watchMediaLibraries = " << newSettings.watchMediaLibraries << ", debounce delay = " << newSettings.watchDebounceDelay.count() << "s");
         LMS_LOG(DBUPDATER, DEBUG, "Using scan settings version " << newSettings.scanVersion);
 
         _settings = std::move(newSettings);
@@ -348,10 +577,61 @@ namespace lms::scanner
         _scanSteps.push_back(std::make_unique<ScanStepDiscoverFiles>(params));
         _scanSteps.push_back(std::make_unique<ScanStepScanFiles>(params));
         _scanSteps.push_back(std::make_unique<ScanStepRemoveOrphanDbFiles>(params));
-        _scanSteps.push_back(std::make_unique<ScanStepCompact>(params));
-        _scanSteps.push_back(std::make_unique<ScanStepOptimize>(params));
         _scanSteps.push_back(std::make_unique<ScanStepComputeClusterStats>(params));
+        _scanSteps.push_back(std::make_unique<ScanStepRebuildListenStats>(params));
         _scanSteps.push_back(std::make_unique<ScanStepCheckDuplicatedDbFiles>(params));
+        _scanSteps.push_back(std::make_unique<ScanStepGenerateCovers>(params));
+        _scanSteps.push_back(std::make_unique<ScanStepOptimize>(params));
+        _scanSteps.push_back(std::make_unique<ScanStepCompact>(params));
+
+        _scanStepDependencies.clear();
+        for (std::size_t stepIndex{}; stepIndex < _scanSteps.size(); ++stepIndex)
+        {
+            std::vector<std::size_t>& dependencies{ _scanStepDependencies.emplace_back() };
+            for (std::size_t previousStepIndex{}; previousStepIndex < stepIndex; ++previousStepIndex)
+            {
+                if (isConflicting(*_scanSteps[previousStepIndex], *_scanSteps[stepIndex]))
+                {
+                    LMS_LOG(DBUPDATER, DEBUG, "Scan step '" << _scanSteps[stepIndex]->getStepName() << "' waits for '" << _scanSteps[previousStepIndex]->getStepName() << "'");
+                    dependencies.push_back(previousStepIndex);
+                }
+            }
+        }
+
+        refreshWatcher();
+    }
+
+    void ScannerService::refreshWatcher()
+    {
+        if (!_settings.watchMediaLibraries || _settings.mediaLibraries.empty())
+        {
+            _watcher.reset();
+            return;
+        }
+
+        std::vector<std::filesystem::path> rootDirectories;
+        for (const ScannerSettings::MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
+            rootDirectories.push_back(mediaLibrary.rootDirectory);
+
+        // Only the watches of the added or removed media libraries are updated
+        if (_watcher && _watcher->getDebounceDelay() == _settings.watchDebounceDelay)
+        {
+            _watcher->setRootDirectories(rootDirectories);
+            return;
+        }
+
+        _watcher.reset();
+        try
+        {
+            _watcher = std::make_unique<FileSystemWatcher>(rootDirectories, _settings.watchDebounceDelay, [this](std::vector<DirectoryChange> changes)
+                {
+                    onWatchedDirectoriesChanged(std::move(changes));
+                });
+        }
+        catch (const core::LmsException& e)
+        {
+            LMS_LOG(DBUPDATER, ERROR, "Cannot watch media libraries: " << e.what());
+        }
     }
 
     ScannerSettings ScannerService::readSettings()
@@ -359,6 +639,11 @@ namespace lms::scanner
         ScannerSettings newSettings;
 
         newSettings.skipDuplicateMBID = core::Service<core::IConfig>::get()->getBool("scanner-skip-duplicate-mbid", false);
+        newSettings.skipUnchangedFiles = core::Service<core::IConfig>::get()->getBool("scanner-skip-unchanged-files", false);
+        newSettings.skipUnchangedDirectories = core::Service<core::IConfig>::get()->getBool("scanner-skip-unchanged-directories", false);
+        newSettings.fullValidationScanInterval = core::Service<core::IConfig>::get()->getULong("scanner-full-validation-scan-interval", 24);
+        newSettings.watchMediaLibraries = core::Service<core::IConfig>::get()->getBool("scanner-watch-media-libraries", false);
+        newSettings.watchDebounceDelay = std::chrono::seconds{ core::Service<core::IConfig>::get()->getULong("scanner-watch-debounce-delay", 5) };
         {
             auto transaction{ _db.getTLSSession().createReadTransaction() };
 
@@ -394,21 +679,39 @@ namespace lms::scanner
 
     void ScannerService::notifyInProgress(const ScanStepStats& stepStats)
     {
-        {
-            std::unique_lock lock{ _statusMutex };
-            _currentScanStepStats = stepStats;
-        }
+        updateCurrentScanStepStats(stepStats);
 
         const std::chrono::system_clock::time_point now{ std::chrono::system_clock::now() };
+
+        std::scoped_lock lock{ _progressMutex };
         _events.scanInProgress(stepStats);
         _lastScanInProgressEmit = now;
     }
 
     void ScannerService::notifyInProgressIfNeeded(const ScanStepStats& stepStats)
     {
+        // always keep the status up to date, as concurrent steps share the emit rate limit
+        updateCurrentScanStepStats(stepStats);
+
         std::chrono::system_clock::time_point now{ std::chrono::system_clock::now() };
 
+        std::scoped_lock lock{ _progressMutex };
         if (std::chrono::duration_cast<std::chrono::seconds>(now - _lastScanInProgressEmit).count() > 1)
-            notifyInProgress(stepStats);
+        {
+            _events.scanInProgress(stepStats);
+            _lastScanInProgressEmit = now;
+        }
+    }
+
+    void ScannerService::updateCurrentScanStepStats(const ScanStepStats& stepStats)
+    {
+        std::unique_lock lock{ _statusMutex };
+
+        auto it{ std::lower_bound(std::begin(_currentScanStepStats), std::end(_currentScanStepStats), stepStats.stepIndex,
+            [](const ScanStepStats& currentStepStats, std::size_t stepIndex) { return currentStepStats.stepIndex < stepIndex; }) };
+        if (it != std::end(_currentScanStepStats) && it->stepIndex == stepStats.stepIndex)
+            *it = stepStats;
+        else
+            _currentScanStepStats.insert(it, stepStats);
     }
 } // namespace lms::scanner
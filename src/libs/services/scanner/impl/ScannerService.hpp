@@ -20,21 +20,27 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include <Wt/WDateTime.h>
 #include <Wt/WIOService.h>
 #include <Wt/WSignal.h>
 
+#include <boost/asio/io_context.hpp>
 #include <boost/asio/system_timer.hpp>
 
 #include "database/Db.hpp"
 #include "database/Session.hpp"
 #include "database/Types.hpp"
 #include "services/scanner/IScannerService.hpp"
+#include "core/IOContextRunner.hpp"
 #include "core/Path.hpp"
+#include "FileSystemWatcher.hpp"
 #include "IScanStep.hpp"
 #include "ScannerSettings.hpp"
 
@@ -69,16 +75,32 @@ namespace lms::scanner
         // Update database (scheduled callback)
         void scan(const ScanOptions& scanOptions);
 
+        // Called from the watcher thread
+        void onWatchedDirectoriesChanged(std::vector<DirectoryChange> changes);
+        void scanWatchedDirectories();
+        // Only runs the steps that work on the given directories: no next scan scheduling, no complete scan stats/event
+        void scanDirectories(std::span<const DirectoryChange> changes);
+
+        // Each step waits for the previous steps it conflicts with, independent steps run concurrently
+        void processScanSteps(IScanStep::ScanContext& context, bool directoryStepsOnly);
+        ScanStepStats processScanStep(IScanStep& scanStep, std::size_t stepIndex, IScanStep::ScanContext& context);
+
         void scanMediaDirectory(const std::filesystem::path& mediaDirectory, bool forceScan, ScanStats& stats);
 
         // Helpers
         void refreshScanSettings();
+        void refreshWatcher();
         ScannerSettings readSettings();
 
         void notifyInProgressIfNeeded(const ScanStepStats& stats);
         void notifyInProgress(const ScanStepStats& stats);
+        void updateCurrentScanStepStats(const ScanStepStats& stats);
 
         std::vector<std::unique_ptr<IScanStep>>	_scanSteps;
+        std::vector<std::vector<std::size_t>>	_scanStepDependencies; // for each step, the previous steps to wait for
+        boost::asio::io_context					_scanStepContext;
+        core::IOContextRunner					_scanStepContextRunner;
+        std::mutex								_progressMutex; // steps may report progress concurrently
 
         std::mutex								_controlMutex;
         bool									_abortScan{};
@@ -91,10 +113,15 @@ namespace lms::scanner
         mutable std::shared_mutex			_statusMutex;
         State								_curState{ State::NotScheduled };
         std::optional<ScanStats> 			_lastCompleteScanStats;
-        std::optional<ScanStepStats> 		_currentScanStepStats;
+        std::vector<ScanStepStats> 			_currentScanStepStats;
+        std::size_t							_currentScanStepCount{};
         Wt::WDateTime						_nextScheduledScan;
 
         ScannerSettings						_settings;
+
+        std::mutex                          _watchedDirectoriesMutex;
+        std::vector<DirectoryChange>        _watchedDirectoryChanges;
+        std::unique_ptr<FileSystemWatcher>  _watcher; // must be destroyed first
     };
 } // Scanner
 
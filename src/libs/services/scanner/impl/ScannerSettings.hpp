@@ -19,12 +19,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 #include <string>
 #include <vector>
 #include <Wt/WDateTime.h>
 #include "database/MediaLibraryId.hpp"
 #include "database/ScanSettings.hpp"
+#include "services/cover/ICoverService.hpp"
 
 namespace lms::scanner
 {
@@ -34,7 +36,13 @@ namespace lms::scanner
         Wt::WTime								startTime;
         db::ScanSettings::UpdatePeriod 	updatePeriod{ db::ScanSettings::UpdatePeriod::Never };
         std::vector<std::filesystem::path>		supportedExtensions;
+        std::vector<std::filesystem::path>		supportedImageExtensions{ cover::getSupportedFileExtensions() };
         bool									skipDuplicateMBID{};
+        bool                                    skipUnchangedFiles{}; // based on a partial content hash, when the last write time changed
+        bool                                    skipUnchangedDirectories{}; // based on the directory last write time
+        std::size_t                             fullValidationScanInterval{}; // when skipping unchanged directories, 0 means only the first scan
+        bool                                    watchMediaLibraries{}; // scan directories as soon as changes are detected
+        std::chrono::seconds                    watchDebounceDelay{};
         std::vector<std::string>				extraTags;
         std::vector<std::string>                artistTagDelimiters;
         std::vector<std::string>                defaultTagDelimiters;
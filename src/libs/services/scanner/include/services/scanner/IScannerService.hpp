@@ -20,6 +20,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "ScannerEvents.hpp"
 #include "ScannerOptions.hpp"
@@ -53,7 +54,8 @@ namespace lms::scanner
             State								currentState{ State::NotScheduled };
             Wt::WDateTime						nextScheduledScan;
             std::optional<ScanStats>			lastCompleteScanStats;
-            std::optional<ScanStepStats> 		currentScanStepStats;
+            std::vector<ScanStepStats> 		currentScanStepStats;	// started steps of the current scan, in step order (several steps may be in progress)
+            std::size_t							currentScanStepCount{};
         };
 
         virtual Status getStatus() const = 0;
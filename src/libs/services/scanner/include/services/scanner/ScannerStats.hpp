@@ -65,16 +65,18 @@ namespace lms::scanner
         Compact,
         DiscoverFiles,
         FetchTrackFeatures,
+        GenerateCovers,
         Optimize,
         ReloadSimilarityEngine,
         ScanFiles,
+        RebuildListenStats, // values are saved in scan checkpoints: only append new steps
     };
-    static inline constexpr unsigned ScanProgressStepCount{ 9 };
 
     // reduced scan stats
     struct ScanStepStats
     {
         Wt::WDateTime   startTime;
+        Wt::WDateTime   stopTime;   // null while the step is in progress
 
         std::size_t stepIndex{};
         ScanStep currentStep;
@@ -82,6 +84,10 @@ namespace lms::scanner
         std::size_t	totalElems{};
         std::size_t	processedElems{};
 
+        // only set by steps that dispatch their work to a thread pool
+        std::size_t	threadCount{};
+        std::size_t	queuedElems{};
+
         unsigned		progress() const;
     };
 
@@ -101,8 +107,15 @@ namespace lms::scanner
 
         std::size_t	featuresFetched{};	// features fetched in DB
 
+        // entries no longer related to any track, removed from DB
+        std::size_t	orphanArtistsRemoved{};
+        std::size_t	orphanReleasesRemoved{};
+        std::size_t	orphanClustersRemoved{};
+        std::size_t	orphanClusterTypesRemoved{};
+
         std::vector<ScanError>		errors;
         std::vector<ScanDuplicate>	duplicates;
+        std::vector<ScanStepStats>	stepStats;	// completed steps, in step order
 
         std::size_t	nbFiles() const;
         std::size_t	nbChanges() const;
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "FileSystemWatcher.hpp"
+
+namespace lms::scanner::tests
+{
+    namespace
+    {
+        class ScopedTestDirectory
+        {
+        public:
+            ScopedTestDirectory(std::string_view name)
+                : _path{ std::filesystem::temp_directory_path() / ("lms-test-" + std::string{ name } + "-" + std::to_string(::getpid())) }
+            {
+                std::filesystem::remove_all(_path);
+                std::filesystem::create_directories(_path);
+            }
+            ~ScopedTestDirectory() { std::filesystem::remove_all(_path); }
+
+            const std::filesystem::path& getPath() const { return _path; }
+
+        private:
+            ScopedTestDirectory(const ScopedTestDirectory&) = delete;
+            ScopedTestDirectory& operator=(const ScopedTestDirectory&) = delete;
+
+            const std::filesystem::path _path;
+        };
+
+        class ChangeCollector
+        {
+        public:
+            void onChange(std::vector<DirectoryChange> changes)
+            {
+                {
+                    std::scoped_lock lock{ _mutex };
+                    _reports.push_back(std::move(changes));
+                }
+                _cv.notify_all();
+            }
+
+            // returns the reports received so far, once at least reportCount reports are received or the timeout expires
+            std::vector<std::vector<DirectoryChange>> waitReports(std::size_t reportCount, std::chrono::milliseconds timeout)
+            {
+                std::unique_lock lock{ _mutex };
+                _cv.wait_for(lock, timeout, [&] { return _reports.size() >= reportCount; });
+                return _reports;
+            }
+
+        private:
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            std::vector<std::vector<DirectoryChange>> _reports;
+        };
+
+        constexpr std::chrono::milliseconds debounceDelay{ 200 };
+        constexpr std::chrono::seconds reportTimeout{ 5 };
+
+        // the watches are set up asynchronously
+        constexpr std::chrono::milliseconds watchSetupDelay{ 200 };
+    }
+
+    TEST(FileSystemWatcher, isSameOrSubDirectory)
+    {
+        struct TestCase
+        {
+            std::filesystem::path directory;
+            std::filesystem::path parentDirectory;
+            bool expectedResult;
+        };
+
+        const TestCase tests[]
+        {
+            { "/root", "/root", true },
+            { "/root/", "/root", true },
+            { "/root", "/root/", true },
+            { "/root/sub", "/root", true },
+            { "/root/sub", "/root/", true },
+            { "/root/sub/sub2", "/root", true },
+            { "/root", "/root/sub", false },
+            { "/root2", "/root", false },
+            { "/roo", "/root", false },
+            { "/root2/sub", "/root", false },
+            { "/other/root", "/root", false },
+        };
+
+        for (const TestCase& test : tests)
+        {
+            EXPECT_EQ(isSameOrSubDirectory(test.directory, test.parentDirectory), test.expectedResult) << "Failed: directory = " << test.directory << ", parentDirectory = " << test.parentDirectory;
+        }
+    }
+
+    TEST(FileSystemWatcher, debounceCoalescesChanges)
+    {
+        const ScopedTestDirectory root{ "watcher-coalesce" };
+        std::filesystem::create_directories(root.getPath() / "a" / "b");
+        std::filesystem::create_directories(root.getPath() / "c");
+
+        ChangeCollector collector;
+        const std::vector<std::filesystem::path> rootDirectories{ root.getPath() };
+        FileSystemWatcher watcher{ rootDirectories, debounceDelay, [&](std::vector<DirectoryChange> changes) { collector.onChange(std::move(changes)); } };
+        std::this_thread::sleep_for(watchSetupDelay);
+
+        // several changes in a row, in a directory and its sub directory, and in another directory
+        std::ofstream{ root.getPath() / "a" / "1.mp3" };
+        std::ofstream{ root.getPath() / "a" / "2.mp3" };
+        std::ofstream{ root.getPath() / "a" / "b" / "3.mp3" };
+        std::ofstream{ root.getPath() / "c" / "4.mp3" };
+
+        const auto reports{ collector.waitReports(1, reportTimeout) };
+        ASSERT_EQ(reports.size(), 1);
+
+        // file changes only concern their own directory
+        const std::vector<DirectoryChange> expectedChanges{ { root.getPath() / "a", false }, { root.getPath() / "a" / "b", false }, { root.getPath() / "c", false } };
+        EXPECT_EQ(reports.front(), expectedChanges);
+
+        // nothing else reported
+        EXPECT_EQ(collector.waitReports(2, 2 * debounceDelay).size(), 1);
+    }
+
+    TEST(FileSystemWatcher, newDirectory)
+    {
+        const ScopedTestDirectory root{ "watcher-new-directory" };
+
+        ChangeCollector collector;
+        const std::vector<std::filesystem::path> rootDirectories{ root.getPath() };
+        FileSystemWatcher watcher{ rootDirectories, debounceDelay, [&](std::vector<DirectoryChange> changes) { collector.onChange(std::move(changes)); } };
+        std::this_thread::sleep_for(watchSetupDelay);
+
+        std::filesystem::create_directories(root.getPath() / "new");
+        {
+            const auto reports{ collector.waitReports(1, reportTimeout) };
+            ASSERT_EQ(reports.size(), 1);
+            EXPECT_EQ(reports[0], (std::vector<DirectoryChange>{ { root.getPath() / "new", true } }));
+        }
+
+        // the new directory is now watched too
+        std::ofstream{ root.getPath() / "new" / "1.mp3" };
+        {
+            const auto reports{ collector.waitReports(2, reportTimeout) };
+            ASSERT_EQ(reports.size(), 2);
+            EXPECT_EQ(reports[1], (std::vector<DirectoryChange>{ { root.getPath() / "new", false } }));
+        }
+
+        // removed directories have to be checked recursively
+        std::filesystem::remove_all(root.getPath() / "new");
+        {
+            const auto reports{ collector.waitReports(3, reportTimeout) };
+            ASSERT_EQ(reports.size(), 3);
+            EXPECT_EQ(reports[2], (std::vector<DirectoryChange>{ { root.getPath() / "new", true } }));
+        }
+    }
+
+    TEST(FileSystemWatcher, coalesceDirectoryChanges)
+    {
+        const std::vector<DirectoryChange> changes{
+            { "/root/b", false },
+            { "/root/a/sub", false },
+            { "/root/a", true },
+            { "/root/b", true },
+            { "/root/b", false },
+            { "/root/c/sub", false },
+            { "/root/c", false },
+            { "/root/a2", false },
+        };
+
+        const std::vector<DirectoryChange> expectedChanges{
+            { "/root/a", true },
+            { "/root/a2", false },
+            { "/root/b", true },
+            { "/root/c", false },
+            { "/root/c/sub", false },
+        };
+        EXPECT_EQ(coalesceDirectoryChanges(changes), expectedChanges);
+    }
+
+    TEST(FileSystemWatcher, setRootDirectories)
+    {
+        const ScopedTestDirectory root1{ "watcher-root1" };
+        const ScopedTestDirectory root2{ "watcher-root2" };
+
+        ChangeCollector collector;
+        const std::vector<std::filesystem::path> rootDirectories{ root1.getPath() };
+        FileSystemWatcher watcher{ rootDirectories, debounceDelay, [&](std::vector<DirectoryChange> changes) { collector.onChange(std::move(changes)); } };
+        std::this_thread::sleep_for(watchSetupDelay);
+
+        const std::vector<std::filesystem::path> newRootDirectories{ root2.getPath() };
+        watcher.setRootDirectories(newRootDirectories);
+        std::this_thread::sleep_for(watchSetupDelay);
+
+        // changes in the removed root directory are ignored
+        std::ofstream{ root1.getPath() / "1.mp3" };
+        std::ofstream{ root2.getPath() / "2.mp3" };
+
+        const auto reports{ collector.waitReports(1, reportTimeout) };
+        ASSERT_EQ(reports.size(), 1);
+        EXPECT_EQ(reports[0], (std::vector<DirectoryChange>{ { root2.getPath(), false } }));
+        EXPECT_EQ(collector.waitReports(2, 2 * debounceDelay).size(), 1);
+    }
+}
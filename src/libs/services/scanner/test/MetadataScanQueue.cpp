@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "MetadataScanQueue.hpp"
+
+namespace lms::scanner::tests
+{
+    namespace
+    {
+        class TestParser : public metadata::IParser
+        {
+        public:
+            std::size_t getParseCount() const { return _parseCount; }
+
+        private:
+            std::unique_ptr<metadata::Track> parse(const std::filesystem::path& p, bool) override
+            {
+                _parseCount++;
+
+                auto track{ std::make_unique<metadata::Track>() };
+                track->title = p.filename().string();
+                return track;
+            }
+
+            void setUserExtraTags(std::span<const std::string>) override {}
+            void setArtistTagDelimiters(std::span<const std::string>) override {}
+            void setDefaultTagDelimiters(std::span<const std::string>) override {}
+
+            std::atomic<std::size_t> _parseCount{};
+        };
+
+        class ScopedTestFile
+        {
+        public:
+            ScopedTestFile(const std::filesystem::path& path, std::string_view content)
+                : _path{ path }
+            {
+                write(content);
+            }
+            ~ScopedTestFile() { std::filesystem::remove(_path); }
+
+            const std::filesystem::path& getPath() const { return _path; }
+            void write(std::string_view content)
+            {
+                std::ofstream{ _path, std::ios::binary | std::ios::trunc }.write(content.data(), static_cast<std::streamsize>(content.size()));
+            }
+
+        private:
+            ScopedTestFile(const ScopedTestFile&) = delete;
+            ScopedTestFile& operator=(const ScopedTestFile&) = delete;
+
+            const std::filesystem::path _path;
+        };
+
+        MetadataScanQueue::ScanResult scanFile(MetadataScanQueue& queue, const std::filesystem::path& path, bool computeContentHash, std::optional<std::uint64_t> knownContentHash)
+        {
+            queue.pushScanRequest(path, computeContentHash, knownContentHash);
+            queue.wait();
+
+            std::vector<MetadataScanQueue::ScanResult> results;
+            EXPECT_EQ(queue.popResults(results, 10), 1);
+            return std::move(results.front());
+        }
+    }
+
+    TEST(MetadataScanQueue, parse)
+    {
+        TestParser parser;
+        bool abort{};
+        MetadataScanQueue queue{ parser, 2, 4, 2, abort };
+
+        const ScopedTestFile file{ std::filesystem::temp_directory_path() / ("lms-test-scan-queue-" + std::to_string(::getpid()) + ".mp3"), "content" };
+
+        const MetadataScanQueue::ScanResult result{ scanFile(queue, file.getPath(), false, std::nullopt) };
+        EXPECT_EQ(parser.getParseCount(), 1);
+        EXPECT_EQ(result.path, file.getPath());
+        ASSERT_TRUE(result.trackMetaData);
+        EXPECT_EQ(result.trackMetaData->title, file.getPath().filename().string());
+        EXPECT_FALSE(result.contentHash);
+        EXPECT_FALSE(result.contentUnchanged);
+    }
+
+    TEST(MetadataScanQueue, skipUnchangedContent)
+    {
+        TestParser parser;
+        bool abort{};
+        MetadataScanQueue queue{ parser, 1, 1, 1, abort };
+
+        ScopedTestFile file{ std::filesystem::temp_directory_path() / ("lms-test-scan-queue-hash-" + std::to_string(::getpid()) + ".mp3"), "some audio content" };
+
+        // first scan: file parsed, hash computed
+        std::uint64_t contentHash{};
+        {
+            const MetadataScanQueue::ScanResult result{ scanFile(queue, file.getPath(), true, std::nullopt) };
+            EXPECT_EQ(parser.getParseCount(), 1);
+            EXPECT_TRUE(result.trackMetaData);
+            EXPECT_FALSE(result.contentUnchanged);
+            ASSERT_TRUE(result.contentHash);
+            contentHash = *result.contentHash;
+        }
+
+        // same content: not parsed again
+        {
+            const MetadataScanQueue::ScanResult result{ scanFile(queue, file.getPath(), true, contentHash) };
+            EXPECT_EQ(parser.getParseCount(), 1);
+            EXPECT_FALSE(result.trackMetaData);
+            EXPECT_TRUE(result.contentUnchanged);
+            ASSERT_TRUE(result.contentHash);
+            EXPECT_EQ(*result.contentHash, contentHash);
+        }
+
+        // content changed: parsed again
+        file.write("some other audio content");
+        {
+            const MetadataScanQueue::ScanResult result{ scanFile(queue, file.getPath(), true, contentHash) };
+            EXPECT_EQ(parser.getParseCount(), 2);
+            EXPECT_TRUE(result.trackMetaData);
+            EXPECT_FALSE(result.contentUnchanged);
+            ASSERT_TRUE(result.contentHash);
+            EXPECT_NE(*result.contentHash, contentHash);
+        }
+
+        // hash not requested: always parsed
+        {
+            const MetadataScanQueue::ScanResult result{ scanFile(queue, file.getPath(), false, contentHash) };
+            EXPECT_EQ(parser.getParseCount(), 3);
+            EXPECT_TRUE(result.trackMetaData);
+            EXPECT_FALSE(result.contentUnchanged);
+        }
+    }
+
+    TEST(MetadataScanQueue, abort)
+    {
+        TestParser parser;
+        bool abort{ true };
+        MetadataScanQueue queue{ parser, 1, 1, 1, abort };
+
+        queue.pushScanRequest("/file.mp3", false, std::nullopt);
+        queue.wait();
+
+        std::vector<MetadataScanQueue::ScanResult> results;
+        EXPECT_EQ(queue.popResults(results, 10), 0);
+        EXPECT_EQ(parser.getParseCount(), 0);
+    }
+
+    TEST(MetadataScanQueue, computeThreadCount)
+    {
+        // parameters: threadCount, usedCpuCount, requestsWaited, cpuThreadBudget, minThreadCount, maxThreadCount
+
+        // budget matched
+        EXPECT_EQ(computeThreadCount(4, 4., true, 4, 1, 16), 4);
+
+        // CPU bound: fewer threads
+        EXPECT_EQ(computeThreadCount(8, 8., true, 4, 1, 16), 6);
+
+        // I/O bound: more threads, only if requests had to wait
+        EXPECT_EQ(computeThreadCount(4, 1., true, 4, 1, 16), 10);
+        EXPECT_EQ(computeThreadCount(4, 1., false, 4, 1, 16), 4);
+
+        // no CPU used at all: grow toward the max
+        EXPECT_EQ(computeThreadCount(2, 0., true, 4, 1, 10), 6);
+
+        // limits
+        EXPECT_EQ(computeThreadCount(4, 16., true, 1, 3, 16), 3);
+        EXPECT_EQ(computeThreadCount(4, 0.1, true, 4, 1, 8), 6);
+    }
+
+    TEST(MetadataScanQueue, computeThreadCountConverges)
+    {
+        std::size_t threadCount{ 4 };
+        for (std::size_t i{}; i < 10; ++i)
+            threadCount = computeThreadCount(threadCount, 0.1, true, 4, 1, 8);
+        EXPECT_EQ(threadCount, 8);
+
+        for (std::size_t i{}; i < 10; ++i)
+            threadCount = computeThreadCount(threadCount, 2. * static_cast<double>(threadCount), false, 2, 2, 8);
+        EXPECT_EQ(threadCount, 2);
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ProcessedFileTracker.hpp"
+
+namespace lms::scanner::tests
+{
+    TEST(ProcessedFileTracker, isBeforeInWalkOrder)
+    {
+        struct TestCase
+        {
+            std::filesystem::path file;
+            std::filesystem::path lastFile;
+            bool expectedResult;
+        };
+
+        const TestCase testCases[]{
+            // same directory, name order
+            { "/root/a.mp3", "/root/b.mp3", true },
+            { "/root/b.mp3", "/root/b.mp3", true },
+            { "/root/c.mp3", "/root/b.mp3", false },
+
+            // files of a directory before its sub directories
+            { "/root/z.mp3", "/root/a/a.mp3", true },
+            { "/root/a/a.mp3", "/root/z.mp3", false },
+
+            // sibling directories, name order
+            { "/root/a/z.mp3", "/root/b/a.mp3", true },
+            { "/root/b/a.mp3", "/root/a/z.mp3", false },
+
+            // nested directories
+            { "/root/a/b/c/a.mp3", "/root/a/c/a.mp3", true },
+            { "/root/a/c/a.mp3", "/root/a/b/c/a.mp3", false },
+            { "/root/a/b.mp3", "/root/a/b/c/a.mp3", true },
+            { "/root/a/b/c/a.mp3", "/root/a/b.mp3", false },
+        };
+
+        for (const TestCase& testCase : testCases)
+            EXPECT_EQ(isBeforeInWalkOrder(testCase.file, testCase.lastFile), testCase.expectedResult) << "file = '" << testCase.file << "', lastFile = '" << testCase.lastFile << "'";
+    }
+
+    TEST(ProcessedFileTracker, empty)
+    {
+        ProcessedFileTracker tracker;
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+    }
+
+    TEST(ProcessedFileTracker, pendingFiles)
+    {
+        ProcessedFileTracker tracker;
+
+        tracker.onFileExplored("/root/a.mp3", true);
+        tracker.onFileExplored("/root/b.mp3", false);
+        tracker.onFileExplored("/root/c.mp3", true);
+        tracker.onFileExplored("/root/d.mp3", true);
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+
+        // out of order completion does not move the last processed file
+        tracker.onFileScanned("/root/c.mp3");
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+
+        tracker.onFileScanned("/root/a.mp3");
+        EXPECT_EQ(tracker.getLastProcessedFile(), "/root/c.mp3");
+
+        tracker.onFileScanned("/root/d.mp3");
+        EXPECT_EQ(tracker.getLastProcessedFile(), "/root/d.mp3");
+
+        tracker.onFileExplored("/root/e.mp3", false);
+        EXPECT_EQ(tracker.getLastProcessedFile(), "/root/e.mp3");
+    }
+
+    TEST(ProcessedFileTracker, saveRestore)
+    {
+        // already sorted in walk order
+        const std::vector<std::filesystem::path> files{
+            "/root/a.mp3",
+            "/root/b.mp3",
+            "/root/a/a.mp3",
+            "/root/a/b/a.mp3",
+            "/root/a/c/a.mp3",
+            "/root/b/a.mp3",
+        };
+        ASSERT_TRUE(std::is_sorted(std::cbegin(files), std::cend(files), [](const std::filesystem::path& lhs, const std::filesystem::path& rhs) { return lhs != rhs && isBeforeInWalkOrder(lhs, rhs); }));
+
+        ProcessedFileTracker tracker;
+        for (const std::filesystem::path& file : files)
+            tracker.onFileExplored(file, true);
+
+        tracker.onFileScanned(files[0]);
+        tracker.onFileScanned(files[1]);
+        tracker.onFileScanned(files[2]);
+        tracker.onFileScanned(files[4]);
+
+        // save
+        const std::filesystem::path lastProcessedFile{ tracker.getLastProcessedFile() };
+        ASSERT_EQ(lastProcessedFile, files[2]);
+
+        // restore: only the files up to the last processed one are skipped
+        std::vector<std::filesystem::path> remainingFiles;
+        std::copy_if(std::cbegin(files), std::cend(files), std::back_inserter(remainingFiles), [&](const std::filesystem::path& file) { return !isBeforeInWalkOrder(file, lastProcessedFile); });
+
+        const std::vector<std::filesystem::path> expectedRemainingFiles{ files[3], files[4], files[5] };
+        EXPECT_EQ(remainingFiles, expectedRemainingFiles);
+    }
+
+    TEST(ProcessedFileTracker, reset)
+    {
+        ProcessedFileTracker tracker;
+
+        tracker.onFileExplored("/root/a.mp3", false);
+        tracker.onFileExplored("/root/b.mp3", true);
+        EXPECT_EQ(tracker.getLastProcessedFile(), "/root/a.mp3");
+
+        tracker.reset();
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+
+        // files scanned before the reset are ignored
+        tracker.onFileScanned("/root/b.mp3");
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+
+        tracker.onFileExplored("/root/c.mp3", true);
+        EXPECT_TRUE(tracker.getLastProcessedFile().empty());
+        tracker.onFileScanned("/root/c.mp3");
+        EXPECT_EQ(tracker.getLastProcessedFile(), "/root/c.mp3");
+    }
+} // namespace lms::scanner::tests
@@ -47,22 +47,22 @@ namespace lms::scrobbling
 
     void InternalBackend::addTimedListen(const TimedListen& listen)
     {
-        db::Session& session{ _db.getTLSSession() };
-        auto transaction{ session.createWriteTransaction() };
+        _db.getWriteQueue().submit([listen](db::Session& session)
+            {
+                if (db::Listen::find(session, listen.userId, listen.trackId, db::ScrobblingBackend::Internal, listen.listenedAt))
+                    return;
 
-        if (db::Listen::find(session, listen.userId, listen.trackId, db::ScrobblingBackend::Internal, listen.listenedAt))
-            return;
-
-        const db::User::pointer user{ db::User::find(session, listen.userId) };
-        if (!user)
-            return;
+                const db::User::pointer user{ db::User::find(session, listen.userId) };
+                if (!user)
+                    return;
 
-        const db::Track::pointer track{ db::Track::find(session, listen.trackId) };
-        if (!track)
-            return;
+                const db::Track::pointer track{ db::Track::find(session, listen.trackId) };
+                if (!track)
+                    return;
 
-        auto dbListen{ session.create<db::Listen>(user, track, db::ScrobblingBackend::Internal, listen.listenedAt) };
-        dbListen.modify()->setSyncState(db::SyncState::Synchronized);
+                auto dbListen{ session.create<db::Listen>(user, track, db::ScrobblingBackend::Internal, listen.listenedAt) };
+                dbListen.modify()->setSyncState(db::SyncState::Synchronized);
+            });
     }
 } // Scrobbling
 
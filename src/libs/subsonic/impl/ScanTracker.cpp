@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanTracker.hpp"
+
+#include "core/Random.hpp"
+#include "RequestContext.hpp"
+
+namespace lms::api::subsonic
+{
+    ScanTracker::ScanInfo ScanTracker::createScanInfo(const RequestContext& context, std::string_view request, db::MediaLibraryId library, std::size_t offset)
+    {
+        return ScanInfo{
+            .clientAddress = context.clientInfo.ipAddress,
+            .clientName = context.clientInfo.name,
+            .userName = context.clientInfo.user,
+            .request = std::string{ request },
+            .library = library,
+            .offset = offset,
+        };
+    }
+
+    std::optional<db::KeysetCursor> ScanTracker::extractCursor(const ScanInfo& scanInfo)
+    {
+        std::optional<db::KeysetCursor> res;
+
+        {
+            const std::scoped_lock lock{ _mutex };
+
+            auto it{ _ongoingScans.find(scanInfo) };
+            if (it != _ongoingScans.end())
+            {
+                res = std::move(it->second.cursor);
+                _ongoingScans.erase(it);
+            }
+        }
+
+        return res;
+    }
+
+    void ScanTracker::setCursor(const ScanInfo& scanInfo, const db::KeysetCursor& cursor)
+    {
+        const ClockType::time_point now{ ClockType::now() };
+
+        const std::scoped_lock lock{ _mutex };
+
+        // clean outdated scan entries; we do this to not have to flush everything each time we add/remove entries in the database
+        std::erase_if(_ongoingScans, [&](const auto& entry) { return now > entry.second.timePoint + maxEntryDuration; });
+        // prevent the cache size from going out of control
+        if (_ongoingScans.size() == maxScanCount)
+            _ongoingScans.erase(core::random::pickRandom(_ongoingScans));
+
+        _ongoingScans[scanInfo] = { now, cursor };
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "database/MediaLibraryId.hpp"
+#include "database/Types.hpp"
+
+namespace lms::api::subsonic
+{
+    struct RequestContext;
+
+    // Some endpoints are used by clients to scan/sync the database, using increasing offsets
+    // This class is used to keep track of the current scans, in order to retrieve the position of the
+    // last returned entry and to speed up the query of the following range (avoid the 'offset' cost)
+    class ScanTracker
+    {
+    public:
+        struct ScanInfo
+        {
+            std::string clientAddress;
+            std::string clientName;
+            std::string userName;
+            std::string request; // what is being scanned (search query, list type, etc.)
+            db::MediaLibraryId library;
+            std::size_t offset{};
+            auto operator<=>(const ScanInfo&) const = default;
+        };
+
+        static ScanInfo createScanInfo(const RequestContext& context, std::string_view request, db::MediaLibraryId library, std::size_t offset);
+
+        std::optional<db::KeysetCursor> extractCursor(const ScanInfo& scanInfo);
+        void setCursor(const ScanInfo& scanInfo, const db::KeysetCursor& cursor);
+
+    private:
+        using ClockType = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            ClockType::time_point timePoint;
+            db::KeysetCursor cursor;
+        };
+
+        static constexpr std::size_t maxScanCount{ 50 };
+        static constexpr ClockType::duration maxEntryDuration{ std::chrono::seconds{ 30 } };
+
+        std::mutex _mutex;
+        std::map<ScanInfo, Entry> _ongoingScans;
+    };
+}
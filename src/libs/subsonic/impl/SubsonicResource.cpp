@@ -20,12 +20,14 @@
 #include "SubsonicResource.hpp"
 
 #include <atomic>
+#include <sstream>
 #include <unordered_map>
 
 #include "services/auth/IPasswordService.hpp"
 #include "services/auth/IEnvService.hpp"
 #include "database/Db.hpp"
 #include "database/Session.hpp"
+#include "database/StarredArtist.hpp"
 #include "database/User.hpp"
 #include "core/EnumSet.hpp"
 #include "core/LiteralString.hpp"
@@ -35,6 +37,7 @@
 #include "core/Service.hpp"
 #include "core/String.hpp"
 #include "core/Utils.hpp"
+#include "core/http/ConditionalRequest.hpp"
 
 #include "entrypoints/AlbumSongLists.hpp"
 #include "entrypoints/Browsing.hpp"
@@ -144,6 +147,44 @@ namespace lms::api::subsonic
             throw NotImplementedGenericError{};
         }
 
+        // Entry points whose responses only depend on the library contents and on some user settings
+        // Value: true if the response also depends on the user's starred artists
+        const std::unordered_map<core::LiteralString, bool, core::LiteralStringHash, core::LiteralStringEqual> conditionalEntryPoints
+        {
+            {"/getIndexes",     true},
+            {"/getArtists",     true},
+            {"/getGenres",      false},
+        };
+
+        std::string computeEntryPointEntityTag(RequestContext& context, std::string_view requestPath, bool dependsOnStarredArtists)
+        {
+            std::ostringstream validatorData;
+            validatorData << requestPath << "/" << context.serverProtocolVersion.major << "." << context.serverProtocolVersion.minor << "." << context.serverProtocolVersion.patch
+                << "/" << context.enableOpenSubsonic
+                << "/" << utils::getLibraryGeneration(context.dbSession);
+
+            {
+                auto transaction{ context.dbSession.createReadTransaction() };
+
+                validatorData << "/" << context.user->getId().getValue() << "/" << static_cast<int>(context.user->getSubsonicArtistListMode());
+                if (dependsOnStarredArtists)
+                    validatorData << "/" << db::StarredArtist::getUserStamp(context.dbSession, context.user->getId());
+            }
+
+            // parameter map is ordered: skip the authentication parameters as they may change for each request
+            for (const auto& [name, values] : context.parameters)
+            {
+                if (name == "p" || name == "t" || name == "s")
+                    continue;
+
+                validatorData << "/" << name;
+                for (const std::string& value : values)
+                    validatorData << "=" << value;
+            }
+
+            return core::http::computeEntityTag(validatorData.str());
+        }
+
         using RequestHandlerFunc = std::function<Response(RequestContext& context)>;
         using CheckImplementedFunc = std::function<void()>;
         struct RequestEntryPointInfo
@@ -324,6 +365,16 @@ namespace lms::api::subsonic
 
                 checkUserTypeIsAllowed(requestContext, itEntryPoint->second.allowedUserTypes);
 
+                if (auto itConditional{ conditionalEntryPoints.find(requestPath) }; itConditional != std::cend(conditionalEntryPoints))
+                {
+                    const core::http::CacheValidators validators{ computeEntryPointEntityTag(requestContext, requestPath, itConditional->second), {} };
+                    if (core::http::processConditionalRequest(request, response, validators))
+                    {
+                        LMS_LOG(API_SUBSONIC, DEBUG, "Request " << requestId << " '" << requestPath << "' not modified");
+                        return;
+                    }
+                }
+
                 const Response resp{ [&] {
                     LMS_SCOPED_TRACE_DETAILED("Subsonic", "HandleRequest");
                     return itEntryPoint->second.func(requestContext);
@@ -21,6 +21,8 @@
 
 #include "core/Service.hpp"
 #include "core/String.hpp"
+#include "database/ReferenceData.hpp"
+#include "database/Session.hpp"
 #include "services/auth/IPasswordService.hpp"
 #include "SubsonicResponse.hpp"
 
@@ -38,4 +40,9 @@ namespace lms::api::subsonic::utils
         return core::stringUtils::replaceInString(name, "/", "_");
     }
 
+    std::size_t getLibraryGeneration(db::Session& session)
+    {
+        return session.getReferenceData()->libraryGeneration;
+    }
+
 }
\ No newline at end of file
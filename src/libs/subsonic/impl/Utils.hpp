@@ -22,8 +22,14 @@
 #include <string>
 #include <string_view>
 
+namespace lms::db
+{
+    class Session;
+}
+
 namespace lms::api::subsonic::utils
 {
     void checkSetPasswordImplemented();
     std::string makeNameFilesystemCompatible(std::string_view name);
+    std::size_t getLibraryGeneration(db::Session& session);
 }
\ No newline at end of file
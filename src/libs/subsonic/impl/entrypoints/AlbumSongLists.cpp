@@ -21,9 +21,11 @@
 
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/Release.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "services/feedback/IFeedbackService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
@@ -32,6 +34,7 @@
 #include "responses/Song.hpp"
 #include "core/Service.hpp"
 #include "ParameterParsing.hpp"
+#include "ScanTracker.hpp"
 #include "SubsonicId.hpp"
 
 namespace lms::api::subsonic
@@ -40,6 +43,26 @@ namespace lms::api::subsonic
 
     namespace
     {
+        // Clients iterate over the whole lists using increasing offsets: keep track of the position
+        // of the last returned release so that the following range can be fetched without any offset
+        RangeResults<ReleaseId> findReleaseIds(RequestContext& context, ScanTracker& scanTracker, std::string_view request, Release::FindParameters& params)
+        {
+            assert(params.range);
+
+            ScanTracker::ScanInfo scanInfo{ ScanTracker::createScanInfo(context, request, params.mediaLibrary, params.range->offset) };
+            if (params.range->offset > 0)
+                params.setCursor(scanTracker.extractCursor(scanInfo));
+
+            RangeResults<ReleaseId> releases{ Release::findIds(context.dbSession, params) };
+            if (releases.nextCursor)
+            {
+                scanInfo.offset = params.range->offset + params.range->size;
+                scanTracker.setCursor(scanInfo, *releases.nextCursor);
+            }
+
+            return releases;
+        }
+
         Response handleGetAlbumListRequestCommon(RequestContext& context, bool id3)
         {
             // Mandatory params
@@ -62,12 +85,14 @@ namespace lms::api::subsonic
 
             if (type == "alphabeticalByName")
             {
+                static ScanTracker currentScansInProgress;
+
                 Release::FindParameters params;
                 params.setSortMethod(ReleaseSortMethod::Name);
                 params.setRange(range);
                 params.setMediaLibrary(mediaLibraryId);
 
-                releases = Release::findIds(context.dbSession, params);
+                releases = findReleaseIds(context, currentScansInProgress, type, params);
             }
             else if (type == "alphabeticalByArtist")
             {
@@ -83,17 +108,20 @@ namespace lms::api::subsonic
                 // Mandatory param
                 const std::string genre{ getMandatoryParameterAs<std::string>(context.parameters, "genre") };
 
-                if (const ClusterType::pointer clusterType{ ClusterType::find(context.dbSession, "GENRE") })
+                const std::shared_ptr<const ReferenceData> referenceData{ context.dbSession.getReferenceData() };
+                if (const ReferenceData::ClusterTypeInfo* clusterType{ referenceData->findClusterType("GENRE") })
                 {
-                    if (const Cluster::pointer cluster{ clusterType->getCluster(genre) })
+                    if (const Cluster::pointer cluster{ Cluster::find(context.dbSession, clusterType->id, genre) })
                     {
+                        static ScanTracker currentScansInProgress;
+
                         Release::FindParameters params;
                         params.setClusters(std::initializer_list<ClusterId>{ cluster->getId() });
                         params.setSortMethod(ReleaseSortMethod::Name);
                         params.setRange(range);
                         params.setMediaLibrary(mediaLibraryId);
 
-                        releases = Release::findIds(context.dbSession, params);
+                        releases = findReleaseIds(context, currentScansInProgress, type + genre, params);
                     }
                 }
             }
@@ -207,11 +235,9 @@ namespace lms::api::subsonic
                     starredNode.addArrayChild("album", createAlbumNode(context, release, context.user, id3));
             }
 
-            for (const TrackId trackId : feedbackService.findStarredTracks(findParameters).results)
-            {
-                if (auto track{ Track::find(context.dbSession, trackId) })
-                    starredNode.addArrayChild("song", createSongNode(context, track, context.user));
-            }
+            const auto starredTrackIds{ feedbackService.findStarredTracks(findParameters) };
+            for (const TrackSummary& track : TrackSummary::find(context.dbSession, starredTrackIds.results))
+                starredNode.addArrayChild("song", createSongNode(context, track, context.user));
 
             return response;
         }
@@ -245,10 +271,9 @@ namespace lms::api::subsonic
         params.setRange(Range{ 0, size });
         params.setMediaLibrary(mediaLibraryId);
 
-        Track::find(context.dbSession, params, [&](const Track::pointer& track)
-            {
-                randomSongsNode.addArrayChild("song", createSongNode(context, track, context.user));
-            });
+        const auto trackIds{ Track::findIds(context.dbSession, params) };
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
+            randomSongsNode.addArrayChild("song", createSongNode(context, track, context.user));
 
         return response;
     }
@@ -268,11 +293,12 @@ namespace lms::api::subsonic
 
         auto transaction{ context.dbSession.createReadTransaction() };
 
-        auto clusterType{ ClusterType::find(context.dbSession, "GENRE") };
+        const std::shared_ptr<const ReferenceData> referenceData{ context.dbSession.getReferenceData() };
+        const ReferenceData::ClusterTypeInfo* clusterType{ referenceData->findClusterType("GENRE") };
         if (!clusterType)
             throw RequestedDataNotFoundError{};
 
-        auto cluster{ clusterType->getCluster(genre) };
+        auto cluster{ Cluster::find(context.dbSession, clusterType->id, genre) };
         if (!cluster)
             throw RequestedDataNotFoundError{};
 
@@ -284,10 +310,9 @@ namespace lms::api::subsonic
         params.setRange(Range{ offset, count });
         params.setMediaLibrary(mediaLibrary);
 
-        Track::find(context.dbSession, params, [&](const Track::pointer& track)
-            {
-                songsByGenreNode.addArrayChild("song", createSongNode(context, track, context.user));
-            });
+        const auto trackIds{ Track::findIds(context.dbSession, params) };
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
+            songsByGenreNode.addArrayChild("song", createSongNode(context, track, context.user));
 
         return response;
     }
@@ -23,6 +23,7 @@
 #include "database/User.hpp"
 #include "database/Track.hpp"
 #include "database/TrackBookmark.hpp"
+#include "database/TrackSummary.hpp"
 #include "responses/Bookmark.hpp"
 #include "responses/Song.hpp"
 #include "ParameterParsing.hpp"
@@ -41,11 +42,27 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.serverProtocolVersion) };
         Response::Node& bookmarksNode{ response.createNode("bookmarks") };
 
+        std::vector<TrackBookmark::pointer> bookmarks;
+        std::vector<TrackId> trackIds;
         for (const TrackBookmarkId bookmarkId : bookmarkIds.results)
         {
-            const TrackBookmark::pointer bookmark{ TrackBookmark::find(context.dbSession, bookmarkId) };
-            Response::Node bookmarkNode{ createBookmarkNode(bookmark) };
-            bookmarkNode.addChild("entry", createSongNode(context, bookmark->getTrack(), context.user));
+            if (TrackBookmark::pointer bookmark{ TrackBookmark::find(context.dbSession, bookmarkId) })
+            {
+                trackIds.push_back(bookmark->getTrackId());
+                bookmarks.push_back(std::move(bookmark));
+            }
+        }
+
+        // summaries are returned in the requested order, missing tracks are skipped
+        const std::vector<TrackSummary> tracks{ TrackSummary::find(context.dbSession, trackIds) };
+        auto itTrack{ std::cbegin(tracks) };
+        for (std::size_t i{}; i < bookmarks.size() && itTrack != std::cend(tracks); ++i)
+        {
+            if (itTrack->id != trackIds[i])
+                continue;
+
+            Response::Node bookmarkNode{ createBookmarkNode(bookmarks[i]) };
+            bookmarkNode.addChild("entry", createSongNode(context, *itTrack++, context.user));
             bookmarksNode.addArrayChild("bookmark", std::move(bookmarkNode));
         }
 
@@ -22,9 +22,11 @@
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
 #include "database/MediaLibrary.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/Session.hpp"
 #include "database/Release.hpp"
 #include "database/Track.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
@@ -256,11 +258,8 @@ namespace lms::api::subsonic
 
             Response response{ Response::createOkResponse(context.serverProtocolVersion) };
             Response::Node& similarSongsNode{ response.createNode(id3 ? Response::Node::Key{ "similarSongs2" } : Response::Node::Key{ "similarSongs" }) };
-            for (const TrackId trackId : tracks)
-            {
-                const Track::pointer track{ Track::find(context.dbSession, trackId) };
+            for (const TrackSummary& track : TrackSummary::find(context.dbSession, tracks))
                 similarSongsNode.addArrayChild("song", createSongNode(context, track, context.user));
-            }
 
             return response;
         }
@@ -273,13 +272,15 @@ namespace lms::api::subsonic
         Response::Node& musicFoldersNode{ response.createNode("musicFolders") };
 
         auto transaction{ context.dbSession.createReadTransaction() };
-        MediaLibrary::find(context.dbSession, [&](const MediaLibrary::pointer& library)
-            {
-                Response::Node& musicFolderNode{ musicFoldersNode.createArrayChild("musicFolder") };
 
-                musicFolderNode.setAttribute("id", idToString(library->getId()));
-                musicFolderNode.setAttribute("name", library->getName());
-            });
+        const std::shared_ptr<const ReferenceData> referenceData{ context.dbSession.getReferenceData() };
+        for (const ReferenceData::MediaLibraryInfo& library : referenceData->mediaLibraries)
+        {
+            Response::Node& musicFolderNode{ musicFoldersNode.createArrayChild("musicFolder") };
+
+            musicFolderNode.setAttribute("id", idToString(library.id));
+            musicFolderNode.setAttribute("name", library.name);
+        }
 
         return response;
     }
@@ -340,10 +341,9 @@ namespace lms::api::subsonic
 
             directoryNode.setAttribute("name", utils::makeNameFilesystemCompatible(release->getName()));
 
-            Track::find(context.dbSession, Track::FindParameters{}.setRelease(*releaseId).setSortMethod(TrackSortMethod::Release), [&](const Track::pointer& track)
-                {
-                    directoryNode.addArrayChild("child", createSongNode(context, track, context.user));
-                });
+            const auto trackIds{ Track::findIds(context.dbSession, Track::FindParameters{}.setRelease(*releaseId).setSortMethod(TrackSortMethod::Release)) };
+            for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
+                directoryNode.addArrayChild("child", createSongNode(context, track, context.user));
         }
         else
             throw BadParameterGenericError{ "id" };
@@ -359,13 +359,17 @@ namespace lms::api::subsonic
 
         auto transaction{ context.dbSession.createReadTransaction() };
 
-        const ClusterType::pointer clusterType{ ClusterType::find(context.dbSession, "GENRE") };
-        if (clusterType)
+        const std::shared_ptr<const ReferenceData> referenceData{ context.dbSession.getReferenceData() };
+        if (const ReferenceData::ClusterTypeInfo* clusterType{ referenceData->findClusterType("GENRE") })
         {
-            const auto clusters{ clusterType->getClusters() };
+            Cluster::FindParameters params;
+            params.setClusterType(clusterType->id);
+            params.setSortMethod(ClusterSortMethod::Name);
 
-            for (const Cluster::pointer& cluster : clusters)
-                genresNode.addArrayChild("genre", createGenreNode(cluster));
+            Cluster::find(context.dbSession, params, [&](const Cluster::pointer& cluster)
+                {
+                    genresNode.addArrayChild("genre", createGenreNode(cluster));
+                });
         }
 
         return response;
@@ -413,8 +417,8 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.serverProtocolVersion) };
         Response::Node albumNode{ createAlbumNode(context, release, context.user, true /* id3 */) };
 
-        const auto tracks{ Track::find(context.dbSession, Track::FindParameters{}.setRelease(id).setSortMethod(TrackSortMethod::Release)) };
-        for (const Track::pointer& track : tracks.results)
+        const auto trackIds{ Track::findIds(context.dbSession, Track::FindParameters{}.setRelease(id).setSortMethod(TrackSortMethod::Release)) };
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
             albumNode.addArrayChild("song", createSongNode(context, track, context.user));
 
         response.addNode("album", std::move(albumNode));
@@ -429,12 +433,12 @@ namespace lms::api::subsonic
 
         auto transaction{ context.dbSession.createReadTransaction() };
 
-        const Track::pointer track{ Track::find(context.dbSession, id) };
-        if (!track)
+        const std::vector<TrackSummary> tracks{ TrackSummary::find(context.dbSession, std::span<const TrackId>{ &id, 1 }) };
+        if (tracks.empty())
             throw RequestedDataNotFoundError{};
 
         Response response{ Response::createOkResponse(context.serverProtocolVersion) };
-        response.addNode("song", createSongNode(context, track, context.user));
+        response.addNode("song", createSongNode(context, tracks.front(), context.user));
 
         return response;
     }
@@ -482,11 +486,8 @@ namespace lms::api::subsonic
         params.setArtist(artists.front()->getId());
 
         const auto trackIds{ core::Service<scrobbling::IScrobblingService>::get()->getTopTracks(params) };
-        for (const TrackId trackId : trackIds.results)
-        {
-            if (Track::pointer track{ Track::find(context.dbSession, trackId) })
-                topSongs.addArrayChild("song", createSongNode(context, track, context.user));
-        }
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
+            topSongs.addArrayChild("song", createSongNode(context, track, context.user));
 
         return response;
     }
@@ -39,8 +39,11 @@ namespace lms::api::subsonic::Scan
             {
                 std::size_t count{};
 
-                if (scanStatus.currentScanStepStats && scanStatus.currentScanStepStats->currentStep == ScanStep::ScanFiles)
-                    count = scanStatus.currentScanStepStats->processedElems;
+                for (const ScanStepStats& stepStats : scanStatus.currentScanStepStats)
+                {
+                    if (stepStats.currentStep == ScanStep::ScanFiles && stepStats.stopTime.isNull())
+                        count = stepStats.processedElems;
+                }
 
                 statusResponse.setAttribute("count", count);
             }
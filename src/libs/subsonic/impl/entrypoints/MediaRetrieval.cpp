@@ -19,6 +19,8 @@
 
 #include "MediaRetrieval.hpp"
 
+#include <sstream>
+
 #include "av/IAudioFile.hpp"
 #include "av/RawResourceHandlerCreator.hpp"
 #include "av/TranscodingParameters.hpp"
@@ -33,8 +35,10 @@
 #include "core/FileResourceHandlerCreator.hpp"
 #include "core/Utils.hpp"
 #include "core/String.hpp"
+#include "core/http/ConditionalRequest.hpp"
 #include "ParameterParsing.hpp"
 #include "SubsonicId.hpp"
+#include "Utils.hpp"
 
 namespace lms::api::subsonic
 {
@@ -246,7 +250,7 @@ namespace lms::api::subsonic
         }
     }
 
-    void handleGetCoverArt(RequestContext& context, const Wt::Http::Request& /*request*/, Wt::Http::Response& response)
+    void handleGetCoverArt(RequestContext& context, const Wt::Http::Request& request, Wt::Http::Response& response)
     {
         // Mandatory params
         const auto trackId{ getParameterAs<TrackId>(context.parameters, "id") };
@@ -259,6 +263,15 @@ namespace lms::api::subsonic
         std::size_t size{ getParameterAs<std::size_t>(context.parameters, "size").value_or(1024) };
         size = core::utils::clamp(size, std::size_t{ 32 }, std::size_t{ 2048 });
 
+        // Covers only change with the library: let the client revalidate its copy before doing any image work
+        {
+            std::ostringstream validatorData;
+            validatorData << "cover/" << getMandatoryParameterAs<std::string>(context.parameters, "id") << "/" << size << "/" << context.enableDefaultCover << "/" << utils::getLibraryGeneration(context.dbSession);
+
+            if (core::http::processConditionalRequest(request, response, core::http::CacheValidators{ core::http::computeEntityTag(validatorData.str()), {} }))
+                return;
+        }
+
         std::shared_ptr<image::IEncodedImage> cover;
         if (trackId)
             cover = core::Service<cover::ICoverService>::get()->getFromTrack(*trackId, size);
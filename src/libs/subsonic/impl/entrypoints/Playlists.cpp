@@ -22,6 +22,7 @@
 #include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "database/TrackList.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "responses/Playlist.hpp"
 #include "responses/Song.hpp"
@@ -32,6 +33,21 @@ namespace lms::api::subsonic
 {
     using namespace db;
 
+    namespace
+    {
+        std::vector<TrackId> getEntryTrackIds(const TrackList::pointer& tracklist)
+        {
+            std::vector<TrackId> trackIds;
+
+            const auto entries{ tracklist->getEntries() };
+            trackIds.reserve(entries.results.size());
+            for (const TrackListEntry::pointer& entry : entries.results)
+                trackIds.push_back(entry->getTrackId());
+
+            return trackIds;
+        }
+    } // namespace
+
     Response handleGetPlaylistsRequest(RequestContext& context)
     {
         auto transaction{ context.dbSession.createReadTransaction() };
@@ -67,9 +83,8 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.serverProtocolVersion) };
         Response::Node playlistNode{ createPlaylistNode(tracklist, context.dbSession) };
 
-        auto entries{ tracklist->getEntries() };
-        for (const TrackListEntry::pointer& entry : entries.results)
-            playlistNode.addArrayChild("entry", createSongNode(context, entry->getTrack(), context.user));
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, getEntryTrackIds(tracklist)))
+            playlistNode.addArrayChild("entry", createSongNode(context, track, context.user));
 
         response.addNode("playlist", std::move(playlistNode));
 
@@ -120,9 +135,8 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.serverProtocolVersion) };
         Response::Node playlistNode{ createPlaylistNode(tracklist, context.dbSession) };
 
-        auto entries{ tracklist->getEntries() };
-        for (const TrackListEntry::pointer& entry : entries.results)
-            playlistNode.addArrayChild("entry", createSongNode(context, entry->getTrack(), context.user));
+        for (const TrackSummary& track : TrackSummary::find(context.dbSession, getEntryTrackIds(tracklist)))
+            playlistNode.addArrayChild("entry", createSongNode(context, track, context.user));
 
         response.addNode("playlist", std::move(playlistNode));
 
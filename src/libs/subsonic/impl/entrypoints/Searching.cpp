@@ -19,20 +19,17 @@
 
 #include "Searching.hpp"
 
-#include <chrono>
-#include <mutex>
-#include <map>
-
-#include "core/Random.hpp"
 #include "database/Artist.hpp"
 #include "database/Release.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "responses/Album.hpp"
 #include "responses/Artist.hpp"
 #include "responses/Song.hpp"
 #include "ParameterParsing.hpp"
+#include "ScanTracker.hpp"
 #include "SubsonicId.hpp"
 
 namespace lms::api::subsonic
@@ -41,80 +38,11 @@ namespace lms::api::subsonic
 
     namespace
     {
-        // Search endpoints can be used to scan/sync the database
-        // This class is used to keep track of the current scans, in order to retrieve the last objectId
-        // to speed up the query of the following range (avoid the 'offset' cost)
-        template <typename ObjectId>
-        class ScanTracker
-        {
-        public:
-            struct ScanInfo
-            {
-                std::string clientAddress;
-                std::string clientName;
-                std::string userName;
-                MediaLibraryId library;
-                std::size_t offset{};
-                auto operator<=>(const ScanInfo&) const = default;
-            };
-
-            ObjectId extractLastRetrievedObjectId(const ScanInfo& info);
-            void setObjectId(const ScanInfo& info, ObjectId lastRetrievedId);
-
-        private:
-            using ClockType = std::chrono::steady_clock;
-
-            struct Entry
-            {
-                ClockType::time_point timePoint;
-                ObjectId objectId;
-            };
-
-            static constexpr std::size_t maxScanCount{ 50 };
-            static constexpr ClockType::duration maxEntryDuration{ std::chrono::seconds{30} };
-
-            std::mutex _mutex;
-            std::map<ScanInfo, Entry> _ongoingScans;
-        };
-
-        template<typename ObjectId>
-        ObjectId ScanTracker<ObjectId>::extractLastRetrievedObjectId(const ScanInfo& scanInfo)
+        // Search endpoints can be used to scan/sync the database: the position of the last returned
+        // entries is tracked so that the following range can be fetched without any offset
+        void findRequestedArtists(RequestContext& context, bool id3, std::string_view query, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
         {
-            ObjectId res;
-
-            {
-                const std::scoped_lock lock{ _mutex };
-
-                auto it{ _ongoingScans.find(scanInfo) };
-                if (it != _ongoingScans.end())
-                {
-                    res = it->second.objectId;
-                    _ongoingScans.erase(it);
-                }
-            }
-
-            return res;
-        }
-
-        template<typename ObjectId>
-        void ScanTracker<ObjectId>::setObjectId(const ScanInfo& scanInfo, ObjectId lastRetrievedId)
-        {
-            const ClockType::time_point now{ ClockType::now() };
-
-            const std::scoped_lock lock{ _mutex };
-
-            // clean outdated scan entries; we do this to not have to flush everything each time we add/remove entries in the database
-            std::erase_if(_ongoingScans, [&](const auto& entry) { return now > entry.second.timePoint + maxEntryDuration; });
-            // prevent the cache size from going out of control
-            if (_ongoingScans.size() == maxScanCount)
-                _ongoingScans.erase(core::random::pickRandom(_ongoingScans));
-
-            _ongoingScans[scanInfo] = { now, lastRetrievedId };
-        }
-
-        void findRequestedArtists(RequestContext& context, bool id3, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
-        {
-            static ScanTracker<ArtistId> currentScansInProgress;
+            static ScanTracker currentScansInProgress;
 
             const std::size_t artistCount{ getParameterAs<std::size_t>(context.parameters, "artistCount").value_or(20) };
             if (artistCount == 0)
@@ -125,61 +53,33 @@ namespace lms::api::subsonic
 
             const std::size_t artistOffset{ getParameterAs<std::size_t>(context.parameters, "artistOffset").value_or(0) };
 
-            ArtistId lastRetrievedId;
-            auto findArtists{ [&]
-            {
-                    Artist::FindParameters params;
-                    params.setKeywords(keywords);
-                    params.setRange(Range{ artistOffset, artistCount });
-                    params.setMediaLibrary(mediaLibrary);
-                    params.setSortMethod(ArtistSortMethod::Id); // must be consistent with both methods
-
-                    Artist::find(context.dbSession, params, [&](const Artist::pointer& artist)
-                        {
-                            searchResultNode.addArrayChild("artist", createArtistNode(context, artist, user, id3));
-                            lastRetrievedId = artist->getId();
-                        });
-                } };
-
-            if (!keywords.empty())
-            {
-                findArtists();
-            }
-            else
-            {
-                ScanTracker<ArtistId>::ScanInfo scanInfo
-                {
-                    .clientAddress = context.clientInfo.ipAddress,
-                    .clientName = context.clientInfo.name,
-                    .userName = context.clientInfo.user,
-                    .library = mediaLibrary,
-                    .offset = artistOffset
-                };
-
-                if (ArtistId cachedLastRetrievedId{ currentScansInProgress.extractLastRetrievedObjectId(scanInfo) }; cachedLastRetrievedId.isValid())
-                {
-                    Artist::find(context.dbSession, cachedLastRetrievedId, artistCount, [&](const Artist::pointer& artist)
-                        {
-                            searchResultNode.addArrayChild("artist", createArtistNode(context, artist, user, id3));
-                        }, mediaLibrary);
-                    lastRetrievedId = cachedLastRetrievedId;
-                }
-                else
-                {
-                    findArtists();
-                }
+            ScanTracker::ScanInfo scanInfo{ ScanTracker::createScanInfo(context, query, mediaLibrary, artistOffset) };
+
+            Artist::FindParameters params;
+            params.setKeywords(keywords);
+            params.setRange(Range{ artistOffset, artistCount });
+            params.setMediaLibrary(mediaLibrary);
+            params.setSortMethod(ArtistSortMethod::Id); // must be consistent with the cursors
+            if (artistOffset > 0)
+                params.setCursor(currentScansInProgress.extractCursor(scanInfo));
 
-                if (lastRetrievedId.isValid())
+            Artist::pointer lastRetrievedArtist;
+            Artist::find(context.dbSession, params, [&](const Artist::pointer& artist)
                 {
-                    scanInfo.offset = artistOffset + artistCount;
-                    currentScansInProgress.setObjectId(scanInfo, lastRetrievedId);
-                }
+                    searchResultNode.addArrayChild("artist", createArtistNode(context, artist, user, id3));
+                    lastRetrievedArtist = artist;
+                });
+
+            if (lastRetrievedArtist)
+            {
+                scanInfo.offset = artistOffset + artistCount;
+                currentScansInProgress.setCursor(scanInfo, *lastRetrievedArtist->getKeysetCursor(ArtistSortMethod::Id));
             }
         }
 
-        void findRequestedAlbums(RequestContext& context, bool id3, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
+        void findRequestedAlbums(RequestContext& context, bool id3, std::string_view query, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
         {
-            static ScanTracker<ReleaseId> currentScansInProgress;
+            static ScanTracker currentScansInProgress;
 
             const std::size_t albumCount{ getParameterAs<std::size_t>(context.parameters, "albumCount").value_or(20) };
             if (albumCount == 0)
@@ -190,62 +90,33 @@ namespace lms::api::subsonic
 
             const std::size_t albumOffset{ getParameterAs<std::size_t>(context.parameters, "albumOffset").value_or(0) };
 
-            ReleaseId lastRetrievedId;
+            ScanTracker::ScanInfo scanInfo{ ScanTracker::createScanInfo(context, query, mediaLibrary, albumOffset) };
 
-            auto findReleases{ [&]
-            {
-                Release::FindParameters params;
-                params.setKeywords(keywords);
-                params.setRange(Range{ albumOffset, albumCount });
-                params.setMediaLibrary(mediaLibrary);
-                params.setSortMethod(ReleaseSortMethod::Id); // must be consistent with both methods
-
-                Release::find(context.dbSession, params, [&](const Release::pointer& release)
-                    {
-                        searchResultNode.addArrayChild("album", createAlbumNode(context, release, user, id3));
-                        lastRetrievedId = release->getId();
-                    });
-            } };
-
-            if (!keywords.empty())
-            {
-                findReleases();
-            }
-            else
-            {
-                ScanTracker<ReleaseId>::ScanInfo scanInfo
-                {
-                    .clientAddress = context.clientInfo.ipAddress,
-                    .clientName = context.clientInfo.name,
-                    .userName = context.clientInfo.user,
-                    .library = mediaLibrary,
-                    .offset = albumOffset
-                };
-
-                if (ReleaseId cachedLastRetrievedId{ currentScansInProgress.extractLastRetrievedObjectId(scanInfo) }; cachedLastRetrievedId.isValid())
-                {
-                    Release::find(context.dbSession, cachedLastRetrievedId, albumCount, [&](const Release::pointer& release)
-                        {
-                            searchResultNode.addArrayChild("album", createAlbumNode(context, release, user, id3));
-                        }, mediaLibrary);
-                    lastRetrievedId = cachedLastRetrievedId;
-                }
-                else
-                {
-                    findReleases();
-                }
+            Release::FindParameters params;
+            params.setKeywords(keywords);
+            params.setRange(Range{ albumOffset, albumCount });
+            params.setMediaLibrary(mediaLibrary);
+            params.setSortMethod(ReleaseSortMethod::Id); // must be consistent with the cursors
+            if (albumOffset > 0)
+                params.setCursor(currentScansInProgress.extractCursor(scanInfo));
 
-                if (lastRetrievedId.isValid())
+            Release::pointer lastRetrievedRelease;
+            Release::find(context.dbSession, params, [&](const Release::pointer& release)
                 {
-                    scanInfo.offset = albumOffset + albumCount;
-                    currentScansInProgress.setObjectId(scanInfo, lastRetrievedId);
-                }
+                    searchResultNode.addArrayChild("album", createAlbumNode(context, release, user, id3));
+                    lastRetrievedRelease = release;
+                });
+
+            if (lastRetrievedRelease)
+            {
+                scanInfo.offset = albumOffset + albumCount;
+                currentScansInProgress.setCursor(scanInfo, *lastRetrievedRelease->getKeysetCursor(ReleaseSortMethod::Id));
             }
         }
 
-        void findRequestedTracks(RequestContext& context, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
+        void findRequestedTracks(RequestContext& context, std::string_view query, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, const User::pointer& user, Response::Node& searchResultNode)
         {
-            static ScanTracker<TrackId> currentScansInProgress;
+            static ScanTracker currentScansInProgress;
 
             const std::size_t songCount{ getParameterAs<std::size_t>(context.parameters, "songCount").value_or(20) };
             if (songCount == 0)
@@ -256,56 +127,24 @@ namespace lms::api::subsonic
 
             const std::size_t songOffset{ getParameterAs<std::size_t>(context.parameters, "songOffset").value_or(0) };
 
-            TrackId lastRetrievedId;
+            ScanTracker::ScanInfo scanInfo{ ScanTracker::createScanInfo(context, query, mediaLibrary, songOffset) };
 
-            auto findTracks{ [&]
-            {
-                Track::FindParameters params;
-                params.setKeywords(keywords);
-                params.setRange(Range{ songOffset, songCount });
-                params.setMediaLibrary(mediaLibrary);
-                params.setSortMethod(TrackSortMethod::Id); // must be consistent with both methods
-
-                Track::find(context.dbSession, params, [&](const Track::pointer& track)
-                    {
-                        searchResultNode.addArrayChild("song", createSongNode(context, track, user));
-                        lastRetrievedId = track->getId();
-                    });
-            } };
-
-            if (!keywords.empty())
-            {
-                findTracks();
-            }
-            else
-            {
-                ScanTracker<TrackId>::ScanInfo scanInfo
-                {
-                    .clientAddress = context.clientInfo.ipAddress,
-                    .clientName = context.clientInfo.name,
-                    .userName = context.clientInfo.user,
-                    .library = mediaLibrary,
-                    .offset = songOffset
-                };
-
-                if (TrackId cachedLastRetrievedId{ currentScansInProgress.extractLastRetrievedObjectId(scanInfo) }; cachedLastRetrievedId.isValid())
-                {
-                    Track::find(context.dbSession, cachedLastRetrievedId, songCount, [&](const Track::pointer& track)
-                        {
-                            searchResultNode.addArrayChild("song", createSongNode(context, track, user));
-                        }, mediaLibrary);
-                    lastRetrievedId = cachedLastRetrievedId;
-                }
-                else
-                {
-                    findTracks();
-                }
+            Track::FindParameters params;
+            params.setKeywords(keywords);
+            params.setRange(Range{ songOffset, songCount });
+            params.setMediaLibrary(mediaLibrary);
+            params.setSortMethod(TrackSortMethod::Id); // must be consistent with the cursors
+            if (songOffset > 0)
+                params.setCursor(currentScansInProgress.extractCursor(scanInfo));
 
-                if (lastRetrievedId.isValid())
-                {
-                    scanInfo.offset = songOffset + songCount;
-                    currentScansInProgress.setObjectId(scanInfo, lastRetrievedId);
-                }
+            const RangeResults<TrackId> trackIds{ Track::findIds(context.dbSession, params) };
+            for (const TrackSummary& track : TrackSummary::find(context.dbSession, trackIds.results))
+                searchResultNode.addArrayChild("song", createSongNode(context, track, user));
+
+            if (trackIds.nextCursor)
+            {
+                scanInfo.offset = songOffset + songCount;
+                currentScansInProgress.setCursor(scanInfo, *trackIds.nextCursor);
             }
         }
     }
@@ -334,9 +173,9 @@ namespace lms::api::subsonic
 
             auto transaction{ context.dbSession.createReadTransaction() };
 
-            findRequestedArtists(context, id3, keywords, mediaLibrary, context.user, searchResultNode);
-            findRequestedAlbums(context, id3, keywords, mediaLibrary, context.user, searchResultNode);
-            findRequestedTracks(context, keywords, mediaLibrary, context.user, searchResultNode);
+            findRequestedArtists(context, id3, query, keywords, mediaLibrary, context.user, searchResultNode);
+            findRequestedAlbums(context, id3, query, keywords, mediaLibrary, context.user, searchResultNode);
+            findRequestedTracks(context, query, keywords, mediaLibrary, context.user, searchResultNode);
 
             return response;
         }
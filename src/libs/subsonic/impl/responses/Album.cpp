@@ -21,6 +21,7 @@
 
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/Release.hpp"
 #include "database/User.hpp"
 #include "services/feedback/IFeedbackService.hpp"
@@ -94,10 +95,11 @@ namespace lms::api::subsonic
         albumNode.setAttribute("playCount", core::Service<scrobbling::IScrobblingService>::get()->getCount(user->getId(), release->getId()));
 
         // Report the first GENRE for this track
-        const ClusterType::pointer genreClusterType{ ClusterType::find(context.dbSession, "GENRE") };
+        const std::shared_ptr<const ReferenceData> referenceData{ context.dbSession.getReferenceData() };
+        const ReferenceData::ClusterTypeInfo* genreClusterType{ referenceData->findClusterType("GENRE") };
         if (genreClusterType)
         {
-            auto clusters{ release->getClusterGroups({genreClusterType->getId()}, 1) };
+            auto clusters{ release->getClusterGroups({genreClusterType->id}, 1) };
             if (!clusters.empty() && !clusters.front().empty())
                 albumNode.setAttribute("genre", clusters.front().front()->getName());
         }
@@ -128,9 +130,13 @@ namespace lms::api::subsonic
         {
             albumNode.createEmptyArrayValue(field);
 
+            const ReferenceData::ClusterTypeInfo* clusterType{ referenceData->findClusterType(clusterTypeName) };
+            if (!clusterType)
+                return;
+
             Cluster::FindParameters params;
             params.setRelease(release->getId());
-            params.setClusterTypeName(clusterTypeName);
+            params.setClusterType(clusterType->id);
 
             Cluster::find(context.dbSession, params, [&](const Cluster::pointer& cluster)
                 {
@@ -146,7 +152,7 @@ namespace lms::api::subsonic
         {
             Cluster::FindParameters params;
             params.setRelease(release->getId());
-            params.setClusterType(genreClusterType->getId());
+            params.setClusterType(genreClusterType->id);
 
             Cluster::find(context.dbSession, params, [&](const Cluster::pointer& cluster)
                 {
@@ -117,11 +117,16 @@ namespace lms::api::subsonic
     }
 
     Response::Node createArtistNode(const Artist::pointer& artist)
+    {
+        return createArtistNode(artist->getId(), artist->getName());
+    }
+
+    Response::Node createArtistNode(ArtistId artistId, std::string_view name)
     {
         Response::Node artistNode;
 
-        artistNode.setAttribute("id", idToString(artist->getId()));
-        artistNode.setAttribute("name", artist->getName());
+        artistNode.setAttribute("id", idToString(artistId));
+        artistNode.setAttribute("name", name);
 
         return artistNode;
     }
@@ -20,7 +20,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+
+#include "database/ArtistId.hpp"
 #include "database/Object.hpp"
 #include "database/Types.hpp"
 #include "SubsonicResponse.hpp"
@@ -41,4 +44,5 @@ namespace lms::api::subsonic
     }
     Response::Node createArtistNode(RequestContext& context, const db::ObjectPtr<db::Artist>& artist, const db::ObjectPtr<db::User>& user, bool id3);
     Response::Node createArtistNode(const db::ObjectPtr<db::Artist>& artist); // only minimal info
+    Response::Node createArtistNode(db::ArtistId artistId, std::string_view name); // only minimal info
 }
\ No newline at end of file
@@ -37,4 +37,16 @@ namespace lms::api::subsonic
 
         return contributorNode;
     }
+
+    Response::Node createContributorNode(const db::TrackSummary::Artist& artist)
+    {
+        Response::Node contributorNode;
+
+        contributorNode.setAttribute("role", utils::toString(artist.linkType));
+        if (!artist.linkSubType.empty())
+            contributorNode.setAttribute("subRole", artist.linkSubType);
+        contributorNode.addChild("artist", createArtistNode(artist.id, artist.name));
+
+        return contributorNode;
+    }
 }
\ No newline at end of file
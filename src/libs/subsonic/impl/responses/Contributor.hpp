@@ -20,6 +20,7 @@
 #pragma once
 
 #include "database/Object.hpp"
+#include "database/TrackSummary.hpp"
 #include "SubsonicResponse.hpp"
 
 namespace lms::db
@@ -31,4 +32,5 @@ namespace lms::db
 namespace lms::api::subsonic
 {
     Response::Node createContributorNode(const db::ObjectPtr<db::TrackArtistLink>& trackArtistLink, const db::ObjectPtr<db::Artist>& artist);
+    Response::Node createContributorNode(const db::TrackSummary::Artist& artist);
 }
\ No newline at end of file
@@ -24,13 +24,18 @@
 namespace lms::api::subsonic
 {
     Response::Node createReplayGainNode(const db::ObjectPtr<db::Track>& track)
+    {
+        return createReplayGainNode(track->getTrackReplayGain(), track->getReleaseReplayGain());
+    }
+
+    Response::Node createReplayGainNode(std::optional<float> trackReplayGain, std::optional<float> releaseReplayGain)
     {
         Response::Node replayGainNode;
 
-        if (const auto trackReplayGain{ track->getTrackReplayGain() })
+        if (trackReplayGain)
             replayGainNode.setAttribute("trackGain", *trackReplayGain);
 
-        if (const auto releaseReplayGain{ track->getReleaseReplayGain() })
+        if (releaseReplayGain)
             replayGainNode.setAttribute("albumGain", *releaseReplayGain);
 
         return replayGainNode;
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "database/Object.hpp"
 #include "SubsonicResponse.hpp"
 
@@ -30,4 +32,5 @@ namespace lms::db
 namespace lms::api::subsonic
 {
     Response::Node createReplayGainNode(const db::ObjectPtr<db::Track>& track);
+    Response::Node createReplayGainNode(std::optional<float> trackReplayGain, std::optional<float> releaseReplayGain);
 }
\ No newline at end of file
@@ -19,14 +19,12 @@
 
 #include "responses/Song.hpp"
 
+#include <span>
 #include <string_view>
 
 #include "av/IAudioFile.hpp"
-#include "database/Artist.hpp"
-#include "database/Cluster.hpp"
-#include "database/Release.hpp"
 #include "database/Track.hpp"
-#include "database/TrackArtistLink.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "services/feedback/IFeedbackService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
@@ -59,30 +57,43 @@ namespace lms::api::subsonic
 
             return "";
         }
+
+        std::string joinArtistNames(std::span<const TrackSummary::Artist* const> artists)
+        {
+            if (artists.size() == 1)
+                return artists.front()->name;
+
+            std::vector<std::string_view> names;
+            names.reserve(artists.size());
+            for (const TrackSummary::Artist* artist : artists)
+                names.push_back(artist->name);
+
+            return core::stringUtils::joinStrings(names, ", ");
+        }
     }
 
-    Response::Node createSongNode(RequestContext& context, const Track::pointer& track, const User::pointer& user)
+    Response::Node createSongNode(RequestContext& context, const TrackSummary& track, const User::pointer& user)
     {
         LMS_SCOPED_TRACE_DETAILED("Subsonic", "CreateSong");
 
         Response::Node trackResponse;
 
-        trackResponse.setAttribute("id", idToString(track->getId()));
+        trackResponse.setAttribute("id", idToString(track.id));
         trackResponse.setAttribute("isDir", false);
-        trackResponse.setAttribute("title", track->getName());
-        if (track->getTrackNumber())
-            trackResponse.setAttribute("track", *track->getTrackNumber());
-        if (track->getDiscNumber())
-            trackResponse.setAttribute("discNumber", *track->getDiscNumber());
-        if (track->getYear())
-            trackResponse.setAttribute("year", *track->getYear());
-        trackResponse.setAttribute("playCount", core::Service<scrobbling::IScrobblingService>::get()->getCount(user->getId(), track->getId()));
-        trackResponse.setAttribute("path", track->getRelativeFilePath().string());
-        trackResponse.setAttribute("size", track->getFileSize());
-
-        if (track->getAbsoluteFilePath().has_extension())
+        trackResponse.setAttribute("title", track.name);
+        if (track.trackNumber)
+            trackResponse.setAttribute("track", *track.trackNumber);
+        if (track.discNumber)
+            trackResponse.setAttribute("discNumber", *track.discNumber);
+        if (track.year)
+            trackResponse.setAttribute("year", *track.year);
+        trackResponse.setAttribute("playCount", core::Service<scrobbling::IScrobblingService>::get()->getCount(user->getId(), track.id));
+        trackResponse.setAttribute("path", track.relativeFilePath.string());
+        trackResponse.setAttribute("size", track.fileSize);
+
+        if (track.absoluteFilePath.has_extension())
         {
-            auto extension{ track->getAbsoluteFilePath().extension() };
+            auto extension{ track.absoluteFilePath.extension() };
             trackResponse.setAttribute("suffix", extension.string().substr(1) /* skip leading .*/);
         }
 
@@ -92,115 +103,94 @@ namespace lms::api::subsonic
             trackResponse.setAttribute("transcodedContentType", av::getMimeType(std::filesystem::path{ "." + fileSuffix }));
         }
 
-        trackResponse.setAttribute("coverArt", idToString(track->getId()));
+        trackResponse.setAttribute("coverArt", idToString(track.id));
 
-        const std::vector<Artist::pointer>& artists{ track->getArtists({TrackArtistLinkType::Artist}) };
+        const std::vector<const TrackSummary::Artist*> artists{ track.getArtists(TrackArtistLinkType::Artist) };
         if (!artists.empty())
         {
-            if (!track->getArtistDisplayName().empty())
-                trackResponse.setAttribute("artist", track->getArtistDisplayName());
+            if (!track.artistDisplayName.empty())
+                trackResponse.setAttribute("artist", track.artistDisplayName);
             else
-                trackResponse.setAttribute("artist", utils::joinArtistNames(artists));
+                trackResponse.setAttribute("artist", joinArtistNames(artists));
 
             if (artists.size() == 1)
-                trackResponse.setAttribute("artistId", idToString(artists.front()->getId()));
+                trackResponse.setAttribute("artistId", idToString(artists.front()->id));
         }
 
-        Release::pointer release{ track->getRelease() };
-        if (release)
+        if (track.releaseId.isValid())
         {
-            trackResponse.setAttribute("album", release->getName());
-            trackResponse.setAttribute("albumId", idToString(release->getId()));
-            trackResponse.setAttribute("parent", idToString(release->getId()));
+            trackResponse.setAttribute("album", track.releaseName);
+            trackResponse.setAttribute("albumId", idToString(track.releaseId));
+            trackResponse.setAttribute("parent", idToString(track.releaseId));
         }
 
-        trackResponse.setAttribute("duration", std::chrono::duration_cast<std::chrono::seconds>(track->getDuration()).count());
-        trackResponse.setAttribute("bitRate", (track->getBitrate() / 1000));
+        trackResponse.setAttribute("duration", std::chrono::duration_cast<std::chrono::seconds>(track.duration).count());
+        trackResponse.setAttribute("bitRate", (track.bitrate / 1000));
         trackResponse.setAttribute("type", "music");
-        trackResponse.setAttribute("created", core::stringUtils::toISO8601String(track->getLastWritten()));
-        trackResponse.setAttribute("contentType", av::getMimeType(track->getAbsoluteFilePath().extension()));
+        trackResponse.setAttribute("created", core::stringUtils::toISO8601String(track.lastWritten));
+        trackResponse.setAttribute("contentType", av::getMimeType(track.absoluteFilePath.extension()));
 
-        if (const Wt::WDateTime dateTime{ core::Service<feedback::IFeedbackService>::get()->getStarredDateTime(user->getId(), track->getId()) }; dateTime.isValid())
+        if (const Wt::WDateTime dateTime{ core::Service<feedback::IFeedbackService>::get()->getStarredDateTime(user->getId(), track.id) }; dateTime.isValid())
             trackResponse.setAttribute("starred", core::stringUtils::toISO8601String(dateTime));
 
         // Report the first GENRE for this track
-        std::vector<Cluster::pointer> genres;
-        {
-            Cluster::FindParameters params;
-            params.setTrack(track->getId());
-            params.setClusterTypeName("GENRE");
-
-            genres = Cluster::find(context.dbSession, params).results;
-            if (!genres.empty())
-                trackResponse.setAttribute("genre", genres.front()->getName());
-        }
+        const std::vector<std::string_view> genres{ track.getClusterNames("GENRE") };
+        if (!genres.empty())
+            trackResponse.setAttribute("genre", genres.front());
 
         // OpenSubsonic specific fields (must always be set)
         if (!context.enableOpenSubsonic)
             return trackResponse;
 
-        trackResponse.setAttribute("bitDepth", track->getBitsPerSample());
-        trackResponse.setAttribute("samplingRate", track->getSampleRate());
-        trackResponse.setAttribute("channelCount", track->getChannelCount());
+        trackResponse.setAttribute("bitDepth", track.bitsPerSample);
+        trackResponse.setAttribute("samplingRate", track.sampleRate);
+        trackResponse.setAttribute("channelCount", track.channelCount);
 
         trackResponse.setAttribute("mediaType", "song");
 
         {
-            const Wt::WDateTime dateTime{ core::Service<scrobbling::IScrobblingService>::get()->getLastListenDateTime(user->getId(), track->getId()) };
+            const Wt::WDateTime dateTime{ core::Service<scrobbling::IScrobblingService>::get()->getLastListenDateTime(user->getId(), track.id) };
             trackResponse.setAttribute("played", dateTime.isValid() ? core::stringUtils::toISO8601String(dateTime) : "");
         }
 
-        {
-            std::optional<core::UUID> mbid{ track->getRecordingMBID() };
-            trackResponse.setAttribute("musicBrainzId", mbid ? mbid->getAsString() : "");
-        }
+        trackResponse.setAttribute("musicBrainzId", track.recordingMBID ? track.recordingMBID->getAsString() : "");
 
         {
             trackResponse.createEmptyArrayChild("albumartists");
             trackResponse.createEmptyArrayChild("artists");
             trackResponse.createEmptyArrayChild("contributors");
 
-            TrackArtistLink::find(context.dbSession, track->getId(), [&](const TrackArtistLink::pointer& link, const Artist::pointer& artist)
+            for (const TrackSummary::Artist& artist : track.artists)
             {
-                switch (link->getType())
+                switch (artist.linkType)
                 {
                     case TrackArtistLinkType::Artist:
-                        trackResponse.addArrayChild("artists", createArtistNode(artist));
+                        trackResponse.addArrayChild("artists", createArtistNode(artist.id, artist.name));
                         break;
                     case TrackArtistLinkType::ReleaseArtist:
-                        trackResponse.addArrayChild("albumartists", createArtistNode(artist));
+                        trackResponse.addArrayChild("albumartists", createArtistNode(artist.id, artist.name));
                         break;
                     default:
-                        trackResponse.addArrayChild("contributors", createContributorNode(link, artist));
+                        trackResponse.addArrayChild("contributors", createContributorNode(artist));
                 }
-            });
+            }
         }
 
-        trackResponse.setAttribute("displayArtist", track->getArtistDisplayName());
-        if (release)
-            trackResponse.setAttribute("displayAlbumArtist", release->getArtistDisplayName());
-
-        auto addClusters{ [&](Response::Node::Key field, std::string_view clusterTypeName)
-        {
-            trackResponse.createEmptyArrayValue(field);
-
-            Cluster::FindParameters params;
-            params.setTrack(track->getId());
-            params.setClusterTypeName(clusterTypeName);
-
-            for (const auto& cluster : Cluster::find(context.dbSession, params).results)
-                trackResponse.addArrayValue(field, cluster->getName());
-        } };
+        trackResponse.setAttribute("displayArtist", track.artistDisplayName);
+        if (track.releaseId.isValid())
+            trackResponse.setAttribute("displayAlbumArtist", track.releaseArtistDisplayName);
 
-        addClusters("moods", "MOOD");
+        trackResponse.createEmptyArrayValue("moods");
+        for (std::string_view mood : track.getClusterNames("MOOD"))
+            trackResponse.addArrayValue("moods", mood);
 
         // Genres
         trackResponse.createEmptyArrayChild("genres");
-        for (const auto& genre : genres)
-            trackResponse.addArrayChild("genres", createItemGenreNode(genre->getName()));
+        for (std::string_view genre : genres)
+            trackResponse.addArrayChild("genres", createItemGenreNode(genre));
 
-        trackResponse.addChild("replayGain", createReplayGainNode(track));
+        trackResponse.addChild("replayGain", createReplayGainNode(track.trackReplayGain, track.releaseReplayGain));
 
         return trackResponse;
     }
-}
\ No newline at end of file
+}
@@ -24,12 +24,12 @@
 
 namespace lms::db
 {
-    class Track;
+    struct TrackSummary;
     class User;
     class Session;
 }
 
 namespace lms::api::subsonic
 {
-    Response::Node createSongNode(RequestContext& context, const db::ObjectPtr<db::Track>& track, const db::ObjectPtr<db::User>& user);
+    Response::Node createSongNode(RequestContext& context, const db::TrackSummary& track, const db::ObjectPtr<db::User>& user);
 }
\ No newline at end of file
@@ -288,7 +288,7 @@ namespace lms
 
             core::IOContextRunner ioContextRunner{ ioContext, getThreadCount(), "Misc" };
 
-            // Connection pool size must be twice the number of threads: we have at least 2 io pools with getThreadCount() each and they all may access the database
+            // Read connection count must be twice the number of threads: we have at least 2 io pools with getThreadCount() each and they all may access the database
             db::Db database{ config->getPath("working-dir") / "lms.db", getThreadCount() * 2 };
             {
                 db::Session session{ database };
@@ -42,6 +42,7 @@
 #include "core/Service.hpp"
 #include "core/String.hpp"
 
+#include "admin/CachesView.hpp"
 #include "admin/InitWizardView.hpp"
 #include "admin/MediaLibrariesView.hpp"
 #include "admin/TracingView.hpp"
@@ -76,6 +77,7 @@ namespace lms::ui
             const std::string appRoot{ Wt::WApplication::appRoot() };
 
             auto res{ std::make_shared<Wt::WMessageResourceBundle>() };
+            res->use(appRoot + "admin-caches");
             res->use(appRoot + "admin-initwizard");
             res->use(appRoot + "admin-medialibraries");
             res->use(appRoot + "admin-medialibrary");
@@ -122,6 +124,7 @@ namespace lms::ui
             IdxAdminUsers,
             IdxAdminUser,
             IdxAdminTracing,
+            IdxAdminCaches,
         };
 
         void handlePathChange(Wt::WStackedWidget& stack, bool isAdmin)
@@ -149,6 +152,7 @@ namespace lms::ui
                 { "/admin/users",		    IdxAdminUsers,		    true,	Wt::WString::tr("Lms.Admin.Users.users") },
                 { "/admin/user",		    IdxAdminUser,		    true,	std::nullopt },
                 { "/admin/tracing",		    IdxAdminTracing,		true,	Wt::WString::tr("Lms.Admin.Tracing.tracing") },
+                { "/admin/caches",		    IdxAdminCaches,		    true,	Wt::WString::tr("Lms.Admin.Caches.caches") },
             };
 
             LMS_LOG(UI, DEBUG, "Internal path changed to '" << wApp->internalPath() << "'");
@@ -445,6 +449,7 @@ namespace lms::ui
                 navbar->bindNew<Wt::WAnchor>("tracing", Wt::WLink{ Wt::LinkType::InternalPath, "/admin/tracing" }, Wt::WString::tr("Lms.Admin.menu-tracing"));
             else
                 navbar->bindEmpty("tracing");
+            navbar->bindNew<Wt::WAnchor>("caches", Wt::WLink{ Wt::LinkType::InternalPath, "/admin/caches" }, Wt::WString::tr("Lms.Admin.menu-caches"));
         }
 
         // Contents
@@ -466,6 +471,7 @@ namespace lms::ui
             mainStack->addNew<UsersView>();
             mainStack->addNew<UserView>();
             mainStack->addNew<TracingView>();
+            mainStack->addNew<CachesView>();
         }
 
         explore->getPlayQueueController().setMaxTrackCountToEnqueue(_playQueue->getCapacity());
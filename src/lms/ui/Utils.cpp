@@ -28,6 +28,7 @@
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
 #include "database/Release.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/ScanSettings.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
@@ -125,8 +126,7 @@ namespace lms::ui::utils
 
         std::unique_ptr<Wt::WContainerWidget> clusterContainer{ std::make_unique<Wt::WContainerWidget>() };
 
-        // TODO: optimize this
-        const auto clusterTypes{ ClusterType::findIds(LmsApp->getDbSession()).results };
+        const auto clusterTypes{ LmsApp->getDbSession().getReferenceData()->getClusterTypeIds() };
         const auto clusterGroups{ track->getClusterGroups(clusterTypes, 3) };
 
         for (const auto& clusters : clusterGroups)
@@ -177,20 +177,44 @@ namespace lms::ui::utils
     {
         using namespace db;
 
+        std::vector<TrackSummary::Artist> artists;
+        artists.reserve(artistIds.size());
+        {
+            auto transaction{ LmsApp->getDbSession().createReadTransaction() };
+
+            for (const ArtistId artistId : artistIds)
+            {
+                if (const Artist::pointer artist{ Artist::find(LmsApp->getDbSession(), artistId) })
+                    artists.push_back(TrackSummary::Artist{ artist->getId(), artist->getName(), artist->getMBID(), TrackArtistLinkType::Artist, {} });
+            }
+        }
+
+        std::vector<const TrackSummary::Artist*> artistPtrs;
+        artistPtrs.reserve(artists.size());
+        for (const TrackSummary::Artist& artist : artists)
+            artistPtrs.push_back(&artist);
+
+        return createArtistDisplayNameWithAnchors(displayName, artistPtrs, cssAnchorClass);
+    }
+
+    std::unique_ptr<Wt::WContainerWidget> createArtistDisplayNameWithAnchors(std::string_view displayName, std::span<const db::TrackSummary::Artist* const> artists, std::string_view cssAnchorClass)
+    {
+        auto createAnchor{ [&](const db::TrackSummary::Artist& artist) {
+            auto anchor{ createArtistAnchor(artist.id, artist.mbid, artist.name) };
+            anchor->addStyleClass("text-decoration-none"); // hack
+            anchor->addStyleClass(std::string{ cssAnchorClass }); // hack
+            return anchor;
+        } };
+
         std::size_t matchCount{};
         std::string_view::size_type currentOffset{};
 
         auto result{ std::make_unique<Wt::WContainerWidget>() };
-        auto transaction{ LmsApp->getDbSession().createReadTransaction() };
 
         // consider order is guaranteed + we will likely succeed
-        for (const ArtistId artistId : artistIds)
+        for (const db::TrackSummary::Artist* artist : artists)
         {
-            const Artist::pointer artist{ Artist::find(LmsApp->getDbSession(), artistId) };
-            if (!artist)
-                break;
-
-            const auto pos{ displayName.find(artist->getName(), currentOffset) };
+            const auto pos{ displayName.find(artist->name, currentOffset) };
             if (pos == std::string_view::npos)
                 break;
 
@@ -198,16 +222,21 @@ namespace lms::ui::utils
             if (pos != currentOffset)
                 result->addNew<Wt::WText>(std::string{ displayName.substr(currentOffset, pos - currentOffset) }, Wt::TextFormat::Plain);
 
-            auto anchor{ createArtistAnchor(artist) };
-            anchor->addStyleClass("text-decoration-none"); // hack
-            anchor->addStyleClass(std::string{ cssAnchorClass }); // hack
-            result->addWidget(std::move(anchor));
-            currentOffset = pos + artist->getName().size();
+            result->addWidget(createAnchor(*artist));
+            currentOffset = pos + artist->name.size();
             matchCount += 1;
         }
 
-        if (matchCount != artistIds.size())
-            return createArtistAnchorList(artistIds, cssAnchorClass);
+        if (matchCount != artists.size())
+        {
+            result = std::make_unique<Wt::WContainerWidget>();
+            for (const db::TrackSummary::Artist* artist : artists)
+            {
+                if (result->count() > 0)
+                    result->addNew<Wt::WText>(" · ");
+                result->addWidget(createAnchor(*artist));
+            }
+        }
 
         return result;
     }
@@ -250,21 +279,32 @@ namespace lms::ui::utils
 
     Wt::WLink createArtistLink(db::Artist::pointer artist)
     {
-        if (const auto mbid{ artist->getMBID() })
-            return Wt::WLink{ Wt::LinkType::InternalPath, "/artist/mbid/" + std::string {mbid->getAsString()} };
+        return createArtistLink(artist->getId(), artist->getMBID());
+    }
+
+    Wt::WLink createArtistLink(db::ArtistId artistId, const std::optional<core::UUID>& artistMBID)
+    {
+        if (artistMBID)
+            return Wt::WLink{ Wt::LinkType::InternalPath, "/artist/mbid/" + std::string {artistMBID->getAsString()} };
         else
-            return Wt::WLink{ Wt::LinkType::InternalPath, "/artist/" + artist->getId().toString() };
+            return Wt::WLink{ Wt::LinkType::InternalPath, "/artist/" + artistId.toString() };
     }
 
     std::unique_ptr<Wt::WAnchor> createArtistAnchor(db::Artist::pointer artist, bool setText)
     {
-        auto res = std::make_unique<Wt::WAnchor>(createArtistLink(artist));
+        return createArtistAnchor(artist->getId(), artist->getMBID(), artist->getName(), setText);
+    }
+
+    std::unique_ptr<Wt::WAnchor> createArtistAnchor(db::ArtistId artistId, const std::optional<core::UUID>& artistMBID, std::string_view artistName, bool setText)
+    {
+        auto res = std::make_unique<Wt::WAnchor>(createArtistLink(artistId, artistMBID));
 
         if (setText)
         {
+            const Wt::WString name{ Wt::WString::fromUTF8(std::string{ artistName }) };
             res->setTextFormat(Wt::TextFormat::Plain);
-            res->setText(Wt::WString::fromUTF8(artist->getName()));
-            res->setToolTip(Wt::WString::fromUTF8(artist->getName()), Wt::TextFormat::Plain);
+            res->setText(name);
+            res->setToolTip(name, Wt::TextFormat::Plain);
         }
 
         return res;
@@ -272,22 +312,32 @@ namespace lms::ui::utils
 
     Wt::WLink createReleaseLink(db::Release::pointer release)
     {
-        if (const auto mbid{ release->getMBID() })
-            return Wt::WLink{ Wt::LinkType::InternalPath, "/release/mbid/" + std::string {mbid->getAsString()} };
+        return createReleaseLink(release->getId(), release->getMBID());
+    }
+
+    Wt::WLink createReleaseLink(db::ReleaseId releaseId, const std::optional<core::UUID>& releaseMBID)
+    {
+        if (releaseMBID)
+            return Wt::WLink{ Wt::LinkType::InternalPath, "/release/mbid/" + std::string {releaseMBID->getAsString()} };
         else
-            return Wt::WLink{ Wt::LinkType::InternalPath, "/release/" + release->getId().toString() };
+            return Wt::WLink{ Wt::LinkType::InternalPath, "/release/" + releaseId.toString() };
     }
 
     std::unique_ptr<Wt::WAnchor> createReleaseAnchor(db::Release::pointer release, bool setText)
     {
-        auto res = std::make_unique<Wt::WAnchor>(createReleaseLink(release));
+        return createReleaseAnchor(release->getId(), release->getMBID(), release->getName(), setText);
+    }
+
+    std::unique_ptr<Wt::WAnchor> createReleaseAnchor(db::ReleaseId releaseId, const std::optional<core::UUID>& releaseMBID, std::string_view releaseName, bool setText)
+    {
+        auto res = std::make_unique<Wt::WAnchor>(createReleaseLink(releaseId, releaseMBID));
 
         if (setText)
         {
-            std::string releaseName{ release->getName() };
+            const Wt::WString name{ Wt::WString::fromUTF8(std::string{ releaseName }) };
             res->setTextFormat(Wt::TextFormat::Plain);
-            res->setText(Wt::WString::fromUTF8(releaseName));
-            res->setToolTip(Wt::WString::fromUTF8(releaseName), Wt::TextFormat::Plain);
+            res->setText(name);
+            res->setToolTip(name, Wt::TextFormat::Plain);
         }
 
         return res;
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <chrono>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -33,6 +35,7 @@
 #include "database/Object.hpp"
 #include "database/ReleaseId.hpp"
 #include "database/TrackId.hpp"
+#include "database/TrackSummary.hpp"
 
 #include "resource/CoverResource.hpp"
 
@@ -63,11 +66,16 @@ namespace lms::ui::utils
 
 	std::unique_ptr<Wt::WContainerWidget> createArtistAnchorList(const std::vector<db::ArtistId>& artistIds, std::string_view cssAnchorClass = "link-success");
 	std::unique_ptr<Wt::WContainerWidget> createArtistDisplayNameWithAnchors(std::string_view displayName, const std::vector<db::ArtistId>& artistIds, std::string_view cssAnchorClass = "link-success");
+	std::unique_ptr<Wt::WContainerWidget> createArtistDisplayNameWithAnchors(std::string_view displayName, std::span<const db::TrackSummary::Artist* const> artists, std::string_view cssAnchorClass = "link-success"); // no database access
 	std::unique_ptr<Wt::WContainerWidget> createArtistsAnchorsForRelease(db::ObjectPtr<db::Release> release, db::ArtistId omitIfMatchThisArtist = {}, std::string_view cssAnchorClass = "link-success");
 
 	Wt::WLink createArtistLink(db::ObjectPtr<db::Artist> artist);
+	Wt::WLink createArtistLink(db::ArtistId artistId, const std::optional<core::UUID>& artistMBID);
 	std::unique_ptr<Wt::WAnchor> createArtistAnchor(db::ObjectPtr<db::Artist> artist, bool setText = true);
+	std::unique_ptr<Wt::WAnchor> createArtistAnchor(db::ArtistId artistId, const std::optional<core::UUID>& artistMBID, std::string_view artistName, bool setText = true);
 	Wt::WLink createReleaseLink(db::ObjectPtr<db::Release> release);
+	Wt::WLink createReleaseLink(db::ReleaseId releaseId, const std::optional<core::UUID>& releaseMBID);
 	std::unique_ptr<Wt::WAnchor> createReleaseAnchor(db::ObjectPtr<db::Release> release, bool setText = true);
+	std::unique_ptr<Wt::WAnchor> createReleaseAnchor(db::ReleaseId releaseId, const std::optional<core::UUID>& releaseMBID, std::string_view releaseName, bool setText = true);
 	std::unique_ptr<Wt::WAnchor> createTrackListAnchor(db::ObjectPtr<db::TrackList> trackList, bool setText = true);
 }
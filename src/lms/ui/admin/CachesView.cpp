@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CachesView.hpp"
+
+#include <sstream>
+
+#include <Wt/WApplication.h>
+#include <Wt/WPushButton.h>
+
+#include "services/cover/ICoverService.hpp"
+#include "core/Service.hpp"
+
+namespace lms::ui
+{
+    namespace
+    {
+        std::string hitRateToString(std::size_t hits, std::size_t misses)
+        {
+            if (hits + misses == 0)
+                return "-";
+
+            return std::to_string(hits * 100 / (hits + misses)) + "%";
+        }
+
+        std::string sizeToString(std::size_t size)
+        {
+            std::ostringstream oss;
+            oss.precision(1);
+            oss << std::fixed << (static_cast<double>(size) / (1000 * 1000)) << " MB";
+            return oss.str();
+        }
+    }
+
+    CachesView::CachesView()
+        : Wt::WTemplate{ Wt::WString::tr("Lms.Admin.Caches.template") }
+    {
+        addFunction("tr", &Wt::WTemplate::Functions::tr);
+
+        Wt::WPushButton* refreshBtn{ bindNew<Wt::WPushButton>("refresh-btn", Wt::WString::tr("Lms.Admin.Caches.refresh")) };
+        refreshBtn->clicked().connect(this, &CachesView::refreshView);
+
+        wApp->internalPathChanged().connect(this, [this]
+            {
+                refreshView();
+            });
+
+        refreshView();
+    }
+
+    void CachesView::refreshView()
+    {
+        if (!wApp->internalPathMatches("/admin/caches"))
+            return;
+
+        const cover::CacheStats stats{ core::Service<cover::ICoverService>::get()->getCacheStats() };
+
+        bindString("cover-entry-count", std::to_string(stats.entryCount));
+        bindString("cover-size", sizeToString(stats.size) + " / " + sizeToString(stats.maxSize));
+        bindString("cover-hits", std::to_string(stats.hits));
+        bindString("cover-misses", std::to_string(stats.misses));
+        bindString("cover-hit-rate", hitRateToString(stats.hits, stats.misses));
+        bindString("cover-evictions", std::to_string(stats.evictions));
+
+        setCondition("if-has-disk-cache", stats.diskCacheMaxSize > 0);
+        bindString("cover-disk-max-size", sizeToString(stats.diskCacheMaxSize));
+        bindString("cover-disk-hits", std::to_string(stats.diskCacheHits));
+        bindString("cover-disk-misses", std::to_string(stats.diskCacheMisses));
+        bindString("cover-disk-hit-rate", hitRateToString(stats.diskCacheHits, stats.diskCacheMisses));
+
+        std::ostringstream sizeStats;
+        for (const cover::CacheStats::SizeStats& sizeStat : stats.sizeStats)
+            sizeStats << "<tr><td>" << sizeStat.size << "</td><td>" << sizeStat.hits << "</td><td>" << sizeStat.misses << "</td><td>" << hitRateToString(sizeStat.hits, sizeStat.misses) << "</td></tr>";
+        bindString("cover-size-stats", sizeStats.str(), Wt::TextFormat::UnsafeXHTML);
+    }
+} // namespace lms::ui
@@ -26,6 +26,7 @@
 #include <Wt/WDateTime.h>
 #include <Wt/WPushButton.h>
 #include <Wt/WResource.h>
+#include <Wt/WText.h>
 
 #include "database/Session.hpp"
 #include "database/Track.hpp"
@@ -51,6 +52,76 @@ namespace lms::ui
 
             return oss.str();
         }
+
+        Wt::WString stepStatsToWString(const scanner::ScanStepStats& stepStats)
+        {
+            using namespace scanner;
+
+            switch (stepStats.currentStep)
+            {
+            case ScanStep::CheckForDuplicateFiles:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-checking-for-duplicate-files")
+                    .arg(stepStats.processedElems);
+
+            case ScanStep::CheckForMissingFiles:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-checking-for-missing-files")
+                    .arg(stepStats.progress());
+
+            case ScanStep::Compact:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-compact");
+
+            case ScanStep::ComputeClusterStats:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-compute-cluster-stats")
+                    .arg(stepStats.progress());
+
+            case ScanStep::DiscoverFiles:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-discovering-files")
+                    .arg(stepStats.processedElems);
+
+            case ScanStep::FetchTrackFeatures:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-fetching-track-features")
+                    .arg(stepStats.processedElems)
+                    .arg(stepStats.totalElems)
+                    .arg(stepStats.progress());
+
+            case ScanStep::GenerateCovers:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-generating-covers")
+                    .arg(stepStats.processedElems)
+                    .arg(stepStats.totalElems)
+                    .arg(stepStats.progress());
+
+            case ScanStep::Optimize:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-optimize")
+                    .arg(stepStats.processedElems)
+                    .arg(stepStats.totalElems)
+                    .arg(stepStats.progress());
+
+            case ScanStep::RebuildListenStats:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-rebuilding-listen-stats");
+
+            case ScanStep::ReloadSimilarityEngine:
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-reloading-similarity-engine")
+                    .arg(stepStats.progress());
+
+            case ScanStep::ScanFiles:
+                if (stepStats.threadCount > 0)
+                {
+                    return Wt::WString::tr("Lms.Admin.ScannerController.step-scanning-files-thread-pool")
+                        .arg(stepStats.processedElems)
+                        .arg(stepStats.totalElems)
+                        .arg(stepStats.progress())
+                        .arg(stepStats.threadCount)
+                        .arg(stepStats.queuedElems);
+                }
+
+                return Wt::WString::tr("Lms.Admin.ScannerController.step-scanning-files")
+                    .arg(stepStats.processedElems)
+                    .arg(stepStats.totalElems)
+                    .arg(stepStats.progress());
+            }
+
+            return "?";
+        }
     }
 
     class ReportResource : public Wt::WResource
@@ -181,6 +252,8 @@ namespace lms::ui
         _stepStatus = bindNew<Wt::WLineEdit>("step-status");
         _stepStatus->setReadOnly(true);
 
+        _stepDetails = bindNew<Wt::WContainerWidget>("step-details");
+
         auto onDbEvent{ [&]() { refreshContents(); } };
 
         LmsApp->getScannerEvents().scanAborted.connect(this, []
@@ -206,6 +279,7 @@ namespace lms::ui
 
         refreshLastScanStatus(status);
         refreshStatus(status);
+        refreshStepDetails(status);
     }
 
     void ScannerController::refreshLastScanStatus(const scanner::IScannerService::Status& status)
@@ -249,70 +323,54 @@ namespace lms::ui
             break;
 
         case IScannerService::State::InProgress:
-            _status->setText(Wt::WString::tr("Lms.Admin.ScannerController.status-in-progress")
-                .arg(status.currentScanStepStats->stepIndex + 1)
-                .arg(scanner::ScanProgressStepCount));
+        {
+            // independent steps may be in progress at the same time
+            std::size_t currentStepIndex{ status.currentScanStepStats.empty() ? 0 : status.currentScanStepStats.back().stepIndex };
+            Wt::WString stepStatus;
+            for (const ScanStepStats& stepStats : status.currentScanStepStats)
+            {
+                if (!stepStats.stopTime.isNull())
+                    continue;
+
+                if (stepStatus.empty())
+                    currentStepIndex = stepStats.stepIndex;
+                else
+                    stepStatus += " | ";
+                stepStatus += stepStatsToWString(stepStats);
+            }
 
-            refreshCurrentStep(*status.currentScanStepStats);
+            _status->setText(Wt::WString::tr("Lms.Admin.ScannerController.status-in-progress")
+                .arg(currentStepIndex + 1)
+                .arg(status.currentScanStepCount));
+            _stepStatus->setText(stepStatus);
             break;
         }
+        }
     }
 
-    void ScannerController::refreshCurrentStep(const scanner::ScanStepStats& stepStats)
+    void ScannerController::refreshStepDetails(const scanner::IScannerService::Status& status)
     {
         using namespace scanner;
 
-        switch (stepStats.currentStep)
-        {
-        case ScanStep::CheckForDuplicateFiles:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-checking-for-duplicate-files")
-                .arg(stepStats.processedElems));
-            break;
+        _stepDetails->clear();
 
-        case scanner::ScanStep::CheckForMissingFiles:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-checking-for-missing-files")
-                .arg(stepStats.progress()));
-            break;
+        const std::vector<ScanStepStats>* stepsStats{};
+        if (status.currentState == IScannerService::State::InProgress)
+            stepsStats = &status.currentScanStepStats;
+        else if (status.lastCompleteScanStats)
+            stepsStats = &status.lastCompleteScanStats->stepStats;
 
-        case scanner::ScanStep::Compact:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-compact"));
-            break;
-
-        case scanner::ScanStep::ComputeClusterStats:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-compute-cluster-stats")
-                .arg(stepStats.progress()));
-            break;
-
-        case scanner::ScanStep::DiscoverFiles:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-discovering-files")
-                .arg(stepStats.processedElems));
-            break;
+        if (!stepsStats)
+            return;
 
-        case scanner::ScanStep::FetchTrackFeatures:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-fetching-track-features")
-                .arg(stepStats.processedElems)
-                .arg(stepStats.totalElems)
-                .arg(stepStats.progress()));
-            break;
-
-        case scanner::ScanStep::Optimize:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-optimize")
-                .arg(stepStats.processedElems)
-                .arg(stepStats.totalElems)
-                .arg(stepStats.progress()));
-            break;
-
-        case scanner::ScanStep::ReloadSimilarityEngine:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-reloading-similarity-engine")
-                .arg(stepStats.progress()));
-            break;
-
-        case scanner::ScanStep::ScanFiles:
-            _stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-scanning-files")
-                .arg(stepStats.processedElems)
-                .arg(stepStats.totalElems)
-                .arg(stepStats.progress()));
-            break;
+        const Wt::WDateTime now{ Wt::WDateTime::currentDateTime() };
+        for (const ScanStepStats& stepStats : *stepsStats)
+        {
+            Wt::WText* stepDetails{ _stepDetails->addNew<Wt::WText>(Wt::WString::tr("Lms.Admin.ScannerController.step-details")
+                .arg(stepStatsToWString(stepStats))
+                .arg(durationToString(stepStats.startTime, stepStats.stopTime.isNull() ? now : stepStats.stopTime)), Wt::TextFormat::Plain) };
+            stepDetails->setInline(false);
+            stepDetails->addStyleClass("list-group-item");
         }
     }
 } // namespace lms::ui
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <Wt/WContainerWidget.h>
 #include <Wt/WPushButton.h>
 #include <Wt/WTemplate.h>
 #include <Wt/WLineEdit.h>
@@ -36,12 +37,13 @@ namespace lms::ui
         void refreshContents();
         void refreshLastScanStatus(const scanner::IScannerService::Status& status);
         void refreshStatus(const scanner::IScannerService::Status& status);
-        void refreshCurrentStep(const scanner::ScanStepStats& stepStats);
+        void refreshStepDetails(const scanner::IScannerService::Status& status);
 
         Wt::WPushButton* _reportBtn;
         Wt::WLineEdit* _lastScanStatus;
         Wt::WLineEdit* _status;
         Wt::WLineEdit* _stepStatus;
+        Wt::WContainerWidget* _stepDetails;
         class ReportResource* _reportResource;
     };
 } // namespace lms::dbStatus
@@ -29,6 +29,9 @@
 
 #include "core/ITraceLogger.hpp"
 #include "core/String.hpp"
+#include "database/Db.hpp"
+#include "database/Session.hpp"
+#include "LmsApplication.hpp"
 
 namespace lms::ui
 {
@@ -37,8 +40,9 @@ namespace lms::ui
         class ReportResource : public Wt::WResource
         {
         public:
-            ReportResource(core::tracing::ITraceLogger& traceLogger)
+            ReportResource(core::tracing::ITraceLogger& traceLogger, db::Db& db)
                 : _traceLogger{ traceLogger }
+                , _db{ db }
             {
             }
 
@@ -56,11 +60,14 @@ namespace lms::ui
                 gzipStream.push(boost::iostreams::gzip_compressor{});
                 gzipStream.push(response.out());
 
+                // up to date stats, including the top queries
+                _db.getTLSSession().refreshTracingLoggerStats();
                 _traceLogger.dumpCurrentBuffer(gzipStream);
             }
 
         private:
             core::tracing::ITraceLogger& _traceLogger;
+            db::Db& _db;
         };
     }
 
@@ -73,7 +80,7 @@ namespace lms::ui
 
         if (auto traceLogger{ core::Service<core::tracing::ITraceLogger>::get() })
         {
-            Wt::WLink link{ std::make_shared<ReportResource>(*traceLogger) };
+            Wt::WLink link{ std::make_shared<ReportResource>(*traceLogger, LmsApp->getDb()) };
             link.setTarget(Wt::LinkTarget::NewWindow);
             dumpBtn->setLink(link);
         }
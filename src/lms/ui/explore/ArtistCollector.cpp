@@ -117,11 +117,13 @@ namespace lms::ui
             params.setLinkType(_linkType);
             params.setSortMethod(ArtistSortMethod::SortName);
             params.setRange(range);
+            params.setCursor(getCursor(range));
 
             {
                 auto transaction{ LmsApp->getDbSession().createReadTransaction() };
                 artists = Artist::findIds(LmsApp->getDbSession(), params);
             }
+            setCursor(range, artists.nextCursor);
             break;
         }
         }
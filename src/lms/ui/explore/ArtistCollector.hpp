@@ -38,7 +38,7 @@ namespace lms::ui
 			using DatabaseCollectorBase::DatabaseCollectorBase;
 
 			db::RangeResults<db::ArtistId>	get(std::optional<db::Range> range = std::nullopt);
-			void reset() { _randomArtists.reset(); }
+			void reset() { _randomArtists.reset(); resetCursor(); }
 			void setArtistLinkType(std::optional<db::TrackArtistLinkType> linkType) { _linkType = linkType; }
 
 		private:
@@ -24,9 +24,11 @@
 #include "database/Artist.hpp"
 #include "database/Cluster.hpp"
 #include "database/Release.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/ScanSettings.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "services/feedback/IFeedbackService.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
@@ -130,7 +132,7 @@ namespace lms::ui
         Wt::WContainerWidget* clusterContainers{ bindNew<Wt::WContainerWidget>("clusters") };
 
         {
-            auto clusterTypes{ ClusterType::findIds(LmsApp->getDbSession()).results };
+            auto clusterTypes{ LmsApp->getDbSession().getReferenceData()->getClusterTypeIds() };
             auto clusterGroups{ artist->getClusterGroups(clusterTypes, 3) };
 
             for (const auto& clusters : clusterGroups)
@@ -354,8 +356,8 @@ namespace lms::ui
 
         auto transaction{ LmsApp->getDbSession().createReadTransaction() };
 
-        const auto tracks{ Track::find(LmsApp->getDbSession(), params) };
-        for (const Track::pointer& track : tracks.results)
+        const auto trackIds{ Track::findIds(LmsApp->getDbSession(), params) };
+        for (const TrackSummary& track : TrackSummary::find(LmsApp->getDbSession(), trackIds.results))
         {
             // TODO handle this with range
             if (_trackContainer->getCount() == _tracksMaxCount)
@@ -366,7 +368,7 @@ namespace lms::ui
             areTracksAdded = true;
         }
 
-        _trackContainer->setHasMore(tracks.moreResults);
+        _trackContainer->setHasMore(trackIds.moreResults);
 
         return areTracksAdded;
     }
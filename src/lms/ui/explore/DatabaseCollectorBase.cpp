@@ -56,8 +56,30 @@ namespace lms::ui
         return _maxCount;
     }
 
+    std::optional<db::KeysetCursor> DatabaseCollectorBase::getCursor(Range range) const
+    {
+        if (range.offset == 0 || range.offset != _cursorOffset)
+            return std::nullopt;
+
+        return _cursor;
+    }
+
+    void DatabaseCollectorBase::setCursor(Range retrievedRange, const std::optional<db::KeysetCursor>& nextCursor)
+    {
+        _cursorOffset = retrievedRange.offset + retrievedRange.size;
+        _cursor = nextCursor;
+    }
+
+    void DatabaseCollectorBase::resetCursor()
+    {
+        _cursorOffset = 0;
+        _cursor.reset();
+    }
+
     void DatabaseCollectorBase::setSearch(std::string_view searchText)
     {
+        resetCursor();
+
         _searchText = searchText;
         if (!searchText.empty())
             _searchKeywords = core::stringUtils::splitString(_searchText, ' ');
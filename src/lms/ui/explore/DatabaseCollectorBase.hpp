@@ -51,7 +51,7 @@ namespace lms::ui
         DatabaseCollectorBase(Filters& filters, Mode defaultMode, std::size_t maxCount);
 
         Mode getMode() const { return _mode; }
-        void setMode(Mode mode) { _mode = mode; }
+        void setMode(Mode mode) { _mode = mode; resetCursor(); }
         void setSearch(std::string_view search);
 
     protected:
@@ -60,11 +60,18 @@ namespace lms::ui
         const Filters&    getFilters() { return _filters; }
         const std::vector<std::string_view>& getSearchKeywords() const { return _searchKeywords; }
 
+        // Keyset pagination: remember where the last retrieved range ended, to quickly fetch the following one
+        std::optional<db::KeysetCursor> getCursor(Range range) const;
+        void setCursor(Range retrievedRange, const std::optional<db::KeysetCursor>& nextCursor);
+        void resetCursor();
+
     private:
         Filters& _filters;
         std::string _searchText;
         std::vector<std::string_view> _searchKeywords;
         Mode        _mode;
         std::size_t _maxCount;
+        std::size_t _cursorOffset{};
+        std::optional<db::KeysetCursor> _cursor;
     };
 } // ns UserInterface
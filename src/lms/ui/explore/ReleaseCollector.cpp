@@ -109,11 +109,13 @@ namespace lms::ui
             params.setSortMethod(ReleaseSortMethod::Name);
             params.setKeywords(getSearchKeywords());
             params.setRange(range);
+            params.setCursor(getCursor(range));
 
             {
                 auto transaction{ LmsApp->getDbSession().createReadTransaction() };
                 releases = Release::findIds(LmsApp->getDbSession(), params);
             }
+            setCursor(range, releases.nextCursor);
             break;
         }
         }
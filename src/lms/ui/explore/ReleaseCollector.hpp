@@ -40,7 +40,7 @@ namespace lms::ui
 			using DatabaseCollectorBase::DatabaseCollectorBase;
 
 			db::RangeResults<db::ReleaseId>	get(std::optional<db::Range> range = std::nullopt);
-			void reset() { _randomReleases.reset(); }
+			void reset() { _randomReleases.reset(); resetCursor(); }
 
 		private:
 			db::RangeResults<db::ReleaseId> getRandomReleases(Range range);
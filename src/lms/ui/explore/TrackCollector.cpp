@@ -110,12 +110,15 @@ namespace lms::ui
             params.setClusters(getFilters().getClusters());
             params.setMediaLibrary(getFilters().getMediaLibrary());
             params.setKeywords(getSearchKeywords());
+            params.setSortMethod(TrackSortMethod::Id);
             params.setRange(range);
+            params.setCursor(getCursor(range));
 
             {
                 auto transaction{ LmsApp->getDbSession().createReadTransaction() };
                 tracks = Track::findIds(LmsApp->getDbSession(), params);
             }
+            setCursor(range, tracks.nextCursor);
             break;
         }
         }
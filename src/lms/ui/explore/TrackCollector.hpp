@@ -38,7 +38,7 @@ namespace lms::ui
 			using DatabaseCollectorBase::DatabaseCollectorBase;
 
 			db::RangeResults<db::TrackId>	get(std::optional<db::Range> range = std::nullopt);
-			void reset() { _randomTracks.reset(); }
+			void reset() { _randomTracks.reset(); resetCursor(); }
 
 		private:
 			db::RangeResults<db::TrackId> getRandomTracks(Range range);
@@ -30,6 +30,7 @@
 #include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "database/TrackArtistLink.hpp"
+#include "database/TrackSummary.hpp"
 #include "database/User.hpp"
 #include "services/feedback/IFeedbackService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
@@ -151,30 +152,29 @@ namespace lms::ui::TrackListHelpers
         LmsApp->getModalManager().show(std::move(trackInfo));
     }
 
-    std::unique_ptr<Wt::WWidget> createEntry(const db::ObjectPtr<db::Track>& track, PlayQueueController& playQueueController, Filters& filters)
+    std::unique_ptr<Wt::WWidget> createEntry(const db::TrackSummary& track, PlayQueueController& playQueueController, Filters& filters)
     {
         auto entry{ std::make_unique<Template>(Wt::WString::tr("Lms.Explore.Tracks.template.entry")) };
         auto* entryPtr{ entry.get() };
 
-        entry->bindString("name", Wt::WString::fromUTF8(track->getName()), Wt::TextFormat::Plain);
+        entry->bindString("name", Wt::WString::fromUTF8(track.name), Wt::TextFormat::Plain);
 
-        const Release::pointer release{ track->getRelease() };
-        const TrackId trackId{ track->getId() };
+        const TrackId trackId{ track.id };
 
-        const auto artists{ track->getArtistIds({TrackArtistLinkType::Artist}) };
+        const auto artists{ track.getArtists(TrackArtistLinkType::Artist) };
         if (!artists.empty())
         {
             entry->setCondition("if-has-artists", true);
-            entry->bindWidget("artists", utils::createArtistDisplayNameWithAnchors(track->getArtistDisplayName(), artists));
-            entry->bindWidget("artists-md", utils::createArtistDisplayNameWithAnchors(track->getArtistDisplayName(), artists));
+            entry->bindWidget("artists", utils::createArtistDisplayNameWithAnchors(track.artistDisplayName, artists));
+            entry->bindWidget("artists-md", utils::createArtistDisplayNameWithAnchors(track.artistDisplayName, artists));
         }
 
-        if (track->getRelease())
+        if (track.releaseId.isValid())
         {
             entry->setCondition("if-has-release", true);
-            entry->bindWidget("release", utils::createReleaseAnchor(track->getRelease()));
-            Wt::WAnchor* anchor{ entry->bindWidget("cover", utils::createReleaseAnchor(release, false)) };
-            auto cover{ utils::createCover(release->getId(), CoverResource::Size::Small) };
+            entry->bindWidget("release", utils::createReleaseAnchor(track.releaseId, track.releaseMBID, track.releaseName));
+            Wt::WAnchor* anchor{ entry->bindWidget("cover", utils::createReleaseAnchor(track.releaseId, track.releaseMBID, track.releaseName, false)) };
+            auto cover{ utils::createCover(track.releaseId, CoverResource::Size::Small) };
             cover->addStyleClass("Lms-cover-track Lms-cover-anchor"); // HACK
             anchor->setImage(std::move((cover)));
         }
@@ -185,7 +185,7 @@ namespace lms::ui::TrackListHelpers
             entry->bindWidget<Wt::WImage>("cover", std::move(cover));
         }
 
-        entry->bindString("duration", utils::durationToString(track->getDuration()), Wt::TextFormat::Plain);
+        entry->bindString("duration", utils::durationToString(track.duration), Wt::TextFormat::Plain);
 
         Wt::WPushButton* playBtn{ entry->bindNew<Wt::WPushButton>("play-btn", Wt::WString::tr("Lms.template.play-btn"), Wt::TextFormat::XHTML) };
         playBtn->clicked().connect([trackId, &playQueueController]
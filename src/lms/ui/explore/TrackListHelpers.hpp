@@ -28,6 +28,7 @@
 namespace lms::db
 {
 	class Track;
+	struct TrackSummary;
 }
 
 namespace lms::ui
@@ -39,6 +40,6 @@ namespace lms::ui
 namespace lms::ui::TrackListHelpers
 {
 	void showTrackInfoModal(db::TrackId trackId, Filters& filters);
-	std::unique_ptr<Wt::WWidget> createEntry(const db::ObjectPtr<db::Track>& track, PlayQueueController& playQueueController, Filters& filters);
+	std::unique_ptr<Wt::WWidget> createEntry(const db::TrackSummary& track, PlayQueueController& playQueueController, Filters& filters);
 } // namespace lms::ui
 
@@ -22,10 +22,12 @@
 #include <Wt/WPushButton.h>
 
 #include "database/Cluster.hpp"
+#include "database/ReferenceData.hpp"
 #include "database/ScanSettings.hpp"
 #include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "database/TrackList.hpp"
+#include "database/TrackSummary.hpp"
 #include "core/ILogger.hpp"
 #include "core/String.hpp"
 
@@ -99,7 +101,7 @@ namespace lms::ui
 
         Wt::WContainerWidget* clusterContainers{ bindNew<Wt::WContainerWidget>("clusters") };
         {
-            const auto clusterTypeIds{ ClusterType::findIds(LmsApp->getDbSession()).results };
+            const auto clusterTypeIds{ LmsApp->getDbSession().getReferenceData()->getClusterTypeIds() };
             const auto clusterGroups{ trackList->getClusterGroups(clusterTypeIds, 3) };
 
             for (const auto& clusters : clusterGroups)
@@ -189,13 +191,11 @@ namespace lms::ui
         params.setSortMethod(db::TrackSortMethod::TrackList);
         params.setRange(db::Range{ static_cast<std::size_t>(_container->getCount()), _batchSize });
         
-        bool moreResults{};
-        db::Track::find(LmsApp->getDbSession(), params, moreResults, [this](const Track::pointer& track)
-            {
-                _container->add(TrackListHelpers::createEntry(track, _playQueueController, _filters));
-            });
-            
-        _container->setHasMore(moreResults);
+        const auto trackIds{ db::Track::findIds(LmsApp->getDbSession(), params) };
+        for (const db::TrackSummary& track : db::TrackSummary::find(LmsApp->getDbSession(), trackIds.results))
+            _container->add(TrackListHelpers::createEntry(track, _playQueueController, _filters));
+
+        _container->setHasMore(trackIds.moreResults);
     }
 } // namespace lms::ui
 
@@ -24,6 +24,7 @@
 
 #include "database/Session.hpp"
 #include "database/Track.hpp"
+#include "database/TrackSummary.hpp"
 #include "core/ILogger.hpp"
 
 #include "common/InfiniteScrollingContainer.hpp"
@@ -119,11 +120,8 @@ namespace lms::ui
 
         const auto trackIds{ _trackCollector.get(Range {static_cast<std::size_t>(_container->getCount()), _batchSize}) };
 
-        for (const TrackId trackId : trackIds.results)
-        {
-            if (const Track::pointer track{ Track::find(LmsApp->getDbSession(), trackId) })
-                _container->add(TrackListHelpers::createEntry(track, _playQueueController, _filters));
-        }
+        for (const TrackSummary& track : TrackSummary::find(LmsApp->getDbSession(), trackIds.results))
+            _container->add(TrackListHelpers::createEntry(track, _playQueueController, _filters));
 
         _container->setHasMore(trackIds.moreResults);
     }
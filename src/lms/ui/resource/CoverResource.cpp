@@ -23,12 +23,15 @@
 #include <Wt/Http/Response.h>
 
 #include "services/cover/ICoverService.hpp"
+#include "database/ReferenceData.hpp"
+#include "database/Session.hpp"
 #include "database/Track.hpp"
 #include "core/Exception.hpp"
 #include "core/ILogger.hpp"
 #include "core/ITraceLogger.hpp"
 #include "core/Service.hpp"
 #include "core/String.hpp"
+#include "core/http/ConditionalRequest.hpp"
 
 #include "LmsApplication.hpp"
 
@@ -36,6 +39,16 @@
 
 namespace lms::ui
 {
+    namespace
+    {
+        core::http::CacheValidators computeCacheValidators(std::string_view objectId, std::size_t size)
+        {
+            const std::size_t libraryGeneration{ LmsApp->getDbSession().getReferenceData()->libraryGeneration };
+
+            return core::http::CacheValidators{ core::http::computeEntityTag(std::string{ objectId } + "/" + std::to_string(size) + "/" + std::to_string(libraryGeneration)), {} };
+        }
+    }
+
     CoverResource::CoverResource()
     {
         LmsApp->getScannerEvents().scanComplete.connect(this, [this](const scanner::ScanStats& stats)
@@ -83,6 +96,17 @@ namespace lms::ui
             return;
         }
 
+        if (!trackIdStr && !releaseIdStr)
+        {
+            LOG(DEBUG, "No track or release provided");
+            return;
+        }
+
+        // The resource url changes when the library does, the client can keep its copy for a while
+        const core::http::CacheValidators validators{ computeCacheValidators(trackIdStr ? "track" + *trackIdStr : "release" + *releaseIdStr, *size) };
+        if (core::http::processConditionalRequest(request, response, validators, "private, max-age=86400"))
+            return;
+
         std::shared_ptr<image::IEncodedImage> cover;
 
         if (trackIdStr)
@@ -100,7 +124,7 @@ namespace lms::ui
             if (!cover)
                 cover = core::Service<cover::ICoverService>::get()->getDefaultSvgCover();
         }
-        else if (releaseIdStr)
+        else
         {
             LOG(DEBUG, "Requested cover for release " << *releaseIdStr << ", size = " << *size);
 
@@ -112,11 +136,6 @@ namespace lms::ui
             if (!cover)
                 cover = core::Service<cover::ICoverService>::get()->getDefaultSvgCover();
         }
-        else
-        {
-            LOG(DEBUG, "No track or release provided");
-            return;
-        }
 
         response.setMimeType(std::string{ cover->getMimeType() });
 
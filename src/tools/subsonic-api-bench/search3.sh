@@ -1,7 +1,26 @@
 #!/bin/bash
 
+usage() {
+    echo "Usage: $0 [-k <keywords_file>] <base_url> <user> <artist_count> <album_count> <song_count> <batch_size> [musicFolderId]"
+    echo "  -k <keywords_file>: keyword search mode, run one search per line of the file instead of browsing with an empty query"
+    exit 1
+}
+
+keywords_file=""
+while getopts "k:" opt; do
+    case "$opt" in
+        k) keywords_file="$OPTARG" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
 if [ "$#" -lt 6 ] || [ "$#" -gt 7 ]; then
-    echo "Usage: $0 <base_url> <user> <artist_count> <album_count> <song_count> <batch_size> [musicFolderId]"
+    usage
+fi
+
+if [ -n "$keywords_file" ] && [ ! -r "$keywords_file" ]; then
+    echo "Cannot read keywords file '$keywords_file'"
     exit 1
 fi
 
@@ -32,8 +51,39 @@ append_music_folder() {
     echo "$url"
 }
 
+url_encode() {
+    local LC_ALL=C # byte wise, to encode UTF-8 sequences
+    local str="$1"
+    local encoded=""
+    local i c
+    for ((i = 0; i < ${#str}; i++)); do
+        c="${str:i:1}"
+        case "$c" in
+            [a-zA-Z0-9.~_-]) encoded+="$c" ;;
+            *) encoded+=$(printf '%%%02X' "'$c") ;;
+        esac
+    done
+    echo "$encoded"
+}
+
 start_time=$(date +%s.%3N)
 
+if [ -n "$keywords_file" ]; then
+    # keyword searches, first page of each category
+    search_count=0
+    while IFS= read -r keywords || [ -n "$keywords" ]; do
+        [ -z "$keywords" ] && continue
+        wget -q -O - "$(append_music_folder "$base_url/rest/search3.view?u=$user&p=$user_password&v=1.13.0&c=benchmark&f=json&query=$(url_encode "$keywords")&artistCount=$artist_count&albumCount=$album_count&songCount=$song_count")" > /dev/null
+        search_count=$((search_count + 1))
+    done < "$keywords_file"
+
+    end_time=$(date +%s.%3N)
+    elapsed_time=$(echo "$end_time - $start_time" | bc)
+
+    echo "Search time: $elapsed_time seconds for $search_count searches"
+    exit 0
+fi
+
 # artists
 echo "Fetching $artist_count artists..."
 for ((i = 0; i < artist_count; i += $batch_size)); do